@@ -44,13 +44,28 @@ abs_build_path = sys.argv[3]
 header_files = [
     'gdbwire_sys.h',
     'gdbwire_string.h',
+    'gdbwire_hash.h',
+    'gdbwire_intern.h',
+    'gdbwire_hex.h',
+    'gdbwire_histogram.h',
     'gdbwire_assert.h',
     'gdbwire_result.h',
     'gdbwire_logger.h',
+    'gdbwire_probe.h',
     'gdbwire_mi_pt.h',
     'gdbwire_mi_pt_alloc.h',
+    'gdbwire_stats.h',
     'gdbwire_mi_parser.h',
+    'gdbwire_mi_schema.h',
     'gdbwire_mi_command.h',
+    'gdbwire_target_state.h',
+    'gdbwire_breakpoint_table.h',
+    'gdbwire_source_file_index.h',
+    'gdbwire_varobj_cache.h',
+    'gdbwire_memory_cache.h',
+    'gdbwire_register_cache.h',
+    'gdbwire_disassembly_cache.h',
+    'gdbwire_line_table_cache.h',
     'gdbwire_mi_grammar.h',
     'gdbwire.h']
 
@@ -59,12 +74,25 @@ source_files = [
     'gdbwire_sys.c',
 
     'gdbwire_string.c',
+    'gdbwire_hash.c',
+    'gdbwire_intern.c',
+    'gdbwire_hex.c',
+    'gdbwire_histogram.c',
 
     'gdbwire_logger.c',
     'gdbwire_mi_parser.c',
     'gdbwire_mi_pt_alloc.c',
     'gdbwire_mi_pt.c',
+    'gdbwire_mi_schema.c',
     'gdbwire_mi_command.c',
+    'gdbwire_target_state.c',
+    'gdbwire_breakpoint_table.c',
+    'gdbwire_source_file_index.c',
+    'gdbwire_varobj_cache.c',
+    'gdbwire_memory_cache.c',
+    'gdbwire_register_cache.c',
+    'gdbwire_disassembly_cache.c',
+    'gdbwire_line_table_cache.c',
 
     'gdbwire_mi_lexer.c',
     'gdbwire_mi_grammar.c',
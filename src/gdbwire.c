@@ -23,6 +23,10 @@
 #include "gdbwire_assert.h"
 #include "gdbwire.h"
 #include "gdbwire_mi_parser.h"
+#include "gdbwire_mi_pt_alloc.h"
+#include "gdbwire_probe.h"
+#include "gdbwire_string.h"
+#include "gdbwire_sys.h"
 
 struct gdbwire
 {
@@ -31,21 +35,389 @@ struct gdbwire
 
     /* The client callback functions */
     struct gdbwire_callbacks callbacks;
+
+    /**
+     * The coalesced stream data waiting to be sent to the client.
+     *
+     * NULL when stream record coalescing is disabled.
+     */
+    struct gdbwire_string *stream_buffer;
+    /* An empty buffer to swap in for stream_buffer when it is flushed */
+    struct gdbwire_string *stream_spare;
+    /* The kind of stream records in stream_buffer */
+    enum gdbwire_mi_stream_record_kind stream_kind;
+    /* The number of stream records in stream_buffer */
+    size_t stream_records;
+    /* Flush the stream_buffer at this many bytes, 0 for no limit */
+    size_t stream_max_bytes;
+    /* Flush the stream_buffer at this many records, 0 for no limit */
+    size_t stream_max_records;
+    /* The arrival time of the first record in stream_buffer */
+    uint64_t stream_arrival;
+
+    /**
+     * The latency histograms, by gdbwire_latency_kind.
+     *
+     * NULL when latency tracking is disabled.
+     */
+    struct gdbwire_histogram *latency[GDBWIRE_LATENCY_PROMPT + 1];
+
+    /* The target state to update or NULL, not owned by gdbwire */
+    struct gdbwire_target_state *target_state;
+
+    /* The breakpoint table to update or NULL, not owned by gdbwire */
+    struct gdbwire_breakpoint_table *breakpoint_table;
+
+    /* The memory cache to update or NULL, not owned by gdbwire */
+    struct gdbwire_memory_cache *memory_cache;
+
+    /* The disassembly cache to update or NULL, not owned by gdbwire */
+    struct gdbwire_disassembly_cache *disassembly_cache;
+
+    /* The line table cache to update or NULL, not owned by gdbwire */
+    struct gdbwire_line_table_cache *line_table_cache;
+
+    /* Called with each streamed source file or NULL if not streaming */
+    gdbwire_source_file_fn source_file_fn;
+    /* The context passed to source_file_fn */
+    void *source_file_context;
+
+    /* Called with each streamed instruction or NULL if not streaming */
+    gdbwire_instruction_fn instruction_fn;
+    /* The context passed to instruction_fn */
+    void *instruction_context;
+
+    /* Called with each streamed symbol file or NULL if not streaming */
+    gdbwire_symbol_file_fn symbol_file_fn;
+    /* Called with each streamed non-debug symbol or NULL if not streaming */
+    gdbwire_symbol_fn nondebug_symbol_fn;
+    /* The context passed to symbol_file_fn and nondebug_symbol_fn */
+    void *symbol_context;
 };
 
+/**
+ * Note that a record is about to be delivered to the client.
+ *
+ * This records the latency of the record, if latency tracking is
+ * enabled, and fires the callback__dispatch probe.
+ *
+ * @param wire
+ * The gdbwire context.
+ *
+ * @param kind
+ * The kind of record being delivered.
+ *
+ * @param arrival
+ * The arrival time of the first byte of the record.
+ *
+ * @param record
+ * The record being delivered.
+ */
+static void
+gdbwire_dispatch_begin(struct gdbwire *wire, enum gdbwire_latency_kind kind,
+        uint64_t arrival, void *record)
+{
+    GDBWIRE_PROBE3(callback__dispatch, wire, (int)kind, record);
+
+    if (wire->latency[kind]) {
+        gdbwire_histogram_record(wire->latency[kind],
+            gdbwire_clock_ns() - arrival);
+    }
+}
+
+/**
+ * Send the coalesced stream data to the client.
+ *
+ * This does nothing if there is no pending stream data.
+ *
+ * The callback may push data, coalescing more stream records, or disable
+ * coalescing. So the pending data is taken out of stream_buffer first,
+ * and an empty buffer takes it's place. If that buffer can not be
+ * allocated, coalescing is disabled rather than losing records.
+ *
+ * @param wire
+ * The gdbwire context to flush.
+ */
+static void
+gdbwire_stream_flush(struct gdbwire *wire)
+{
+    struct gdbwire_mi_stream_record stream_record;
+    struct gdbwire_string *buffer;
+
+    if (!wire->stream_buffer || wire->stream_records == 0) {
+        return;
+    }
+
+    buffer = wire->stream_buffer;
+    wire->stream_buffer = (wire->stream_spare) ? wire->stream_spare :
+        gdbwire_string_create();
+    wire->stream_spare = NULL;
+    wire->stream_records = 0;
+
+    stream_record.kind = wire->stream_kind;
+    stream_record.cstring = gdbwire_string_data(buffer);
+
+    gdbwire_dispatch_begin(wire, GDBWIRE_LATENCY_STREAM,
+        wire->stream_arrival, &stream_record);
+    if (wire->callbacks.gdbwire_stream_record_fn) {
+        wire->callbacks.gdbwire_stream_record_fn(
+            wire->callbacks.context, &stream_record);
+    }
+
+    /* Keep the buffer for the next flush, while coalescing is enabled */
+    if (wire->stream_buffer && !wire->stream_spare) {
+        gdbwire_string_clear(buffer);
+        wire->stream_spare = buffer;
+    } else {
+        gdbwire_string_destroy(buffer);
+    }
+}
+
+/**
+ * Append a stream record to the coalesced stream data.
+ *
+ * @param wire
+ * The gdbwire context, stream record coalescing must be enabled.
+ *
+ * @param stream_record
+ * The stream record to coalesce.
+ */
+static void
+gdbwire_stream_coalesce(struct gdbwire *wire,
+        struct gdbwire_mi_stream_record *stream_record)
+{
+    if (wire->stream_records > 0 && wire->stream_kind != stream_record->kind) {
+        gdbwire_stream_flush(wire);
+    }
+
+    /**
+     * If coalescing was disabled by the flush, or the append fails,
+     * deliver what is available rather than losing the record.
+     */
+    if (!wire->stream_buffer || gdbwire_string_append_cstr(
+            wire->stream_buffer, stream_record->cstring) == -1) {
+        gdbwire_stream_flush(wire);
+        gdbwire_dispatch_begin(wire, GDBWIRE_LATENCY_STREAM,
+            gdbwire_mi_parser_get_line_arrival(wire->parser), stream_record);
+        if (wire->callbacks.gdbwire_stream_record_fn) {
+            wire->callbacks.gdbwire_stream_record_fn(
+                wire->callbacks.context, stream_record);
+        }
+        return;
+    }
+
+    if (wire->stream_records == 0) {
+        wire->stream_arrival =
+            gdbwire_mi_parser_get_line_arrival(wire->parser);
+    }
+    wire->stream_kind = stream_record->kind;
+    wire->stream_records++;
+
+    if ((wire->stream_max_bytes &&
+            gdbwire_string_size(wire->stream_buffer) >=
+                wire->stream_max_bytes) ||
+        (wire->stream_max_records &&
+            wire->stream_records >= wire->stream_max_records)) {
+        gdbwire_stream_flush(wire);
+    }
+}
+
+/**
+ * Deliver the elements of the files=[...] list as they are parsed.
+ *
+ * @return
+ * Non zero if the element was a source file and was delivered.
+ */
+static int
+gdbwire_source_file_element(struct gdbwire *wire, const char *variable,
+        int depth, struct gdbwire_mi_result *element)
+{
+    struct gdbwire_mi_source_file file;
+
+    if (depth != 1 || !variable || strcmp(variable, "files") != 0 ||
+            element->kind != GDBWIRE_MI_TUPLE ||
+            gdbwire_get_mi_source_file(element, &file) != GDBWIRE_OK) {
+        return 0;
+    }
+
+    wire->source_file_fn(wire->source_file_context, &file);
+    gdbwire_mi_result_free(element);
+
+    return 1;
+}
+
+/**
+ * Deliver the instructions of the asm_insns=[...] list as they are parsed.
+ *
+ * In source mode, the instructions are in the line_asm_insn=[...] list
+ * of each src_and_asm_line={...} tuple instead.
+ *
+ * @return
+ * Non zero if the element was an instruction and was delivered.
+ */
+static int
+gdbwire_instruction_element(struct gdbwire *wire, const char *variable,
+        int depth, struct gdbwire_mi_result *element)
+{
+    struct gdbwire_mi_instruction instruction;
+
+    if (!variable || element->kind != GDBWIRE_MI_TUPLE || element->variable) {
+        return 0;
+    }
+
+    if (!(depth == 1 && strcmp(variable, "asm_insns") == 0) &&
+            !(depth == 3 && strcmp(variable, "line_asm_insn") == 0)) {
+        return 0;
+    }
+
+    if (gdbwire_get_mi_instruction(element, &instruction) != GDBWIRE_OK) {
+        return 0;
+    }
+
+    wire->instruction_fn(wire->instruction_context, &instruction);
+    gdbwire_mi_result_free(element);
+
+    return 1;
+}
+
+/**
+ * Deliver the elements of the debug=[...] and nondebug=[...] lists of
+ * the -symbol-info-* output as they are parsed.
+ *
+ * Each element of the debug list is a symbol file with all of it's
+ * symbols, so the parse tree holds only one symbol file at a time. The
+ * line itself is buffered in full before parsing starts.
+ *
+ * @return
+ * Non zero if the element was a symbol file or symbol and was delivered.
+ */
+static int
+gdbwire_symbol_element(struct gdbwire *wire, const char *variable,
+        int depth, struct gdbwire_mi_result *element)
+{
+    struct gdbwire_mi_symbol_file file;
+    struct gdbwire_mi_symbol symbol;
+
+    if (depth != 2 || !variable || element->kind != GDBWIRE_MI_TUPLE) {
+        return 0;
+    }
+
+    if (wire->symbol_file_fn && strcmp(variable, "debug") == 0) {
+        if (gdbwire_get_mi_symbol_file(element, &file) != GDBWIRE_OK) {
+            return 0;
+        }
+        wire->symbol_file_fn(wire->symbol_context, &file);
+        gdbwire_mi_symbol_file_free_symbols(&file);
+    } else if (wire->nondebug_symbol_fn && strcmp(variable, "nondebug") == 0) {
+        if (gdbwire_get_mi_symbol(element, &symbol) != GDBWIRE_OK) {
+            return 0;
+        }
+        wire->nondebug_symbol_fn(wire->symbol_context, &symbol);
+    } else {
+        return 0;
+    }
+
+    gdbwire_mi_result_free(element);
+
+    return 1;
+}
+
+/**
+ * Deliver list elements to the streaming functions as they are parsed.
+ *
+ * This is the parser list element function while source files or
+ * instructions are being streamed. See gdbwire_mi_list_element_fn.
+ */
+static int
+gdbwire_list_element(void *context, const char *variable,
+        int depth, struct gdbwire_mi_result *element)
+{
+    struct gdbwire *wire = (struct gdbwire *)context;
+
+    if (wire->source_file_fn &&
+            gdbwire_source_file_element(wire, variable, depth, element)) {
+        return 1;
+    }
+
+    if (wire->instruction_fn &&
+            gdbwire_instruction_element(wire, variable, depth, element)) {
+        return 1;
+    }
+
+    if ((wire->symbol_file_fn || wire->nondebug_symbol_fn) &&
+            gdbwire_symbol_element(wire, variable, depth, element)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Only have the parser offer list elements while something is streamed.
+ *
+ * @param wire
+ * The gdbwire instance.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_update_list_element_fn(struct gdbwire *wire)
+{
+    int streaming = wire->source_file_fn || wire->instruction_fn ||
+        wire->symbol_file_fn || wire->nondebug_symbol_fn;
+
+    return gdbwire_mi_parser_set_list_element_fn(wire->parser,
+        (streaming) ? gdbwire_list_element : NULL, wire);
+}
+
 static void
 gdbwire_mi_output_callback(void *context, struct gdbwire_mi_output *output) {
     struct gdbwire *wire = (struct gdbwire *)context;
 
     struct gdbwire_mi_output *cur = output;
+    uint64_t arrival = gdbwire_mi_parser_get_line_arrival(wire->parser);
 
     while (cur) {
+        /* Coalesced stream data is always delivered before other output */
+        if (cur->kind != GDBWIRE_MI_OUTPUT_OOB ||
+            cur->variant.oob_record->kind != GDBWIRE_MI_STREAM) {
+            gdbwire_stream_flush(wire);
+        }
+
         switch (cur->kind) {
             case GDBWIRE_MI_OUTPUT_OOB: {
                 struct gdbwire_mi_oob_record *oob_record =
                     cur->variant.oob_record;
                 switch (oob_record->kind) {
                     case GDBWIRE_MI_ASYNC:
+                        if (wire->target_state) {
+                            gdbwire_target_state_async_record(
+                                wire->target_state,
+                                    oob_record->variant.async_record);
+                        }
+                        if (wire->breakpoint_table) {
+                            gdbwire_breakpoint_table_async_record(
+                                wire->breakpoint_table,
+                                    oob_record->variant.async_record);
+                        }
+                        if (wire->memory_cache) {
+                            gdbwire_memory_cache_async_record(
+                                wire->memory_cache,
+                                    oob_record->variant.async_record);
+                        }
+                        if (wire->disassembly_cache) {
+                            gdbwire_disassembly_cache_async_record(
+                                wire->disassembly_cache,
+                                    oob_record->variant.async_record);
+                        }
+                        if (wire->line_table_cache) {
+                            gdbwire_line_table_cache_async_record(
+                                wire->line_table_cache,
+                                    oob_record->variant.async_record);
+                        }
+                        gdbwire_dispatch_begin(wire, GDBWIRE_LATENCY_ASYNC,
+                            arrival, oob_record->variant.async_record);
                         if (wire->callbacks.gdbwire_async_record_fn) {
                             wire->callbacks.gdbwire_async_record_fn(
                                 wire->callbacks.context,
@@ -53,22 +425,48 @@ gdbwire_mi_output_callback(void *context, struct gdbwire_mi_output *output) {
                         }
                         break;
                     case GDBWIRE_MI_STREAM:
-                        if (wire->callbacks.gdbwire_stream_record_fn) {
-                            wire->callbacks.gdbwire_stream_record_fn(
-                                wire->callbacks.context,
+                        if (wire->stream_buffer) {
+                            gdbwire_stream_coalesce(wire,
+                                oob_record->variant.stream_record);
+                        } else {
+                            gdbwire_dispatch_begin(wire,
+                                GDBWIRE_LATENCY_STREAM, arrival,
                                     oob_record->variant.stream_record);
+                            if (wire->callbacks.gdbwire_stream_record_fn) {
+                                wire->callbacks.gdbwire_stream_record_fn(
+                                    wire->callbacks.context,
+                                        oob_record->variant.stream_record);
+                            }
                         }
                         break;
                 }
                 break;
             }
             case GDBWIRE_MI_OUTPUT_RESULT:
+                /**
+                 * The streamed elements were in this result record. Stop
+                 * streaming before the callback so the caller can start
+                 * streaming again for the next command from it.
+                 */
+                if (wire->source_file_fn) {
+                    gdbwire_stream_source_files(wire, NULL, NULL);
+                }
+                if (wire->instruction_fn) {
+                    gdbwire_stream_instructions(wire, NULL, NULL);
+                }
+                if (wire->symbol_file_fn || wire->nondebug_symbol_fn) {
+                    gdbwire_stream_symbols(wire, NULL, NULL, NULL);
+                }
+                gdbwire_dispatch_begin(wire, GDBWIRE_LATENCY_RESULT, arrival,
+                    cur->variant.result_record);
                 if (wire->callbacks.gdbwire_result_record_fn) {
                     wire->callbacks.gdbwire_result_record_fn(
                         wire->callbacks.context, cur->variant.result_record);
                 }
                 break;
             case GDBWIRE_MI_OUTPUT_PROMPT:
+                gdbwire_dispatch_begin(wire, GDBWIRE_LATENCY_PROMPT, arrival,
+                    cur->line);
                 if (wire->callbacks.gdbwire_prompt_fn) {
                     wire->callbacks.gdbwire_prompt_fn(
                         wire->callbacks.context, cur->line);
@@ -95,7 +493,7 @@ gdbwire_create(struct gdbwire_callbacks callbacks)
 {
     struct gdbwire *result = 0;
     
-    result = malloc(sizeof(struct gdbwire));
+    result = calloc(1, sizeof(struct gdbwire));
     if (result) {
         struct gdbwire_mi_parser_callbacks parser_callbacks =
             { result,gdbwire_mi_output_callback };
@@ -114,7 +512,10 @@ void
 gdbwire_destroy(struct gdbwire *gdbwire)
 {
     if (gdbwire) {
+        gdbwire_set_latency_tracking(gdbwire, 0);
         gdbwire_mi_parser_destroy(gdbwire->parser);
+        gdbwire_string_destroy(gdbwire->stream_buffer);
+        gdbwire_string_destroy(gdbwire->stream_spare);
         free(gdbwire);
     }
 }
@@ -128,6 +529,209 @@ gdbwire_push_data(struct gdbwire *wire, const char *data, size_t size)
     return result;
 }
 
+enum gdbwire_result
+gdbwire_read_fd(struct gdbwire *wire, int fd, size_t max_bytes,
+        enum gdbwire_read_status *status)
+{
+    GDBWIRE_ASSERT(wire);
+    return gdbwire_mi_parser_read_fd(wire->parser, fd, max_bytes, status);
+}
+
+enum gdbwire_result
+gdbwire_get_stats(struct gdbwire *wire, struct gdbwire_stats *stats)
+{
+    GDBWIRE_ASSERT(wire);
+    return gdbwire_mi_parser_get_stats(wire->parser, stats);
+}
+
+enum gdbwire_result
+gdbwire_reset_stats(struct gdbwire *wire)
+{
+    int kind;
+
+    GDBWIRE_ASSERT(wire);
+
+    for (kind = 0; kind <= GDBWIRE_LATENCY_PROMPT; ++kind) {
+        if (wire->latency[kind]) {
+            gdbwire_histogram_clear(wire->latency[kind]);
+        }
+    }
+
+    return gdbwire_mi_parser_reset_stats(wire->parser);
+}
+
+enum gdbwire_result
+gdbwire_set_stats_timing(struct gdbwire *wire, int enable)
+{
+    GDBWIRE_ASSERT(wire);
+    return gdbwire_mi_parser_set_timing(wire->parser, enable);
+}
+
+enum gdbwire_result
+gdbwire_set_latency_tracking(struct gdbwire *wire, int enable)
+{
+    int kind;
+
+    GDBWIRE_ASSERT(wire);
+
+    /**
+     * Pending stream data has no arrival time, it is measured from
+     * when tracking started.
+     */
+    if (enable && !wire->latency[0]) {
+        wire->stream_arrival = gdbwire_clock_ns();
+    }
+
+    for (kind = 0; kind <= GDBWIRE_LATENCY_PROMPT; ++kind) {
+        if (enable && !wire->latency[kind]) {
+            wire->latency[kind] = gdbwire_histogram_create();
+            if (!wire->latency[kind]) {
+                gdbwire_set_latency_tracking(wire, 0);
+                return GDBWIRE_NOMEM;
+            }
+        } else if (!enable) {
+            gdbwire_histogram_destroy(wire->latency[kind]);
+            wire->latency[kind] = NULL;
+        }
+    }
+
+    return gdbwire_mi_parser_set_arrival_times(wire->parser, enable);
+}
+
+const struct gdbwire_histogram *
+gdbwire_get_latency(struct gdbwire *wire, enum gdbwire_latency_kind kind)
+{
+    return (wire) ? wire->latency[kind] : NULL;
+}
+
+enum gdbwire_result
+gdbwire_set_stream_coalescing(struct gdbwire *wire, int enable,
+        size_t max_bytes, size_t max_records)
+{
+    GDBWIRE_ASSERT(wire);
+
+    if (enable) {
+        if (!wire->stream_buffer) {
+            wire->stream_buffer = gdbwire_string_create();
+            if (!wire->stream_buffer) {
+                return GDBWIRE_NOMEM;
+            }
+            wire->stream_records = 0;
+        }
+        wire->stream_max_bytes = max_bytes;
+        wire->stream_max_records = max_records;
+
+        /* The new limits may already be reached by the pending data */
+        if ((max_bytes &&
+                gdbwire_string_size(wire->stream_buffer) >= max_bytes) ||
+            (max_records && wire->stream_records >= max_records)) {
+            gdbwire_stream_flush(wire);
+        }
+    } else if (wire->stream_buffer) {
+        /* The callback may coalesce more records while it is flushed */
+        while (wire->stream_buffer && wire->stream_records > 0) {
+            gdbwire_stream_flush(wire);
+        }
+        gdbwire_string_destroy(wire->stream_buffer);
+        gdbwire_string_destroy(wire->stream_spare);
+        wire->stream_buffer = NULL;
+        wire->stream_spare = NULL;
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_flush_stream_records(struct gdbwire *wire)
+{
+    GDBWIRE_ASSERT(wire);
+    gdbwire_stream_flush(wire);
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_set_target_state(struct gdbwire *wire,
+        struct gdbwire_target_state *state)
+{
+    GDBWIRE_ASSERT(wire);
+    wire->target_state = state;
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_set_breakpoint_table(struct gdbwire *wire,
+        struct gdbwire_breakpoint_table *table)
+{
+    GDBWIRE_ASSERT(wire);
+    wire->breakpoint_table = table;
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_set_memory_cache(struct gdbwire *wire,
+        struct gdbwire_memory_cache *cache)
+{
+    GDBWIRE_ASSERT(wire);
+    wire->memory_cache = cache;
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_set_disassembly_cache(struct gdbwire *wire,
+        struct gdbwire_disassembly_cache *cache)
+{
+    GDBWIRE_ASSERT(wire);
+    wire->disassembly_cache = cache;
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_set_line_table_cache(struct gdbwire *wire,
+        struct gdbwire_line_table_cache *cache)
+{
+    GDBWIRE_ASSERT(wire);
+    wire->line_table_cache = cache;
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_stream_source_files(struct gdbwire *wire,
+        gdbwire_source_file_fn source_file_fn, void *context)
+{
+    GDBWIRE_ASSERT(wire);
+
+    wire->source_file_fn = source_file_fn;
+    wire->source_file_context = context;
+
+    return gdbwire_update_list_element_fn(wire);
+}
+
+enum gdbwire_result
+gdbwire_stream_instructions(struct gdbwire *wire,
+        gdbwire_instruction_fn instruction_fn, void *context)
+{
+    GDBWIRE_ASSERT(wire);
+
+    wire->instruction_fn = instruction_fn;
+    wire->instruction_context = context;
+
+    return gdbwire_update_list_element_fn(wire);
+}
+
+enum gdbwire_result
+gdbwire_stream_symbols(struct gdbwire *wire,
+        gdbwire_symbol_file_fn symbol_file_fn,
+        gdbwire_symbol_fn nondebug_symbol_fn, void *context)
+{
+    GDBWIRE_ASSERT(wire);
+
+    wire->symbol_file_fn = symbol_file_fn;
+    wire->nondebug_symbol_fn = nondebug_symbol_fn;
+    wire->symbol_context = context;
+
+    return gdbwire_update_list_element_fn(wire);
+}
+
 struct gdbwire_interpreter_exec_context {
     enum gdbwire_result result;
     enum gdbwire_mi_command_kind kind;
@@ -27,7 +27,15 @@ extern "C" {
 #include <stdlib.h>
 #include "gdbwire_result.h"
 #include "gdbwire_mi_pt.h"
+#include "gdbwire_stats.h"
+#include "gdbwire_histogram.h"
 #include "gdbwire_mi_command.h"
+#include "gdbwire_target_state.h"
+#include "gdbwire_breakpoint_table.h"
+#include "gdbwire_memory_cache.h"
+#include "gdbwire_register_cache.h"
+#include "gdbwire_disassembly_cache.h"
+#include "gdbwire_line_table_cache.h"
 
 /* The opaque gdbwire context */
 struct gdbwire;
@@ -167,10 +175,499 @@ void gdbwire_destroy(struct gdbwire *wire);
  *
  * @return
  * GDBWIRE_OK on success or appropriate error result on failure.
+ * GDBWIRE_LOGIC if called from a streaming function, ie. the
+ * gdbwire_source_file_fn, which runs in the middle of parsing a line.
  */
 enum gdbwire_result gdbwire_push_data(struct gdbwire *wire, const char *data,
         size_t size);
 
+/**
+ * Read GDB output from a file descriptor directly into gdbwire.
+ *
+ * This is gdbwire_push_data for callers that own GDB's stdout. Instead of
+ * reading into a buffer of it's own and pushing that buffer, which copies
+ * the data twice, the caller lets gdbwire read it into the buffer the
+ * parser works from. Each call makes a single read.
+ *
+ * During this function, callback events may be invoked to alert the
+ * caller of useful gdbwire_mi events.
+ *
+ * A typical event loop, with fd nonblocking, reads until there is nothing
+ * left,
+ *   do {
+ *       result = gdbwire_read_fd(wire, fd, 65536, &status);
+ *   } while (result == GDBWIRE_OK && (status == GDBWIRE_READ_RECORDS ||
+ *       status == GDBWIRE_READ_PARTIAL));
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param fd
+ * The file descriptor to read GDB output from. It may be blocking or
+ * nonblocking.
+ *
+ * @param max_bytes
+ * The most bytes to read.
+ *
+ * @param status
+ * GDBWIRE_READ_RECORDS if the data read completed at least one record,
+ * which was handed to the callbacks. With stream record coalescing
+ * enabled, a completed stream record may still be pending. Otherwise,
+ * GDBWIRE_READ_PARTIAL, GDBWIRE_READ_AGAIN or GDBWIRE_READ_EOF.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ * If the read fails, GDBWIRE_LOGIC is returned and errno is left set.
+ * Like gdbwire_push_data, GDBWIRE_LOGIC is also returned if called from
+ * a streaming function.
+ */
+enum gdbwire_result gdbwire_read_fd(struct gdbwire *wire, int fd,
+        size_t max_bytes, enum gdbwire_read_status *status);
+
+/**
+ * Get a snapshot of the runtime statistics of gdbwire.
+ *
+ * The statistics count what gdbwire has done with the data pushed to
+ * it, ie. the bytes and lines received, the records parsed by kind and
+ * the memory the parse trees needed. See struct gdbwire_stats.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param stats
+ * The statistics since the gdbwire instance was created, or since they
+ * were last reset.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_get_stats(struct gdbwire *wire,
+        struct gdbwire_stats *stats);
+
+/**
+ * Reset the runtime statistics of gdbwire to zero.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_reset_stats(struct gdbwire *wire);
+
+/**
+ * Enable or disable the timing statistics of gdbwire.
+ *
+ * When enabled, gdbwire measures the time spent lexing, parsing and
+ * in the callbacks. This reads a clock for every token, so it is
+ * disabled by default.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param enable
+ * Non zero to enable the timing statistics, zero to disable them.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_stats_timing(struct gdbwire *wire,
+        int enable);
+
+/** The kinds of records gdbwire measures the latency of. */
+enum gdbwire_latency_kind {
+    /** Delivered with gdbwire_stream_record_fn. */
+    GDBWIRE_LATENCY_STREAM,
+
+    /** Delivered with gdbwire_async_record_fn. */
+    GDBWIRE_LATENCY_ASYNC,
+
+    /** Delivered with gdbwire_result_record_fn. */
+    GDBWIRE_LATENCY_RESULT,
+
+    /** Delivered with gdbwire_prompt_fn. */
+    GDBWIRE_LATENCY_PROMPT
+};
+
+/**
+ * Measure the latency of each record gdbwire delivers.
+ *
+ * The latency of a record is the time from when the first byte of it's
+ * line was pushed with gdbwire_push_data until it's callback is
+ * invoked, in nanoseconds. A line that waits in gdbwire across several
+ * pushes is measured from the first of them. Coalesced stream records
+ * are measured from the first record coalesced.
+ *
+ * The latencies are recorded in a histogram for each kind of record,
+ * which gdbwire_get_latency returns, so the tail latencies can be
+ * queried with gdbwire_histogram_quantile. gdbwire_reset_stats clears
+ * the histograms.
+ *
+ * Measuring reads a clock on each push and each record, so it is
+ * disabled by default.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param enable
+ * Non zero to measure latency, zero to stop and discard the histograms.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_latency_tracking(struct gdbwire *wire,
+        int enable);
+
+/**
+ * Get the latency histogram of a kind of record.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param kind
+ * The kind of record.
+ *
+ * @return
+ * The histogram of latencies in nanoseconds, owned by gdbwire, or NULL
+ * if latency tracking is not enabled.
+ */
+const struct gdbwire_histogram *gdbwire_get_latency(struct gdbwire *wire,
+        enum gdbwire_latency_kind kind);
+
+/**
+ * Coalesce consecutive stream records of the same kind.
+ *
+ * Commands like "info functions" or "x/4096x" run through the console
+ * interpreter can produce thousands of stream records in a row. By
+ * default, each one of them results in a gdbwire_stream_record_fn
+ * callback. When coalescing is enabled, consecutive stream records of
+ * the same kind are appended into a single buffer instead, and delivered
+ * as one gdbwire_stream_record_fn callback.
+ *
+ * The pending stream data is flushed to the caller when,
+ * - a stream record of a different kind arrives
+ * - any other output arrives (async record, result record, prompt or
+ *   parse error), the stream data is delivered before that output
+ * - the pending data reaches max_bytes or max_records
+ * - coalescing is disabled with this function
+ * - the caller flushes it with gdbwire_flush_stream_records
+ *
+ * Since GDB always ends a command with a prompt, the caller will receive
+ * all of the stream data before it is ready to receive the next command.
+ * Any pending stream data is discarded when the gdbwire instance is
+ * destroyed, so a caller that stops reading before the prompt, ie.
+ * because GDB exited, flushes it first.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param enable
+ * Non zero to enable coalescing, zero to disable it.
+ *
+ * @param max_bytes
+ * Flush the pending data once it is at least this many bytes long.
+ * Use 0 for no limit.
+ *
+ * @param max_records
+ * Flush the pending data once this many stream records have been
+ * coalesced. Use 0 for no limit.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_stream_coalescing(struct gdbwire *wire,
+        int enable, size_t max_bytes, size_t max_records);
+
+/**
+ * Deliver the pending coalesced stream data now.
+ *
+ * The pending data is handed to the gdbwire_stream_record_fn callback
+ * as one stream record. This does nothing if coalescing is disabled or
+ * no stream data is pending.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_flush_stream_records(struct gdbwire *wire);
+
+/**
+ * Keep a target state up to date with the output of GDB.
+ *
+ * Each asynchronous record gdbwire receives is given to the target state
+ * before the gdbwire_async_record_fn callback is invoked. This way, the
+ * target state is already up to date when the caller receives the
+ * asynchronous record.
+ *
+ * The gdbwire instance does not take ownership of the target state.
+ * The caller must keep it alive until it is detached, or until
+ * the gdbwire instance is destroyed.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param state
+ * The target state to update or NULL to detach the current one.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_target_state(struct gdbwire *wire,
+        struct gdbwire_target_state *state);
+
+/**
+ * Keep a breakpoint table up to date with the output of GDB.
+ *
+ * Each asynchronous record gdbwire receives is given to the breakpoint
+ * table before the gdbwire_async_record_fn callback is invoked.
+ *
+ * The gdbwire instance does not take ownership of the breakpoint table.
+ * The caller must keep it alive until it is detached, or until
+ * the gdbwire instance is destroyed.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param table
+ * The breakpoint table to update or NULL to detach the current one.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_breakpoint_table(struct gdbwire *wire,
+        struct gdbwire_breakpoint_table *table);
+
+/**
+ * Keep a memory cache up to date with the output of GDB.
+ *
+ * Each asynchronous record gdbwire receives is given to the memory
+ * cache before the gdbwire_async_record_fn callback is invoked.
+ *
+ * The gdbwire instance does not take ownership of the memory cache.
+ * The caller must keep it alive until it is detached, or until
+ * the gdbwire instance is destroyed.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param cache
+ * The memory cache to update or NULL to detach the current one.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_memory_cache(struct gdbwire *wire,
+        struct gdbwire_memory_cache *cache);
+
+/**
+ * Keep a disassembly cache up to date with the output of GDB.
+ *
+ * Each asynchronous record gdbwire receives is given to the disassembly
+ * cache before the gdbwire_async_record_fn callback is invoked.
+ *
+ * The gdbwire instance does not take ownership of the disassembly cache.
+ * The caller must keep it alive until it is detached, or until
+ * the gdbwire instance is destroyed.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param cache
+ * The disassembly cache to update or NULL to detach the current one.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_disassembly_cache(struct gdbwire *wire,
+        struct gdbwire_disassembly_cache *cache);
+
+/**
+ * Keep a line table cache up to date with the output of GDB.
+ *
+ * Each asynchronous record gdbwire receives is given to the line table
+ * cache before the gdbwire_async_record_fn callback is invoked.
+ *
+ * The gdbwire instance does not take ownership of the line table cache.
+ * The caller must keep it alive until it is detached, or until
+ * the gdbwire instance is destroyed.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param cache
+ * The line table cache to update or NULL to detach the current one.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_set_line_table_cache(struct gdbwire *wire,
+        struct gdbwire_line_table_cache *cache);
+
+/**
+ * A source file streamed from the -file-list-exec-source-files output.
+ *
+ * @param context
+ * The context pointer passed to gdbwire_stream_source_files.
+ *
+ * @param file
+ * The source file. The file and it's strings are only valid during
+ * this call, copy them if they are needed later.
+ *
+ * This is called while the line is being parsed, so gdbwire_push_data
+ * and gdbwire_read_fd can not be called from it. The same goes for the
+ * other streaming functions.
+ */
+typedef void (*gdbwire_source_file_fn)(void *context,
+        struct gdbwire_mi_source_file *file);
+
+/**
+ * Stream the source files of the next -file-list-exec-source-files result.
+ *
+ * For large programs, GDB outputs hundreds of thousands of source files
+ * on a single line. Decoding them with gdbwire_get_mi_command requires
+ * the parse tree of the entire line and then a copy of every file.
+ * Instead, call this function before sending the command to GDB and each
+ * source file is passed to source_file_fn as soon as it is parsed, and
+ * then freed.
+ *
+ * The line is only parsed once all of it has arrived, so the whole line
+ * is still buffered. Streaming saves the parse tree and the decoded
+ * copies of the files, not the line itself.
+ *
+ * The source files are left out of the parse tree, so the result record
+ * passed to gdbwire_result_record_fn has an empty files list. Streaming
+ * stops automatically when that result record arrives.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param source_file_fn
+ * The function to pass each source file to, or NULL to stop streaming.
+ *
+ * @param context
+ * An arbitrary pointer passed to source_file_fn.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_stream_source_files(struct gdbwire *wire,
+        gdbwire_source_file_fn source_file_fn, void *context);
+
+/**
+ * An instruction streamed from the -data-disassemble output.
+ *
+ * @param context
+ * The context pointer passed to gdbwire_stream_instructions.
+ *
+ * @param instruction
+ * The instruction. The instruction and it's strings are only valid during
+ * this call, copy them if they are needed later.
+ */
+typedef void (*gdbwire_instruction_fn)(void *context,
+        struct gdbwire_mi_instruction *instruction);
+
+/**
+ * Stream the instructions of the next -data-disassemble result.
+ *
+ * Disassembling a large function outputs thousands of instructions on
+ * a single line. Rather than building the parse tree of the entire line,
+ * call this function before sending the command to GDB and each
+ * instruction is passed to instruction_fn as soon as it is parsed, and
+ * then freed. The line is only parsed once all of it has arrived.
+ *
+ * The instructions are left out of the parse tree, so the result record
+ * passed to gdbwire_result_record_fn has an empty asm_insns list. In
+ * source mode, the src_and_asm_line tuples are still in the parse tree,
+ * each with an empty line_asm_insn list. Streaming stops automatically
+ * when that result record arrives.
+ *
+ * Streaming instructions and streaming source files can be done at the
+ * same time, since they come from different lists.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param instruction_fn
+ * The function to pass each instruction to, or NULL to stop streaming.
+ *
+ * @param context
+ * An arbitrary pointer passed to instruction_fn.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_stream_instructions(struct gdbwire *wire,
+        gdbwire_instruction_fn instruction_fn, void *context);
+
+/**
+ * A symbol file streamed from the -symbol-info-* output.
+ *
+ * @param context
+ * The context pointer passed to gdbwire_stream_symbols.
+ *
+ * @param file
+ * The symbol file, with all of it's debug symbols. The file, it's
+ * symbols and their strings are only valid during this call, copy them
+ * if they are needed later.
+ */
+typedef void (*gdbwire_symbol_file_fn)(void *context,
+        struct gdbwire_mi_symbol_file *file);
+
+/**
+ * A non-debug symbol streamed from the -symbol-info-* output.
+ *
+ * @param context
+ * The context pointer passed to gdbwire_stream_symbols.
+ *
+ * @param symbol
+ * The symbol. The symbol and it's strings are only valid during this
+ * call, copy them if they are needed later.
+ */
+typedef void (*gdbwire_symbol_fn)(void *context,
+        struct gdbwire_mi_symbol *symbol);
+
+/**
+ * Stream the symbols of the next -symbol-info-functions,
+ * -symbol-info-variables or -symbol-info-types result.
+ *
+ * Symbol queries against large programs output tens of megabytes on
+ * a single line. Call this function before sending the command to GDB
+ * and each symbol file is passed to symbol_file_fn as soon as the parser
+ * has it's last symbol, and then freed. The non-debug symbols are passed
+ * to nondebug_symbol_fn one at a time.
+ *
+ * The line is only parsed once all of it has arrived, so the whole line
+ * is still buffered and memory peaks at least at the size of the result.
+ * Streaming keeps the parse tree to one symbol file at a time, rather
+ * than a parse tree and a decoded copy of the whole result on top.
+ *
+ * The streamed elements are left out of the parse tree, so the result
+ * record passed to gdbwire_result_record_fn has empty debug and nondebug
+ * lists. Streaming stops automatically when that result record arrives.
+ *
+ * @param wire
+ * The gdbwire context to operate on.
+ *
+ * @param symbol_file_fn
+ * The function to pass each symbol file to, or NULL to leave the
+ * symbol files in the parse tree.
+ *
+ * @param nondebug_symbol_fn
+ * The function to pass each non-debug symbol to, or NULL to leave the
+ * non-debug symbols in the parse tree.
+ *
+ * @param context
+ * An arbitrary pointer passed to symbol_file_fn and nondebug_symbol_fn.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_stream_symbols(struct gdbwire *wire,
+        gdbwire_symbol_file_fn symbol_file_fn,
+        gdbwire_symbol_fn nondebug_symbol_fn, void *context);
+
 /**
  * Handle an interpreter-exec command.
  *
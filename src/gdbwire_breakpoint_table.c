@@ -0,0 +1,395 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_hash.h"
+#include "gdbwire_breakpoint_table.h"
+
+/**
+ * The breakpoint as stored in the breakpoint table.
+ *
+ * The public breakpoint must be the first member so that a pointer to
+ * the public breakpoint can be converted back into this structure.
+ */
+struct gdbwire_breakpoint_table_entry {
+    struct gdbwire_breakpoint breakpoint;
+    /* The number of entries allocated in the locations array */
+    size_t locations_capacity;
+    /* The last resynchronization that reported this breakpoint */
+    unsigned long generation;
+    /* The index of this breakpoint in the table's breakpoints array */
+    size_t index;
+};
+
+struct gdbwire_breakpoint_table {
+    /* The client callback functions */
+    struct gdbwire_breakpoint_table_callbacks callbacks;
+
+    /* The breakpoints indexed by number, does not own the breakpoints */
+    struct gdbwire_hash *breakpoints_by_number;
+    /* The breakpoints in a dense array for iteration, owns the breakpoints */
+    struct gdbwire_breakpoint **breakpoints;
+    /* The number of breakpoints */
+    size_t breakpoints_size;
+    /* The number of entries allocated in breakpoints */
+    size_t breakpoints_capacity;
+
+    /* Incremented each time the table is resynchronized */
+    unsigned long generation;
+};
+
+/**
+ * Free a breakpoint table entry.
+ *
+ * @param breakpoint
+ * The breakpoint to free.
+ */
+static void
+gdbwire_breakpoint_free(struct gdbwire_breakpoint *breakpoint)
+{
+    gdbwire_mi_breakpoint_free(breakpoint->breakpoint);
+    free(breakpoint->locations);
+    free(breakpoint);
+}
+
+static void
+gdbwire_breakpoint_table_notify(struct gdbwire_breakpoint_table *table,
+        enum gdbwire_breakpoint_table_change change,
+        struct gdbwire_breakpoint *breakpoint)
+{
+    if (table->callbacks.gdbwire_breakpoint_fn) {
+        table->callbacks.gdbwire_breakpoint_fn(table->callbacks.context,
+            change, breakpoint);
+    }
+}
+
+struct gdbwire_breakpoint_table *
+gdbwire_breakpoint_table_create(
+        struct gdbwire_breakpoint_table_callbacks callbacks)
+{
+    struct gdbwire_breakpoint_table *table;
+
+    table = calloc(1, sizeof(struct gdbwire_breakpoint_table));
+    if (!table) {
+        return NULL;
+    }
+
+    table->callbacks = callbacks;
+    table->breakpoints_by_number = gdbwire_hash_create(NULL);
+    if (!table->breakpoints_by_number) {
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void
+gdbwire_breakpoint_table_destroy(struct gdbwire_breakpoint_table *table)
+{
+    size_t index;
+
+    if (table) {
+        for (index = 0; index < table->breakpoints_size; ++index) {
+            gdbwire_breakpoint_free(table->breakpoints[index]);
+        }
+        free(table->breakpoints);
+        gdbwire_hash_destroy(table->breakpoints_by_number);
+        free(table);
+    }
+}
+
+/**
+ * Replace the mi breakpoint of a breakpoint table entry.
+ *
+ * The locations array is rebuilt from the locations of the mi breakpoint.
+ *
+ * @param entry
+ * The breakpoint table entry to update.
+ *
+ * @param mi_breakpoint
+ * The new mi breakpoint. The entry takes ownership of it on success.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_NOMEM, in which case the entry is
+ * left unchanged.
+ */
+static enum gdbwire_result
+gdbwire_breakpoint_table_set(struct gdbwire_breakpoint_table_entry *entry,
+        struct gdbwire_mi_breakpoint *mi_breakpoint)
+{
+    struct gdbwire_breakpoint *breakpoint = &entry->breakpoint;
+    struct gdbwire_mi_breakpoint *cur;
+    size_t size = 0, index = 0;
+
+    for (cur = mi_breakpoint->multi_breakpoints; cur; cur = cur->next) {
+        ++size;
+    }
+
+    if (size > entry->locations_capacity) {
+        struct gdbwire_mi_breakpoint **locations = realloc(
+            breakpoint->locations,
+            size * sizeof(struct gdbwire_mi_breakpoint *));
+        if (!locations) {
+            return GDBWIRE_NOMEM;
+        }
+        breakpoint->locations = locations;
+        entry->locations_capacity = size;
+    }
+
+    for (cur = mi_breakpoint->multi_breakpoints; cur; cur = cur->next) {
+        breakpoint->locations[index++] = cur;
+    }
+
+    gdbwire_mi_breakpoint_free(breakpoint->breakpoint);
+    breakpoint->breakpoint = mi_breakpoint;
+    breakpoint->locations_size = size;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Add or modify a breakpoint in the breakpoint table.
+ *
+ * @param table
+ * The breakpoint table.
+ *
+ * @param mi_breakpoint
+ * The breakpoint as GDB reported it. The breakpoint table takes
+ * ownership of it, even on failure.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_breakpoint_table_update(struct gdbwire_breakpoint_table *table,
+        struct gdbwire_mi_breakpoint *mi_breakpoint)
+{
+    enum gdbwire_result result;
+    struct gdbwire_breakpoint_table_entry *entry;
+
+    mi_breakpoint->next = 0;
+
+    entry = gdbwire_hash_find(table->breakpoints_by_number,
+        mi_breakpoint->number);
+    if (entry) {
+        result = gdbwire_breakpoint_table_set(entry, mi_breakpoint);
+        if (result != GDBWIRE_OK) {
+            gdbwire_mi_breakpoint_free(mi_breakpoint);
+            return result;
+        }
+        entry->generation = table->generation;
+        gdbwire_breakpoint_table_notify(table,
+            GDBWIRE_BREAKPOINT_TABLE_MODIFIED, &entry->breakpoint);
+        return GDBWIRE_OK;
+    }
+
+    if (table->breakpoints_size == table->breakpoints_capacity) {
+        size_t capacity = (table->breakpoints_capacity) ?
+            table->breakpoints_capacity * 2 : 16;
+        struct gdbwire_breakpoint **breakpoints = realloc(
+            table->breakpoints, capacity * sizeof(struct gdbwire_breakpoint *));
+        if (!breakpoints) {
+            gdbwire_mi_breakpoint_free(mi_breakpoint);
+            return GDBWIRE_NOMEM;
+        }
+        table->breakpoints = breakpoints;
+        table->breakpoints_capacity = capacity;
+    }
+
+    entry = calloc(1, sizeof(struct gdbwire_breakpoint_table_entry));
+    if (!entry) {
+        gdbwire_mi_breakpoint_free(mi_breakpoint);
+        return GDBWIRE_NOMEM;
+    }
+
+    if (gdbwire_breakpoint_table_set(entry, mi_breakpoint) != GDBWIRE_OK ||
+            gdbwire_hash_insert(table->breakpoints_by_number,
+                mi_breakpoint->number, entry) == -1) {
+        gdbwire_mi_breakpoint_free(mi_breakpoint);
+        free(entry->breakpoint.locations);
+        free(entry);
+        return GDBWIRE_NOMEM;
+    }
+    entry->generation = table->generation;
+    entry->index = table->breakpoints_size;
+
+    table->breakpoints[table->breakpoints_size++] = &entry->breakpoint;
+    gdbwire_breakpoint_table_notify(table,
+        GDBWIRE_BREAKPOINT_TABLE_ADDED, &entry->breakpoint);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Delete a breakpoint from the breakpoint table.
+ *
+ * The last breakpoint in the breakpoints array is moved into it's place,
+ * so deleting does not depend on the number of breakpoints.
+ *
+ * @param table
+ * The breakpoint table.
+ *
+ * @param entry
+ * The breakpoint to delete.
+ */
+static void
+gdbwire_breakpoint_table_delete(struct gdbwire_breakpoint_table *table,
+        struct gdbwire_breakpoint_table_entry *entry)
+{
+    struct gdbwire_breakpoint_table_entry *last;
+
+    gdbwire_breakpoint_table_notify(table,
+        GDBWIRE_BREAKPOINT_TABLE_DELETED, &entry->breakpoint);
+    gdbwire_hash_remove(table->breakpoints_by_number,
+        entry->breakpoint.breakpoint->number);
+
+    last = (struct gdbwire_breakpoint_table_entry *)
+        table->breakpoints[--table->breakpoints_size];
+    table->breakpoints[entry->index] = &last->breakpoint;
+    last->index = entry->index;
+
+    gdbwire_breakpoint_free(&entry->breakpoint);
+}
+
+enum gdbwire_result
+gdbwire_breakpoint_table_break_info(struct gdbwire_breakpoint_table *table,
+        struct gdbwire_mi_command *mi_command)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_breakpoint *cur, *next;
+    size_t index;
+
+    GDBWIRE_ASSERT(table);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_BREAK_INFO);
+
+    cur = mi_command->variant.break_info.breakpoints;
+    mi_command->variant.break_info.breakpoints = 0;
+
+    table->generation++;
+
+    for (; cur; cur = next) {
+        next = cur->next;
+        if (result == GDBWIRE_OK) {
+            result = gdbwire_breakpoint_table_update(table, cur);
+        } else {
+            gdbwire_mi_breakpoint_free(cur);
+        }
+    }
+
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    /* Delete the breakpoints GDB no longer knows about */
+    index = table->breakpoints_size;
+    while (index > 0) {
+        struct gdbwire_breakpoint_table_entry *entry =
+            (struct gdbwire_breakpoint_table_entry *)
+                table->breakpoints[--index];
+        if (entry->generation != table->generation) {
+            gdbwire_breakpoint_table_delete(table, entry);
+        }
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_breakpoint_table_async_record(struct gdbwire_breakpoint_table *table,
+        struct gdbwire_mi_async_record *async_record)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_breakpoint *mi_breakpoint;
+    struct gdbwire_breakpoint_table_entry *entry;
+
+    GDBWIRE_ASSERT(table);
+    GDBWIRE_ASSERT(async_record);
+
+    mi_result = async_record->result;
+
+    switch (async_record->async_class) {
+        case GDBWIRE_MI_ASYNC_BREAKPOINT_CREATED:
+        case GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED:
+            GDBWIRE_ASSERT(mi_result && mi_result->variable &&
+                strcmp(mi_result->variable, "bkpt") == 0);
+            result = gdbwire_get_mi_breakpoint(mi_result, &mi_breakpoint);
+            if (result == GDBWIRE_OK) {
+                result = gdbwire_breakpoint_table_update(table,
+                    mi_breakpoint);
+            }
+            break;
+        case GDBWIRE_MI_ASYNC_BREAKPOINT_DELETED:
+            GDBWIRE_ASSERT(mi_result && mi_result->variable &&
+                strcmp(mi_result->variable, "id") == 0 &&
+                mi_result->kind == GDBWIRE_MI_CSTRING);
+            entry = gdbwire_hash_find(table->breakpoints_by_number,
+                mi_result->variant.cstring);
+            if (entry) {
+                gdbwire_breakpoint_table_delete(table, entry);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
+struct gdbwire_breakpoint *
+gdbwire_breakpoint_table_find(struct gdbwire_breakpoint_table *table,
+        const char *number)
+{
+    return (table) ?
+        gdbwire_hash_find(table->breakpoints_by_number, number) : NULL;
+}
+
+struct gdbwire_mi_breakpoint *
+gdbwire_breakpoint_table_location(struct gdbwire_breakpoint_table *table,
+        const char *number)
+{
+    struct gdbwire_breakpoint *breakpoint;
+    const char *dot;
+    char *end_ptr;
+    unsigned long location;
+    size_t index;
+
+    if (!table || !number || !(dot = strchr(number, '.'))) {
+        return NULL;
+    }
+
+    breakpoint = gdbwire_hash_find_data(table->breakpoints_by_number,
+        number, dot - number);
+    if (!breakpoint) {
+        return NULL;
+    }
+
+    /* GDB numbers the locations from 1, in the order it reports them */
+    errno = 0;
+    location = strtoul(dot + 1, &end_ptr, 10);
+    if (errno == 0 && end_ptr != dot + 1 && *end_ptr == '\0' &&
+            location > 0 && location <= breakpoint->locations_size &&
+            strcmp(breakpoint->locations[location - 1]->number,
+                number) == 0) {
+        return breakpoint->locations[location - 1];
+    }
+
+    for (index = 0; index < breakpoint->locations_size; ++index) {
+        if (strcmp(breakpoint->locations[index]->number, number) == 0) {
+            return breakpoint->locations[index];
+        }
+    }
+
+    return NULL;
+}
+
+struct gdbwire_breakpoint **
+gdbwire_breakpoint_table_breakpoints(struct gdbwire_breakpoint_table *table,
+        size_t *size)
+{
+    *size = (table) ? table->breakpoints_size : 0;
+    return (*size) ? table->breakpoints : NULL;
+}
@@ -0,0 +1,218 @@
+#ifndef GDBWIRE_BREAKPOINT_TABLE_H
+#define GDBWIRE_BREAKPOINT_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A breakpoint table kept up to date incrementally.
+ *
+ * Decoding the output of -break-info after every breakpoint change is
+ * expensive when breakpoints have thousands of locations, as happens
+ * with templates and inlined functions. Instead, the breakpoint table is
+ * seeded once from the output of -break-info and then updated from the
+ * =breakpoint-created, =breakpoint-modified and =breakpoint-deleted
+ * asynchronous records.
+ *
+ * Breakpoints are indexed by breakpoint number and the locations of
+ * each breakpoint are kept in an array, so that finding a breakpoint
+ * or one of it's locations does not require walking any lists.
+ */
+struct gdbwire_breakpoint_table;
+
+/** A breakpoint in the breakpoint table. */
+struct gdbwire_breakpoint {
+    /**
+     * The breakpoint as GDB last reported it.
+     *
+     * This is never NULL. The next field is always NULL, the breakpoints
+     * are not linked together in the breakpoint table.
+     */
+    struct gdbwire_mi_breakpoint *breakpoint;
+
+    /**
+     * The locations of a multiple location breakpoint.
+     *
+     * These are the breakpoints in the multi_breakpoints list of the
+     * breakpoint above, in the order GDB reported them.
+     *
+     * NULL if the breakpoint does not have multiple locations.
+     */
+    struct gdbwire_mi_breakpoint **locations;
+
+    /** The number of locations in the locations array. */
+    size_t locations_size;
+};
+
+/** The changes the breakpoint table reports through it's callbacks. */
+enum gdbwire_breakpoint_table_change {
+    /** A breakpoint was added. */
+    GDBWIRE_BREAKPOINT_TABLE_ADDED,
+    /** A breakpoint was modified. */
+    GDBWIRE_BREAKPOINT_TABLE_MODIFIED,
+    /**
+     * A breakpoint is being deleted.
+     *
+     * The breakpoint is still valid during the callback, but is freed
+     * right after it.
+     */
+    GDBWIRE_BREAKPOINT_TABLE_DELETED
+};
+
+/**
+ * The change notifications of the breakpoint table.
+ *
+ * All of the callbacks are optional, NULL callbacks are not called.
+ */
+struct gdbwire_breakpoint_table_callbacks {
+    /**
+     * An arbitrary pointer to associate with the callbacks.
+     *
+     * This pointer will be passed back to the caller in each callback.
+     */
+    void *context;
+
+    /**
+     * A breakpoint changed.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param change
+     * How the breakpoint changed.
+     *
+     * @param breakpoint
+     * The breakpoint that changed.
+     */
+    void (*gdbwire_breakpoint_fn)(void *context,
+            enum gdbwire_breakpoint_table_change change,
+            struct gdbwire_breakpoint *breakpoint);
+};
+
+/**
+ * Create a breakpoint table instance.
+ *
+ * @param callbacks
+ * The change notifications to invoke.
+ *
+ * @return
+ * A new breakpoint table instance or NULL on error.
+ */
+struct gdbwire_breakpoint_table *gdbwire_breakpoint_table_create(
+        struct gdbwire_breakpoint_table_callbacks callbacks);
+
+/**
+ * Destroy a breakpoint table instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param table
+ * The instance to destroy.
+ */
+void gdbwire_breakpoint_table_destroy(struct gdbwire_breakpoint_table *table);
+
+/**
+ * Resynchronize the breakpoint table with the output of -break-info.
+ *
+ * This is typically done once, when the front end starts. Breakpoints
+ * that are not in the -break-info output are deleted, breakpoints that
+ * are already in the table are modified and the rest are added.
+ *
+ * The breakpoint table takes ownership of the breakpoints in the
+ * command, the breakpoints field of the command is NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param table
+ * The breakpoint table to resynchronize.
+ *
+ * @param mi_command
+ * The decoded -break-info command, of kind GDBWIRE_MI_BREAK_INFO.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_breakpoint_table_break_info(
+        struct gdbwire_breakpoint_table *table,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Update the breakpoint table with an asynchronous record.
+ *
+ * Asynchronous records that do not affect breakpoints are ignored.
+ *
+ * If the breakpoint table is attached to a gdbwire instance with
+ * gdbwire_set_breakpoint_table, gdbwire calls this function for you.
+ *
+ * @param table
+ * The breakpoint table to update.
+ *
+ * @param async_record
+ * The asynchronous record GDB output.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_breakpoint_table_async_record(
+        struct gdbwire_breakpoint_table *table,
+        struct gdbwire_mi_async_record *async_record);
+
+/**
+ * Find a breakpoint by it's number.
+ *
+ * @param table
+ * The breakpoint table to search.
+ *
+ * @param number
+ * The breakpoint number, ie. "2".
+ *
+ * @return
+ * The breakpoint or NULL if there is no breakpoint with that number.
+ */
+struct gdbwire_breakpoint *gdbwire_breakpoint_table_find(
+        struct gdbwire_breakpoint_table *table, const char *number);
+
+/**
+ * Find a location of a multiple location breakpoint by it's number.
+ *
+ * @param table
+ * The breakpoint table to search.
+ *
+ * @param number
+ * The location number, ie. "2.1".
+ *
+ * @return
+ * The location or NULL if there is no location with that number.
+ */
+struct gdbwire_mi_breakpoint *gdbwire_breakpoint_table_location(
+        struct gdbwire_breakpoint_table *table, const char *number);
+
+/**
+ * Get all of the breakpoints.
+ *
+ * The breakpoints are in the order they were added, except that
+ * deleting a breakpoint moves the last breakpoint into it's place.
+ * The array is only valid until the breakpoint table is updated again.
+ *
+ * @param table
+ * The breakpoint table.
+ *
+ * @param size
+ * Will return the number of breakpoints in the array.
+ *
+ * @return
+ * An array of breakpoints or NULL if there are no breakpoints.
+ */
+struct gdbwire_breakpoint **gdbwire_breakpoint_table_breakpoints(
+        struct gdbwire_breakpoint_table *table, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
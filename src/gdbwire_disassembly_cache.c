@@ -0,0 +1,337 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_intern.h"
+#include "gdbwire_disassembly_cache.h"
+
+/** A disassembled range, owning the decoded -data-disassemble output. */
+struct gdbwire_disassembly_cache_range {
+    /* The public part of the range, which owns the arrays */
+    struct gdbwire_disassembly disassembly;
+    /* The strings the instructions and source lines point to */
+    struct gdbwire_intern *strings;
+    /* True if the instructions are in address order */
+    int sorted;
+};
+
+struct gdbwire_disassembly_cache {
+    /* The ranges, sorted by address and never overlapping */
+    struct gdbwire_disassembly_cache_range *ranges;
+    /* The number of ranges */
+    size_t ranges_size;
+    /* The number of ranges allocated */
+    size_t ranges_capacity;
+};
+
+struct gdbwire_disassembly_cache *
+gdbwire_disassembly_cache_create(void)
+{
+    return calloc(1, sizeof(struct gdbwire_disassembly_cache));
+}
+
+void
+gdbwire_disassembly_cache_destroy(struct gdbwire_disassembly_cache *cache)
+{
+    if (cache) {
+        gdbwire_disassembly_cache_clear(cache);
+        free(cache->ranges);
+        free(cache);
+    }
+}
+
+/**
+ * Free the contents of a range.
+ *
+ * @param range
+ * The range to free the contents of.
+ */
+static void
+gdbwire_disassembly_cache_range_free(
+        struct gdbwire_disassembly_cache_range *range)
+{
+    free((void *)range->disassembly.instructions);
+    free((void *)range->disassembly.source_lines);
+    gdbwire_intern_destroy(range->strings);
+}
+
+/**
+ * Remove ranges from the ranges array.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param low
+ * The index of the first range to remove.
+ *
+ * @param high
+ * The index just past the last range to remove.
+ */
+static void
+gdbwire_disassembly_cache_remove(struct gdbwire_disassembly_cache *cache,
+        size_t low, size_t high)
+{
+    size_t index;
+
+    if (low == high) {
+        return;
+    }
+
+    for (index = low; index < high; ++index) {
+        gdbwire_disassembly_cache_range_free(&cache->ranges[index]);
+    }
+
+    memmove(&cache->ranges[low], &cache->ranges[high],
+        (cache->ranges_size - high) *
+            sizeof(struct gdbwire_disassembly_cache_range));
+    cache->ranges_size -= high - low;
+}
+
+/**
+ * Find the first range that ends after an address.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param address
+ * The address to search for.
+ *
+ * @return
+ * The index of the first range whose end is greater than address,
+ * or ranges_size if there is none.
+ */
+static size_t
+gdbwire_disassembly_cache_lower_bound(struct gdbwire_disassembly_cache *cache,
+        uint64_t address)
+{
+    size_t low = 0, high = cache->ranges_size, middle;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (cache->ranges[middle].disassembly.end <= address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Find the ranges that overlap some memory.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param begin
+ * The first address of the memory.
+ *
+ * @param end
+ * The address just past the end of the memory.
+ *
+ * @param high
+ * The index just past the last overlapping range on the way out.
+ *
+ * @return
+ * The index of the first overlapping range. There are none if this
+ * is equal to high.
+ */
+static size_t
+gdbwire_disassembly_cache_overlap(struct gdbwire_disassembly_cache *cache,
+        uint64_t begin, uint64_t end, size_t *high)
+{
+    size_t low = gdbwire_disassembly_cache_lower_bound(cache, begin);
+
+    for (*high = low; *high < cache->ranges_size &&
+            cache->ranges[*high].disassembly.begin < end; ++*high) {
+    }
+
+    return low;
+}
+
+enum gdbwire_result
+gdbwire_disassembly_cache_data_disassemble(
+        struct gdbwire_disassembly_cache *cache,
+        uint64_t begin, uint64_t end,
+        struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_disassembly_cache_range range;
+    struct gdbwire_mi_instruction *instructions;
+    size_t low, high, index, size;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_DATA_DISASSEMBLE);
+    GDBWIRE_ASSERT(begin < end);
+
+    if (cache->ranges_size == cache->ranges_capacity) {
+        size_t capacity = (cache->ranges_capacity) ?
+            cache->ranges_capacity * 2 : 16;
+        struct gdbwire_disassembly_cache_range *ranges = realloc(
+            cache->ranges,
+            capacity * sizeof(struct gdbwire_disassembly_cache_range));
+        if (!ranges) {
+            return GDBWIRE_NOMEM;
+        }
+        cache->ranges = ranges;
+        cache->ranges_capacity = capacity;
+    }
+
+    /* Take the decoded output from the command */
+    instructions = mi_command->variant.data_disassemble.instructions;
+    size = mi_command->variant.data_disassemble.instructions_size;
+
+    memset(&range, 0, sizeof(struct gdbwire_disassembly_cache_range));
+    range.disassembly.begin = begin;
+    range.disassembly.end = end;
+    range.disassembly.instructions = instructions;
+    range.disassembly.instructions_size = size;
+    range.disassembly.source_lines =
+        mi_command->variant.data_disassemble.source_lines;
+    range.disassembly.source_lines_size =
+        mi_command->variant.data_disassemble.source_lines_size;
+    range.strings = mi_command->variant.data_disassemble.strings;
+    range.sorted = 1;
+    for (index = 1; index < size && range.sorted; ++index) {
+        range.sorted = instructions[index - 1].address <
+            instructions[index].address;
+    }
+
+    mi_command->variant.data_disassemble.instructions = NULL;
+    mi_command->variant.data_disassemble.instructions_size = 0;
+    mi_command->variant.data_disassemble.source_lines = NULL;
+    mi_command->variant.data_disassemble.source_lines_size = 0;
+    mi_command->variant.data_disassemble.strings = NULL;
+
+    /* The new range replaces the ranges it overlaps */
+    low = gdbwire_disassembly_cache_overlap(cache, begin, end, &high);
+    gdbwire_disassembly_cache_remove(cache, low, high);
+
+    memmove(&cache->ranges[low + 1], &cache->ranges[low],
+        (cache->ranges_size - low) *
+            sizeof(struct gdbwire_disassembly_cache_range));
+    cache->ranges[low] = range;
+    cache->ranges_size++;
+
+    return GDBWIRE_OK;
+}
+
+const struct gdbwire_disassembly *
+gdbwire_disassembly_cache_find(struct gdbwire_disassembly_cache *cache,
+        uint64_t address)
+{
+    size_t index;
+
+    if (!cache) {
+        return NULL;
+    }
+
+    index = gdbwire_disassembly_cache_lower_bound(cache, address);
+    if (index < cache->ranges_size &&
+            cache->ranges[index].disassembly.begin <= address) {
+        return &cache->ranges[index].disassembly;
+    }
+
+    return NULL;
+}
+
+const struct gdbwire_mi_instruction *
+gdbwire_disassembly_cache_instruction(struct gdbwire_disassembly_cache *cache,
+        uint64_t address)
+{
+    const struct gdbwire_disassembly_cache_range *range;
+    const struct gdbwire_mi_instruction *instructions;
+    size_t low, high, middle;
+
+    range = (const struct gdbwire_disassembly_cache_range *)
+        gdbwire_disassembly_cache_find(cache, address);
+    if (!range) {
+        return NULL;
+    }
+
+    instructions = range->disassembly.instructions;
+    low = 0;
+    high = range->disassembly.instructions_size;
+
+    if (!range->sorted) {
+        /* Source mode 1 outputs the instructions in source line order */
+        for (; low < high; ++low) {
+            if (instructions[low].address == address) {
+                return &instructions[low];
+            }
+        }
+        return NULL;
+    }
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (instructions[middle].address < address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < range->disassembly.instructions_size &&
+            instructions[low].address == address) {
+        return &instructions[low];
+    }
+
+    return NULL;
+}
+
+void
+gdbwire_disassembly_cache_invalidate(struct gdbwire_disassembly_cache *cache,
+        uint64_t address, uint64_t size)
+{
+    uint64_t end = gdbwire_mi_memory_end(address, size);
+    size_t low, high;
+
+    if (!cache || size == 0) {
+        return;
+    }
+
+    low = gdbwire_disassembly_cache_overlap(cache, address, end, &high);
+    gdbwire_disassembly_cache_remove(cache, low, high);
+}
+
+void
+gdbwire_disassembly_cache_clear(struct gdbwire_disassembly_cache *cache)
+{
+    if (cache) {
+        gdbwire_disassembly_cache_remove(cache, 0, cache->ranges_size);
+    }
+}
+
+enum gdbwire_result
+gdbwire_disassembly_cache_async_record(
+        struct gdbwire_disassembly_cache *cache,
+        struct gdbwire_mi_async_record *async_record)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_memory_changed changed;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(async_record);
+
+    switch (async_record->async_class) {
+        case GDBWIRE_MI_ASYNC_MEMORY_CHANGED:
+            result = gdbwire_get_mi_memory_changed(async_record, &changed);
+            if (result != GDBWIRE_OK) {
+                return result;
+            }
+
+            gdbwire_disassembly_cache_invalidate(cache, changed.address,
+                changed.size);
+            break;
+        case GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED:
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED:
+            gdbwire_disassembly_cache_clear(cache);
+            break;
+        default:
+            break;
+    }
+
+    return GDBWIRE_OK;
+}
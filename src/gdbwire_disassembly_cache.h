@@ -0,0 +1,192 @@
+#ifndef GDBWIRE_DISASSEMBLY_CACHE_H
+#define GDBWIRE_DISASSEMBLY_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A cache of disassembled code.
+ *
+ * While the user single steps through a function, a front end shows the
+ * disassembly around the program counter after every step. The code does
+ * not change between steps, so asking GDB to disassemble it again, and
+ * parsing the output again, is wasted work.
+ *
+ * The disassembly cache remembers the decoded -data-disassemble output
+ * by the address range that was disassembled, ie. the -s and -e options.
+ * The front end looks up an address before asking GDB to disassemble it.
+ *
+ * Code is rarely modified, however the disassembly is forgotten when GDB
+ * reports the memory it is in as changed with =memory-changed, and all
+ * of it is forgotten when a library is unloaded or a new process starts,
+ * since different code may then be loaded at the same addresses.
+ */
+struct gdbwire_disassembly_cache;
+
+/** A disassembled address range in the disassembly cache. */
+struct gdbwire_disassembly {
+    /** The first address of the range. */
+    uint64_t begin;
+
+    /** The address just past the end of the range. */
+    uint64_t end;
+
+    /** The instructions, see gdbwire_mi_command's data_disassemble. */
+    const struct gdbwire_mi_instruction *instructions;
+
+    /** The number of instructions in the instructions array. */
+    size_t instructions_size;
+
+    /** The source lines, NULL unless disassembled in source mode. */
+    const struct gdbwire_mi_source_line *source_lines;
+
+    /** The number of source lines in the source_lines array. */
+    size_t source_lines_size;
+};
+
+/**
+ * Create a disassembly cache instance.
+ *
+ * @return
+ * A new disassembly cache instance or NULL on error.
+ */
+struct gdbwire_disassembly_cache *gdbwire_disassembly_cache_create(void);
+
+/**
+ * Destroy a disassembly cache instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param cache
+ * The instance to destroy.
+ */
+void gdbwire_disassembly_cache_destroy(
+        struct gdbwire_disassembly_cache *cache);
+
+/**
+ * Add the output of -data-disassemble to the cache.
+ *
+ * GDB does not output the range that was disassembled, so the caller
+ * passes in the start and end addresses given to -data-disassemble.
+ * Any cached ranges that overlap the new range are replaced by it.
+ *
+ * The disassembly cache takes ownership of the instructions, source lines
+ * and strings of the command, those fields are NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param begin
+ * The start address given to -data-disassemble.
+ *
+ * @param end
+ * The end address given to -data-disassemble.
+ *
+ * @param mi_command
+ * The decoded -data-disassemble command,
+ * of kind GDBWIRE_MI_DATA_DISASSEMBLE.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_disassembly_cache_data_disassemble(
+        struct gdbwire_disassembly_cache *cache,
+        uint64_t begin, uint64_t end,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Find the cached range that contains an address.
+ *
+ * The range is only valid until the disassembly cache is updated again.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param address
+ * The address to search for.
+ *
+ * @return
+ * The range that contains address, or NULL if the address has to be
+ * disassembled by GDB.
+ */
+const struct gdbwire_disassembly *gdbwire_disassembly_cache_find(
+        struct gdbwire_disassembly_cache *cache, uint64_t address);
+
+/**
+ * Find the cached instruction at an address.
+ *
+ * The instruction is only valid until the disassembly cache is
+ * updated again.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param address
+ * The address of the instruction, ie. the program counter.
+ *
+ * @return
+ * The instruction that starts at address, or NULL if there is none.
+ */
+const struct gdbwire_mi_instruction *gdbwire_disassembly_cache_instruction(
+        struct gdbwire_disassembly_cache *cache, uint64_t address);
+
+/**
+ * Update the disassembly cache with an asynchronous record.
+ *
+ * The =memory-changed record forgets the ranges that overlap the changed
+ * memory. The =library-unloaded and =thread-group-started records clear
+ * the cache. Other records are ignored.
+ *
+ * If the disassembly cache is attached to a gdbwire instance with
+ * gdbwire_set_disassembly_cache, gdbwire calls this function for you.
+ *
+ * @param cache
+ * The disassembly cache to update.
+ *
+ * @param async_record
+ * The asynchronous record GDB output.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_disassembly_cache_async_record(
+        struct gdbwire_disassembly_cache *cache,
+        struct gdbwire_mi_async_record *async_record);
+
+/**
+ * Forget the cached ranges that overlap some memory.
+ *
+ * @param cache
+ * The disassembly cache.
+ *
+ * @param address
+ * The address of the first byte of the memory.
+ *
+ * @param size
+ * The number of bytes of memory.
+ */
+void gdbwire_disassembly_cache_invalidate(
+        struct gdbwire_disassembly_cache *cache,
+        uint64_t address, uint64_t size);
+
+/**
+ * Forget all of the cached ranges.
+ *
+ * @param cache
+ * The disassembly cache.
+ */
+void gdbwire_disassembly_cache_clear(struct gdbwire_disassembly_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
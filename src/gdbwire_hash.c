@@ -0,0 +1,333 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "gdbwire_hash.h"
+
+/* An entry in the hash table, unused when key is NULL */
+struct gdbwire_hash_entry {
+    /* The key, owned by the hash table */
+    char *key;
+    /* The length of key */
+    size_t key_size;
+    /* The full hash value of key */
+    size_t hash;
+    /* True if key belongs to the caller and must not be freed */
+    int borrowed;
+    /* The value associated with key */
+    void *value;
+};
+
+struct gdbwire_hash {
+    /* The entries, capacity is always a power of 2 */
+    struct gdbwire_hash_entry *entries;
+    /* The number of entries that hold a key */
+    size_t size;
+    /* The number of entries allocated */
+    size_t capacity;
+    /* The function used to free values or NULL */
+    gdbwire_hash_free_fn free_fn;
+};
+
+size_t
+gdbwire_hash_string(const char *key, size_t size)
+{
+    /* The FNV-1a hash function. */
+    size_t index;
+    unsigned long hash = 2166136261UL;
+
+    for (index = 0; index < size; ++index) {
+        hash ^= (unsigned char)key[index];
+        hash *= 16777619UL;
+    }
+
+    return (size_t)hash;
+}
+
+struct gdbwire_hash *
+gdbwire_hash_create(gdbwire_hash_free_fn free_fn)
+{
+    struct gdbwire_hash *hash;
+
+    hash = calloc(1, sizeof (struct gdbwire_hash));
+    if (hash) {
+        hash->free_fn = free_fn;
+    }
+
+    return hash;
+}
+
+void
+gdbwire_hash_clear(struct gdbwire_hash *hash)
+{
+    size_t index;
+
+    if (hash) {
+        for (index = 0; index < hash->capacity; ++index) {
+            struct gdbwire_hash_entry *entry = &hash->entries[index];
+            if (entry->key) {
+                if (!entry->borrowed) {
+                    free(entry->key);
+                }
+                if (hash->free_fn) {
+                    hash->free_fn(entry->value);
+                }
+                memset(entry, 0, sizeof (struct gdbwire_hash_entry));
+            }
+        }
+        hash->size = 0;
+    }
+}
+
+void
+gdbwire_hash_destroy(struct gdbwire_hash *hash)
+{
+    if (hash) {
+        gdbwire_hash_clear(hash);
+        free(hash->entries);
+        free(hash);
+    }
+}
+
+/**
+ * Find the entry index for a key.
+ *
+ * @param hash
+ * The hash table to search, must have a non zero capacity.
+ *
+ * @param key
+ * The key to search for.
+ *
+ * @param size
+ * The length of key.
+ *
+ * @param key_hash
+ * The hash value of key.
+ *
+ * @return
+ * The index of the entry holding key, or the index of the unused entry
+ * where key would be inserted if it is not in the hash table.
+ */
+static size_t
+gdbwire_hash_lookup(struct gdbwire_hash *hash, const char *key,
+        size_t size, size_t key_hash)
+{
+    size_t mask = hash->capacity - 1;
+    size_t index = key_hash & mask;
+
+    for (;;) {
+        struct gdbwire_hash_entry *entry = &hash->entries[index];
+        if (!entry->key || (entry->hash == key_hash &&
+                entry->key_size == size &&
+                memcmp(entry->key, key, size) == 0)) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/**
+ * Increase the capacity of the hash table.
+ *
+ * @param hash
+ * The hash table to grow.
+ *
+ * @return
+ * 0 on success or -1 on error.
+ */
+static int
+gdbwire_hash_grow(struct gdbwire_hash *hash)
+{
+    struct gdbwire_hash_entry *old_entries = hash->entries;
+    size_t old_capacity = hash->capacity, index;
+    size_t capacity = (old_capacity) ? old_capacity * 2 : 16;
+
+    hash->entries = calloc(capacity, sizeof (struct gdbwire_hash_entry));
+    if (!hash->entries) {
+        hash->entries = old_entries;
+        return -1;
+    }
+    hash->capacity = capacity;
+
+    for (index = 0; index < old_capacity; ++index) {
+        struct gdbwire_hash_entry *entry = &old_entries[index];
+        if (entry->key) {
+            size_t new_index = gdbwire_hash_lookup(hash, entry->key,
+                entry->key_size, entry->hash);
+            hash->entries[new_index] = *entry;
+        }
+    }
+
+    free(old_entries);
+
+    return 0;
+}
+
+/**
+ * Insert a value into the hash table.
+ *
+ * @param hash
+ * The hash table to insert into.
+ *
+ * @param key
+ * The key to associate the value with.
+ *
+ * @param value
+ * The value to insert.
+ *
+ * @param borrowed
+ * True to keep a pointer to key, false to keep a copy of key.
+ *
+ * @return
+ * 0 on success or -1 on failure.
+ */
+static int
+gdbwire_hash_insert_key(struct gdbwire_hash *hash, const char *key,
+        void *value, int borrowed)
+{
+    struct gdbwire_hash_entry *entry;
+    size_t size, key_hash, index;
+
+    if (!hash || !key) {
+        return -1;
+    }
+
+    /* Keep the load factor at or below one half for short probes */
+    if ((hash->size + 1) * 2 > hash->capacity) {
+        if (gdbwire_hash_grow(hash) == -1) {
+            return -1;
+        }
+    }
+
+    size = strlen(key);
+    key_hash = gdbwire_hash_string(key, size);
+    index = gdbwire_hash_lookup(hash, key, size, key_hash);
+    entry = &hash->entries[index];
+
+    if (entry->key) {
+        if (hash->free_fn && entry->value != value) {
+            hash->free_fn(entry->value);
+        }
+    } else {
+        if (borrowed) {
+            entry->key = (char *)key;
+        } else {
+            entry->key = malloc(size + 1);
+            if (!entry->key) {
+                return -1;
+            }
+            memcpy(entry->key, key, size + 1);
+        }
+        entry->borrowed = borrowed;
+        entry->key_size = size;
+        entry->hash = key_hash;
+        hash->size++;
+    }
+    entry->value = value;
+
+    return 0;
+}
+
+int
+gdbwire_hash_insert(struct gdbwire_hash *hash, const char *key, void *value)
+{
+    return gdbwire_hash_insert_key(hash, key, value, 0);
+}
+
+int
+gdbwire_hash_insert_borrowed(struct gdbwire_hash *hash, const char *key,
+        void *value)
+{
+    return gdbwire_hash_insert_key(hash, key, value, 1);
+}
+
+void *
+gdbwire_hash_find_data(struct gdbwire_hash *hash, const char *key,
+        size_t size)
+{
+    size_t index;
+
+    if (!hash || !key || hash->size == 0) {
+        return NULL;
+    }
+
+    index = gdbwire_hash_lookup(hash, key, size,
+        gdbwire_hash_string(key, size));
+
+    return hash->entries[index].value;
+}
+
+void *
+gdbwire_hash_find(struct gdbwire_hash *hash, const char *key)
+{
+    return (key) ? gdbwire_hash_find_data(hash, key, strlen(key)) : NULL;
+}
+
+int
+gdbwire_hash_remove(struct gdbwire_hash *hash, const char *key)
+{
+    size_t size, index, next, mask;
+
+    if (!hash || !key || hash->size == 0) {
+        return -1;
+    }
+
+    size = strlen(key);
+    index = gdbwire_hash_lookup(hash, key, size,
+        gdbwire_hash_string(key, size));
+    if (!hash->entries[index].key) {
+        return -1;
+    }
+
+    if (!hash->entries[index].borrowed) {
+        free(hash->entries[index].key);
+    }
+    if (hash->free_fn) {
+        hash->free_fn(hash->entries[index].value);
+    }
+    memset(&hash->entries[index], 0, sizeof (struct gdbwire_hash_entry));
+    hash->size--;
+
+    /**
+     * Shift the following entries in the probe sequence back, so that
+     * no entry becomes unreachable because of the hole just created.
+     */
+    mask = hash->capacity - 1;
+    for (next = (index + 1) & mask; hash->entries[next].key;
+            next = (next + 1) & mask) {
+        size_t home = hash->entries[next].hash & mask;
+        int movable = (index <= next) ?
+            (home <= index || home > next) :
+            (home <= index && home > next);
+        if (movable) {
+            hash->entries[index] = hash->entries[next];
+            memset(&hash->entries[next], 0,
+                sizeof (struct gdbwire_hash_entry));
+            index = next;
+        }
+    }
+
+    return 0;
+}
+
+size_t
+gdbwire_hash_size(struct gdbwire_hash *hash)
+{
+    return (hash) ? hash->size : 0;
+}
+
+void
+gdbwire_hash_foreach(struct gdbwire_hash *hash,
+        void (*fn)(void *context, const char *key, void *value),
+        void *context)
+{
+    size_t index;
+
+    if (hash && fn) {
+        for (index = 0; index < hash->capacity; ++index) {
+            struct gdbwire_hash_entry *entry = &hash->entries[index];
+            if (entry->key) {
+                fn(context, entry->key, entry->value);
+            }
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#ifndef __GDBWIRE_HASH_H__
+#define __GDBWIRE_HASH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+/**
+ * A hash table mapping strings to values.
+ *
+ * To create and destroy a hash table use gdbwire_hash_create() and
+ * gdbwire_hash_destroy() respectively.
+ *
+ * The keys are copied into the hash table when they are inserted, so the
+ * caller does not have to keep them around. The values are arbitrary
+ * pointers. If a free function is provided when the hash table is created,
+ * the hash table owns the values and will free them when they are
+ * replaced, removed or when the hash table is destroyed.
+ *
+ * The hash table uses open addressing, so inserting or removing an entry
+ * may move other entries around. Do not insert or remove entries while
+ * iterating over the hash table with gdbwire_hash_foreach().
+ */
+struct gdbwire_hash;
+
+/**
+ * The function used to free a value in the hash table.
+ *
+ * @param value
+ * The value to free.
+ */
+typedef void (*gdbwire_hash_free_fn)(void *value);
+
+/**
+ * Create a hash table instance.
+ *
+ * @param free_fn
+ * The function used to free values or NULL if the hash table should not
+ * free the values stored in it.
+ *
+ * @return
+ * A valid hash table instance or NULL on error.
+ */
+struct gdbwire_hash *gdbwire_hash_create(gdbwire_hash_free_fn free_fn);
+
+/**
+ * Destroy the hash table instance and it's resources.
+ *
+ * @param hash
+ * The hash table to destroy, OK to pass in NULL.
+ */
+void gdbwire_hash_destroy(struct gdbwire_hash *hash);
+
+/**
+ * Remove all of the entries from the hash table.
+ *
+ * @param hash
+ * The hash table to clear.
+ */
+void gdbwire_hash_clear(struct gdbwire_hash *hash);
+
+/**
+ * Insert a value into the hash table.
+ *
+ * If the key already exists, the value associated with it is replaced.
+ *
+ * @param hash
+ * The hash table to insert into.
+ *
+ * @param key
+ * The key to associate the value with.
+ *
+ * @param value
+ * The value to insert.
+ *
+ * @return
+ * 0 on success or -1 on failure.
+ */
+int gdbwire_hash_insert(struct gdbwire_hash *hash, const char *key,
+        void *value);
+
+/**
+ * Insert a value into the hash table with out copying the key.
+ *
+ * This is the same as gdbwire_hash_insert, except that the hash table
+ * keeps a pointer to key rather than a copy of it. This saves memory
+ * when the caller already keeps the key around, for instance when the
+ * key is a field of the value. The key must not change or be freed
+ * until it is removed from the hash table.
+ *
+ * If the key already exists, only the value associated with it is
+ * replaced, the hash table keeps using the original key.
+ *
+ * @param hash
+ * The hash table to insert into.
+ *
+ * @param key
+ * The key to associate the value with.
+ *
+ * @param value
+ * The value to insert.
+ *
+ * @return
+ * 0 on success or -1 on failure.
+ */
+int gdbwire_hash_insert_borrowed(struct gdbwire_hash *hash, const char *key,
+        void *value);
+
+/**
+ * Find the value associated with a key.
+ *
+ * @param hash
+ * The hash table to search.
+ *
+ * @param key
+ * The key to search for.
+ *
+ * @return
+ * The value associated with key or NULL if the key is not found.
+ */
+void *gdbwire_hash_find(struct gdbwire_hash *hash, const char *key);
+
+/**
+ * Find the value associated with a key that is not NUL terminated.
+ *
+ * This is useful for looking up keys that are a slice of a larger
+ * buffer, with out having to copy them first.
+ *
+ * @param hash
+ * The hash table to search.
+ *
+ * @param key
+ * The key to search for, it does not need to be NUL terminated.
+ *
+ * @param size
+ * The number of characters in key.
+ *
+ * @return
+ * The value associated with key or NULL if the key is not found.
+ */
+void *gdbwire_hash_find_data(struct gdbwire_hash *hash, const char *key,
+        size_t size);
+
+/**
+ * Remove a key and it's value from the hash table.
+ *
+ * @param hash
+ * The hash table to remove the key from.
+ *
+ * @param key
+ * The key to remove.
+ *
+ * @return
+ * 0 if the key was removed or -1 if the key was not found.
+ */
+int gdbwire_hash_remove(struct gdbwire_hash *hash, const char *key);
+
+/**
+ * Determine the number of entries in the hash table.
+ *
+ * @param hash
+ * The hash table.
+ *
+ * @return
+ * The number of keys in the hash table.
+ */
+size_t gdbwire_hash_size(struct gdbwire_hash *hash);
+
+/**
+ * Call a function for each entry in the hash table.
+ *
+ * The order the entries are visited in is unspecified.
+ *
+ * @param hash
+ * The hash table to iterate over.
+ *
+ * @param fn
+ * The function to call for each entry.
+ *
+ * @param context
+ * An arbitrary pointer passed to fn.
+ */
+void gdbwire_hash_foreach(struct gdbwire_hash *hash,
+        void (*fn)(void *context, const char *key, void *value),
+        void *context);
+
+/**
+ * The hash function used by the hash table.
+ *
+ * @param key
+ * The data to hash, it does not need to be NUL terminated.
+ *
+ * @param size
+ * The number of characters in key.
+ *
+ * @return
+ * The hash value of key.
+ */
+size_t gdbwire_hash_string(const char *key, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "gdbwire_hex.h"
+
+/**
+ * The value of each hexadecimal digit plus one, or 0 if not a digit.
+ */
+static const unsigned char gdbwire_hex_digits[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+    ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16
+};
+
+#if defined(__SSE2__)
+/**
+ * Convert 16 hexadecimal digits into their values.
+ *
+ * @param digits
+ * The hexadecimal digits.
+ *
+ * @param values
+ * The value of each digit, from 0 to 15, on the way out.
+ *
+ * @return
+ * Non zero if all 16 characters were hexadecimal digits, otherwise 0.
+ */
+static int
+gdbwire_hex_values_sse2(__m128i digits, __m128i *values)
+{
+    __m128i lower = _mm_or_si128(digits, _mm_set1_epi8(0x20));
+    __m128i is_digit = _mm_and_si128(
+        _mm_cmpgt_epi8(digits, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(digits, _mm_set1_epi8('9' + 1)));
+    __m128i is_alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF) {
+        return 0;
+    }
+
+    *values = _mm_or_si128(
+        _mm_and_si128(is_digit, _mm_sub_epi8(digits, _mm_set1_epi8('0'))),
+        _mm_and_si128(is_alpha,
+            _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+    return 1;
+}
+
+/**
+ * Combine pairs of digit values into bytes.
+ *
+ * @param values
+ * The values of 16 hexadecimal digits.
+ *
+ * @return
+ * The 8 bytes, each in the low half of a 16 bit lane.
+ */
+static __m128i
+gdbwire_hex_pairs_sse2(__m128i values)
+{
+    /* The first digit of each pair is the low byte of each lane */
+    __m128i high = _mm_and_si128(values, _mm_set1_epi16(0x00FF));
+    __m128i low = _mm_srli_epi16(values, 8);
+    return _mm_or_si128(_mm_slli_epi16(high, 4), low);
+}
+#endif
+
+int
+gdbwire_hex_decode(const char *hex, size_t size, unsigned char *out)
+{
+    const unsigned char *cur = (const unsigned char *)hex;
+    unsigned char high, low;
+
+    if (size % 2 != 0) {
+        return -1;
+    }
+
+#if defined(__SSE2__)
+    /* Decode 32 digits into 16 bytes at a time */
+    while (size >= 32) {
+        __m128i first, second;
+
+        if (!gdbwire_hex_values_sse2(
+                _mm_loadu_si128((const __m128i *)cur), &first) ||
+            !gdbwire_hex_values_sse2(
+                _mm_loadu_si128((const __m128i *)(cur + 16)), &second)) {
+            return -1;
+        }
+
+        _mm_storeu_si128((__m128i *)out, _mm_packus_epi16(
+            gdbwire_hex_pairs_sse2(first), gdbwire_hex_pairs_sse2(second)));
+
+        cur += 32;
+        out += 16;
+        size -= 32;
+    }
+#endif
+
+    for (; size > 0; size -= 2) {
+        high = gdbwire_hex_digits[*cur++];
+        low = gdbwire_hex_digits[*cur++];
+        if (!high || !low) {
+            return -1;
+        }
+        *out++ = (unsigned char)(((high - 1) << 4) | (low - 1));
+    }
+
+    return 0;
+}
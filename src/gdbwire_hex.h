@@ -0,0 +1,40 @@
+#ifndef GDBWIRE_HEX_H
+#define GDBWIRE_HEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+/**
+ * Decode a string of hexadecimal digits into bytes.
+ *
+ * GDB outputs target memory as hexadecimal digits, two digits per byte,
+ * ie. the contents field of -data-read-memory-bytes. Such output is
+ * often megabytes long, so this is done many bytes at a time when the
+ * processor supports it.
+ *
+ * Both lower and upper case digits are accepted.
+ *
+ * @param hex
+ * The hexadecimal digits to decode, they do not have to be NUL terminated.
+ *
+ * @param size
+ * The number of digits in hex. This must be even.
+ *
+ * @param out
+ * The buffer to write the bytes to. It must have room for size / 2 bytes.
+ * The buffer may be partially written on failure.
+ *
+ * @return
+ * 0 on success or -1 if size is odd or hex has a character that
+ * is not a hexadecimal digit.
+ */
+int gdbwire_hex_decode(const char *hex, size_t size, unsigned char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
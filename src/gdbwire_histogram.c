@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_histogram.h"
+
+/** The log base 2 of GDBWIRE_HISTOGRAM_SUB_BUCKETS. */
+#define GDBWIRE_HISTOGRAM_SUB_BITS 4
+
+/**
+ * The number of buckets.
+ *
+ * Values below GDBWIRE_HISTOGRAM_SUB_BUCKETS take the first set of
+ * linear buckets. Each power of two from there up to 2^63 takes
+ * another set.
+ */
+#define GDBWIRE_HISTOGRAM_BUCKETS \
+    ((64 - GDBWIRE_HISTOGRAM_SUB_BITS + 1) * GDBWIRE_HISTOGRAM_SUB_BUCKETS)
+
+struct gdbwire_histogram {
+    /** The number of values recorded. */
+    uint64_t count;
+
+    /** The largest value recorded. */
+    uint64_t max;
+
+    /** The number of values recorded in each bucket. */
+    uint64_t buckets[GDBWIRE_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * Get the index of the highest bit set in a value.
+ *
+ * @param value
+ * The value, it must not be zero.
+ *
+ * @return
+ * The index of the highest bit set, from 0 to 63.
+ */
+static int
+gdbwire_histogram_high_bit(uint64_t value)
+{
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * Get the bucket a value is counted in.
+ *
+ * @param value
+ * The value to find the bucket of.
+ *
+ * @return
+ * The index of the bucket.
+ */
+static size_t
+gdbwire_histogram_bucket(uint64_t value)
+{
+    int shift;
+
+    if (value < GDBWIRE_HISTOGRAM_SUB_BUCKETS) {
+        return (size_t)value;
+    }
+
+    /**
+     * The top GDBWIRE_HISTOGRAM_SUB_BITS + 1 bits of the value pick the
+     * bucket, the highest of them is always set.
+     */
+    shift = gdbwire_histogram_high_bit(value) - GDBWIRE_HISTOGRAM_SUB_BITS;
+    return (size_t)(shift + 1) * GDBWIRE_HISTOGRAM_SUB_BUCKETS +
+        (size_t)(value >> shift) - GDBWIRE_HISTOGRAM_SUB_BUCKETS;
+}
+
+/**
+ * Get the largest value counted in a bucket.
+ *
+ * @param bucket
+ * The index of the bucket.
+ *
+ * @return
+ * The largest value that gdbwire_histogram_bucket maps to bucket.
+ */
+static uint64_t
+gdbwire_histogram_bucket_max(size_t bucket)
+{
+    size_t group = bucket / GDBWIRE_HISTOGRAM_SUB_BUCKETS;
+    uint64_t sub = bucket % GDBWIRE_HISTOGRAM_SUB_BUCKETS;
+    int shift;
+
+    if (group == 0) {
+        return sub;
+    }
+
+    shift = (int)group - 1;
+    return ((GDBWIRE_HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+struct gdbwire_histogram *
+gdbwire_histogram_create(void)
+{
+    return calloc(1, sizeof(struct gdbwire_histogram));
+}
+
+void
+gdbwire_histogram_destroy(struct gdbwire_histogram *histogram)
+{
+    free(histogram);
+}
+
+void
+gdbwire_histogram_record(struct gdbwire_histogram *histogram, uint64_t value)
+{
+    histogram->buckets[gdbwire_histogram_bucket(value)]++;
+    histogram->count++;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+void
+gdbwire_histogram_clear(struct gdbwire_histogram *histogram)
+{
+    memset(histogram, 0, sizeof(struct gdbwire_histogram));
+}
+
+uint64_t
+gdbwire_histogram_count(const struct gdbwire_histogram *histogram)
+{
+    return histogram->count;
+}
+
+uint64_t
+gdbwire_histogram_max(const struct gdbwire_histogram *histogram)
+{
+    return histogram->max;
+}
+
+uint64_t
+gdbwire_histogram_quantile(const struct gdbwire_histogram *histogram,
+        double quantile)
+{
+    uint64_t rank, seen = 0;
+    size_t bucket;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    /* The rank of the value at the quantile, from 1 to count */
+    if (quantile <= 0) {
+        rank = 1;
+    } else if (quantile >= 1) {
+        rank = histogram->count;
+    } else {
+        rank = (uint64_t)(quantile * (double)histogram->count);
+        if ((double)rank < quantile * (double)histogram->count) {
+            ++rank;
+        }
+        if (rank == 0) {
+            rank = 1;
+        }
+    }
+
+    for (bucket = 0; bucket < GDBWIRE_HISTOGRAM_BUCKETS; ++bucket) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank) {
+            uint64_t max = gdbwire_histogram_bucket_max(bucket);
+            return (max < histogram->max) ? max : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
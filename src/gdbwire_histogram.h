@@ -0,0 +1,108 @@
+#ifndef GDBWIRE_HISTOGRAM_H
+#define GDBWIRE_HISTOGRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * A log-linear histogram of 64 bit values, ie. latencies in nanoseconds.
+ *
+ * The values are counted in buckets. Each power of two range is split
+ * into GDBWIRE_HISTOGRAM_SUB_BUCKETS linear buckets, so a bucket is at
+ * most 1/GDBWIRE_HISTOGRAM_SUB_BUCKETS of the values it holds wide.
+ * Values below GDBWIRE_HISTOGRAM_SUB_BUCKETS are counted exactly.
+ *
+ * Recording a value is a few instructions and never allocates, so it
+ * can be done for every record gdbwire delivers.
+ */
+struct gdbwire_histogram;
+
+/** The number of linear buckets in each power of two range. */
+#define GDBWIRE_HISTOGRAM_SUB_BUCKETS 16
+
+/**
+ * Create a histogram.
+ *
+ * @return
+ * The new, empty, histogram or NULL on error.
+ */
+struct gdbwire_histogram *gdbwire_histogram_create(void);
+
+/**
+ * Destroy a histogram.
+ *
+ * @param histogram
+ * The histogram to destroy or NULL.
+ */
+void gdbwire_histogram_destroy(struct gdbwire_histogram *histogram);
+
+/**
+ * Record a value in the histogram.
+ *
+ * @param histogram
+ * The histogram to record the value in.
+ *
+ * @param value
+ * The value to record.
+ */
+void gdbwire_histogram_record(struct gdbwire_histogram *histogram,
+        uint64_t value);
+
+/**
+ * Remove all of the values from the histogram.
+ *
+ * @param histogram
+ * The histogram to clear.
+ */
+void gdbwire_histogram_clear(struct gdbwire_histogram *histogram);
+
+/**
+ * Get the number of values recorded.
+ *
+ * @param histogram
+ * The histogram to query.
+ *
+ * @return
+ * The number of values recorded since the histogram was created or
+ * last cleared.
+ */
+uint64_t gdbwire_histogram_count(const struct gdbwire_histogram *histogram);
+
+/**
+ * Get the largest value recorded.
+ *
+ * @param histogram
+ * The histogram to query.
+ *
+ * @return
+ * The exact largest value, or 0 if the histogram is empty.
+ */
+uint64_t gdbwire_histogram_max(const struct gdbwire_histogram *histogram);
+
+/**
+ * Get a quantile of the values recorded.
+ *
+ * For instance, 0.5 is the median, 0.99 the 99th percentile and
+ * 0.999 the 99.9th percentile.
+ *
+ * @param histogram
+ * The histogram to query.
+ *
+ * @param quantile
+ * The quantile to get, from 0 to 1.
+ *
+ * @return
+ * The largest value in the bucket of the quantile, but no more than
+ * the largest value recorded. 0 if the histogram is empty.
+ */
+uint64_t gdbwire_histogram_quantile(const struct gdbwire_histogram *histogram,
+        double quantile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "gdbwire_hash.h"
+#include "gdbwire_intern.h"
+
+/**
+ * The size of the first block the strings are packed into.
+ *
+ * Most pools hold the strings of a single small command, so the first
+ * block is small and each block after it is twice the size of the last,
+ * up to GDBWIRE_INTERN_BLOCK_SIZE_MAX.
+ */
+#define GDBWIRE_INTERN_BLOCK_SIZE 256
+
+/* The largest size of the blocks the strings are packed into */
+#define GDBWIRE_INTERN_BLOCK_SIZE_MAX 65536
+
+/* A block of strings, the strings follow the header */
+struct gdbwire_intern_block {
+    /* The previous block or NULL */
+    struct gdbwire_intern_block *prev;
+    /* The number of characters that fit in this block */
+    size_t capacity;
+    /* The number of characters used in this block */
+    size_t size;
+};
+
+struct gdbwire_intern {
+    /* The strings indexed by themselves, the keys are in the blocks */
+    struct gdbwire_hash *strings;
+    /* The block new strings are added to */
+    struct gdbwire_intern_block *block;
+};
+
+struct gdbwire_intern *
+gdbwire_intern_create(void)
+{
+    struct gdbwire_intern *intern;
+
+    intern = calloc(1, sizeof (struct gdbwire_intern));
+    if (intern) {
+        intern->strings = gdbwire_hash_create(NULL);
+        if (!intern->strings) {
+            free(intern);
+            intern = NULL;
+        }
+    }
+
+    return intern;
+}
+
+void
+gdbwire_intern_destroy(struct gdbwire_intern *intern)
+{
+    struct gdbwire_intern_block *block, *prev;
+
+    if (intern) {
+        gdbwire_hash_destroy(intern->strings);
+        for (block = intern->block; block; block = prev) {
+            prev = block->prev;
+            free(block);
+        }
+        free(intern);
+    }
+}
+
+/**
+ * Copy a string into the blocks.
+ *
+ * @param intern
+ * The string pool.
+ *
+ * @param data
+ * The characters to copy.
+ *
+ * @param size
+ * The number of characters to copy, not including the NUL terminator.
+ *
+ * @return
+ * The NUL terminated copy or NULL on error.
+ */
+static char *
+gdbwire_intern_copy(struct gdbwire_intern *intern, const char *data,
+        size_t size)
+{
+    struct gdbwire_intern_block *block = intern->block;
+    char *copy;
+
+    if (!block || block->capacity - block->size < size + 1) {
+        size_t capacity = GDBWIRE_INTERN_BLOCK_SIZE;
+
+        if (block) {
+            capacity = (block->capacity < GDBWIRE_INTERN_BLOCK_SIZE_MAX / 2) ?
+                block->capacity * 2 : GDBWIRE_INTERN_BLOCK_SIZE_MAX;
+        }
+
+        /* Strings larger than a block get a block of their own */
+        if (size + 1 > capacity) {
+            capacity = size + 1;
+        }
+
+        block = malloc(sizeof (struct gdbwire_intern_block) + capacity);
+        if (!block) {
+            return NULL;
+        }
+        block->capacity = capacity;
+        block->size = 0;
+        block->prev = intern->block;
+        intern->block = block;
+    }
+
+    copy = (char *)(block + 1) + block->size;
+    memcpy(copy, data, size);
+    copy[size] = 0;
+    block->size += size + 1;
+
+    return copy;
+}
+
+const char *
+gdbwire_intern_data(struct gdbwire_intern *intern, const char *data,
+        size_t size)
+{
+    char *copy;
+
+    if (!intern || !data) {
+        return NULL;
+    }
+
+    copy = gdbwire_hash_find_data(intern->strings, data, size);
+    if (copy) {
+        return copy;
+    }
+
+    copy = gdbwire_intern_copy(intern, data, size);
+    if (!copy || gdbwire_hash_insert_borrowed(intern->strings,
+            copy, copy) == -1) {
+        /* The copy stays in the block, it is freed with the pool */
+        return NULL;
+    }
+
+    return copy;
+}
+
+const char *
+gdbwire_intern_string(struct gdbwire_intern *intern, const char *str)
+{
+    return (str) ? gdbwire_intern_data(intern, str, strlen(str)) : NULL;
+}
+
+const char *
+gdbwire_intern_find(struct gdbwire_intern *intern, const char *str)
+{
+    return (intern) ? gdbwire_hash_find(intern->strings, str) : NULL;
+}
+
+size_t
+gdbwire_intern_size(struct gdbwire_intern *intern)
+{
+    return (intern) ? gdbwire_hash_size(intern->strings) : 0;
+}
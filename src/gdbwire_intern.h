@@ -0,0 +1,103 @@
+#ifndef __GDBWIRE_INTERN_H__
+#define __GDBWIRE_INTERN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+/**
+ * A pool of interned strings.
+ *
+ * Interning a string returns a pointer to the one copy of that string
+ * in the pool. Interning an equal string again returns the same pointer,
+ * so interned strings can be compared by pointer, and a string that
+ * shows up many times is only stored once.
+ *
+ * The strings are packed into blocks rather than being allocated one at
+ * a time. The blocks start small and double in size as the pool grows.
+ * The strings stay valid until the pool is destroyed.
+ */
+struct gdbwire_intern;
+
+/**
+ * Create a string pool.
+ *
+ * @return
+ * A valid string pool instance or NULL on error.
+ */
+struct gdbwire_intern *gdbwire_intern_create(void);
+
+/**
+ * Destroy the string pool and all of it's strings.
+ *
+ * @param intern
+ * The string pool to destroy, OK to pass in NULL.
+ */
+void gdbwire_intern_destroy(struct gdbwire_intern *intern);
+
+/**
+ * Intern a string.
+ *
+ * @param intern
+ * The string pool.
+ *
+ * @param str
+ * The string to intern.
+ *
+ * @return
+ * The interned copy of str or NULL on error.
+ */
+const char *gdbwire_intern_string(struct gdbwire_intern *intern,
+        const char *str);
+
+/**
+ * Intern a string that is not NUL terminated.
+ *
+ * @param intern
+ * The string pool.
+ *
+ * @param data
+ * The characters to intern, they do not need to be NUL terminated.
+ *
+ * @param size
+ * The number of characters in data.
+ *
+ * @return
+ * The interned, NUL terminated, copy of data or NULL on error.
+ */
+const char *gdbwire_intern_data(struct gdbwire_intern *intern,
+        const char *data, size_t size);
+
+/**
+ * Find a string in the pool with out interning it.
+ *
+ * @param intern
+ * The string pool.
+ *
+ * @param str
+ * The string to search for.
+ *
+ * @return
+ * The interned copy of str or NULL if str was never interned.
+ */
+const char *gdbwire_intern_find(struct gdbwire_intern *intern,
+        const char *str);
+
+/**
+ * Determine the number of distinct strings in the pool.
+ *
+ * @param intern
+ * The string pool.
+ *
+ * @return
+ * The number of distinct strings in the pool.
+ */
+size_t gdbwire_intern_size(struct gdbwire_intern *intern);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_sys.h"
+#include "gdbwire_assert.h"
+#include "gdbwire_hash.h"
+#include "gdbwire_line_table_cache.h"
+
+/** A cached line table and the files it belongs to. */
+struct gdbwire_line_table_cache_entry {
+    /* The full name of the source file, the key of the entry */
+    char *fullname;
+    /* The object file the source file belongs to or NULL */
+    char *objfile;
+    /* The line table of the source file */
+    struct gdbwire_mi_line_table *table;
+};
+
+struct gdbwire_line_table_cache {
+    /* The entries, keyed by their full name */
+    struct gdbwire_hash *entries;
+};
+
+/**
+ * Free a line table cache entry.
+ *
+ * @param value
+ * The struct gdbwire_line_table_cache_entry to free.
+ */
+static void
+gdbwire_line_table_cache_entry_free(void *value)
+{
+    struct gdbwire_line_table_cache_entry *entry = value;
+
+    free(entry->fullname);
+    free(entry->objfile);
+    gdbwire_mi_line_table_free(entry->table);
+    free(entry);
+}
+
+struct gdbwire_line_table_cache *
+gdbwire_line_table_cache_create(void)
+{
+    struct gdbwire_line_table_cache *cache;
+
+    cache = calloc(1, sizeof(struct gdbwire_line_table_cache));
+    if (cache) {
+        cache->entries = gdbwire_hash_create(
+            gdbwire_line_table_cache_entry_free);
+        if (!cache->entries) {
+            free(cache);
+            cache = 0;
+        }
+    }
+
+    return cache;
+}
+
+void
+gdbwire_line_table_cache_destroy(struct gdbwire_line_table_cache *cache)
+{
+    if (cache) {
+        gdbwire_hash_destroy(cache->entries);
+        free(cache);
+    }
+}
+
+enum gdbwire_result
+gdbwire_line_table_cache_symbol_list_lines(
+        struct gdbwire_line_table_cache *cache,
+        const char *fullname, const char *objfile,
+        struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_line_table_cache_entry *entry;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(fullname);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_SYMBOL_LIST_LINES);
+
+    entry = calloc(1, sizeof(struct gdbwire_line_table_cache_entry));
+    if (!entry) {
+        return GDBWIRE_NOMEM;
+    }
+
+    entry->fullname = gdbwire_strdup(fullname);
+    entry->objfile = (objfile) ? gdbwire_strdup(objfile) : 0;
+    if (!entry->fullname || (objfile && !entry->objfile)) {
+        gdbwire_line_table_cache_entry_free(entry);
+        return GDBWIRE_NOMEM;
+    }
+
+    /* The entry is the owner of it's key, so replace any previous one */
+    gdbwire_hash_remove(cache->entries, fullname);
+    if (gdbwire_hash_insert_borrowed(cache->entries, entry->fullname,
+            entry) == -1) {
+        gdbwire_line_table_cache_entry_free(entry);
+        return GDBWIRE_NOMEM;
+    }
+
+    /* Take the decoded output from the command */
+    entry->table = mi_command->variant.symbol_list_lines.table;
+    mi_command->variant.symbol_list_lines.table = NULL;
+
+    return GDBWIRE_OK;
+}
+
+const struct gdbwire_mi_line_table *
+gdbwire_line_table_cache_find(struct gdbwire_line_table_cache *cache,
+        const char *fullname)
+{
+    struct gdbwire_line_table_cache_entry *entry;
+
+    if (!cache || !fullname) {
+        return NULL;
+    }
+
+    entry = gdbwire_hash_find(cache->entries, fullname);
+
+    return (entry) ? entry->table : NULL;
+}
+
+/** The entries of an object file, collected by gdbwire_hash_foreach. */
+struct gdbwire_line_table_cache_match {
+    /* The object files to match, unused ones are NULL */
+    const char *objfiles[3];
+    /* The keys of the matching entries */
+    const char **keys;
+    /* The number of keys */
+    size_t keys_size;
+};
+
+/**
+ * Collect the key of an entry if it belongs to an object file.
+ *
+ * @param context
+ * The struct gdbwire_line_table_cache_match.
+ *
+ * @param key
+ * The full name of the entry.
+ *
+ * @param value
+ * The struct gdbwire_line_table_cache_entry.
+ */
+static void
+gdbwire_line_table_cache_match(void *context, const char *key, void *value)
+{
+    struct gdbwire_line_table_cache_match *match = context;
+    struct gdbwire_line_table_cache_entry *entry = value;
+    size_t index;
+
+    if (!entry->objfile) {
+        return;
+    }
+
+    for (index = 0; index < 3; ++index) {
+        if (match->objfiles[index] &&
+                strcmp(match->objfiles[index], entry->objfile) == 0) {
+            match->keys[match->keys_size++] = key;
+            return;
+        }
+    }
+}
+
+/**
+ * Forget the line tables of an object file known by several names.
+ *
+ * @param cache
+ * The line table cache.
+ *
+ * @param match
+ * The names of the object file, the keys are filled in.
+ */
+static void
+gdbwire_line_table_cache_remove(struct gdbwire_line_table_cache *cache,
+        struct gdbwire_line_table_cache_match *match)
+{
+    size_t index, size = gdbwire_hash_size(cache->entries);
+
+    if (size == 0) {
+        return;
+    }
+
+    /* The hash table can not be changed while it is iterated over,
+     * so the matching entries are collected first. The keys stay
+     * valid until their own entry is removed. Forgetting too much is
+     * safe if there is no memory to collect them in. */
+    match->keys = malloc(size * sizeof(const char *));
+    if (!match->keys) {
+        gdbwire_hash_clear(cache->entries);
+        return;
+    }
+    match->keys_size = 0;
+
+    gdbwire_hash_foreach(cache->entries, gdbwire_line_table_cache_match,
+        match);
+    for (index = 0; index < match->keys_size; ++index) {
+        gdbwire_hash_remove(cache->entries, match->keys[index]);
+    }
+
+    free(match->keys);
+}
+
+void
+gdbwire_line_table_cache_invalidate(struct gdbwire_line_table_cache *cache,
+        const char *objfile)
+{
+    struct gdbwire_line_table_cache_match match;
+
+    if (!cache || !objfile) {
+        return;
+    }
+
+    memset(&match, 0, sizeof(struct gdbwire_line_table_cache_match));
+    match.objfiles[0] = objfile;
+    gdbwire_line_table_cache_remove(cache, &match);
+}
+
+void
+gdbwire_line_table_cache_clear(struct gdbwire_line_table_cache *cache)
+{
+    if (cache) {
+        gdbwire_hash_clear(cache->entries);
+    }
+}
+
+enum gdbwire_result
+gdbwire_line_table_cache_async_record(
+        struct gdbwire_line_table_cache *cache,
+        struct gdbwire_mi_async_record *async_record)
+{
+    struct gdbwire_line_table_cache_match match;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(async_record);
+
+    switch (async_record->async_class) {
+        case GDBWIRE_MI_ASYNC_LIBRARY_LOADED:
+        case GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED:
+            memset(&match, 0, sizeof(struct gdbwire_line_table_cache_match));
+            match.objfiles[0] = gdbwire_get_mi_cstring(async_record->result,
+                "id");
+            match.objfiles[1] = gdbwire_get_mi_cstring(async_record->result,
+                "target-name");
+            match.objfiles[2] = gdbwire_get_mi_cstring(async_record->result,
+                "host-name");
+            gdbwire_line_table_cache_remove(cache, &match);
+            break;
+        default:
+            break;
+    }
+
+    return GDBWIRE_OK;
+}
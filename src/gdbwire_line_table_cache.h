@@ -0,0 +1,149 @@
+#ifndef GDBWIRE_LINE_TABLE_CACHE_H
+#define GDBWIRE_LINE_TABLE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A cache of source file line tables.
+ *
+ * A front end that marks the breakable lines of a source file, or maps
+ * the cursor to an address, asks GDB for the line table of the file
+ * with -symbol-list-lines. The line table of a file only changes when
+ * the object file it was compiled into is loaded again, so asking GDB
+ * every time the file is shown is wasted work.
+ *
+ * The line table cache remembers the decoded -symbol-list-lines output
+ * by the full name of the source file. The line table of a file in a
+ * shared library is forgotten when GDB reports that library as loaded
+ * or unloaded, since it may then be at a different address.
+ */
+struct gdbwire_line_table_cache;
+
+/**
+ * Create a line table cache instance.
+ *
+ * @return
+ * A new line table cache instance or NULL on error.
+ */
+struct gdbwire_line_table_cache *gdbwire_line_table_cache_create(void);
+
+/**
+ * Destroy a line table cache instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param cache
+ * The instance to destroy.
+ */
+void gdbwire_line_table_cache_destroy(
+        struct gdbwire_line_table_cache *cache);
+
+/**
+ * Add the output of -symbol-list-lines to the cache.
+ *
+ * GDB does not output the source file or the object file it belongs to,
+ * so the caller passes them in. The object file is the name of the
+ * shared library the source file was compiled into, as GDB reports it
+ * in =library-loaded, or NULL for the main program. A line table that
+ * is already cached for the source file is replaced.
+ *
+ * The line table cache takes ownership of the line table of the command,
+ * that field is NULL on the way out. The caller still has to free the
+ * command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The line table cache.
+ *
+ * @param fullname
+ * The full name of the source file given to -symbol-list-lines.
+ *
+ * @param objfile
+ * The object file the source file belongs to or NULL.
+ *
+ * @param mi_command
+ * The decoded -symbol-list-lines command,
+ * of kind GDBWIRE_MI_SYMBOL_LIST_LINES.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_line_table_cache_symbol_list_lines(
+        struct gdbwire_line_table_cache *cache,
+        const char *fullname, const char *objfile,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Find the cached line table of a source file.
+ *
+ * The line table is only valid until the line table cache is
+ * updated again.
+ *
+ * @param cache
+ * The line table cache.
+ *
+ * @param fullname
+ * The full name of the source file.
+ *
+ * @return
+ * The line table, or NULL if it has to be listed by GDB.
+ */
+const struct gdbwire_mi_line_table *gdbwire_line_table_cache_find(
+        struct gdbwire_line_table_cache *cache, const char *fullname);
+
+/**
+ * Update the line table cache with an asynchronous record.
+ *
+ * The =library-loaded and =library-unloaded records forget the line
+ * tables of the library, which is matched against the id, target-name
+ * and host-name fields. Other records are ignored.
+ *
+ * If the line table cache is attached to a gdbwire instance with
+ * gdbwire_set_line_table_cache, gdbwire calls this function for you.
+ *
+ * @param cache
+ * The line table cache to update.
+ *
+ * @param async_record
+ * The asynchronous record GDB output.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_line_table_cache_async_record(
+        struct gdbwire_line_table_cache *cache,
+        struct gdbwire_mi_async_record *async_record);
+
+/**
+ * Forget the line tables of the source files of an object file.
+ *
+ * @param cache
+ * The line table cache.
+ *
+ * @param objfile
+ * The object file, as passed to
+ * gdbwire_line_table_cache_symbol_list_lines.
+ */
+void gdbwire_line_table_cache_invalidate(
+        struct gdbwire_line_table_cache *cache, const char *objfile);
+
+/**
+ * Forget all of the cached line tables.
+ *
+ * @param cache
+ * The line table cache.
+ */
+void gdbwire_line_table_cache_clear(struct gdbwire_line_table_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,9 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "gdbwire_logger.h"
 
+/**
+ * The atomic operations the log is built on.
+ *
+ * With out compiler support, these are plain memory operations and the
+ * log is only safe to use from one thread.
+ */
+#ifdef __GNUC__
+#define GDBWIRE_LOGGER_LOAD(var, order) \
+    __atomic_load_n(&(var), __ATOMIC_##order)
+#define GDBWIRE_LOGGER_STORE(var, value, order) \
+    __atomic_store_n(&(var), value, __ATOMIC_##order)
+#define GDBWIRE_LOGGER_CAS(var, expected, desired) \
+    __atomic_compare_exchange_n(&(var), expected, desired, 1, \
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define GDBWIRE_LOGGER_ADD(var, value) \
+    __atomic_fetch_add(&(var), value, __ATOMIC_RELAXED)
+#else
+#define GDBWIRE_LOGGER_LOAD(var, order) (var)
+#define GDBWIRE_LOGGER_STORE(var, value, order) ((var) = (value))
+#define GDBWIRE_LOGGER_CAS(var, expected, desired) \
+    ((var) == *(expected) ? ((var) = (desired), 1) : (*(expected) = (var), 0))
+#define GDBWIRE_LOGGER_ADD(var, value) ((var) += (value))
+#endif
+
+#define GDBWIRE_LOGGER_RING_MASK (GDBWIRE_LOGGER_RING_SIZE - 1)
+
 static const char *gdbwire_logger_level_str[GDBWIRE_LOGGER_ERROR+1] = {
     "DEBUG",
     "INFO",
@@ -11,34 +38,196 @@ static const char *gdbwire_logger_level_str[GDBWIRE_LOGGER_ERROR+1] = {
     "ERROR"
 };
 
+/**
+ * A slot in the log.
+ *
+ * The log is a bounded multi-producer, multi-consumer queue. Each slot
+ * has a sequence number saying whose turn it is to use it. When it
+ * equals the position a producer claimed, the slot is free to write.
+ * When it is one past the position a consumer claimed, the slot holds
+ * a message to read.
+ */
+struct gdbwire_logger_slot {
+    /**
+     * The sequence number, less the index of the slot.
+     *
+     * Storing the difference lets the zero initialized log start
+     * with each slot's sequence number equal to it's index.
+     */
+    size_t sequence;
+
+    /** The message, the message field points to text. */
+    struct gdbwire_logger_record record;
+
+    /** The formatted message. */
+    char text[GDBWIRE_LOGGER_MESSAGE_SIZE];
+};
+
+int gdbwire_logger_threshold = -1;
+
+/** The slots of the log. */
+static struct gdbwire_logger_slot gdbwire_logger_ring[
+    GDBWIRE_LOGGER_RING_SIZE];
+
+/** The next position to log a message at. */
+static size_t gdbwire_logger_enqueue_position;
+
+/** The next position to drain a message from. */
+static size_t gdbwire_logger_dequeue_position;
+
+/** The number of messages dropped because the log was full. */
+static size_t gdbwire_logger_dropped_count;
+
+/** Non zero to write each message to stderr as it is logged. */
+static int gdbwire_logger_to_stderr;
+
+/** Non zero once the environment has been checked. */
+static int gdbwire_logger_checked_env;
+
+/**
+ * Check the GDBWIRE_DEBUG_TO_STDERR environment variable, once.
+ *
+ * If it is set, every message is written to stderr. Unless the level
+ * was already set, it also decides whether anything is logged.
+ */
+static void
+gdbwire_logger_check_env(void)
+{
+    int expected = -1, to_stderr;
+
+    if (GDBWIRE_LOGGER_LOAD(gdbwire_logger_checked_env, ACQUIRE)) {
+        return;
+    }
+
+    to_stderr = getenv("GDBWIRE_DEBUG_TO_STDERR") != NULL;
+    GDBWIRE_LOGGER_STORE(gdbwire_logger_to_stderr, to_stderr, RELAXED);
+    GDBWIRE_LOGGER_CAS(gdbwire_logger_threshold, &expected,
+        (to_stderr) ? GDBWIRE_LOGGER_DEBUG : GDBWIRE_LOGGER_NONE);
+    GDBWIRE_LOGGER_STORE(gdbwire_logger_checked_env, 1, RELEASE);
+}
+
+void
+gdbwire_logger_set_level(enum gdbwire_logger_level level)
+{
+    gdbwire_logger_check_env();
+    GDBWIRE_LOGGER_STORE(gdbwire_logger_threshold, (int)level, RELAXED);
+}
+
+/**
+ * Write a message to stderr.
+ *
+ * @param context
+ * Unused.
+ *
+ * @param record
+ * The message to write.
+ */
+static void
+gdbwire_logger_stderr(void *context,
+        const struct gdbwire_logger_record *record)
+{
+    fprintf(stderr, "gdbwire_logger_log: [%s] %s:%d %s\n",
+        gdbwire_logger_level_str[record->level], record->file, record->line,
+        record->message);
+}
+
 void
 gdbwire_logger_log(const char *file, int line, enum gdbwire_logger_level level,
         const char *fmt, ...)
 {
-    static int checked_env = 0;
-    static int gdbwire_debug_to_stderr;
-    char *buf;
-    int size;
-
+    struct gdbwire_logger_slot *slot;
+    size_t position, index;
+    intptr_t difference;
     va_list ap;
-    va_start(ap, fmt);
 
-    size = vsnprintf(0, 0, fmt, ap);
-    buf = malloc(sizeof(char)*size + 1);
+    if (GDBWIRE_LOGGER_LOAD(gdbwire_logger_threshold, RELAXED) < 0) {
+        gdbwire_logger_check_env();
+    }
+    if (!GDBWIRE_LOGGER_ENABLED(level)) {
+        return;
+    }
+
+    /* Claim the slot at the enqueue position */
+    position = GDBWIRE_LOGGER_LOAD(gdbwire_logger_enqueue_position, RELAXED);
+    for (;;) {
+        index = position & GDBWIRE_LOGGER_RING_MASK;
+        slot = &gdbwire_logger_ring[index];
+        difference = (intptr_t)(GDBWIRE_LOGGER_LOAD(slot->sequence, ACQUIRE)
+            + index - position);
+        if (difference == 0) {
+            if (GDBWIRE_LOGGER_CAS(gdbwire_logger_enqueue_position,
+                    &position, position + 1)) {
+                break;
+            }
+        } else if (difference < 0) {
+            /* The log is full, the oldest message has not been drained */
+            GDBWIRE_LOGGER_ADD(gdbwire_logger_dropped_count, 1);
+            return;
+        } else {
+            position = GDBWIRE_LOGGER_LOAD(gdbwire_logger_enqueue_position,
+                RELAXED);
+        }
+    }
 
     va_start(ap, fmt);
-    size = vsnprintf(buf, size + 1, fmt, ap);
+    vsnprintf(slot->text, GDBWIRE_LOGGER_MESSAGE_SIZE, fmt, ap);
     va_end(ap);
 
-    if (checked_env == 0) {
-        checked_env = 1;
-        gdbwire_debug_to_stderr = getenv("GDBWIRE_DEBUG_TO_STDERR") != NULL;
+    slot->record.level = level;
+    slot->record.file = file;
+    slot->record.line = line;
+    slot->record.message = slot->text;
+
+    /* Publish the message to the consumers */
+    GDBWIRE_LOGGER_STORE(slot->sequence, position + 1 - index, RELEASE);
+
+    if (GDBWIRE_LOGGER_LOAD(gdbwire_logger_to_stderr, RELAXED)) {
+        gdbwire_logger_drain(gdbwire_logger_stderr, 0);
     }
+}
+
+size_t
+gdbwire_logger_drain(gdbwire_logger_sink_fn sink, void *context)
+{
+    struct gdbwire_logger_slot *slot;
+    size_t position, index, count = 0;
+    intptr_t difference;
 
-    if (gdbwire_debug_to_stderr) {
-        fprintf(stderr, "gdbwire_logger_log: [%s] %s:%d %s\n",
-            gdbwire_logger_level_str[level], file, line, buf);
+    position = GDBWIRE_LOGGER_LOAD(gdbwire_logger_dequeue_position, RELAXED);
+    for (;;) {
+        index = position & GDBWIRE_LOGGER_RING_MASK;
+        slot = &gdbwire_logger_ring[index];
+        difference = (intptr_t)(GDBWIRE_LOGGER_LOAD(slot->sequence, ACQUIRE)
+            + index - (position + 1));
+        if (difference == 0) {
+            if (!GDBWIRE_LOGGER_CAS(gdbwire_logger_dequeue_position,
+                    &position, position + 1)) {
+                continue;
+            }
+
+            if (sink) {
+                sink(context, &slot->record);
+            }
+            ++count;
+
+            /* Hand the slot back to the producers, a lap later */
+            GDBWIRE_LOGGER_STORE(slot->sequence,
+                position + GDBWIRE_LOGGER_RING_SIZE - index, RELEASE);
+            ++position;
+        } else if (difference < 0) {
+            /* The log is empty */
+            break;
+        } else {
+            position = GDBWIRE_LOGGER_LOAD(gdbwire_logger_dequeue_position,
+                RELAXED);
+        }
     }
 
-    free(buf);
+    return count;
+}
+
+size_t
+gdbwire_logger_dropped(void)
+{
+    return GDBWIRE_LOGGER_LOAD(gdbwire_logger_dropped_count, RELAXED);
 }
@@ -1,24 +1,107 @@
 #ifndef __GDBWIRE_LOGGER_H__
 #define __GDBWIRE_LOGGER_H__
 
+#include <stdlib.h>
 #include "gdbwire_result.h"
 
-#ifdef __cplusplus 
-extern "C" { 
-#endif 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 enum gdbwire_logger_level {
     GDBWIRE_LOGGER_DEBUG,
     GDBWIRE_LOGGER_INFO,
     GDBWIRE_LOGGER_WARN,
-    GDBWIRE_LOGGER_ERROR
+    GDBWIRE_LOGGER_ERROR,
+    /** Not a message level, disables logging with gdbwire_logger_set_level */
+    GDBWIRE_LOGGER_NONE
+};
+
+/**
+ * The lowest level that is compiled in.
+ *
+ * The logging macros for levels below this expand to nothing, so their
+ * messages cost nothing at all. For instance, compile with
+ * -DGDBWIRE_LOGGER_MIN_LEVEL=3 to keep only gdbwire_error, or with
+ * -DGDBWIRE_LOGGER_MIN_LEVEL=4 to strip all logging.
+ */
+#ifndef GDBWIRE_LOGGER_MIN_LEVEL
+#define GDBWIRE_LOGGER_MIN_LEVEL 0
+#endif
+
+/** The size of a message in the log, longer messages are truncated. */
+#define GDBWIRE_LOGGER_MESSAGE_SIZE 256
+
+/** The number of messages the log holds until it is drained. */
+#define GDBWIRE_LOGGER_RING_SIZE 64
+
+/** A message in the log. */
+struct gdbwire_logger_record {
+    /** The level of the message. */
+    enum gdbwire_logger_level level;
+
+    /** The filename the message was logged from. */
+    const char *file;
+
+    /** The line number the message was logged from. */
+    int line;
+
+    /** The formatted message, truncated if it did not fit. */
+    const char *message;
 };
 
+/**
+ * Handle a message drained from the log.
+ *
+ * @param context
+ * The context passed to gdbwire_logger_drain.
+ *
+ * @param record
+ * The message, only valid during the call.
+ */
+typedef void (*gdbwire_logger_sink_fn)(void *context,
+        const struct gdbwire_logger_record *record);
+
+/**
+ * The lowest level that is logged, do not use directly.
+ *
+ * This is -1 until the GDBWIRE_DEBUG_TO_STDERR environment variable
+ * has been checked.
+ */
+extern int gdbwire_logger_threshold;
+
+#ifdef __GNUC__
+#define GDBWIRE_LOGGER_ENABLED(level) \
+    ((int)(level) >= __atomic_load_n(&gdbwire_logger_threshold, \
+        __ATOMIC_RELAXED))
+#else
+#define GDBWIRE_LOGGER_ENABLED(level) \
+    ((int)(level) >= gdbwire_logger_threshold)
+#endif
+
+/**
+ * Set the lowest level that is logged.
+ *
+ * Messages below the level are discarded before they are formatted.
+ * By default nothing is logged, unless the GDBWIRE_DEBUG_TO_STDERR
+ * environment variable is set, in which case every message is logged
+ * and written to stderr as soon as it is logged.
+ *
+ * @param level
+ * The lowest level to log, or GDBWIRE_LOGGER_NONE to log nothing.
+ */
+void gdbwire_logger_set_level(enum gdbwire_logger_level level);
+
 /**
  * Log a statement to the logger.
  *
  * This is typically not called directly. Use the below macros instead.
- * The macros automatically supply the file, line and level arguments.
+ * The macros automatically supply the file, line and level arguments,
+ * and skip the call when the level is not logged.
+ *
+ * The message is formatted straight into the log, which is a fixed size
+ * ring of messages shared by all threads, with out taking a lock or
+ * allocating memory. If the log is full, the message is dropped.
  *
  * @param file
  * The filename the logger was invoked from.
@@ -42,18 +125,65 @@ void gdbwire_logger_log(const char *file, int line,
 #endif
         ;
 
+/**
+ * Remove the messages from the log, oldest first.
+ *
+ * Any thread may drain the log, including while other threads log.
+ *
+ * @param sink
+ * The function to call with each message.
+ *
+ * @param context
+ * An arbitrary pointer passed to sink.
+ *
+ * @return
+ * The number of messages drained.
+ */
+size_t gdbwire_logger_drain(gdbwire_logger_sink_fn sink, void *context);
+
+/**
+ * Get the number of messages dropped because the log was full.
+ *
+ * @return
+ * The number of messages dropped since the program started.
+ */
+size_t gdbwire_logger_dropped(void);
+
 /* The macros intended to be used for logging */
-#define gdbwire_debug(fmt, ...)(gdbwire_logger_log(__FILE__, __LINE__, \
-        GDBWIRE_LOGGER_DEBUG, fmt, ##__VA_ARGS__))
-#define gdbwire_info(fmt, ...)(gdbwire_logger_log(__FILE__, __LINE__, \
-        GDBWIRE_LOGGER_INFO, fmt, ##__VA_ARGS__))
-#define gdbwire_warn(fmt, ...)(gdbwire_logger_log(__FILE__, __LINE__, \
-        GDBWIRE_LOGGER_WARN, fmt, ##__VA_ARGS__))
-#define gdbwire_error(fmt, ...)(gdbwire_logger_log(__FILE__, __LINE__, \
-        GDBWIRE_LOGGER_ERROR, fmt, ##__VA_ARGS__))
-
-#ifdef __cplusplus 
+#define GDBWIRE_LOGGER_LOG(level, fmt, ...) \
+    (GDBWIRE_LOGGER_ENABLED(level) ? gdbwire_logger_log(__FILE__, \
+        __LINE__, level, fmt, ##__VA_ARGS__) : (void)0)
+
+#if GDBWIRE_LOGGER_MIN_LEVEL <= 0
+#define gdbwire_debug(fmt, ...) \
+    GDBWIRE_LOGGER_LOG(GDBWIRE_LOGGER_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define gdbwire_debug(fmt, ...) ((void)0)
+#endif
+
+#if GDBWIRE_LOGGER_MIN_LEVEL <= 1
+#define gdbwire_info(fmt, ...) \
+    GDBWIRE_LOGGER_LOG(GDBWIRE_LOGGER_INFO, fmt, ##__VA_ARGS__)
+#else
+#define gdbwire_info(fmt, ...) ((void)0)
+#endif
+
+#if GDBWIRE_LOGGER_MIN_LEVEL <= 2
+#define gdbwire_warn(fmt, ...) \
+    GDBWIRE_LOGGER_LOG(GDBWIRE_LOGGER_WARN, fmt, ##__VA_ARGS__)
+#else
+#define gdbwire_warn(fmt, ...) ((void)0)
+#endif
+
+#if GDBWIRE_LOGGER_MIN_LEVEL <= 3
+#define gdbwire_error(fmt, ...) \
+    GDBWIRE_LOGGER_LOG(GDBWIRE_LOGGER_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define gdbwire_error(fmt, ...) ((void)0)
+#endif
+
+#ifdef __cplusplus
 }
-#endif 
+#endif
 
 #endif
@@ -0,0 +1,552 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_loop.h"
+#include "gdbwire_string.h"
+
+/** The bytes read from a session each time through the loop by default. */
+#define GDBWIRE_LOOP_DEFAULT_BUDGET 65536
+
+/** The most file descriptors serviced by one gdbwire_loop_run_once. */
+#define GDBWIRE_LOOP_MAX_EVENTS 256
+
+/** A file descriptor of a session, as registered with epoll. */
+struct gdbwire_loop_watch {
+    /* The session the file descriptor belongs to */
+    struct gdbwire_session *session;
+    /* The file descriptor */
+    int fd;
+    /* The epoll events it is registered for, 0 when not registered */
+    uint32_t events;
+};
+
+struct gdbwire_session {
+    /* The loop the session is in */
+    struct gdbwire_loop *loop;
+    /* The gdbwire instance GDB's output is read into */
+    struct gdbwire *wire;
+    /* The context pointer of the gdbwire callbacks */
+    void *context;
+    /* Called when the session stops, may be NULL */
+    gdbwire_session_closed_fn closed_fn;
+    /* GDB's stdout, and GDB's stdin when they are the same fd */
+    struct gdbwire_loop_watch output;
+    /* GDB's stdin, when it is not the same fd as GDB's stdout */
+    struct gdbwire_loop_watch input;
+    /* The data sent to GDB that it has not taken yet */
+    struct gdbwire_string *pending;
+    /* Non zero once the session stopped or was removed */
+    int closed;
+    /* Non zero once the session was removed from the loop */
+    int removed;
+    /* The sessions in the loop, or the sessions waiting to be destroyed */
+    struct gdbwire_session *prev, *next;
+};
+
+struct gdbwire_loop {
+    /* The epoll instance watching the sessions */
+    int epfd;
+    /* The most bytes read from a session each time through the loop */
+    size_t budget;
+    /* The sessions in the loop */
+    struct gdbwire_session *sessions;
+    /* The number of sessions in the loop */
+    size_t size;
+    /* The sessions removed while the loop was servicing them */
+    struct gdbwire_session *removed;
+    /* Non zero while the loop is servicing sessions */
+    int depth;
+};
+
+/**
+ * Make a file descriptor nonblocking.
+ *
+ * @param fd
+ * The file descriptor.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_loop_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    GDBWIRE_ASSERT_ERRNO(flags != -1);
+    if (!(flags & O_NONBLOCK)) {
+        GDBWIRE_ASSERT_ERRNO(fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1);
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Register a watch with epoll for the events given.
+ *
+ * @param loop
+ * The loop the watch is in.
+ *
+ * @param watch
+ * The watch to register.
+ *
+ * @param events
+ * The epoll events to watch for, 0 to stop watching.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_loop_register(struct gdbwire_loop *loop,
+        struct gdbwire_loop_watch *watch, uint32_t events)
+{
+    struct epoll_event event;
+    int op;
+
+    if (events == watch->events) {
+        return GDBWIRE_OK;
+    }
+
+    if (events == 0) {
+        op = EPOLL_CTL_DEL;
+    } else if (watch->events == 0) {
+        op = EPOLL_CTL_ADD;
+    } else {
+        op = EPOLL_CTL_MOD;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = watch;
+    GDBWIRE_ASSERT_ERRNO(epoll_ctl(loop->epfd, op, watch->fd, &event) == 0);
+    watch->events = events;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Watch a session's file descriptors for what it is waiting on.
+ *
+ * GDB's stdout is watched while the session is open, GDB's stdin only
+ * while there is data pending for it.
+ *
+ * @param session
+ * The session to watch.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_loop_watch_session(struct gdbwire_session *session)
+{
+    enum gdbwire_result result;
+    uint32_t input = 0, output = 0;
+
+    if (!session->closed) {
+        output = EPOLLIN;
+        if (gdbwire_string_size(session->pending) > 0) {
+            input = EPOLLOUT;
+        }
+    }
+
+    if (session->input.fd == session->output.fd) {
+        return gdbwire_loop_register(session->loop, &session->output,
+            output | input);
+    }
+
+    result = gdbwire_loop_register(session->loop, &session->output, output);
+    if (result == GDBWIRE_OK) {
+        result = gdbwire_loop_register(session->loop, &session->input, input);
+    }
+
+    return result;
+}
+
+/**
+ * Stop a session and let the caller know.
+ *
+ * GDB's output is no longer read, so the stream data gdbwire is
+ * coalescing is delivered first. The loop must be servicing sessions,
+ * since the callbacks may remove the session.
+ *
+ * @param session
+ * The session to stop.
+ *
+ * @param result
+ * Why the session stopped, errno is kept for the callback.
+ */
+static void
+gdbwire_loop_close_session(struct gdbwire_session *session,
+        enum gdbwire_result result)
+{
+    int error = errno;
+
+    if (session->closed) {
+        return;
+    }
+
+    gdbwire_flush_stream_records(session->wire);
+    if (session->closed) {
+        return;
+    }
+
+    session->closed = 1;
+    gdbwire_loop_watch_session(session);
+
+    if (session->closed_fn) {
+        errno = error;
+        session->closed_fn(session->context, session, result);
+    }
+}
+
+/**
+ * Destroy a session, it must already be out of the loop.
+ *
+ * @param session
+ * The session to destroy.
+ */
+static void
+gdbwire_loop_destroy_session(struct gdbwire_session *session)
+{
+    gdbwire_destroy(session->wire);
+    gdbwire_string_destroy(session->pending);
+    free(session);
+}
+
+/**
+ * Start servicing sessions.
+ *
+ * Sessions removed until the matching gdbwire_loop_leave are destroyed
+ * by it, so that a session removed from one of it's callbacks stays
+ * valid until the loop is done with it.
+ *
+ * @param loop
+ * The loop.
+ */
+static void
+gdbwire_loop_enter(struct gdbwire_loop *loop)
+{
+    loop->depth++;
+}
+
+/**
+ * Stop servicing sessions, destroying the sessions removed meanwhile.
+ *
+ * @param loop
+ * The loop.
+ */
+static void
+gdbwire_loop_leave(struct gdbwire_loop *loop)
+{
+    struct gdbwire_session *session;
+
+    if (--loop->depth > 0) {
+        return;
+    }
+
+    while (loop->removed) {
+        session = loop->removed;
+        loop->removed = session->next;
+        gdbwire_loop_destroy_session(session);
+    }
+}
+
+/**
+ * Read GDB's output into a session, up to the loop's budget.
+ *
+ * A single read is made. If GDB has more output than the budget, the
+ * file descriptor is still ready the next time through the loop.
+ *
+ * @param session
+ * The session to read.
+ */
+static void
+gdbwire_loop_read(struct gdbwire_session *session)
+{
+    enum gdbwire_read_status status;
+    enum gdbwire_result result;
+
+    result = gdbwire_read_fd(session->wire, session->output.fd,
+        session->loop->budget, &status);
+    if (result != GDBWIRE_OK) {
+        gdbwire_loop_close_session(session, result);
+    } else if (status == GDBWIRE_READ_EOF) {
+        gdbwire_loop_close_session(session, GDBWIRE_OK);
+    }
+}
+
+/**
+ * Write as much of the pending data to GDB as it will take.
+ *
+ * @param session
+ * The session to write.
+ */
+static void
+gdbwire_loop_write(struct gdbwire_session *session)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    size_t size = gdbwire_string_size(session->pending), written = 0;
+    char *data = gdbwire_string_data(session->pending);
+    ssize_t count;
+
+    while (written < size) {
+        count = write(session->input.fd, data + written, size - written);
+        if (count == -1 && errno == EINTR) {
+            continue;
+        } else if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (count == -1) {
+            gdbwire_error("write failed, errno[%d], strerror[%s]",
+                errno, strerror(errno));
+            result = GDBWIRE_LOGIC;
+            break;
+        }
+        written += count;
+    }
+
+    if (written > 0) {
+        gdbwire_string_erase(session->pending, 0, written);
+    }
+
+    if (result != GDBWIRE_OK) {
+        gdbwire_loop_close_session(session, result);
+    } else if (gdbwire_loop_watch_session(session) != GDBWIRE_OK) {
+        gdbwire_loop_close_session(session, GDBWIRE_LOGIC);
+    }
+}
+
+struct gdbwire_loop *
+gdbwire_loop_create(size_t budget)
+{
+    struct gdbwire_loop *loop;
+
+    loop = (struct gdbwire_loop *)calloc(1, sizeof(struct gdbwire_loop));
+    if (!loop) {
+        return NULL;
+    }
+
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epfd == -1) {
+        free(loop);
+        return NULL;
+    }
+
+    loop->budget = (budget > 0) ? budget : GDBWIRE_LOOP_DEFAULT_BUDGET;
+
+    return loop;
+}
+
+void
+gdbwire_loop_destroy(struct gdbwire_loop *loop)
+{
+    struct gdbwire_session *session;
+
+    if (loop) {
+        while (loop->sessions) {
+            session = loop->sessions;
+            loop->sessions = session->next;
+            gdbwire_loop_destroy_session(session);
+        }
+
+        while (loop->removed) {
+            session = loop->removed;
+            loop->removed = session->next;
+            gdbwire_loop_destroy_session(session);
+        }
+
+        close(loop->epfd);
+        free(loop);
+    }
+}
+
+enum gdbwire_result
+gdbwire_loop_add(struct gdbwire_loop *loop,
+        struct gdbwire_callbacks callbacks, int gdb_stdin, int gdb_stdout,
+        gdbwire_session_closed_fn closed, struct gdbwire_session **session)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_session *added;
+
+    GDBWIRE_ASSERT(loop && session && gdb_stdin >= 0 && gdb_stdout >= 0);
+
+    added = (struct gdbwire_session *)calloc(1,
+        sizeof(struct gdbwire_session));
+    if (!added) {
+        return GDBWIRE_NOMEM;
+    }
+
+    added->loop = loop;
+    added->context = callbacks.context;
+    added->closed_fn = closed;
+    added->output.session = added;
+    added->output.fd = gdb_stdout;
+    added->input.session = added;
+    added->input.fd = gdb_stdin;
+
+    added->wire = gdbwire_create(callbacks);
+    added->pending = gdbwire_string_create();
+    GDBWIRE_ASSERT_GOTO(added->wire && added->pending, result, cleanup);
+
+    result = gdbwire_loop_set_nonblocking(gdb_stdout);
+    GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
+    result = gdbwire_loop_set_nonblocking(gdb_stdin);
+    GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
+
+    result = gdbwire_loop_watch_session(added);
+    GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
+
+    added->next = loop->sessions;
+    if (loop->sessions) {
+        loop->sessions->prev = added;
+    }
+    loop->sessions = added;
+    loop->size++;
+
+    *session = added;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_loop_destroy_session(added);
+    return result;
+}
+
+enum gdbwire_result
+gdbwire_loop_remove(struct gdbwire_loop *loop,
+        struct gdbwire_session *session)
+{
+    GDBWIRE_ASSERT(loop && session && session->loop == loop);
+    GDBWIRE_ASSERT(!session->removed);
+
+    /**
+     * Deliver the stream data gdbwire is coalescing before it is
+     * destroyed. The callbacks may remove the session themselves.
+     */
+    gdbwire_loop_enter(loop);
+    gdbwire_flush_stream_records(session->wire);
+
+    if (!session->removed) {
+        /* Stop watching it, without letting the caller know */
+        session->closed = 1;
+        session->removed = 1;
+        gdbwire_loop_watch_session(session);
+
+        if (session->prev) {
+            session->prev->next = session->next;
+        } else {
+            loop->sessions = session->next;
+        }
+        if (session->next) {
+            session->next->prev = session->prev;
+        }
+        loop->size--;
+
+        session->prev = NULL;
+        session->next = loop->removed;
+        loop->removed = session;
+    }
+
+    gdbwire_loop_leave(loop);
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_loop_run_once(struct gdbwire_loop *loop, int timeout_ms,
+        int *serviced)
+{
+    struct epoll_event events[GDBWIRE_LOOP_MAX_EVENTS];
+    struct gdbwire_loop_watch *watch;
+    struct gdbwire_session *session;
+    int count, index;
+
+    GDBWIRE_ASSERT(loop);
+
+    count = epoll_wait(loop->epfd, events, GDBWIRE_LOOP_MAX_EVENTS,
+        timeout_ms);
+    if (count == -1 && errno == EINTR) {
+        count = 0;
+    }
+    GDBWIRE_ASSERT_ERRNO(count != -1);
+
+    gdbwire_loop_enter(loop);
+
+    for (index = 0; index < count; ++index) {
+        watch = (struct gdbwire_loop_watch *)events[index].data.ptr;
+        session = watch->session;
+
+        /* A hang up or error is found out by reading or writing */
+        if (watch == &session->output && !session->closed &&
+                (events[index].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+            gdbwire_loop_read(session);
+        }
+
+        if (!session->closed && (watch == &session->input ||
+                session->input.fd == session->output.fd) &&
+                gdbwire_string_size(session->pending) > 0 &&
+                (events[index].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))) {
+            gdbwire_loop_write(session);
+        }
+    }
+
+    gdbwire_loop_leave(loop);
+
+    if (serviced) {
+        *serviced = count;
+    }
+
+    return GDBWIRE_OK;
+}
+
+size_t
+gdbwire_loop_size(struct gdbwire_loop *loop)
+{
+    return loop->size;
+}
+
+struct gdbwire *
+gdbwire_session_get_wire(struct gdbwire_session *session)
+{
+    return session->wire;
+}
+
+enum gdbwire_result
+gdbwire_session_send(struct gdbwire_session *session, const char *data,
+        size_t size)
+{
+    struct gdbwire_loop *loop;
+    int closed, waiting;
+
+    GDBWIRE_ASSERT(session && data);
+
+    if (session->closed) {
+        return GDBWIRE_LOGIC;
+    }
+
+    /* Data already waiting is written when GDB is ready for more */
+    waiting = gdbwire_string_size(session->pending) > 0;
+    GDBWIRE_ASSERT(gdbwire_string_append_data(session->pending, data,
+        size) == 0);
+    if (waiting) {
+        return GDBWIRE_OK;
+    }
+
+    /* The session may be removed from the closed callback */
+    loop = session->loop;
+    gdbwire_loop_enter(loop);
+    gdbwire_loop_write(session);
+    closed = session->closed;
+    gdbwire_loop_leave(loop);
+
+    return closed ? GDBWIRE_LOGIC : GDBWIRE_OK;
+}
+
+size_t
+gdbwire_session_pending(struct gdbwire_session *session)
+{
+    return gdbwire_string_size(session->pending);
+}
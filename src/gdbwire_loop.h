@@ -0,0 +1,224 @@
+#ifndef GDBWIRE_LOOP_H
+#define GDBWIRE_LOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire.h"
+
+/**
+ * An event loop driving many GDB instances from one thread.
+ *
+ * The loop owns a set of sessions. A session is a gdbwire instance
+ * along with the file descriptors of a GDB process, the write end of
+ * it's stdin and the read end of it's stdout. They may be the same file
+ * descriptor, ie. the master side of a pseudo terminal.
+ *
+ * The loop makes the file descriptors nonblocking and watches them with
+ * epoll(7). When GDB writes output, the loop reads it straight into the
+ * session's gdbwire instance with gdbwire_read_fd, which invokes the
+ * session's gdbwire callbacks. Commands sent to GDB with
+ * gdbwire_session_send are written as GDB is able to take them, the rest
+ * waits in the session's output buffer.
+ *
+ * A session reads at most the loop's budget of bytes each time through
+ * the loop. A GDB producing a lot of output, ie. from "info functions",
+ * then can not hold up the other sessions, the rest of it's output is
+ * read the next time through the loop.
+ *
+ * The caller still starts each GDB process, and closes it's file
+ * descriptors and waits for it once it's session is removed. Writing to
+ * a GDB that has exited raises SIGPIPE, which the caller should ignore.
+ *
+ * The loop is only available on systems with epoll, and only when
+ * gdbwire is configured with --enable-loop.
+ */
+struct gdbwire_loop;
+
+/** A GDB instance driven by a gdbwire_loop. */
+struct gdbwire_session;
+
+/**
+ * A session stopped, because GDB closed it's output or an error occurred.
+ *
+ * The session's file descriptors are no longer watched. Any stream data
+ * the session's gdbwire instance was coalescing has been delivered to
+ * it's callbacks. The session stays in the loop until it is removed with
+ * gdbwire_loop_remove, which may be done from this callback.
+ *
+ * @param context
+ * The context pointer of the session's gdbwire callbacks.
+ *
+ * @param session
+ * The session that stopped.
+ *
+ * @param result
+ * GDBWIRE_OK if GDB closed it's output, otherwise the error. If a read or
+ * write failed, errno is still set.
+ */
+typedef void (*gdbwire_session_closed_fn)(void *context,
+        struct gdbwire_session *session, enum gdbwire_result result);
+
+/**
+ * Create an event loop.
+ *
+ * @param budget
+ * The most bytes read from a session each time through the loop.
+ * Use 0 for the default, 65536.
+ *
+ * @return
+ * A new event loop or NULL on error.
+ */
+struct gdbwire_loop *gdbwire_loop_create(size_t budget);
+
+/**
+ * Destroy an event loop and all of it's sessions.
+ *
+ * The file descriptors of the sessions are not closed. Stream data the
+ * sessions are coalescing is discarded, remove a session first to have
+ * it delivered.
+ *
+ * This function will do nothing if loop is NULL.
+ *
+ * @param loop
+ * The event loop to destroy.
+ */
+void gdbwire_loop_destroy(struct gdbwire_loop *loop);
+
+/**
+ * Add a GDB instance to the loop.
+ *
+ * @param loop
+ * The event loop to add the session to.
+ *
+ * @param callbacks
+ * The callbacks of the session's gdbwire instance.
+ *
+ * @param gdb_stdin
+ * The file descriptor to write commands to GDB on.
+ *
+ * @param gdb_stdout
+ * The file descriptor to read GDB's output from, may be gdb_stdin.
+ *
+ * @param closed
+ * Called when the session stops, may be NULL.
+ *
+ * @param session
+ * The new session on success, owned by the loop.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_loop_add(struct gdbwire_loop *loop,
+        struct gdbwire_callbacks callbacks, int gdb_stdin, int gdb_stdout,
+        gdbwire_session_closed_fn closed, struct gdbwire_session **session);
+
+/**
+ * Remove a session from the loop and destroy it.
+ *
+ * Stream data the session's gdbwire instance is coalescing is delivered
+ * to it's callbacks first. This may be called from the session's
+ * callbacks. The file descriptors of the session are not closed.
+ *
+ * @param loop
+ * The event loop the session is in.
+ *
+ * @param session
+ * The session to remove.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_loop_remove(struct gdbwire_loop *loop,
+        struct gdbwire_session *session);
+
+/**
+ * Wait for the sessions to be ready and service them once.
+ *
+ * Each session with output reads up to the loop's budget and dispatches
+ * the records completed to it's callbacks. Each session with pending
+ * commands writes what GDB will take.
+ *
+ * @param loop
+ * The event loop to run.
+ *
+ * @param timeout_ms
+ * The most milliseconds to wait for a session to be ready, 0 to not wait
+ * or -1 to wait until one is.
+ *
+ * @param serviced
+ * If not NULL, the number of file descriptors serviced.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ * A signal interrupting the wait is not an error.
+ */
+enum gdbwire_result gdbwire_loop_run_once(struct gdbwire_loop *loop,
+        int timeout_ms, int *serviced);
+
+/**
+ * Get the number of sessions in the loop.
+ *
+ * @param loop
+ * The event loop.
+ *
+ * @return
+ * The number of sessions, including sessions that stopped.
+ */
+size_t gdbwire_loop_size(struct gdbwire_loop *loop);
+
+/**
+ * Get the gdbwire instance of a session.
+ *
+ * Use it to configure the instance, ie. stream record coalescing or
+ * a target state. It is destroyed with the session.
+ *
+ * @param session
+ * The session.
+ *
+ * @return
+ * The gdbwire instance of the session.
+ */
+struct gdbwire *gdbwire_session_get_wire(struct gdbwire_session *session);
+
+/**
+ * Send a command to GDB.
+ *
+ * As much of the data as GDB will take is written now, the rest is kept
+ * in order and written when GDB is ready for it.
+ *
+ * @param session
+ * The session to send the command to.
+ *
+ * @param data
+ * The command, ie. "-break-info\n".
+ *
+ * @param size
+ * The size of data.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ * GDBWIRE_LOGIC if the session stopped.
+ */
+enum gdbwire_result gdbwire_session_send(struct gdbwire_session *session,
+        const char *data, size_t size);
+
+/**
+ * Get the number of bytes waiting to be written to GDB.
+ *
+ * @param session
+ * The session.
+ *
+ * @return
+ * The bytes sent with gdbwire_session_send that GDB has not taken yet.
+ */
+size_t gdbwire_session_pending(struct gdbwire_session *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
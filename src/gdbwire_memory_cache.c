@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_memory_cache.h"
+
+/** A contiguous region of cached memory, from begin up to end. */
+struct gdbwire_memory_cache_region {
+    uint64_t begin;
+    uint64_t end;
+    /* The end - begin bytes of the region */
+    unsigned char *bytes;
+};
+
+struct gdbwire_memory_cache {
+    /* The regions, sorted by address and never overlapping or touching */
+    struct gdbwire_memory_cache_region *regions;
+    /* The number of regions */
+    size_t regions_size;
+    /* The number of regions allocated */
+    size_t regions_capacity;
+
+    /* The statistics, except for bytes and regions */
+    struct gdbwire_memory_cache_stats stats;
+};
+
+struct gdbwire_memory_cache *
+gdbwire_memory_cache_create(void)
+{
+    return calloc(1, sizeof(struct gdbwire_memory_cache));
+}
+
+void
+gdbwire_memory_cache_destroy(struct gdbwire_memory_cache *cache)
+{
+    if (cache) {
+        gdbwire_memory_cache_clear(cache);
+        free(cache->regions);
+        free(cache);
+    }
+}
+
+/**
+ * Find the first region that ends after an address.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param address
+ * The address to search for.
+ *
+ * @return
+ * The index of the first region whose end is greater than address,
+ * or regions_size if there is none.
+ */
+static size_t
+gdbwire_memory_cache_lower_bound(struct gdbwire_memory_cache *cache,
+        uint64_t address)
+{
+    size_t low = 0, high = cache->regions_size, middle;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (cache->regions[middle].end <= address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Make room for regions in the regions array.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param size
+ * The number of regions that must fit in the regions array.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_NOMEM on failure.
+ */
+static enum gdbwire_result
+gdbwire_memory_cache_reserve(struct gdbwire_memory_cache *cache, size_t size)
+{
+    if (size > cache->regions_capacity) {
+        size_t capacity = (cache->regions_capacity) ?
+            cache->regions_capacity * 2 : 16;
+        struct gdbwire_memory_cache_region *regions = realloc(cache->regions,
+            capacity * sizeof(struct gdbwire_memory_cache_region));
+        if (!regions) {
+            return GDBWIRE_NOMEM;
+        }
+        cache->regions = regions;
+        cache->regions_capacity = capacity;
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Add memory to the cache.
+ *
+ * The regions the memory overlaps or touches are merged with it into
+ * a single region. Where the memory overlaps a region, the new memory
+ * replaces the cached memory.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param begin
+ * The address of the memory.
+ *
+ * @param bytes
+ * The memory.
+ *
+ * @param size
+ * The number of bytes of memory.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_memory_cache_insert(struct gdbwire_memory_cache *cache,
+        uint64_t begin, const unsigned char *bytes, size_t size)
+{
+    struct gdbwire_memory_cache_region region, *cur;
+    uint64_t end = begin + size;
+    size_t low, high, index;
+
+    GDBWIRE_ASSERT(end >= begin);
+
+    if (size == 0) {
+        return GDBWIRE_OK;
+    }
+
+    /* The regions from low up to high overlap or touch the new memory */
+    low = (begin > 0) ? gdbwire_memory_cache_lower_bound(cache, begin - 1) :
+        0;
+    for (high = low; high < cache->regions_size &&
+            cache->regions[high].begin <= end; ++high) {
+    }
+
+    region.begin = begin;
+    region.end = end;
+    if (low < high) {
+        if (cache->regions[low].begin < region.begin) {
+            region.begin = cache->regions[low].begin;
+        }
+        if (cache->regions[high - 1].end > region.end) {
+            region.end = cache->regions[high - 1].end;
+        }
+    }
+
+    if (low == high && gdbwire_memory_cache_reserve(cache,
+            cache->regions_size + 1) != GDBWIRE_OK) {
+        return GDBWIRE_NOMEM;
+    }
+
+    region.bytes = malloc(region.end - region.begin);
+    if (!region.bytes) {
+        return GDBWIRE_NOMEM;
+    }
+
+    for (index = low; index < high; ++index) {
+        cur = &cache->regions[index];
+        memcpy(region.bytes + (cur->begin - region.begin), cur->bytes,
+            cur->end - cur->begin);
+        free(cur->bytes);
+    }
+    memcpy(region.bytes + (begin - region.begin), bytes, size);
+
+    /* Replace the merged regions with the new region */
+    memmove(&cache->regions[low + 1], &cache->regions[high],
+        (cache->regions_size - high) *
+            sizeof(struct gdbwire_memory_cache_region));
+    cache->regions_size = cache->regions_size - (high - low) + 1;
+    cache->regions[low] = region;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_memory_cache_data_read_memory_bytes(
+        struct gdbwire_memory_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_memory_block *block;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_DATA_READ_MEMORY_BYTES);
+
+    block = mi_command->variant.data_read_memory_bytes.blocks;
+    for (; block && result == GDBWIRE_OK; block = block->next) {
+        result = gdbwire_memory_cache_insert(cache, block->begin,
+            block->contents, block->contents_size);
+    }
+
+    return result;
+}
+
+enum gdbwire_result
+gdbwire_memory_cache_invalidate(struct gdbwire_memory_cache *cache,
+        uint64_t address, uint64_t size)
+{
+    struct gdbwire_memory_cache_region *cur, tail;
+    uint64_t end = gdbwire_mi_memory_end(address, size);
+    size_t index;
+
+    GDBWIRE_ASSERT(cache);
+
+    if (size == 0) {
+        return GDBWIRE_OK;
+    }
+
+    index = gdbwire_memory_cache_lower_bound(cache, address);
+    if (index < cache->regions_size && cache->regions[index].begin < end) {
+        cache->stats.invalidations++;
+    }
+
+    while (index < cache->regions_size &&
+            cache->regions[index].begin < end) {
+        cur = &cache->regions[index];
+
+        if (cur->begin < address && cur->end > end &&
+                gdbwire_memory_cache_reserve(cache,
+                    cache->regions_size + 1) == GDBWIRE_OK &&
+                (tail.bytes = malloc(cache->regions[index].end - end))) {
+            /* Split the region around the invalidated memory */
+            cur = &cache->regions[index];
+            tail.begin = end;
+            tail.end = cur->end;
+            memcpy(tail.bytes, cur->bytes + (end - cur->begin),
+                tail.end - tail.begin);
+            cur->end = address;
+
+            memmove(&cache->regions[index + 2], &cache->regions[index + 1],
+                (cache->regions_size - index - 1) *
+                    sizeof(struct gdbwire_memory_cache_region));
+            cache->regions[index + 1] = tail;
+            cache->regions_size++;
+            break;
+        }
+
+        cur = &cache->regions[index];
+        if (cur->begin < address && cur->end <= end) {
+            /* Keep the start of the region */
+            cur->end = address;
+            ++index;
+        } else if (cur->begin >= address && cur->end > end) {
+            /* Keep the end of the region */
+            memmove(cur->bytes, cur->bytes + (end - cur->begin),
+                cur->end - end);
+            cur->begin = end;
+            break;
+        } else {
+            /*
+             * The whole region is invalidated. This is also the case when
+             * there is not enough memory to split the region.
+             */
+            free(cur->bytes);
+            memmove(&cache->regions[index], &cache->regions[index + 1],
+                (cache->regions_size - index - 1) *
+                    sizeof(struct gdbwire_memory_cache_region));
+            cache->regions_size--;
+        }
+    }
+
+    return GDBWIRE_OK;
+}
+
+void
+gdbwire_memory_cache_clear(struct gdbwire_memory_cache *cache)
+{
+    size_t index;
+
+    if (cache) {
+        for (index = 0; index < cache->regions_size; ++index) {
+            free(cache->regions[index].bytes);
+        }
+        cache->regions_size = 0;
+        cache->stats.clears++;
+    }
+}
+
+enum gdbwire_result
+gdbwire_memory_cache_async_record(struct gdbwire_memory_cache *cache,
+        struct gdbwire_mi_async_record *async_record)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_memory_changed changed;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(async_record);
+
+    switch (async_record->async_class) {
+        case GDBWIRE_MI_ASYNC_MEMORY_CHANGED:
+            /* ie. =memory-changed,thread-group="i1",addr="0x..",len="0x4" */
+            result = gdbwire_get_mi_memory_changed(async_record, &changed);
+            if (result != GDBWIRE_OK) {
+                return result;
+            }
+
+            return gdbwire_memory_cache_invalidate(cache, changed.address,
+                changed.size);
+        case GDBWIRE_MI_ASYNC_RUNNING:
+            gdbwire_memory_cache_clear(cache);
+            break;
+        default:
+            break;
+    }
+
+    return GDBWIRE_OK;
+}
+
+int
+gdbwire_memory_cache_read(struct gdbwire_memory_cache *cache,
+        uint64_t address, size_t size, unsigned char *buffer)
+{
+    struct gdbwire_memory_cache_region *region;
+    size_t index;
+
+    if (!cache) {
+        return -1;
+    }
+
+    index = gdbwire_memory_cache_lower_bound(cache, address);
+    if (index < cache->regions_size) {
+        region = &cache->regions[index];
+        if (region->begin <= address && size <= region->end - address) {
+            memcpy(buffer, region->bytes + (address - region->begin), size);
+            cache->stats.hits++;
+            cache->stats.hit_bytes += size;
+            return 0;
+        }
+    }
+
+    cache->stats.misses++;
+
+    return -1;
+}
+
+void
+gdbwire_memory_cache_get_stats(struct gdbwire_memory_cache *cache,
+        struct gdbwire_memory_cache_stats *stats)
+{
+    size_t index;
+
+    memset(stats, 0, sizeof(struct gdbwire_memory_cache_stats));
+
+    if (cache) {
+        *stats = cache->stats;
+        stats->regions = cache->regions_size;
+        for (index = 0; index < cache->regions_size; ++index) {
+            stats->bytes += cache->regions[index].end -
+                cache->regions[index].begin;
+        }
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef GDBWIRE_MEMORY_CACHE_H
+#define GDBWIRE_MEMORY_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A cache of target memory.
+ *
+ * Front ends tend to read the same memory over and over while the target
+ * is stopped, ie. to refresh a memory view. The memory cache remembers
+ * the output of -data-read-memory-bytes so that any read that falls
+ * within memory that was already read can be served without asking GDB.
+ *
+ * The cached memory is kept as a sorted set of non overlapping regions.
+ * Regions that overlap or touch are merged as they are added.
+ *
+ * Memory is only valid while the target is stopped. The cache forgets
+ * the memory GDB reports as changed with =memory-changed and forgets
+ * everything when the target resumes with *running.
+ */
+struct gdbwire_memory_cache;
+
+/** Statistics about how well the memory cache is doing. */
+struct gdbwire_memory_cache_stats {
+    /** The number of reads served from the cache. */
+    unsigned long hits;
+
+    /** The number of reads the cache could not serve. */
+    unsigned long misses;
+
+    /** The number of bytes served from the cache. */
+    uint64_t hit_bytes;
+
+    /** The number of times cached memory was invalidated. */
+    unsigned long invalidations;
+
+    /** The number of times the whole cache was cleared. */
+    unsigned long clears;
+
+    /** The number of bytes currently in the cache. */
+    uint64_t bytes;
+
+    /** The number of regions currently in the cache. */
+    size_t regions;
+};
+
+/**
+ * Create a memory cache instance.
+ *
+ * @return
+ * A new memory cache instance or NULL on error.
+ */
+struct gdbwire_memory_cache *gdbwire_memory_cache_create(void);
+
+/**
+ * Destroy a memory cache instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param cache
+ * The instance to destroy.
+ */
+void gdbwire_memory_cache_destroy(struct gdbwire_memory_cache *cache);
+
+/**
+ * Add the memory read by -data-read-memory-bytes to the cache.
+ *
+ * The memory is copied, the caller still owns the command.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param mi_command
+ * The decoded -data-read-memory-bytes command,
+ * of kind GDBWIRE_MI_DATA_READ_MEMORY_BYTES.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_memory_cache_data_read_memory_bytes(
+        struct gdbwire_memory_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Update the memory cache with an asynchronous record.
+ *
+ * The =memory-changed record invalidates the memory it reports and the
+ * *running record clears the cache. Other records are ignored.
+ *
+ * If the memory cache is attached to a gdbwire instance with
+ * gdbwire_set_memory_cache, gdbwire calls this function for you.
+ *
+ * @param cache
+ * The memory cache to update.
+ *
+ * @param async_record
+ * The asynchronous record GDB output.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_memory_cache_async_record(
+        struct gdbwire_memory_cache *cache,
+        struct gdbwire_mi_async_record *async_record);
+
+/**
+ * Read memory from the cache.
+ *
+ * The read is only served if all of the memory requested is cached.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param address
+ * The address of the first byte to read.
+ *
+ * @param size
+ * The number of bytes to read.
+ *
+ * @param buffer
+ * The buffer to copy the memory into, it must have room for size bytes.
+ *
+ * @return
+ * 0 if the memory was copied into buffer, or -1 if it is not all cached
+ * and has to be read from GDB.
+ */
+int gdbwire_memory_cache_read(struct gdbwire_memory_cache *cache,
+        uint64_t address, size_t size, unsigned char *buffer);
+
+/**
+ * Forget some of the cached memory.
+ *
+ * GDB does not output =memory-changed for the memory changed by the
+ * front end's own commands, ie. -data-write-memory-bytes. The front end
+ * should invalidate that memory itself.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param address
+ * The address of the first byte to forget.
+ *
+ * @param size
+ * The number of bytes to forget.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_memory_cache_invalidate(
+        struct gdbwire_memory_cache *cache, uint64_t address, uint64_t size);
+
+/**
+ * Forget all of the cached memory.
+ *
+ * @param cache
+ * The memory cache.
+ */
+void gdbwire_memory_cache_clear(struct gdbwire_memory_cache *cache);
+
+/**
+ * Get the statistics of the memory cache.
+ *
+ * @param cache
+ * The memory cache.
+ *
+ * @param stats
+ * The statistics on the way out.
+ */
+void gdbwire_memory_cache_get_stats(struct gdbwire_memory_cache *cache,
+        struct gdbwire_memory_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
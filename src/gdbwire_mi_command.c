@@ -4,6 +4,9 @@
 
 #include "gdbwire_sys.h"
 #include "gdbwire_assert.h"
+#include "gdbwire_hex.h"
+#include "gdbwire_probe.h"
+#include "gdbwire_mi_schema.h"
 #include "gdbwire_mi_command.h"
 
 /**
@@ -54,55 +57,109 @@ gdbwire_mi_breakpoints_free(struct gdbwire_mi_breakpoint *breakpoints)
     }
 }
 
+void
+gdbwire_mi_breakpoint_free(struct gdbwire_mi_breakpoint *breakpoint)
+{
+    if (breakpoint) {
+        breakpoint->next = 0;
+        gdbwire_mi_breakpoints_free(breakpoint);
+    }
+}
+
+void
+gdbwire_mi_stack_frame_free(struct gdbwire_mi_stack_frame *frame)
+{
+    if (frame) {
+        free(frame->address);
+        free(frame->func);
+        free(frame->file);
+        free(frame->fullname);
+        free(frame->from);
+        free(frame);
+    }
+}
+
+void
+gdbwire_mi_varobj_free(struct gdbwire_mi_varobj *varobj)
+{
+    if (varobj) {
+        free(varobj->name);
+        free(varobj->exp);
+        free(varobj->value);
+        free(varobj->type);
+        free(varobj->displayhint);
+        free(varobj);
+    }
+}
+
 /**
- * Free a stack frame.
+ * Free a variable object list.
  *
- * @param frame
- * The frame to free, OK to pass in NULL.
+ * @param varobjs
+ * The variable object list to free, OK to pass in NULL.
  */
 static void
-gdbwire_mi_stack_frame_free(struct gdbwire_mi_stack_frame *frame)
+gdbwire_mi_varobjs_free(struct gdbwire_mi_varobj *varobjs)
 {
-    free(frame->address);
-    free(frame->func);
-    free(frame->file);
-    free(frame->fullname);
-    free(frame->from);
-    free(frame);
+    struct gdbwire_mi_varobj *tmp, *cur = varobjs;
+    while (cur) {
+        tmp = cur;
+        cur = cur->next;
+        gdbwire_mi_varobj_free(tmp);
+    }
 }
 
 /**
- * Convert a string to an unsigned long.
+ * Free a variable object change list.
  *
- * @param str
- * The string to convert.
- *
- * @param num
- * If GDBWIRE_OK is returned, this will be returned as the number.
- *
- * @return
- * GDBWIRE_OK on success, and num is valid, or GDBWIRE_LOGIC on failure.
+ * @param changes
+ * The change list to free, OK to pass in NULL.
  */
-static enum gdbwire_result
-gdbwire_string_to_ulong(char *str, unsigned long *num)
+static void
+gdbwire_mi_varobj_changes_free(struct gdbwire_mi_varobj_change *changes)
 {
-    enum gdbwire_result result = GDBWIRE_LOGIC;
-    unsigned long int strtol_result;
-    char *end_ptr;
-
-    GDBWIRE_ASSERT(str);
-    GDBWIRE_ASSERT(num);
-
-    errno = 0;
-    strtol_result = strtoul(str, &end_ptr, 10);
-    if (errno == 0 && str != end_ptr && *end_ptr == '\0') {
-        *num = strtol_result;
-        result = GDBWIRE_OK;
+    struct gdbwire_mi_varobj_change *tmp, *cur = changes;
+    while (cur) {
+        free(cur->name);
+        free(cur->value);
+        free(cur->new_type);
+        gdbwire_mi_varobjs_free(cur->new_children);
+        tmp = cur;
+        cur = cur->next;
+        free(tmp);
     }
-
-    return result;
 }
 
+/** The dispositions, indexed by enum gdbwire_mi_breakpoint_disp_kind. */
+static const char *const break_info_dispositions[] = {
+    "del", "dstp", "dis", "keep", 0
+};
+
+/** The fields of a breakpoint tuple, ie. bkpt={...}. */
+#define BREAK_INFO_FIELDS(X, T) \
+    X(T, "number", STRING, number, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "enabled", BOOL, enabled, 0, 0) \
+    X(T, "addr", STRING, address, 0, 0) \
+    X(T, "catch-type", STRING, catch_type, 0, 0) \
+    X(T, "type", STRING, type, 0, 0) \
+    X(T, "disp", ENUM, disp_kind, GDBWIRE_MI_FIELD_STRICT, \
+        break_info_dispositions) \
+    X(T, "func", STRING, func_name, 0, 0) \
+    X(T, "file", STRING, file, 0, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0) \
+    X(T, "line", ULONG, line, 0, 0) \
+    X(T, "times", ULONG, times, 0, 0) \
+    X(T, "original-location", STRING, original_location, 0, 0) \
+    X(T, "locations", LIST, locations, 0, 0)
+
+/** The decoded fields of a breakpoint tuple, pointing into the tree. */
+struct break_info_fields {
+    BREAK_INFO_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct break_info_fields)
+};
+
+GDBWIRE_MI_SCHEMA(break_info_schema, struct break_info_fields,
+    BREAK_INFO_FIELDS);
+
 /**
  * Handle breakpoints from the -break-info command.
  *
@@ -123,138 +180,79 @@ break_info_for_breakpoint(struct gdbwire_mi_result *mi_result,
     enum gdbwire_result result = GDBWIRE_OK;
 
     struct gdbwire_mi_breakpoint *breakpoint = 0;
-
-    char *number = 0;
-    int multi = 0;
-    int from_multi = 0;
-    char *catch_type = 0;
-    int pending = 0;
-    int enabled = 0;
-    char *address = 0;
-    char *type = 0;
-    enum gdbwire_mi_breakpoint_disp_kind disp_kind = GDBWIRE_MI_BP_DISP_UNKNOWN;
-    char *func_name = 0;
-    char *file = 0;
-    char *fullname = 0;
-    unsigned long line = 0;
-    unsigned long times = 0;
-    char *original_location = 0;
-    struct gdbwire_mi_breakpoint *multi_breakpoints = 0;
+    struct break_info_fields fields;
+    struct gdbwire_mi_result *loc_result;
+    struct gdbwire_mi_breakpoint *multi_breakpoints = 0, *multi_tail = 0;
 
     GDBWIRE_ASSERT(mi_result);
     GDBWIRE_ASSERT(bkpt);
 
     *bkpt = 0;
 
-    while (mi_result) {
-        GDBWIRE_ASSERT(mi_result->variable);
-        if (strcmp(mi_result->variable, "number") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            number = mi_result->variant.cstring;
+    memset(&fields, 0, sizeof(struct break_info_fields));
+    fields.disp_kind = GDBWIRE_MI_BP_DISP_UNKNOWN;
 
-            if (strstr(number, ".") != NULL) {
-                from_multi = 1;
-            }
-        } else if (strcmp(mi_result->variable, "enabled") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            enabled = mi_result->variant.cstring[0] == 'y';
-        } else if (strcmp(mi_result->variable, "addr") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            multi = strcmp(mi_result->variant.cstring, "<MULTIPLE>") == 0;
-            pending = strcmp(mi_result->variant.cstring, "<PENDING>") == 0;
-            address = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "catch-type") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            catch_type = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "type") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            type = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "disp") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            if (strcmp(mi_result->variant.cstring, "del") == 0) {
-                disp_kind = GDBWIRE_MI_BP_DISP_DELETE;
-            } else if (strcmp(mi_result->variant.cstring, "dstp") == 0) {
-                disp_kind = GDBWIRE_MI_BP_DISP_DELETE_NEXT_STOP;
-            } else if (strcmp(mi_result->variant.cstring, "dis") == 0) {
-                disp_kind = GDBWIRE_MI_BP_DISP_DISABLE;
-            } else if (strcmp(mi_result->variant.cstring, "keep") == 0) {
-                disp_kind = GDBWIRE_MI_BP_DISP_KEEP;
-            } else {
-                return GDBWIRE_LOGIC;
-            }
-        } else if (strcmp(mi_result->variable, "func") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            func_name = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "file") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            file = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "fullname") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            fullname = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "line") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            GDBWIRE_ASSERT(gdbwire_string_to_ulong(
-                    mi_result->variant.cstring, &line) == GDBWIRE_OK);
-        } else if (strcmp(mi_result->variable, "times") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            GDBWIRE_ASSERT(gdbwire_string_to_ulong(
-                    mi_result->variant.cstring, &times) == GDBWIRE_OK);
-        } else if (strcmp(mi_result->variable, "original-location") == 0) {
-            GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
-            original_location = mi_result->variant.cstring;
-        } else if (strcmp(mi_result->variable, "locations") == 0) {
-            struct gdbwire_mi_result *loc_result = mi_result;
-            GDBWIRE_ASSERT(loc_result->kind == GDBWIRE_MI_LIST);
-
-            loc_result = loc_result->variant.result;
-            while (loc_result) {
-                GDBWIRE_ASSERT(loc_result->kind == GDBWIRE_MI_TUPLE);
-                struct gdbwire_mi_breakpoint *new_bkpt = 0;
-                result = break_info_for_breakpoint(
-                        loc_result->variant.result, &new_bkpt);
-
-                /* Append breakpoint to the multiple location breakpoints */
-                if (multi_breakpoints) {
-                    struct gdbwire_mi_breakpoint *cur = multi_breakpoints;
-                    while (cur->next) {
-                        cur = cur->next;
-                    }
-                    cur->next = new_bkpt;
-                } else {
-                    multi_breakpoints = new_bkpt;
-                }
-                loc_result = loc_result->next;
-            }
+    result = gdbwire_mi_schema_decode(&break_info_schema, mi_result,
+        &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    for (loc_result = fields.locations; loc_result;
+            loc_result = loc_result->next) {
+        struct gdbwire_mi_breakpoint *new_bkpt = 0;
+
+        GDBWIRE_ASSERT_GOTO(loc_result->kind == GDBWIRE_MI_TUPLE,
+            result, err);
+        result = break_info_for_breakpoint(
+                loc_result->variant.result, &new_bkpt);
+        if (result != GDBWIRE_OK) {
+            goto err;
         }
 
-        mi_result = mi_result->next;
+        /**
+         * Append breakpoint to the multiple location breakpoints.
+         *
+         * Keep track of the tail, breakpoints in templates or
+         * inlined functions can have thousands of locations.
+         */
+        if (multi_tail) {
+            multi_tail->next = new_bkpt;
+        } else {
+            multi_breakpoints = new_bkpt;
+        }
+        multi_tail = new_bkpt;
     }
 
-    /* Validate required fields before proceeding. */
-    GDBWIRE_ASSERT(number);
-
     /* At this point, allocate a breakpoint */
     breakpoint = calloc(1, sizeof(struct gdbwire_mi_breakpoint));
     if (!breakpoint) {
-        return GDBWIRE_NOMEM;
+        result = GDBWIRE_NOMEM;
+        goto err;
     }
 
-    breakpoint->multi = multi;
-    breakpoint->from_multi = from_multi;
-    breakpoint->number = gdbwire_strdup(number);
-    breakpoint->type = (type)?gdbwire_strdup(type):0;
-    breakpoint->catch_type = (catch_type)?gdbwire_strdup(catch_type):0;
-    breakpoint->disposition = disp_kind;
-    breakpoint->enabled = enabled;
-    breakpoint->address = (address)?gdbwire_strdup(address):0;
-    breakpoint->func_name = (func_name)?gdbwire_strdup(func_name):0;
-    breakpoint->file = (file)?gdbwire_strdup(file):0;
-    breakpoint->fullname = (fullname)?gdbwire_strdup(fullname):0;
-    breakpoint->line = line;
-    breakpoint->times = times;
-    breakpoint->original_location =
-        (original_location)?gdbwire_strdup(original_location):0;
-    breakpoint->pending = pending;
+    breakpoint->multi = fields.address &&
+        strcmp(fields.address, "<MULTIPLE>") == 0;
+    breakpoint->from_multi = strstr(fields.number, ".") != NULL;
+    breakpoint->number = gdbwire_strdup(fields.number);
+    breakpoint->type = (fields.type)?gdbwire_strdup(fields.type):0;
+    breakpoint->catch_type =
+        (fields.catch_type)?gdbwire_strdup(fields.catch_type):0;
+    breakpoint->disposition = fields.disp_kind;
+    breakpoint->enabled = fields.enabled;
+    breakpoint->address =
+        (fields.address)?gdbwire_strdup(fields.address):0;
+    breakpoint->func_name =
+        (fields.func_name)?gdbwire_strdup(fields.func_name):0;
+    breakpoint->file = (fields.file)?gdbwire_strdup(fields.file):0;
+    breakpoint->fullname =
+        (fields.fullname)?gdbwire_strdup(fields.fullname):0;
+    breakpoint->line = fields.line;
+    breakpoint->times = fields.times;
+    breakpoint->original_location = (fields.original_location)?
+        gdbwire_strdup(fields.original_location):0;
+    breakpoint->pending = fields.address &&
+        strcmp(fields.address, "<PENDING>") == 0;
     breakpoint->multi_breakpoints = multi_breakpoints;
 
     if (breakpoint->multi_breakpoints) {
@@ -267,13 +265,13 @@ break_info_for_breakpoint(struct gdbwire_mi_result *mi_result,
 
     /* Handle the out of memory situation */
     if (!breakpoint->number ||
-        (type && !breakpoint->type) ||
-        (catch_type && !breakpoint->catch_type) ||
-        (address && !breakpoint->address) ||
-        (func_name && !breakpoint->func_name) ||
-        (file && !breakpoint->file) ||
-        (fullname && !breakpoint->fullname) ||
-        (original_location && !breakpoint->original_location)) {
+        (fields.type && !breakpoint->type) ||
+        (fields.catch_type && !breakpoint->catch_type) ||
+        (fields.address && !breakpoint->address) ||
+        (fields.func_name && !breakpoint->func_name) ||
+        (fields.file && !breakpoint->file) ||
+        (fields.fullname && !breakpoint->fullname) ||
+        (fields.original_location && !breakpoint->original_location)) {
         gdbwire_mi_breakpoints_free(breakpoint);
         breakpoint = 0;
         result = GDBWIRE_NOMEM;
@@ -282,6 +280,59 @@ break_info_for_breakpoint(struct gdbwire_mi_result *mi_result,
     *bkpt = breakpoint;
 
     return result;
+
+err:
+    gdbwire_mi_breakpoints_free(multi_breakpoints);
+
+    return result;
+}
+
+enum gdbwire_result
+gdbwire_get_mi_breakpoint(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_breakpoint **out_breakpoint)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_breakpoint *breakpoint, *tail, *location;
+
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_breakpoint);
+
+    *out_breakpoint = 0;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    result = break_info_for_breakpoint(mi_result->variant.result, &breakpoint);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    tail = breakpoint->multi_breakpoints;
+    while (tail && tail->next) {
+        tail = tail->next;
+    }
+
+    /* In mi2 mode, the locations follow the breakpoint as unnamed tuples */
+    for (mi_result = mi_result->next; mi_result && !mi_result->variable &&
+            mi_result->kind == GDBWIRE_MI_TUPLE; mi_result = mi_result->next) {
+        result = break_info_for_breakpoint(mi_result->variant.result,
+            &location);
+        if (result != GDBWIRE_OK) {
+            gdbwire_mi_breakpoint_free(breakpoint);
+            return result;
+        }
+
+        location->multi_breakpoint = breakpoint;
+        if (tail) {
+            tail->next = location;
+        } else {
+            breakpoint->multi_breakpoints = location;
+        }
+        tail = location;
+    }
+
+    *out_breakpoint = breakpoint;
+
+    return GDBWIRE_OK;
 }
 
 /**
@@ -304,7 +355,8 @@ break_info(
     enum gdbwire_result result = GDBWIRE_OK;
     struct gdbwire_mi_result *mi_result;
     struct gdbwire_mi_command *mi_command = 0;
-    struct gdbwire_mi_breakpoint *breakpoints = 0, *cur_bkpt;
+    struct gdbwire_mi_breakpoint *breakpoints = 0, *cur_bkpt = 0;
+    struct gdbwire_mi_breakpoint *multi_tail = 0;
     int found_body = 0;
 
     GDBWIRE_ASSERT(result_record);
@@ -387,21 +439,28 @@ break_info(
         }
 
         if (bkpt->from_multi) {
+            if (!cur_bkpt) {
+                gdbwire_mi_breakpoints_free(bkpt);
+                result = GDBWIRE_LOGIC;
+                goto cleanup;
+            }
 
             bkpt->multi_breakpoint = cur_bkpt;
 
             /* Append breakpoint to the multiple location breakpoints */
-            if (cur_bkpt->multi_breakpoints) {
-                struct gdbwire_mi_breakpoint *multi =
-                    cur_bkpt->multi_breakpoints;
-                while (multi->next) {
-                    multi = multi->next;
-                }
-                multi->next = bkpt;
+            if (multi_tail) {
+                multi_tail->next = bkpt;
             } else {
                 cur_bkpt->multi_breakpoints = bkpt;
             }
+            multi_tail = bkpt;
         } else {
+            /* In mi3 mode, the locations are already attached */
+            multi_tail = bkpt->multi_breakpoints;
+            while (multi_tail && multi_tail->next) {
+                multi_tail = multi_tail->next;
+            }
+
             /* Append breakpoint to the list of breakpoints */
             if (breakpoints) {
                 cur_bkpt->next = bkpt;
@@ -431,68 +490,127 @@ cleanup:
 }
 
 /**
- * Handle the -stack-info-frame command.
+ * Convert an address string to a number.
  *
- * @param result_record
- * The mi result record that makes up the command output from gdb.
+ * @param str
+ * The address string, ie. "0x00000000004004f8".
  *
- * @param out
- * The output command, null on error.
+ * @param pc
+ * If GDBWIRE_OK is returned, this will be returned as the address.
  *
  * @return
- * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ * GDBWIRE_OK on success, and pc is valid, or GDBWIRE_LOGIC on failure.
  */
 static enum gdbwire_result
-stack_info_frame(
-    struct gdbwire_mi_result_record *result_record,
-    struct gdbwire_mi_command **out)
+gdbwire_string_to_address(const char *str, uint64_t *pc)
 {
-    struct gdbwire_mi_stack_frame *frame;
-    struct gdbwire_mi_result *mi_result;
-    struct gdbwire_mi_command *mi_command = 0;
+    unsigned long long strtoull_result;
+    char *end_ptr;
 
-    char *level = 0, *address = 0;
-    char *func = 0, *file = 0, *fullname = 0, *line = 0, *from = 0;
+    errno = 0;
+    strtoull_result = strtoull(str, &end_ptr, 16);
+    if (errno == 0 && str != end_ptr && *end_ptr == '\0') {
+        *pc = strtoull_result;
+        return GDBWIRE_OK;
+    }
 
-    *out = 0;
+    return GDBWIRE_LOGIC;
+}
 
-    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
-    GDBWIRE_ASSERT(result_record->result);
+/** The fields of a frame tuple, ie. frame={...}. */
+#define STACK_FRAME_FIELDS(X, T, level_flags) \
+    X(T, "level", INT, level, level_flags, 0) \
+    X(T, "addr", STRING, address, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "func", STRING, func, 0, 0) \
+    X(T, "file", STRING, file, 0, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0) \
+    X(T, "line", INT, line, 0, 0) \
+    X(T, "from", STRING, from, 0, 0)
 
-    mi_result = result_record->result;
+/** The frame fields, for frames that may not have a level. */
+#define STACK_FRAME_ANY_FIELDS(X, T) STACK_FRAME_FIELDS(X, T, 0)
 
-    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
-    GDBWIRE_ASSERT(strcmp(mi_result->variable, "frame") == 0);
-    GDBWIRE_ASSERT(mi_result->variant.result);
-    GDBWIRE_ASSERT(!mi_result->next);
-    mi_result = mi_result->variant.result;
+/** The frame fields, for frames that must have a level. */
+#define STACK_FRAME_LEVEL_FIELDS(X, T) \
+    STACK_FRAME_FIELDS(X, T, GDBWIRE_MI_FIELD_REQUIRED)
 
-    while (mi_result) {
-        if (mi_result->kind == GDBWIRE_MI_CSTRING) {
-            if (strcmp(mi_result->variable, "level") == 0) {
-                level = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "addr") == 0) {
-                address = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "func") == 0) {
-                func = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "file") == 0) {
-                file = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "fullname") == 0) {
-                fullname = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "line") == 0) {
-                line = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "from") == 0) {
-                from = mi_result->variant.cstring;
-            }
-        }
+GDBWIRE_MI_SCHEMA(stack_frame_schema, struct gdbwire_mi_stack_frame,
+    STACK_FRAME_ANY_FIELDS);
+GDBWIRE_MI_SCHEMA(stack_frame_level_schema, struct gdbwire_mi_stack_frame,
+    STACK_FRAME_LEVEL_FIELDS);
 
-        mi_result = mi_result->next;
+/**
+ * Get the fields of a frame tuple, ie. frame={...}, with out copying them.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the frame tuple.
+ *
+ * @param level_required
+ * Non zero if the level field must be present. The frame tuple in the
+ * -stack-info-frame output always has a level, however the frame tuple
+ * in asynchronous records like *stopped does not.
+ *
+ * @param frame
+ * The frame to fill in. The strings point into the parse tree.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+stack_frame_fields(struct gdbwire_mi_result *mi_result,
+        int level_required, struct gdbwire_mi_stack_frame *frame)
+{
+    enum gdbwire_result result;
+
+    memset(frame, 0, sizeof(struct gdbwire_mi_stack_frame));
+
+    result = gdbwire_mi_schema_decode((level_required) ?
+        &stack_frame_level_schema : &stack_frame_schema, mi_result, frame);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    if (strcmp(frame->address, "<unavailable>") == 0) {
+        frame->address = 0;
+    } else if (gdbwire_string_to_address(frame->address,
+            &frame->pc) != GDBWIRE_OK) {
+        frame->pc = 0;
     }
 
-    GDBWIRE_ASSERT(level && address);
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle a frame tuple, ie. frame={...}.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the frame tuple.
+ *
+ * @param level_required
+ * Non zero if the level field must be present.
+ * See stack_frame_fields for details.
+ *
+ * @param out
+ * Allocated frame on way out on success. Otherwise NULL on way out.
+ *
+ * @return
+ * GDBWIRE_OK on success and out is an allocated frame. Otherwise
+ * the appropriate error code and out will be NULL.
+ */
+static enum gdbwire_result
+stack_frame_for_frame(struct gdbwire_mi_result *mi_result,
+        int level_required, struct gdbwire_mi_stack_frame **out)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_stack_frame fields, *frame;
+
+    GDBWIRE_ASSERT(out);
+
+    *out = 0;
 
-    if (strcmp(address, "<unavailable>") == 0) {
-        address = 0;
+    result = stack_frame_fields(mi_result, level_required, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
     }
 
     frame = calloc(1, sizeof(struct gdbwire_mi_stack_frame));
@@ -500,119 +618,224 @@ stack_info_frame(
         return GDBWIRE_NOMEM;
     }
 
-    frame->level = atoi(level);
-    frame->address = (address)?gdbwire_strdup(address):0;
-    frame->func = (func)?gdbwire_strdup(func):0;
-    frame->file = (file)?gdbwire_strdup(file):0;
-    frame->fullname = (fullname)?gdbwire_strdup(fullname):0;
-    frame->line = (line)?atoi(line):0;
-    frame->from = (from)?gdbwire_strdup(from):0;
+    frame->level = fields.level;
+    frame->address = (fields.address)?gdbwire_strdup(fields.address):0;
+    frame->pc = fields.pc;
+    frame->func = (fields.func)?gdbwire_strdup(fields.func):0;
+    frame->file = (fields.file)?gdbwire_strdup(fields.file):0;
+    frame->fullname = (fields.fullname)?gdbwire_strdup(fields.fullname):0;
+    frame->line = fields.line;
+    frame->from = (fields.from)?gdbwire_strdup(fields.from):0;
 
     /* Handle the out of memory situation */
-    if ((address && !frame->address) ||
-        (func && !frame->func) ||
-        (file && !frame->file) ||
-        (fullname && !frame->fullname) ||
-        (from && !frame->from)) {
-        gdbwire_mi_stack_frame_free(frame);
-        return GDBWIRE_NOMEM;
-    }
-
-    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
-    if (!mi_command) {
+    if ((fields.address && !frame->address) ||
+        (fields.func && !frame->func) ||
+        (fields.file && !frame->file) ||
+        (fields.fullname && !frame->fullname) ||
+        (fields.from && !frame->from)) {
         gdbwire_mi_stack_frame_free(frame);
         return GDBWIRE_NOMEM;
     }
-    mi_command->kind = GDBWIRE_MI_STACK_INFO_FRAME;
-    mi_command->variant.stack_info_frame.frame = frame;
 
-    *out = mi_command;
+    *out = frame;
 
     return GDBWIRE_OK;
 }
 
+enum gdbwire_result
+gdbwire_get_mi_stack_frame(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_stack_frame **out_frame)
+{
+    GDBWIRE_ASSERT(mi_result);
+
+    return stack_frame_for_frame(mi_result, 0, out_frame);
+}
+
 /**
- * Handle the -file-list-exec-source-file command.
- *
- * @param result_record
- * The mi result record that makes up the command output from gdb.
+ * The *stopped reason strings, indexed by enum gdbwire_mi_stop_reason.
+ */
+static const char *gdbwire_mi_stop_reasons[] = {
+    0,
+    "breakpoint-hit",
+    "watchpoint-trigger",
+    "read-watchpoint-trigger",
+    "access-watchpoint-trigger",
+    "function-finished",
+    "location-reached",
+    "watchpoint-scope",
+    "end-stepping-range",
+    "exited-signalled",
+    "exited",
+    "exited-normally",
+    "signal-received",
+    "solib-event",
+    "fork",
+    "vfork",
+    "syscall-entry",
+    "syscall-return",
+    "exec",
+    "no-history"
+};
+
+/**
+ * Convert a *stopped reason string to it's enumeration.
  *
- * @param out
- * The output command, null on error.
+ * @param reason
+ * The reason string, ie. "breakpoint-hit", or NULL if there is none.
  *
  * @return
- * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ * The stop reason.
  */
-static enum gdbwire_result
-file_list_exec_source_file(
-    struct gdbwire_mi_result_record *result_record,
-    struct gdbwire_mi_command **out)
+static enum gdbwire_mi_stop_reason
+gdbwire_mi_stop_reason_for_string(const char *reason)
 {
-    struct gdbwire_mi_result *mi_result;
-    struct gdbwire_mi_command *mi_command = 0;
+    size_t index;
+    size_t size = sizeof(gdbwire_mi_stop_reasons) /
+        sizeof(gdbwire_mi_stop_reasons[0]);
 
-    char *line = 0, *file = 0, *fullname = 0, *macro_info = 0;
+    if (!reason) {
+        return GDBWIRE_MI_STOP_REASON_NONE;
+    }
 
-    *out = 0;
+    for (index = 1; index < size; ++index) {
+        if (strcmp(reason, gdbwire_mi_stop_reasons[index]) == 0) {
+            return (enum gdbwire_mi_stop_reason)index;
+        }
+    }
 
-    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
-    GDBWIRE_ASSERT(result_record->result);
+    return GDBWIRE_MI_STOP_REASON_UNSUPPORTED;
+}
 
-    mi_result = result_record->result;
+/** The fields of a *stopped record. */
+#define ASYNC_STOPPED_FIELDS(X, T) \
+    X(T, "reason", STRING, reason, 0, 0) \
+    X(T, "thread-id", INT, thread_id, 0, 0) \
+    X(T, "stopped-threads", RESULT, stopped_threads, 0, 0) \
+    X(T, "core", INT, core, 0, 0) \
+    X(T, "bkptno", STRING, bkptno, 0, 0) \
+    X(T, "signal-name", STRING, signal_name, 0, 0) \
+    X(T, "exit-code", STRING, exit_code, 0, 0) \
+    X(T, "frame", TUPLE, frame, 0, 0)
+
+/** The decoded fields of a *stopped record, pointing into the tree. */
+struct async_stopped_fields {
+    ASYNC_STOPPED_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct async_stopped_fields)
+};
+
+GDBWIRE_MI_SCHEMA(async_stopped_schema, struct async_stopped_fields,
+    ASYNC_STOPPED_FIELDS);
 
-    while (mi_result) {
-        if (mi_result->kind == GDBWIRE_MI_CSTRING) {
-            if (strcmp(mi_result->variable, "line") == 0) {
-                line = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "file") == 0) {
-                file = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "fullname") == 0) {
-                fullname = mi_result->variant.cstring;
-            } else if (strcmp(mi_result->variable, "macro-info") == 0) {
-                macro_info = mi_result->variant.cstring;
-                GDBWIRE_ASSERT(strlen(macro_info) == 1);
-                GDBWIRE_ASSERT(macro_info[0] == '0' || macro_info[0] == '1');
-            }
-        }
+enum gdbwire_result
+gdbwire_get_mi_async_stopped(struct gdbwire_mi_async_record *async_record,
+        struct gdbwire_mi_async_stopped *out_stopped)
+{
+    enum gdbwire_result result;
+    struct async_stopped_fields fields;
 
-        mi_result = mi_result->next;
-    }
+    GDBWIRE_ASSERT(async_record);
+    GDBWIRE_ASSERT(out_stopped);
+    GDBWIRE_ASSERT(async_record->async_class == GDBWIRE_MI_ASYNC_STOPPED);
 
-    GDBWIRE_ASSERT(line && file);
+    memset(out_stopped, 0, sizeof(struct gdbwire_mi_async_stopped));
+    memset(&fields, 0, sizeof(struct async_stopped_fields));
+    fields.core = -1;
 
-    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
-    if (!mi_command) {
-        return GDBWIRE_NOMEM;
+    result = gdbwire_mi_schema_decode(&async_stopped_schema,
+        async_record->result, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
     }
 
-    mi_command->kind = GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILE;
-    mi_command->variant.file_list_exec_source_file.line = atoi(line);
-    mi_command->variant.file_list_exec_source_file.file = gdbwire_strdup(file);
-    if (!mi_command->variant.file_list_exec_source_file.file) {
-        gdbwire_mi_command_free(mi_command);
-        return GDBWIRE_NOMEM;
+    out_stopped->reason_text = fields.reason;
+    out_stopped->thread_id = fields.thread_id;
+    out_stopped->core = fields.core;
+    out_stopped->signal_name = fields.signal_name;
+
+    /* GDB outputs stopped-threads="all" or a list of thread ids */
+    if (fields.stopped_threads &&
+            fields.stopped_threads->kind == GDBWIRE_MI_CSTRING) {
+        out_stopped->all_threads_stopped =
+            strcmp(fields.stopped_threads->variant.cstring, "all") == 0;
+    } else if (fields.stopped_threads &&
+            fields.stopped_threads->kind == GDBWIRE_MI_LIST) {
+        out_stopped->stopped_threads =
+            fields.stopped_threads->variant.result;
     }
-    mi_command->variant.file_list_exec_source_file.fullname =
-        (fullname)?gdbwire_strdup(fullname):0;
-    if (fullname &&
-        !mi_command->variant.file_list_exec_source_file.fullname) {
-        gdbwire_mi_command_free(mi_command);
-        return GDBWIRE_NOMEM;
+
+    if (fields.frame) {
+        result = stack_frame_fields(fields.frame, 0, &out_stopped->frame);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        out_stopped->has_frame = 1;
     }
-    mi_command->variant.file_list_exec_source_file.macro_info_exists =
-        macro_info != 0;
-    if (macro_info) {
-        mi_command->variant.file_list_exec_source_file.macro_info =
-            atoi(macro_info);
+
+    out_stopped->reason =
+        gdbwire_mi_stop_reason_for_string(out_stopped->reason_text);
+
+    if (out_stopped->reason == GDBWIRE_MI_STOP_REASON_BREAKPOINT_HIT &&
+            fields.bkptno) {
+        out_stopped->breakpoint_number = atoi(fields.bkptno);
     }
 
-    *out = mi_command;
+    /* GDB outputs the exit code in octal, ie. exit-code="01" */
+    if (out_stopped->reason == GDBWIRE_MI_STOP_REASON_EXITED &&
+            fields.exit_code) {
+        out_stopped->exit_code = (int)strtol(fields.exit_code, 0, 0);
+    }
 
     return GDBWIRE_OK;
 }
 
+char *
+gdbwire_get_mi_cstring(struct gdbwire_mi_result *mi_result,
+        const char *variable)
+{
+    for (; mi_result; mi_result = mi_result->next) {
+        if (mi_result->variable &&
+                strcmp(mi_result->variable, variable) == 0) {
+            return (mi_result->kind == GDBWIRE_MI_CSTRING) ?
+                mi_result->variant.cstring : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/** The fields of a =memory-changed record. */
+#define MEMORY_CHANGED_FIELDS(X, T) \
+    X(T, "addr", ADDRESS, address, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "len", ADDRESS, size, GDBWIRE_MI_FIELD_REQUIRED, 0)
+
+GDBWIRE_MI_SCHEMA(memory_changed_schema, struct gdbwire_mi_memory_changed,
+    MEMORY_CHANGED_FIELDS);
+
+enum gdbwire_result
+gdbwire_get_mi_memory_changed(struct gdbwire_mi_async_record *async_record,
+        struct gdbwire_mi_memory_changed *out_changed)
+{
+    GDBWIRE_ASSERT(async_record);
+    GDBWIRE_ASSERT(out_changed);
+    GDBWIRE_ASSERT(async_record->async_class ==
+        GDBWIRE_MI_ASYNC_MEMORY_CHANGED);
+
+    memset(out_changed, 0, sizeof(struct gdbwire_mi_memory_changed));
+
+    return gdbwire_mi_schema_decode(&memory_changed_schema,
+        async_record->result, out_changed);
+}
+
+uint64_t
+gdbwire_mi_memory_end(uint64_t address, uint64_t size)
+{
+    uint64_t end = address + size;
+
+    /* Memory that wraps around the address space goes up to the end */
+    return (end < address) ? UINT64_MAX : end;
+}
+
 /**
- * Handle the -file-list-exec-source-files command.
+ * Handle the -stack-info-frame command.
  *
  * @param result_record
  * The mi result record that makes up the command output from gdb.
@@ -624,64 +847,2320 @@ file_list_exec_source_file(
  * GDBWIRE_OK on success, otherwise failure and out is NULL.
  */
 static enum gdbwire_result
-file_list_exec_source_files(
+stack_info_frame(
     struct gdbwire_mi_result_record *result_record,
     struct gdbwire_mi_command **out)
 {
-    enum gdbwire_result result = GDBWIRE_OK;
+    enum gdbwire_result result;
+    struct gdbwire_mi_stack_frame *frame;
     struct gdbwire_mi_result *mi_result;
-    struct gdbwire_mi_source_file *files = 0, *cur_node, *new_node;
+    struct gdbwire_mi_command *mi_command = 0;
+
+    *out = 0;
 
     GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
     GDBWIRE_ASSERT(result_record->result);
 
     mi_result = result_record->result;
 
-    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
-    GDBWIRE_ASSERT(strcmp(mi_result->variable, "files") == 0);
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "frame") == 0);
+    GDBWIRE_ASSERT(mi_result->variant.result);
     GDBWIRE_ASSERT(!mi_result->next);
-
     mi_result = mi_result->variant.result;
 
-    while (mi_result) {
-        struct gdbwire_mi_result *tuple;
-        char *file = 0, *fullname = 0;
-        enum gdbwire_mi_debug_fully_read_kind debug_fully_read =
-            GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN;
-        GDBWIRE_ASSERT_GOTO(mi_result->kind == GDBWIRE_MI_TUPLE, result, err);
-        tuple = mi_result->variant.result;
-
-        while (tuple) {
-            /* file field */
-            GDBWIRE_ASSERT_GOTO(tuple->kind == GDBWIRE_MI_CSTRING, result, err);
-
-            if (strcmp(tuple->variable, "file") == 0) {
-                file = tuple->variant.cstring;
-            } else if (strcmp(tuple->variable, "fullname") == 0) {
-                fullname = tuple->variant.cstring;
-            } else if (strcmp(tuple->variable, "debug-fully-read") == 0) {
-                if (strcmp(tuple->variant.cstring, "false") == 0) {
-                    debug_fully_read =
-                        GDBWIRE_MI_DEBUG_FULLY_READ_FALSE;
-                } else if (strcmp(tuple->variant.cstring, "true") == 0) {
-                    debug_fully_read =
-                        GDBWIRE_MI_DEBUG_FULLY_READ_TRUE;
-                }
+    result = stack_frame_for_frame(mi_result, 1, &frame);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        gdbwire_mi_stack_frame_free(frame);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_STACK_INFO_FRAME;
+    mi_command->variant.stack_info_frame.frame = frame;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Intern the strings of a frame.
+ *
+ * @param strings
+ * The string pool to intern the strings in.
+ *
+ * @param fields
+ * The frame fields, as returned by stack_frame_fields.
+ *
+ * @param frame
+ * The frame to fill in, with strings pointing into the pool.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_NOMEM on failure.
+ */
+static enum gdbwire_result
+stack_frame_intern(struct gdbwire_intern *strings,
+        struct gdbwire_mi_stack_frame *fields,
+        struct gdbwire_mi_stack_frame *frame)
+{
+    char **from[5], **to[5];
+    int index;
+
+    *frame = *fields;
+
+    from[0] = &fields->address;  to[0] = &frame->address;
+    from[1] = &fields->func;     to[1] = &frame->func;
+    from[2] = &fields->file;     to[2] = &frame->file;
+    from[3] = &fields->fullname; to[3] = &frame->fullname;
+    from[4] = &fields->from;     to[4] = &frame->from;
+
+    for (index = 0; index < 5; ++index) {
+        if (*from[index]) {
+            *to[index] = (char *)gdbwire_intern_string(strings, *from[index]);
+            if (!*to[index]) {
+                return GDBWIRE_NOMEM;
+            }
+        }
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the -stack-list-frames command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+stack_list_frames(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result, *cur;
+    struct gdbwire_mi_command *mi_command = 0;
+    struct gdbwire_mi_stack_frame fields, *frames;
+    size_t size = 0, index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "stack") == 0);
+    GDBWIRE_ASSERT(!mi_result->next);
+
+    /* Count the frames first so that they can be allocated at once */
+    for (cur = mi_result->variant.result; cur; cur = cur->next) {
+        GDBWIRE_ASSERT(cur->kind == GDBWIRE_MI_TUPLE);
+        GDBWIRE_ASSERT(cur->variable && strcmp(cur->variable, "frame") == 0);
+        ++size;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_STACK_LIST_FRAMES;
+
+    mi_command->variant.stack_list_frames.strings = gdbwire_intern_create();
+    if (!mi_command->variant.stack_list_frames.strings) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+
+    if (size > 0) {
+        frames = calloc(size, sizeof(struct gdbwire_mi_stack_frame));
+        if (!frames) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.stack_list_frames.frames = frames;
+        mi_command->variant.stack_list_frames.frames_size = size;
+
+        for (cur = mi_result->variant.result; cur; cur = cur->next) {
+            result = stack_frame_fields(cur->variant.result, 1, &fields);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+
+            result = stack_frame_intern(
+                mi_command->variant.stack_list_frames.strings,
+                &fields, &frames[index++]);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_command_free(mi_command);
+
+    return result;
+}
+
+/** The fields of a variable object. */
+#define VAROBJ_FIELDS(X, T) \
+    X(T, "name", STRING, name, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "exp", STRING, exp, 0, 0) \
+    X(T, "numchild", INT, numchild, 0, 0) \
+    X(T, "value", STRING, value, 0, 0) \
+    X(T, "type", STRING, type, 0, 0) \
+    X(T, "thread-id", INT, thread_id, 0, 0) \
+    X(T, "displayhint", STRING, displayhint, 0, 0) \
+    X(T, "dynamic", INT, dynamic, 0, 0) \
+    X(T, "has_more", INT, has_more, 0, 0)
+
+/** The decoded fields of a variable object, pointing into the tree. */
+struct varobj_fields {
+    VAROBJ_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct varobj_fields)
+};
+
+GDBWIRE_MI_SCHEMA(varobj_schema, struct varobj_fields, VAROBJ_FIELDS);
+
+/**
+ * Handle the fields of a variable object.
+ *
+ * The -var-create command outputs the fields of the variable object
+ * in the result record, ie. ^done,name="var1",numchild="0",...
+ * The -var-list-children command outputs them in a child tuple,
+ * ie. child={name="var1.a",exp="a",numchild="0",...}.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the first field of the variable object.
+ *
+ * @param out
+ * Allocated variable object on way out on success. Otherwise NULL.
+ *
+ * @return
+ * GDBWIRE_OK on success and out is an allocated variable object.
+ * Otherwise the appropriate error code and out will be NULL.
+ */
+static enum gdbwire_result
+varobj_for_fields(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_varobj **out)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_varobj *varobj;
+    struct varobj_fields fields;
+
+    *out = 0;
+
+    memset(&fields, 0, sizeof(struct varobj_fields));
+
+    result = gdbwire_mi_schema_decode(&varobj_schema, mi_result, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    varobj = calloc(1, sizeof(struct gdbwire_mi_varobj));
+    if (!varobj) {
+        return GDBWIRE_NOMEM;
+    }
+
+    varobj->name = gdbwire_strdup(fields.name);
+    varobj->exp = (fields.exp)?gdbwire_strdup(fields.exp):0;
+    varobj->numchild = fields.numchild;
+    varobj->value = (fields.value)?gdbwire_strdup(fields.value):0;
+    varobj->type = (fields.type)?gdbwire_strdup(fields.type):0;
+    varobj->thread_id = fields.thread_id;
+    varobj->displayhint =
+        (fields.displayhint)?gdbwire_strdup(fields.displayhint):0;
+    varobj->dynamic = fields.dynamic != 0;
+    varobj->has_more = fields.has_more != 0;
+
+    /* Handle the out of memory situation */
+    if (!varobj->name ||
+        (fields.exp && !varobj->exp) ||
+        (fields.value && !varobj->value) ||
+        (fields.type && !varobj->type) ||
+        (fields.displayhint && !varobj->displayhint)) {
+        gdbwire_mi_varobj_free(varobj);
+        return GDBWIRE_NOMEM;
+    }
+
+    *out = varobj;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle a list of child tuples, ie. [child={...},child={...}].
+ *
+ * @param mi_result
+ * The mi parse tree starting from the first child tuple.
+ *
+ * @param out
+ * The allocated variable object list on success, NULL if the list
+ * is empty or on failure.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise the appropriate error code.
+ */
+static enum gdbwire_result
+varobjs_for_children(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_varobj **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_varobj *varobjs = 0, **tail = &varobjs;
+
+    *out = 0;
+
+    for (; mi_result; mi_result = mi_result->next) {
+        GDBWIRE_ASSERT_GOTO(mi_result->kind == GDBWIRE_MI_TUPLE,
+            result, cleanup);
+
+        result = varobj_for_fields(mi_result->variant.result, tail);
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
+        }
+        tail = &(*tail)->next;
+    }
+
+    *out = varobjs;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_varobjs_free(varobjs);
+
+    return result;
+}
+
+/**
+ * Handle the -var-create command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+var_create(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_varobj *varobj;
+    struct gdbwire_mi_command *mi_command;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    result = varobj_for_fields(result_record->result, &varobj);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        gdbwire_mi_varobj_free(varobj);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_VAR_CREATE;
+    mi_command->variant.var_create.varobj = varobj;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/** The fields of the -var-list-children output. */
+#define VAR_LIST_CHILDREN_FIELDS(X, T) \
+    X(T, "numchild", INT, numchild, 0, 0) \
+    X(T, "children", LIST, children, 0, 0) \
+    X(T, "has_more", INT, has_more, 0, 0)
+
+/** The decoded -var-list-children fields. */
+struct var_list_children_fields {
+    VAR_LIST_CHILDREN_FIELDS(GDBWIRE_MI_FIELD_MEMBER,
+        struct var_list_children_fields)
+};
+
+GDBWIRE_MI_SCHEMA(var_list_children_schema, struct var_list_children_fields,
+    VAR_LIST_CHILDREN_FIELDS);
+
+/**
+ * Handle the -var-list-children command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+var_list_children(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_varobj *children = 0;
+    struct gdbwire_mi_command *mi_command;
+    struct var_list_children_fields fields;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+
+    memset(&fields, 0, sizeof(struct var_list_children_fields));
+
+    result = gdbwire_mi_schema_decode(&var_list_children_schema,
+        result_record->result, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    result = varobjs_for_children(fields.children, &children);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        gdbwire_mi_varobjs_free(children);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_VAR_LIST_CHILDREN;
+    mi_command->variant.var_list_children.numchild = fields.numchild;
+    mi_command->variant.var_list_children.children = children;
+    mi_command->variant.var_list_children.has_more = fields.has_more != 0;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/** The type_changed values, indexed by their meaning. */
+static const char *const varobj_change_type_changed[] = {
+    "false", "true", 0
+};
+
+/** The fields of a change tuple in the -var-update changelist. */
+#define VAROBJ_CHANGE_FIELDS(X, T) \
+    X(T, "name", STRING, name, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "value", STRING, value, 0, 0) \
+    X(T, "in_scope", STRING, in_scope, 0, 0) \
+    X(T, "type_changed", ENUM, type_changed, 0, varobj_change_type_changed) \
+    X(T, "new_type", STRING, new_type, 0, 0) \
+    X(T, "new_num_children", INT, new_num_children, 0, 0) \
+    X(T, "has_more", INT, has_more, 0, 0) \
+    X(T, "new_children", LIST, new_children, 0, 0)
+
+/** The decoded fields of a change tuple, pointing into the tree. */
+struct varobj_change_fields {
+    VAROBJ_CHANGE_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct varobj_change_fields)
+};
+
+GDBWIRE_MI_SCHEMA(varobj_change_schema, struct varobj_change_fields,
+    VAROBJ_CHANGE_FIELDS);
+
+/**
+ * Handle a change tuple in the -var-update changelist.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the change tuple.
+ *
+ * @param out
+ * Allocated change on way out on success. Otherwise NULL on way out.
+ *
+ * @return
+ * GDBWIRE_OK on success and out is an allocated change. Otherwise
+ * the appropriate error code and out will be NULL.
+ */
+static enum gdbwire_result
+varobj_change_for_tuple(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_varobj_change **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_varobj_change *change;
+    struct varobj_change_fields fields;
+
+    *out = 0;
+
+    memset(&fields, 0, sizeof(struct varobj_change_fields));
+    fields.new_num_children = -1;
+
+    result = gdbwire_mi_schema_decode(&varobj_change_schema, mi_result,
+        &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    change = calloc(1, sizeof(struct gdbwire_mi_varobj_change));
+    if (!change) {
+        return GDBWIRE_NOMEM;
+    }
+
+    change->name = gdbwire_strdup(fields.name);
+    change->value = (fields.value)?gdbwire_strdup(fields.value):0;
+    change->new_type = (fields.new_type)?gdbwire_strdup(fields.new_type):0;
+    change->new_num_children = fields.new_num_children;
+    change->type_changed = fields.type_changed;
+    change->has_more = fields.has_more != 0;
+
+    if (!fields.in_scope || strcmp(fields.in_scope, "true") == 0) {
+        change->in_scope = GDBWIRE_MI_VAROBJ_IN_SCOPE;
+    } else if (strcmp(fields.in_scope, "false") == 0) {
+        change->in_scope = GDBWIRE_MI_VAROBJ_OUT_OF_SCOPE;
+    } else {
+        change->in_scope = GDBWIRE_MI_VAROBJ_INVALID;
+    }
+
+    /* Handle the out of memory situation */
+    if (!change->name ||
+        (fields.value && !change->value) ||
+        (fields.new_type && !change->new_type)) {
+        result = GDBWIRE_NOMEM;
+    } else if (fields.new_children) {
+        result = varobjs_for_children(fields.new_children,
+            &change->new_children);
+    }
+
+    if (result != GDBWIRE_OK) {
+        gdbwire_mi_varobj_changes_free(change);
+        return result;
+    }
+
+    *out = change;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the -var-update command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+var_update(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_varobj_change *changes = 0, **tail = &changes;
+    struct gdbwire_mi_command *mi_command;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "changelist") == 0);
+
+    for (mi_result = mi_result->variant.result; mi_result;
+            mi_result = mi_result->next) {
+        GDBWIRE_ASSERT_GOTO(mi_result->kind == GDBWIRE_MI_TUPLE,
+            result, cleanup);
+
+        result = varobj_change_for_tuple(mi_result->variant.result, tail);
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
+        }
+        tail = &(*tail)->next;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+    mi_command->kind = GDBWIRE_MI_VAR_UPDATE;
+    mi_command->variant.var_update.changes = changes;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_varobj_changes_free(changes);
+
+    return result;
+}
+
+/** The fields of a memory tuple, ie. {begin=...,end=...,contents=...}. */
+#define MEMORY_BLOCK_FIELDS(X, T) \
+    X(T, "begin", ADDRESS, begin, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "offset", ADDRESS, offset, 0, 0) \
+    X(T, "end", ADDRESS, end, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "contents", STRING, contents, GDBWIRE_MI_FIELD_REQUIRED, 0)
+
+/** The decoded fields of a memory tuple, pointing into the tree. */
+struct memory_block_fields {
+    MEMORY_BLOCK_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct memory_block_fields)
+};
+
+GDBWIRE_MI_SCHEMA(memory_block_schema, struct memory_block_fields,
+    MEMORY_BLOCK_FIELDS);
+
+/**
+ * Get the fields of a memory tuple, with out decoding the contents.
+ *
+ * @param mi_result
+ * The contents of the memory tuple.
+ *
+ * @param block
+ * The memory block to fill in, except for the contents field.
+ *
+ * @param contents
+ * The hexadecimal contents of the memory block on the way out.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+memory_block_fields(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_memory_block *block, const char **contents)
+{
+    enum gdbwire_result result;
+    struct memory_block_fields fields;
+    size_t size;
+
+    memset(block, 0, sizeof(struct gdbwire_mi_memory_block));
+    memset(&fields, 0, sizeof(struct memory_block_fields));
+    *contents = 0;
+
+    result = gdbwire_mi_schema_decode(&memory_block_schema, mi_result,
+        &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    block->begin = fields.begin;
+    block->offset = fields.offset;
+    block->end = fields.end;
+    *contents = fields.contents;
+
+    size = strlen(*contents);
+    GDBWIRE_ASSERT(size % 2 == 0);
+    GDBWIRE_ASSERT(block->end - block->begin == size / 2);
+    block->contents_size = size / 2;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_get_mi_memory_block(struct gdbwire_mi_result *mi_result,
+        unsigned char *buffer, size_t buffer_size,
+        struct gdbwire_mi_memory_block *out_block)
+{
+    enum gdbwire_result result;
+    const char *contents;
+
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_block);
+
+    result = memory_block_fields(mi_result, out_block, &contents);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    if (buffer_size < out_block->contents_size) {
+        return GDBWIRE_LOGIC;
+    }
+
+    GDBWIRE_ASSERT(buffer || out_block->contents_size == 0);
+    GDBWIRE_ASSERT(gdbwire_hex_decode(contents,
+        out_block->contents_size * 2, buffer) == 0);
+    out_block->contents = buffer;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Free a memory block list.
+ *
+ * The contents of each block are part of the block's allocation.
+ *
+ * @param blocks
+ * The memory block list to free, OK to pass in NULL.
+ */
+static void
+gdbwire_mi_memory_blocks_free(struct gdbwire_mi_memory_block *blocks)
+{
+    struct gdbwire_mi_memory_block *tmp, *cur = blocks;
+    while (cur) {
+        tmp = cur;
+        cur = cur->next;
+        free(tmp);
+    }
+}
+
+/**
+ * Handle the -data-read-memory-bytes command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+data_read_memory_bytes(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_memory_block fields, *block;
+    struct gdbwire_mi_memory_block *blocks = 0, **tail = &blocks;
+    struct gdbwire_mi_command *mi_command;
+    const char *contents;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "memory") == 0);
+
+    for (mi_result = mi_result->variant.result; mi_result;
+            mi_result = mi_result->next) {
+        GDBWIRE_ASSERT_GOTO(mi_result->kind == GDBWIRE_MI_TUPLE,
+            result, cleanup);
+
+        result = memory_block_fields(mi_result->variant.result,
+            &fields, &contents);
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
+        }
+
+        /* The contents are allocated right after the block */
+        block = malloc(sizeof(struct gdbwire_mi_memory_block) +
+            fields.contents_size);
+        if (!block) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        *block = fields;
+        block->contents = (unsigned char *)(block + 1);
+        *tail = block;
+        tail = &block->next;
+
+        GDBWIRE_ASSERT_GOTO(gdbwire_hex_decode(contents,
+            block->contents_size * 2, block->contents) == 0,
+            result, cleanup);
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+    mi_command->kind = GDBWIRE_MI_DATA_READ_MEMORY_BYTES;
+    mi_command->variant.data_read_memory_bytes.blocks = blocks;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_memory_blocks_free(blocks);
+
+    return result;
+}
+
+/**
+ * Count the elements of a list.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the first element of the list.
+ *
+ * @return
+ * The number of elements.
+ */
+static size_t
+list_size(struct gdbwire_mi_result *mi_result)
+{
+    size_t size = 0;
+
+    for (; mi_result; mi_result = mi_result->next) {
+        ++size;
+    }
+
+    return size;
+}
+
+/**
+ * Free the register names of a -data-list-register-names command.
+ *
+ * @param names
+ * The register names to free, OK to pass in NULL.
+ *
+ * @param size
+ * The number of register names.
+ */
+static void
+gdbwire_mi_register_names_free(char **names, size_t size)
+{
+    size_t index;
+
+    if (names) {
+        for (index = 0; index < size; ++index) {
+            free(names[index]);
+        }
+        free(names);
+    }
+}
+
+/**
+ * Free the register values of a -data-list-register-values command.
+ *
+ * @param values
+ * The register values to free, OK to pass in NULL.
+ *
+ * @param size
+ * The number of register values.
+ */
+static void
+gdbwire_mi_register_values_free(struct gdbwire_mi_register_value *values,
+        size_t size)
+{
+    size_t index;
+
+    if (values) {
+        for (index = 0; index < size; ++index) {
+            free(values[index].value);
+        }
+        free(values);
+    }
+}
+
+/**
+ * Handle the -data-list-register-names command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+data_list_register_names(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_command *mi_command;
+    char **names = 0;
+    size_t size, index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "register-names") == 0);
+
+    size = list_size(mi_result->variant.result);
+
+    for (mi_result = mi_result->variant.result; mi_result;
+            mi_result = mi_result->next) {
+        GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_DATA_LIST_REGISTER_NAMES;
+
+    if (size > 0) {
+        names = calloc(size, sizeof(char *));
+        if (!names) {
+            free(mi_command);
+            return GDBWIRE_NOMEM;
+        }
+        mi_command->variant.data_list_register_names.names = names;
+        mi_command->variant.data_list_register_names.names_size = size;
+    }
+
+    mi_result = result_record->result->variant.result;
+    for (; mi_result; mi_result = mi_result->next, ++index) {
+        /* Unused register numbers have an empty name */
+        if (mi_result->variant.cstring[0]) {
+            names[index] = gdbwire_strdup(mi_result->variant.cstring);
+            if (!names[index]) {
+                gdbwire_mi_command_free(mi_command);
+                return GDBWIRE_NOMEM;
+            }
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/** The fields of a register value tuple, ie. {number=...,value=...}. */
+#define REGISTER_VALUE_FIELDS(X, T) \
+    X(T, "number", INT, number, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "value", STRING, value, GDBWIRE_MI_FIELD_REQUIRED, 0)
+
+/** The decoded fields of a register value tuple. */
+struct register_value_fields {
+    REGISTER_VALUE_FIELDS(GDBWIRE_MI_FIELD_MEMBER,
+        struct register_value_fields)
+};
+
+GDBWIRE_MI_SCHEMA(register_value_schema, struct register_value_fields,
+    REGISTER_VALUE_FIELDS);
+
+/**
+ * Handle the -data-list-register-values command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+data_list_register_values(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_command *mi_command;
+    struct gdbwire_mi_register_value *values;
+    struct register_value_fields fields;
+    size_t size, index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "register-values") == 0);
+
+    size = list_size(mi_result->variant.result);
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_DATA_LIST_REGISTER_VALUES;
+
+    if (size > 0) {
+        values = calloc(size, sizeof(struct gdbwire_mi_register_value));
+        if (!values) {
+            free(mi_command);
+            return GDBWIRE_NOMEM;
+        }
+        mi_command->variant.data_list_register_values.values = values;
+        mi_command->variant.data_list_register_values.values_size = size;
+
+        for (mi_result = mi_result->variant.result; mi_result;
+                mi_result = mi_result->next, ++index) {
+            GDBWIRE_ASSERT_GOTO(mi_result->kind == GDBWIRE_MI_TUPLE,
+                result, cleanup);
+
+            memset(&fields, 0, sizeof(struct register_value_fields));
+            result = gdbwire_mi_schema_decode(&register_value_schema,
+                mi_result->variant.result, &fields);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+
+            values[index].number = fields.number;
+            values[index].value = gdbwire_strdup(fields.value);
+            if (!values[index].value) {
+                result = GDBWIRE_NOMEM;
+                goto cleanup;
+            }
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_command_free(mi_command);
+
+    return result;
+}
+
+/**
+ * Handle the -data-list-changed-registers command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+data_list_changed_registers(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    struct gdbwire_mi_result *mi_result, *cur;
+    struct gdbwire_mi_command *mi_command;
+    int *numbers = 0;
+    size_t size, index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "changed-registers") == 0);
+
+    mi_result = mi_result->variant.result;
+    size = list_size(mi_result);
+
+    for (cur = mi_result; cur; cur = cur->next) {
+        GDBWIRE_ASSERT(cur->kind == GDBWIRE_MI_CSTRING);
+    }
+
+    if (size > 0) {
+        numbers = calloc(size, sizeof(int));
+        if (!numbers) {
+            return GDBWIRE_NOMEM;
+        }
+
+        for (cur = mi_result; cur; cur = cur->next) {
+            numbers[index++] = atoi(cur->variant.cstring);
+        }
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        free(numbers);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS;
+    mi_command->variant.data_list_changed_registers.numbers = numbers;
+    mi_command->variant.data_list_changed_registers.numbers_size = size;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/** The fields of an instruction tuple, ie. {address=...,inst=...}. */
+#define INSTRUCTION_FIELDS(X, T) \
+    X(T, "address", ADDRESS, address, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "func-name", STRING, func_name, 0, 0) \
+    X(T, "offset", INT, offset, 0, 0) \
+    X(T, "inst", STRING, inst, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "opcodes", STRING, opcodes, 0, 0)
+
+GDBWIRE_MI_SCHEMA(instruction_schema, struct gdbwire_mi_instruction,
+    INSTRUCTION_FIELDS);
+
+/**
+ * Get the fields of an instruction tuple with out copying them.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the instruction tuple.
+ *
+ * @param instruction
+ * The instruction to fill in. The strings point into the parse tree.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+instruction_fields(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_instruction *instruction)
+{
+    memset(instruction, 0, sizeof(struct gdbwire_mi_instruction));
+    instruction->offset = -1;
+
+    return gdbwire_mi_schema_decode(&instruction_schema, mi_result,
+        instruction);
+}
+
+enum gdbwire_result
+gdbwire_get_mi_instruction(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_instruction *out_instruction)
+{
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_instruction);
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    return instruction_fields(mi_result->variant.result, out_instruction);
+}
+
+/**
+ * Intern a string in place.
+ *
+ * @param strings
+ * The string pool to intern the string in.
+ *
+ * @param str
+ * The string to intern, OK to point to NULL. On success, it points
+ * to the interned string on the way out.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_NOMEM on failure.
+ */
+static enum gdbwire_result
+intern_in_place(struct gdbwire_intern *strings, char **str)
+{
+    if (*str) {
+        *str = (char *)gdbwire_intern_string(strings, *str);
+        if (!*str) {
+            return GDBWIRE_NOMEM;
+        }
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Decode an instruction tuple, interning it's strings.
+ *
+ * @param strings
+ * The string pool to intern the strings in.
+ *
+ * @param mi_result
+ * The instruction tuple.
+ *
+ * @param instruction
+ * The instruction to fill in, with strings pointing into the pool.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+disassemble_instruction(struct gdbwire_intern *strings,
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_instruction *instruction)
+{
+    enum gdbwire_result result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    result = instruction_fields(mi_result->variant.result, instruction);
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &instruction->func_name);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &instruction->inst);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &instruction->opcodes);
+    }
+
+    return result;
+}
+
+/**
+ * Get the instructions of a source line tuple.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the source line tuple,
+ * ie. line="5",file="main.c",line_asm_insn=[...].
+ *
+ * @return
+ * The first element of the line_asm_insn list or NULL if it is empty.
+ */
+static struct gdbwire_mi_result *
+source_line_instructions(struct gdbwire_mi_result *mi_result)
+{
+    for (; mi_result; mi_result = mi_result->next) {
+        if (mi_result->kind == GDBWIRE_MI_LIST &&
+                strcmp(mi_result->variable, "line_asm_insn") == 0) {
+            return mi_result->variant.result;
+        }
+    }
+
+    return NULL;
+}
+
+/** The fields of a source line tuple, ie. src_and_asm_line={...}. */
+#define SOURCE_LINE_FIELDS(X, T) \
+    X(T, "line", INT, line, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "file", STRING, file, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0)
+
+GDBWIRE_MI_SCHEMA(source_line_schema, struct gdbwire_mi_source_line,
+    SOURCE_LINE_FIELDS);
+
+/**
+ * Decode a source line tuple, interning it's strings.
+ *
+ * The first and count fields are left for the caller to fill in.
+ *
+ * @param strings
+ * The string pool to intern the strings in.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the source line tuple.
+ *
+ * @param source_line
+ * The source line to fill in, with strings pointing into the pool.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+disassemble_source_line(struct gdbwire_intern *strings,
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_source_line *source_line)
+{
+    enum gdbwire_result result;
+
+    memset(source_line, 0, sizeof(struct gdbwire_mi_source_line));
+
+    result = gdbwire_mi_schema_decode(&source_line_schema, mi_result,
+        source_line);
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &source_line->file);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &source_line->fullname);
+    }
+
+    return result;
+}
+
+/**
+ * Handle the -data-disassemble command.
+ *
+ * Without source, GDB outputs a list of instruction tuples,
+ *   ^done,asm_insns=[{address="0x...",...},...]
+ * In source mode, GDB outputs a list of source line tuples, each with
+ * a list of instruction tuples,
+ *   ^done,asm_insns=[src_and_asm_line={line="5",...,line_asm_insn=[...]}]
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+data_disassemble(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result, *cur, *insn;
+    struct gdbwire_mi_command *mi_command = 0;
+    struct gdbwire_mi_instruction *instructions = 0;
+    struct gdbwire_mi_source_line *source_lines = 0, *source_line;
+    struct gdbwire_intern *strings;
+    size_t instructions_size = 0, source_lines_size = 0;
+    size_t index = 0, line_index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "asm_insns") == 0);
+
+    /* Count everything first so that it can be allocated at once */
+    for (cur = mi_result->variant.result; cur; cur = cur->next) {
+        GDBWIRE_ASSERT(cur->kind == GDBWIRE_MI_TUPLE);
+        if (cur->variable && strcmp(cur->variable, "src_and_asm_line") == 0) {
+            ++source_lines_size;
+            instructions_size += list_size(
+                source_line_instructions(cur->variant.result));
+        } else {
+            ++instructions_size;
+        }
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_DATA_DISASSEMBLE;
+
+    strings = gdbwire_intern_create();
+    mi_command->variant.data_disassemble.strings = strings;
+    if (!strings) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+
+    if (instructions_size > 0) {
+        instructions = calloc(instructions_size,
+            sizeof(struct gdbwire_mi_instruction));
+        if (!instructions) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.data_disassemble.instructions = instructions;
+        mi_command->variant.data_disassemble.instructions_size =
+            instructions_size;
+    }
+
+    if (source_lines_size > 0) {
+        source_lines = calloc(source_lines_size,
+            sizeof(struct gdbwire_mi_source_line));
+        if (!source_lines) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.data_disassemble.source_lines = source_lines;
+        mi_command->variant.data_disassemble.source_lines_size =
+            source_lines_size;
+    }
+
+    for (cur = mi_result->variant.result; cur; cur = cur->next) {
+        if (cur->variable && strcmp(cur->variable, "src_and_asm_line") == 0) {
+            source_line = &source_lines[line_index++];
+            result = disassemble_source_line(strings, cur->variant.result,
+                source_line);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+
+            source_line->first = index;
+            insn = source_line_instructions(cur->variant.result);
+            for (; insn; insn = insn->next) {
+                result = disassemble_instruction(strings, insn,
+                    &instructions[index++]);
+                if (result != GDBWIRE_OK) {
+                    goto cleanup;
+                }
+            }
+            source_line->count = index - source_line->first;
+        } else {
+            result = disassemble_instruction(strings, cur,
+                &instructions[index++]);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_command_free(mi_command);
+
+    return result;
+}
+
+/**
+ * The slot a thread id hashes to in the thread index.
+ *
+ * @param id
+ * The thread id.
+ *
+ * @param slots_size
+ * The number of slots, a power of two.
+ *
+ * @return
+ * The first slot to probe for the thread id.
+ */
+static size_t
+thread_info_slot(int id, size_t slots_size)
+{
+    /* Thread ids are sequential, so spread them over the table */
+    return ((size_t)(unsigned)id * 2654435761u) & (slots_size - 1);
+}
+
+struct gdbwire_mi_thread *
+gdbwire_mi_thread_info_find(struct gdbwire_mi_command *mi_command, int id)
+{
+    struct gdbwire_mi_thread *threads;
+    size_t *slots, slots_size, slot;
+
+    if (!mi_command || mi_command->kind != GDBWIRE_MI_THREAD_INFO ||
+            !mi_command->variant.thread_info.slots) {
+        return NULL;
+    }
+
+    threads = mi_command->variant.thread_info.threads;
+    slots = mi_command->variant.thread_info.slots;
+    slots_size = mi_command->variant.thread_info.slots_size;
+
+    for (slot = thread_info_slot(id, slots_size); slots[slot];
+            slot = (slot + 1) & (slots_size - 1)) {
+        if (threads[slots[slot] - 1].id == id) {
+            return &threads[slots[slot] - 1];
+        }
+    }
+
+    return NULL;
+}
+
+/** The state values, indexed by enum gdbwire_mi_thread_state. */
+static const char *const thread_info_states[] = { "stopped", "running", 0 };
+
+/** The fields of a thread tuple in the -thread-info output. */
+#define THREAD_INFO_FIELDS(X, T) \
+    X(T, "id", INT, id, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "target-id", STRING, target_id, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "name", STRING, name, 0, 0) \
+    X(T, "details", STRING, details, 0, 0) \
+    X(T, "state", ENUM, state, GDBWIRE_MI_FIELD_REQUIRED, \
+        thread_info_states) \
+    X(T, "core", INT, core, 0, 0) \
+    X(T, "frame", TUPLE, frame, 0, 0)
+
+/** The decoded fields of a thread tuple, pointing into the tree. */
+struct thread_info_fields {
+    THREAD_INFO_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct thread_info_fields)
+};
+
+GDBWIRE_MI_SCHEMA(thread_info_schema, struct thread_info_fields,
+    THREAD_INFO_FIELDS);
+
+/**
+ * Decode a thread tuple, interning it's strings.
+ *
+ * @param strings
+ * The string pool to intern the strings in.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the thread tuple.
+ *
+ * @param thread
+ * The thread to fill in, with strings pointing into the pool.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+thread_info_thread(struct gdbwire_intern *strings,
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_thread *thread)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_stack_frame frame;
+    struct thread_info_fields fields;
+
+    memset(thread, 0, sizeof(struct gdbwire_mi_thread));
+    memset(&fields, 0, sizeof(struct thread_info_fields));
+    fields.state = GDBWIRE_MI_THREAD_STATE_UNSUPPORTED;
+    fields.core = -1;
+
+    result = gdbwire_mi_schema_decode(&thread_info_schema, mi_result,
+        &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    thread->id = fields.id;
+    thread->target_id = fields.target_id;
+    thread->name = fields.name;
+    thread->details = fields.details;
+    thread->state = (enum gdbwire_mi_thread_state)fields.state;
+    thread->core = fields.core;
+
+    if (fields.frame) {
+        result = stack_frame_fields(fields.frame, 0, &frame);
+        if (result == GDBWIRE_OK) {
+            result = stack_frame_intern(strings, &frame, &thread->frame);
+        }
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        thread->has_frame = 1;
+    }
+
+    result = intern_in_place(strings, &thread->target_id);
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &thread->name);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &thread->details);
+    }
+
+    return result;
+}
+
+/** The fields of the -thread-info output. */
+#define THREAD_INFO_LIST_FIELDS(X, T) \
+    X(T, "threads", LIST, threads, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "current-thread-id", INT, current_thread_id, 0, 0)
+
+/** The decoded -thread-info fields. */
+struct thread_info_list_fields {
+    THREAD_INFO_LIST_FIELDS(GDBWIRE_MI_FIELD_MEMBER,
+        struct thread_info_list_fields)
+};
+
+GDBWIRE_MI_SCHEMA(thread_info_list_schema, struct thread_info_list_fields,
+    THREAD_INFO_LIST_FIELDS);
+
+/**
+ * Handle the -thread-info command.
+ *
+ * The threads are decoded straight into the threads array. The strings
+ * are interned rather than duplicated one at a time, so a response with
+ * tens of thousands of threads only makes a handful of allocations.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+thread_info(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *cur;
+    struct gdbwire_mi_command *mi_command = 0;
+    struct gdbwire_mi_thread *threads;
+    struct gdbwire_intern *strings;
+    struct thread_info_list_fields fields;
+    size_t size = 0, index = 0, *slots, slots_size = 8, slot;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+
+    memset(&fields, 0, sizeof(struct thread_info_list_fields));
+    fields.current_thread_id = -1;
+
+    result = gdbwire_mi_schema_decode(&thread_info_list_schema,
+        result_record->result, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    /* Count the threads first so that they can be allocated at once */
+    for (cur = fields.threads; cur; cur = cur->next) {
+        GDBWIRE_ASSERT(cur->kind == GDBWIRE_MI_TUPLE);
+        ++size;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = GDBWIRE_MI_THREAD_INFO;
+    mi_command->variant.thread_info.current_thread_id =
+        fields.current_thread_id;
+
+    strings = gdbwire_intern_create();
+    mi_command->variant.thread_info.strings = strings;
+    if (!strings) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+
+    if (size > 0) {
+        /* Keep the thread index at most half full */
+        while (slots_size < size * 2) {
+            slots_size *= 2;
+        }
+
+        threads = calloc(size, sizeof(struct gdbwire_mi_thread));
+        slots = calloc(slots_size, sizeof(size_t));
+        mi_command->variant.thread_info.threads = threads;
+        mi_command->variant.thread_info.slots = slots;
+        if (!threads || !slots) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.thread_info.threads_size = size;
+        mi_command->variant.thread_info.slots_size = slots_size;
+
+        for (cur = fields.threads; cur; cur = cur->next, ++index) {
+            result = thread_info_thread(strings, cur->variant.result,
+                &threads[index]);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
+            }
+
+            slot = thread_info_slot(threads[index].id, slots_size);
+            while (slots[slot]) {
+                slot = (slot + 1) & (slots_size - 1);
+            }
+            slots[slot] = index + 1;
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_command_free(mi_command);
+
+    return result;
+}
+
+/** The fields of a symbol tuple, ie. {line=...,name=...,...}. */
+#define SYMBOL_FIELDS(X, T) \
+    X(T, "line", INT, line, 0, 0) \
+    X(T, "name", STRING, name, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "type", STRING, type, 0, 0) \
+    X(T, "description", STRING, description, 0, 0) \
+    X(T, "address", ADDRESS, address, 0, 0)
+
+GDBWIRE_MI_SCHEMA(symbol_schema, struct gdbwire_mi_symbol, SYMBOL_FIELDS);
+
+/**
+ * Get the fields of a symbol tuple with out copying them.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the symbol tuple.
+ *
+ * @param symbol
+ * The symbol to fill in. The strings point into the parse tree.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+symbol_fields(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol *symbol)
+{
+    memset(symbol, 0, sizeof(struct gdbwire_mi_symbol));
+
+    return gdbwire_mi_schema_decode(&symbol_schema, mi_result, symbol);
+}
+
+enum gdbwire_result
+gdbwire_get_mi_symbol(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol *out_symbol)
+{
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_symbol);
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    return symbol_fields(mi_result->variant.result, out_symbol);
+}
+
+/** The fields of a symbol file tuple, ie. {filename=...,symbols=[...]}. */
+#define SYMBOL_FILE_FIELDS(X, T) \
+    X(T, "filename", STRING, filename, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0) \
+    X(T, "symbols", LIST, symbols, 0, 0)
+
+/** The decoded fields of a symbol file tuple, pointing into the tree. */
+struct symbol_file_fields {
+    SYMBOL_FILE_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct symbol_file_fields)
+};
+
+GDBWIRE_MI_SCHEMA(symbol_file_schema, struct symbol_file_fields,
+    SYMBOL_FILE_FIELDS);
+
+/**
+ * Get the fields of a symbol file tuple with out copying them.
+ *
+ * The symbols and symbols_size fields are left for the caller.
+ *
+ * @param mi_result
+ * The mi parse tree starting from the contents of the symbol file tuple.
+ *
+ * @param file
+ * The symbol file to fill in. The strings point into the parse tree.
+ *
+ * @param symbols
+ * The first element of the symbols=[...] list on the way out,
+ * or NULL if the list is empty.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+symbol_file_fields(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol_file *file,
+        struct gdbwire_mi_result **symbols)
+{
+    enum gdbwire_result result;
+    struct symbol_file_fields fields;
+
+    memset(file, 0, sizeof(struct gdbwire_mi_symbol_file));
+    memset(&fields, 0, sizeof(struct symbol_file_fields));
+    *symbols = 0;
+
+    result = gdbwire_mi_schema_decode(&symbol_file_schema, mi_result,
+        &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    file->filename = fields.filename;
+    file->fullname = fields.fullname;
+    *symbols = fields.symbols;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_get_mi_symbol_file(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol_file *out_file)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_result *symbols;
+    size_t size, index = 0;
+
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_file);
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    result = symbol_file_fields(mi_result->variant.result, out_file,
+        &symbols);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    size = list_size(symbols);
+    if (size > 0) {
+        out_file->symbols = calloc(size, sizeof(struct gdbwire_mi_symbol));
+        if (!out_file->symbols) {
+            return GDBWIRE_NOMEM;
+        }
+        out_file->symbols_size = size;
+
+        for (; symbols && result == GDBWIRE_OK; symbols = symbols->next) {
+            result = gdbwire_get_mi_symbol(symbols,
+                &out_file->symbols[index++]);
+        }
+
+        if (result != GDBWIRE_OK) {
+            gdbwire_mi_symbol_file_free_symbols(out_file);
+        }
+    }
+
+    return result;
+}
+
+void
+gdbwire_mi_symbol_file_free_symbols(struct gdbwire_mi_symbol_file *file)
+{
+    if (file) {
+        free(file->symbols);
+        file->symbols = NULL;
+        file->symbols_size = 0;
+    }
+}
+
+/**
+ * Decode a symbol tuple, interning it's strings.
+ *
+ * @param strings
+ * The string pool to intern the strings in.
+ *
+ * @param mi_result
+ * The symbol tuple.
+ *
+ * @param symbol
+ * The symbol to fill in, with strings pointing into the pool.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+symbol_info_symbol(struct gdbwire_intern *strings,
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol *symbol)
+{
+    enum gdbwire_result result;
+
+    result = gdbwire_get_mi_symbol(mi_result, symbol);
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &symbol->name);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &symbol->type);
+    }
+    if (result == GDBWIRE_OK) {
+        result = intern_in_place(strings, &symbol->description);
+    }
+
+    return result;
+}
+
+/**
+ * Handle the -symbol-info-functions, -symbol-info-variables and
+ * -symbol-info-types commands.
+ *
+ * GDB outputs the debug symbols grouped by symbol file, followed by
+ * the non-debug symbols when they are asked for,
+ *   ^done,symbols={debug=[{filename="f.c",symbols=[...]},...],
+ *     nondebug=[{address="0x...",name="_init"},...]}
+ *
+ * @param kind
+ * The kind of command, all three commands have the same output.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+symbol_info(enum gdbwire_mi_command_kind kind,
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result, *debug = 0, *nondebug = 0;
+    struct gdbwire_mi_result *cur, *symbols;
+    struct gdbwire_mi_command *mi_command = 0;
+    struct gdbwire_mi_symbol_file fields, *files = 0, *file;
+    struct gdbwire_mi_symbol *all_symbols = 0, *nondebug_symbols = 0;
+    struct gdbwire_intern *strings;
+    size_t files_size = 0, symbols_size = 0, nondebug_size = 0;
+    size_t file_index = 0, index = 0;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "symbols") == 0);
+
+    for (cur = mi_result->variant.result; cur; cur = cur->next) {
+        if (cur->kind == GDBWIRE_MI_LIST &&
+                strcmp(cur->variable, "debug") == 0) {
+            debug = cur->variant.result;
+        } else if (cur->kind == GDBWIRE_MI_LIST &&
+                strcmp(cur->variable, "nondebug") == 0) {
+            nondebug = cur->variant.result;
+        }
+    }
+
+    /* Count everything first so that it can be allocated at once */
+    for (cur = debug; cur; cur = cur->next) {
+        GDBWIRE_ASSERT(cur->kind == GDBWIRE_MI_TUPLE);
+        result = symbol_file_fields(cur->variant.result, &fields, &symbols);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        ++files_size;
+        symbols_size += list_size(symbols);
+    }
+    nondebug_size = list_size(nondebug);
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->kind = kind;
+
+    strings = gdbwire_intern_create();
+    mi_command->variant.symbol_info.strings = strings;
+    if (!strings) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+
+    if (files_size > 0) {
+        files = calloc(files_size, sizeof(struct gdbwire_mi_symbol_file));
+        mi_command->variant.symbol_info.files = files;
+        if (!files) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.symbol_info.files_size = files_size;
+    }
+
+    if (symbols_size > 0) {
+        all_symbols = calloc(symbols_size, sizeof(struct gdbwire_mi_symbol));
+        mi_command->variant.symbol_info.symbols = all_symbols;
+        if (!all_symbols) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.symbol_info.symbols_size = symbols_size;
+    }
+
+    if (nondebug_size > 0) {
+        nondebug_symbols = calloc(nondebug_size,
+            sizeof(struct gdbwire_mi_symbol));
+        mi_command->variant.symbol_info.nondebug = nondebug_symbols;
+        if (!nondebug_symbols) {
+            result = GDBWIRE_NOMEM;
+            goto cleanup;
+        }
+        mi_command->variant.symbol_info.nondebug_size = nondebug_size;
+    }
+
+    for (cur = debug; cur; cur = cur->next) {
+        file = &files[file_index++];
+        result = symbol_file_fields(cur->variant.result, file, &symbols);
+        if (result == GDBWIRE_OK) {
+            result = intern_in_place(strings, &file->filename);
+        }
+        if (result == GDBWIRE_OK) {
+            result = intern_in_place(strings, &file->fullname);
+        }
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
+        }
+
+        file->symbols = (symbols) ? &all_symbols[index] : NULL;
+        for (; symbols; symbols = symbols->next) {
+            result = symbol_info_symbol(strings, symbols,
+                &all_symbols[index++]);
+            if (result != GDBWIRE_OK) {
+                goto cleanup;
             }
+            file->symbols_size++;
+        }
+    }
+
+    for (index = 0, cur = nondebug; cur; cur = cur->next) {
+        result = symbol_info_symbol(strings, cur,
+            &nondebug_symbols[index++]);
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
+        }
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_command_free(mi_command);
+
+    return result;
+}
+
+/**
+ * Order line table entries by address, and then by line.
+ *
+ * @param first
+ * The first struct gdbwire_mi_line.
+ *
+ * @param second
+ * The second struct gdbwire_mi_line.
+ *
+ * @return
+ * Less than, equal to or greater than 0 if first is ordered before,
+ * with or after second.
+ */
+static int
+line_table_compare_address(const void *first, const void *second)
+{
+    const struct gdbwire_mi_line *lhs = first, *rhs = second;
+
+    if (lhs->pc != rhs->pc) {
+        return (lhs->pc < rhs->pc) ? -1 : 1;
+    }
+
+    return (lhs->line > rhs->line) - (lhs->line < rhs->line);
+}
+
+/**
+ * Order line table entries by line, and then by address.
+ *
+ * See line_table_compare_address for the parameters.
+ */
+static int
+line_table_compare_line(const void *first, const void *second)
+{
+    const struct gdbwire_mi_line *lhs = first, *rhs = second;
+
+    if (lhs->line != rhs->line) {
+        return (lhs->line < rhs->line) ? -1 : 1;
+    }
+
+    return (lhs->pc > rhs->pc) - (lhs->pc < rhs->pc);
+}
+
+const struct gdbwire_mi_line *
+gdbwire_mi_line_table_find_address(const struct gdbwire_mi_line_table *table,
+        uint64_t pc)
+{
+    size_t low = 0, high, middle;
+
+    if (!table) {
+        return NULL;
+    }
+
+    /* Find the first entry after pc, the answer is the one before it */
+    high = table->size;
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (table->by_address[middle].pc <= pc) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (low > 0) ? &table->by_address[low - 1] : NULL;
+}
+
+const struct gdbwire_mi_line *
+gdbwire_mi_line_table_find_line(const struct gdbwire_mi_line_table *table,
+        int line, size_t *count)
+{
+    size_t low = 0, high, middle, end;
+
+    *count = 0;
+
+    if (!table) {
+        return NULL;
+    }
+
+    high = table->size;
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (table->by_line[middle].line < line) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == table->size) {
+        return NULL;
+    }
+
+    for (end = low; end < table->size &&
+            table->by_line[end].line == table->by_line[low].line; ++end) {
+    }
+    *count = end - low;
+
+    return &table->by_line[low];
+}
+
+void
+gdbwire_mi_line_table_free(struct gdbwire_mi_line_table *table)
+{
+    /* The entries are part of the table's allocation */
+    free(table);
+}
+
+/** The fields of a line tuple in the -symbol-list-lines output. */
+#define LINE_TABLE_FIELDS(X, T) \
+    X(T, "pc", ADDRESS, pc, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "line", INT, line, GDBWIRE_MI_FIELD_REQUIRED, 0)
+
+GDBWIRE_MI_SCHEMA(line_table_schema, struct gdbwire_mi_line,
+    LINE_TABLE_FIELDS);
+
+/**
+ * Handle the -symbol-list-lines command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+symbol_list_lines(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result, *cur;
+    struct gdbwire_mi_command *mi_command;
+    struct gdbwire_mi_line_table *table;
+    struct gdbwire_mi_line *entry;
+    size_t size, index = 0;
+
+    *out = 0;
 
-            tuple = tuple->next;
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "lines") == 0);
+
+    size = list_size(mi_result->variant.result);
+
+    /* The table and both of it's arrays are a single allocation */
+    table = malloc(sizeof(struct gdbwire_mi_line_table) +
+        2 * size * sizeof(struct gdbwire_mi_line));
+    if (!table) {
+        return GDBWIRE_NOMEM;
+    }
+    table->by_address = (struct gdbwire_mi_line *)(table + 1);
+    table->by_line = table->by_address + size;
+    table->size = size;
+
+    for (cur = mi_result->variant.result; cur; cur = cur->next) {
+        GDBWIRE_ASSERT_GOTO(cur->kind == GDBWIRE_MI_TUPLE, result, cleanup);
+
+        entry = &table->by_address[index++];
+        memset(entry, 0, sizeof(struct gdbwire_mi_line));
+        result = gdbwire_mi_schema_decode(&line_table_schema,
+            cur->variant.result, entry);
+        if (result != GDBWIRE_OK) {
+            goto cleanup;
         }
+    }
+
+    if (size > 0) {
+        memcpy(table->by_line, table->by_address,
+            size * sizeof(struct gdbwire_mi_line));
+        qsort(table->by_address, size, sizeof(struct gdbwire_mi_line),
+            line_table_compare_address);
+        qsort(table->by_line, size, sizeof(struct gdbwire_mi_line),
+            line_table_compare_line);
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        result = GDBWIRE_NOMEM;
+        goto cleanup;
+    }
+    mi_command->kind = GDBWIRE_MI_SYMBOL_LIST_LINES;
+    mi_command->variant.symbol_list_lines.table = table;
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+
+cleanup:
+    gdbwire_mi_line_table_free(table);
+    return result;
+}
+
+/** The macro-info values, indexed by their meaning. */
+static const char *const exec_source_file_macro_info[] = { "0", "1", 0 };
 
-        // file is required, but fullname and debug_fully_read is not
-        GDBWIRE_ASSERT_GOTO(file, result, err);
+/** The fields of the -file-list-exec-source-file output. */
+#define EXEC_SOURCE_FILE_FIELDS(X, T) \
+    X(T, "line", INT, line, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "file", STRING, file, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0) \
+    X(T, "macro-info", ENUM, macro_info, GDBWIRE_MI_FIELD_STRICT, \
+        exec_source_file_macro_info)
+
+/** The decoded -file-list-exec-source-file fields. */
+struct exec_source_file_fields {
+    EXEC_SOURCE_FILE_FIELDS(GDBWIRE_MI_FIELD_MEMBER,
+        struct exec_source_file_fields)
+};
+
+GDBWIRE_MI_SCHEMA(exec_source_file_schema, struct exec_source_file_fields,
+    EXEC_SOURCE_FILE_FIELDS);
+
+/**
+ * Handle the -file-list-exec-source-file command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+file_list_exec_source_file(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result;
+    struct gdbwire_mi_command *mi_command = 0;
+    struct exec_source_file_fields fields;
+
+    *out = 0;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    memset(&fields, 0, sizeof(struct exec_source_file_fields));
+    fields.macro_info = -1;
+
+    result = gdbwire_mi_schema_decode(&exec_source_file_schema,
+        result_record->result, &fields);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    mi_command = calloc(1, sizeof(struct gdbwire_mi_command));
+    if (!mi_command) {
+        return GDBWIRE_NOMEM;
+    }
+
+    mi_command->kind = GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILE;
+    mi_command->variant.file_list_exec_source_file.line = fields.line;
+    mi_command->variant.file_list_exec_source_file.file =
+        gdbwire_strdup(fields.file);
+    if (!mi_command->variant.file_list_exec_source_file.file) {
+        gdbwire_mi_command_free(mi_command);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->variant.file_list_exec_source_file.fullname =
+        (fields.fullname)?gdbwire_strdup(fields.fullname):0;
+    if (fields.fullname &&
+        !mi_command->variant.file_list_exec_source_file.fullname) {
+        gdbwire_mi_command_free(mi_command);
+        return GDBWIRE_NOMEM;
+    }
+    mi_command->variant.file_list_exec_source_file.macro_info_exists =
+        fields.macro_info != -1;
+    if (fields.macro_info != -1) {
+        mi_command->variant.file_list_exec_source_file.macro_info =
+            fields.macro_info;
+    }
+
+    *out = mi_command;
+
+    return GDBWIRE_OK;
+}
+
+/** The debug-fully-read values, indexed by their enumeration. */
+static const char *const source_file_debug_fully_read[] = {
+    "", "true", "false", 0
+};
+
+/** The fields of a source file tuple, ie. {file=...,fullname=...}. */
+#define SOURCE_FILE_FIELDS(X, T) \
+    X(T, "file", STRING, file, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+    X(T, "fullname", STRING, fullname, 0, 0) \
+    X(T, "debug-fully-read", ENUM, debug_fully_read, 0, \
+        source_file_debug_fully_read)
+
+GDBWIRE_MI_SCHEMA(source_file_schema, struct gdbwire_mi_source_file,
+    SOURCE_FILE_FIELDS);
+
+enum gdbwire_result
+gdbwire_get_mi_source_file(struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_source_file *out_file)
+{
+    GDBWIRE_ASSERT(mi_result);
+    GDBWIRE_ASSERT(out_file);
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+
+    memset(out_file, 0, sizeof(struct gdbwire_mi_source_file));
+    out_file->debug_fully_read = GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN;
+
+    // file is required, but fullname and debug_fully_read is not
+    return gdbwire_mi_schema_decode(&source_file_schema,
+        mi_result->variant.result, out_file);
+}
+
+/**
+ * Handle the -file-list-exec-source-files command.
+ *
+ * @param result_record
+ * The mi result record that makes up the command output from gdb.
+ *
+ * @param out
+ * The output command, null on error.
+ *
+ * @return
+ * GDBWIRE_OK on success, otherwise failure and out is NULL.
+ */
+static enum gdbwire_result
+file_list_exec_source_files(
+    struct gdbwire_mi_result_record *result_record,
+    struct gdbwire_mi_command **out)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+    struct gdbwire_mi_source_file *files = 0, *cur_node, *new_node;
+
+    GDBWIRE_ASSERT(result_record->result_class == GDBWIRE_MI_DONE);
+    GDBWIRE_ASSERT(result_record->result);
+
+    mi_result = result_record->result;
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+    GDBWIRE_ASSERT(strcmp(mi_result->variable, "files") == 0);
+    GDBWIRE_ASSERT(!mi_result->next);
+
+    mi_result = mi_result->variant.result;
+
+    while (mi_result) {
+        struct gdbwire_mi_source_file file;
+
+        result = gdbwire_get_mi_source_file(mi_result, &file);
+        if (result != GDBWIRE_OK) {
+            goto err;
+        }
 
         /* Create the new */
         new_node = calloc(1, sizeof(struct gdbwire_mi_source_file));
         GDBWIRE_ASSERT_GOTO(new_node, result, err);
 
-        new_node->file = gdbwire_strdup(file);
-        new_node->fullname = (fullname)?gdbwire_strdup(fullname):0;
-        new_node->debug_fully_read = debug_fully_read;
+        new_node->file = gdbwire_strdup(file.file);
+        new_node->fullname = (file.fullname)?gdbwire_strdup(file.fullname):0;
+        new_node->debug_fully_read = file.debug_fully_read;
         new_node->next = 0;
 
         /* Append the node to the list */
@@ -692,8 +3171,8 @@ file_list_exec_source_files(
             files = cur_node = new_node;
         }
 
-        GDBWIRE_ASSERT_GOTO(new_node->file && (new_node->fullname || !fullname),
-            result, err);
+        GDBWIRE_ASSERT_GOTO(new_node->file &&
+            (new_node->fullname || !file.fullname), result, err);
 
         mi_result = mi_result->next;
     }
@@ -736,8 +3215,48 @@ gdbwire_get_mi_command(enum gdbwire_mi_command_kind kind,
         case GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILES:
             result = file_list_exec_source_files(result_record, out);
             break;
+        case GDBWIRE_MI_STACK_LIST_FRAMES:
+            result = stack_list_frames(result_record, out);
+            break;
+        case GDBWIRE_MI_VAR_CREATE:
+            result = var_create(result_record, out);
+            break;
+        case GDBWIRE_MI_VAR_LIST_CHILDREN:
+            result = var_list_children(result_record, out);
+            break;
+        case GDBWIRE_MI_VAR_UPDATE:
+            result = var_update(result_record, out);
+            break;
+        case GDBWIRE_MI_DATA_READ_MEMORY_BYTES:
+            result = data_read_memory_bytes(result_record, out);
+            break;
+        case GDBWIRE_MI_DATA_LIST_REGISTER_NAMES:
+            result = data_list_register_names(result_record, out);
+            break;
+        case GDBWIRE_MI_DATA_LIST_REGISTER_VALUES:
+            result = data_list_register_values(result_record, out);
+            break;
+        case GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS:
+            result = data_list_changed_registers(result_record, out);
+            break;
+        case GDBWIRE_MI_DATA_DISASSEMBLE:
+            result = data_disassemble(result_record, out);
+            break;
+        case GDBWIRE_MI_THREAD_INFO:
+            result = thread_info(result_record, out);
+            break;
+        case GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS:
+        case GDBWIRE_MI_SYMBOL_INFO_VARIABLES:
+        case GDBWIRE_MI_SYMBOL_INFO_TYPES:
+            result = symbol_info(kind, result_record, out);
+            break;
+        case GDBWIRE_MI_SYMBOL_LIST_LINES:
+            result = symbol_list_lines(result_record, out);
+            break;
     }
-    
+
+    GDBWIRE_PROBE3(command__decoded, (int)kind, (int)result, *out);
+
     return result;
 }
 
@@ -761,6 +3280,64 @@ void gdbwire_mi_command_free(struct gdbwire_mi_command *mi_command)
                 gdbwire_mi_source_files_free(
                     mi_command->variant.file_list_exec_source_files.files);
                 break;
+            case GDBWIRE_MI_STACK_LIST_FRAMES:
+                free(mi_command->variant.stack_list_frames.frames);
+                gdbwire_intern_destroy(
+                    mi_command->variant.stack_list_frames.strings);
+                break;
+            case GDBWIRE_MI_VAR_CREATE:
+                gdbwire_mi_varobj_free(mi_command->variant.var_create.varobj);
+                break;
+            case GDBWIRE_MI_VAR_LIST_CHILDREN:
+                gdbwire_mi_varobjs_free(
+                    mi_command->variant.var_list_children.children);
+                break;
+            case GDBWIRE_MI_VAR_UPDATE:
+                gdbwire_mi_varobj_changes_free(
+                    mi_command->variant.var_update.changes);
+                break;
+            case GDBWIRE_MI_DATA_READ_MEMORY_BYTES:
+                gdbwire_mi_memory_blocks_free(
+                    mi_command->variant.data_read_memory_bytes.blocks);
+                break;
+            case GDBWIRE_MI_DATA_LIST_REGISTER_NAMES:
+                gdbwire_mi_register_names_free(
+                    mi_command->variant.data_list_register_names.names,
+                    mi_command->variant.data_list_register_names.names_size);
+                break;
+            case GDBWIRE_MI_DATA_LIST_REGISTER_VALUES:
+                gdbwire_mi_register_values_free(
+                    mi_command->variant.data_list_register_values.values,
+                    mi_command->variant.data_list_register_values.values_size);
+                break;
+            case GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS:
+                free(mi_command->variant.data_list_changed_registers.numbers);
+                break;
+            case GDBWIRE_MI_DATA_DISASSEMBLE:
+                free(mi_command->variant.data_disassemble.instructions);
+                free(mi_command->variant.data_disassemble.source_lines);
+                gdbwire_intern_destroy(
+                    mi_command->variant.data_disassemble.strings);
+                break;
+            case GDBWIRE_MI_THREAD_INFO:
+                free(mi_command->variant.thread_info.threads);
+                free(mi_command->variant.thread_info.slots);
+                gdbwire_intern_destroy(
+                    mi_command->variant.thread_info.strings);
+                break;
+            case GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS:
+            case GDBWIRE_MI_SYMBOL_INFO_VARIABLES:
+            case GDBWIRE_MI_SYMBOL_INFO_TYPES:
+                free(mi_command->variant.symbol_info.files);
+                free(mi_command->variant.symbol_info.symbols);
+                free(mi_command->variant.symbol_info.nondebug);
+                gdbwire_intern_destroy(
+                    mi_command->variant.symbol_info.strings);
+                break;
+            case GDBWIRE_MI_SYMBOL_LIST_LINES:
+                gdbwire_mi_line_table_free(
+                    mi_command->variant.symbol_list_lines.table);
+                break;
         }
 
         free(mi_command);
@@ -5,8 +5,10 @@
 extern "C" { 
 #endif 
 
+#include <stdint.h>
 #include "gdbwire_result.h"
 #include "gdbwire_mi_pt.h"
+#include "gdbwire_intern.h"
 
 /**
  * An enumeration representing the supported GDB/MI commands.
@@ -21,7 +23,43 @@ enum gdbwire_mi_command_kind {
     /* -file-list-exec-source-file */
     GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILE,
     /* -file-list-exec-source-files */
-    GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILES
+    GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILES,
+
+    /* -stack-list-frames */
+    GDBWIRE_MI_STACK_LIST_FRAMES,
+
+    /* -var-create */
+    GDBWIRE_MI_VAR_CREATE,
+    /* -var-list-children */
+    GDBWIRE_MI_VAR_LIST_CHILDREN,
+    /* -var-update */
+    GDBWIRE_MI_VAR_UPDATE,
+
+    /* -data-read-memory-bytes */
+    GDBWIRE_MI_DATA_READ_MEMORY_BYTES,
+
+    /* -data-list-register-names */
+    GDBWIRE_MI_DATA_LIST_REGISTER_NAMES,
+    /* -data-list-register-values */
+    GDBWIRE_MI_DATA_LIST_REGISTER_VALUES,
+    /* -data-list-changed-registers */
+    GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS,
+
+    /* -data-disassemble */
+    GDBWIRE_MI_DATA_DISASSEMBLE,
+
+    /* -thread-info */
+    GDBWIRE_MI_THREAD_INFO,
+
+    /* -symbol-info-functions */
+    GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS,
+    /* -symbol-info-variables */
+    GDBWIRE_MI_SYMBOL_INFO_VARIABLES,
+    /* -symbol-info-types */
+    GDBWIRE_MI_SYMBOL_INFO_TYPES,
+
+    /* -symbol-list-lines */
+    GDBWIRE_MI_SYMBOL_LIST_LINES
 };
 
 /**
@@ -249,6 +287,13 @@ struct gdbwire_mi_stack_frame {
      */
     char *address;
 
+    /**
+     * The address above as a number.
+     *
+     * Zero if the address is NULL.
+     */
+    uint64_t pc;
+
    /**
     * The function name for the frame. May be NULL if unknown.
     */
@@ -278,6 +323,413 @@ struct gdbwire_mi_stack_frame {
    char *from;
 };
 
+/** The reasons GDB gives for stopping the target in the *stopped record. */
+enum gdbwire_mi_stop_reason {
+    /** GDB did not give a reason, ie. after -exec-interrupt in all-stop. */
+    GDBWIRE_MI_STOP_REASON_NONE,
+    /** breakpoint-hit */
+    GDBWIRE_MI_STOP_REASON_BREAKPOINT_HIT,
+    /** watchpoint-trigger */
+    GDBWIRE_MI_STOP_REASON_WATCHPOINT_TRIGGER,
+    /** read-watchpoint-trigger */
+    GDBWIRE_MI_STOP_REASON_READ_WATCHPOINT_TRIGGER,
+    /** access-watchpoint-trigger */
+    GDBWIRE_MI_STOP_REASON_ACCESS_WATCHPOINT_TRIGGER,
+    /** function-finished */
+    GDBWIRE_MI_STOP_REASON_FUNCTION_FINISHED,
+    /** location-reached */
+    GDBWIRE_MI_STOP_REASON_LOCATION_REACHED,
+    /** watchpoint-scope */
+    GDBWIRE_MI_STOP_REASON_WATCHPOINT_SCOPE,
+    /** end-stepping-range */
+    GDBWIRE_MI_STOP_REASON_END_STEPPING_RANGE,
+    /** exited-signalled */
+    GDBWIRE_MI_STOP_REASON_EXITED_SIGNALLED,
+    /** exited */
+    GDBWIRE_MI_STOP_REASON_EXITED,
+    /** exited-normally */
+    GDBWIRE_MI_STOP_REASON_EXITED_NORMALLY,
+    /** signal-received */
+    GDBWIRE_MI_STOP_REASON_SIGNAL_RECEIVED,
+    /** solib-event */
+    GDBWIRE_MI_STOP_REASON_SOLIB_EVENT,
+    /** fork */
+    GDBWIRE_MI_STOP_REASON_FORK,
+    /** vfork */
+    GDBWIRE_MI_STOP_REASON_VFORK,
+    /** syscall-entry */
+    GDBWIRE_MI_STOP_REASON_SYSCALL_ENTRY,
+    /** syscall-return */
+    GDBWIRE_MI_STOP_REASON_SYSCALL_RETURN,
+    /** exec */
+    GDBWIRE_MI_STOP_REASON_EXEC,
+    /** no-history */
+    GDBWIRE_MI_STOP_REASON_NO_HISTORY,
+    /** A reason gdbwire does not know about, see reason_text. */
+    GDBWIRE_MI_STOP_REASON_UNSUPPORTED
+};
+
+/**
+ * A decoded *stopped asynchronous record.
+ *
+ * The strings in this structure point into the parse tree of the
+ * asynchronous record it was decoded from. They are only valid as long
+ * as the asynchronous record is.
+ */
+struct gdbwire_mi_async_stopped {
+    /** The reason the target stopped. */
+    enum gdbwire_mi_stop_reason reason;
+
+    /**
+     * The reason as GDB output it, ie. "breakpoint-hit".
+     *
+     * NULL if GDB did not give a reason.
+     */
+    const char *reason_text;
+
+    /** The thread-id field, or 0 if it is not present. */
+    int thread_id;
+
+    /** True if the stopped-threads field is "all", otherwise false. */
+    unsigned char all_threads_stopped:1;
+
+    /** True if the frame field is valid, otherwise false. */
+    unsigned char has_frame:1;
+
+    /**
+     * The stopped-threads list, ie. stopped-threads=["1","2"].
+     *
+     * The elements are GDBWIRE_MI_CSTRING results holding the thread ids.
+     * NULL if the field is not present or if it is "all".
+     */
+    struct gdbwire_mi_result *stopped_threads;
+
+    /** The core field, or -1 if it is not present. */
+    int core;
+
+    /**
+     * The breakpoint number, ie. bkptno="1".
+     *
+     * Zero if the reason is not GDBWIRE_MI_STOP_REASON_BREAKPOINT_HIT.
+     */
+    int breakpoint_number;
+
+    /**
+     * The signal-name field, ie. "SIGSEGV".
+     *
+     * Present for GDBWIRE_MI_STOP_REASON_SIGNAL_RECEIVED and
+     * GDBWIRE_MI_STOP_REASON_EXITED_SIGNALLED, otherwise NULL.
+     */
+    const char *signal_name;
+
+    /**
+     * The exit code of the inferior.
+     *
+     * Only valid for GDBWIRE_MI_STOP_REASON_EXITED, otherwise 0.
+     * GDB outputs this field in octal, it is converted here.
+     */
+    int exit_code;
+
+    /**
+     * The frame the target stopped in.
+     *
+     * Only valid if has_frame is true. The level field is always 0.
+     */
+    struct gdbwire_mi_stack_frame frame;
+};
+
+/**
+ * A GDB variable object.
+ *
+ * Variable objects are created with -var-create and their children are
+ * listed with -var-list-children.
+ */
+struct gdbwire_mi_varobj {
+    /** The name of the variable object, ie. "var1" or "var1.count". */
+    char *name;
+
+    /**
+     * The expression the child represents, ie. "count".
+     *
+     * Only present in the -var-list-children output, otherwise NULL.
+     */
+    char *exp;
+
+    /**
+     * The number of children of the variable object.
+     *
+     * For a dynamic variable object, this is the number of children
+     * the front end has listed so far, not the total.
+     */
+    int numchild;
+
+    /** The value of the variable object or NULL if GDB did not output it. */
+    char *value;
+
+    /** The type of the variable object. May be NULL if unknown. */
+    char *type;
+
+    /** The thread the variable object is bound to, or 0 if it is not. */
+    int thread_id;
+
+    /** The display hint of a dynamic variable object, ie. "map", or NULL. */
+    char *displayhint;
+
+    /** True if the variable object is dynamic, otherwise false. */
+    unsigned char dynamic:1;
+
+    /** True if a dynamic variable object has more children to list. */
+    unsigned char has_more:1;
+
+    /** The next variable object or NULL if none. */
+    struct gdbwire_mi_varobj *next;
+};
+
+/** The in_scope field of a -var-update change. */
+enum gdbwire_mi_varobj_scope {
+    /** in_scope="true", the variable object is in scope. */
+    GDBWIRE_MI_VAROBJ_IN_SCOPE,
+    /** in_scope="false", the variable object is not in scope. */
+    GDBWIRE_MI_VAROBJ_OUT_OF_SCOPE,
+    /**
+     * in_scope="invalid", the variable object no longer holds a valid
+     * value, ie. the file was recompiled. It should be deleted.
+     */
+    GDBWIRE_MI_VAROBJ_INVALID
+};
+
+/** A change to a variable object, from the -var-update changelist. */
+struct gdbwire_mi_varobj_change {
+    /** The name of the variable object that changed. */
+    char *name;
+
+    /**
+     * The new value of the variable object.
+     *
+     * NULL if GDB did not output it, ie. with --no-values or when
+     * the variable object is not in scope.
+     */
+    char *value;
+
+    /** If the variable object is in scope. */
+    enum gdbwire_mi_varobj_scope in_scope;
+
+    /**
+     * True if the type of the variable object changed.
+     *
+     * GDB deletes the children of the variable object when this happens.
+     */
+    unsigned char type_changed:1;
+
+    /** True if a dynamic variable object has more children to list. */
+    unsigned char has_more:1;
+
+    /** The new type when type_changed is true, otherwise NULL. */
+    char *new_type;
+
+    /** The new number of children or -1 if GDB did not output it. */
+    int new_num_children;
+
+    /** The new children of a dynamic variable object or NULL if none. */
+    struct gdbwire_mi_varobj *new_children;
+
+    /** The next change or NULL if none. */
+    struct gdbwire_mi_varobj_change *next;
+};
+
+/** A block of target memory, from -data-read-memory-bytes. */
+struct gdbwire_mi_memory_block {
+    /** The start address of the memory block. */
+    uint64_t begin;
+
+    /**
+     * The offset of the memory block, relative to the start address
+     * passed to -data-read-memory-bytes.
+     */
+    uint64_t offset;
+
+    /** The end address of the memory block. */
+    uint64_t end;
+
+    /**
+     * The contents of the memory block, as bytes rather than the
+     * hexadecimal digits GDB outputs.
+     */
+    unsigned char *contents;
+
+    /** The number of bytes in contents. */
+    size_t contents_size;
+
+    /** The next memory block or NULL if none. */
+    struct gdbwire_mi_memory_block *next;
+};
+
+/** A register value, from -data-list-register-values. */
+struct gdbwire_mi_register_value {
+    /** The register number. */
+    int number;
+
+    /**
+     * The value of the register, in the format requested.
+     *
+     * Vector registers have values like "{v4_float = {0x0, ...}, ...}".
+     */
+    char *value;
+};
+
+/** A machine instruction, from -data-disassemble. */
+struct gdbwire_mi_instruction {
+    /** The address of the instruction. */
+    uint64_t address;
+
+    /**
+     * The offset of the instruction from the start of the function,
+     * or -1 if GDB does not know which function the instruction is in.
+     */
+    int offset;
+
+    /** The function the instruction is in or NULL if unknown. */
+    char *func_name;
+
+    /** The instruction, ie. "mov    %rsp,%rbp". */
+    char *inst;
+
+    /**
+     * The raw bytes of the instruction, ie. "48 89 e5", or NULL unless
+     * the raw opcodes were asked for with /r or mode 2, 3 or 5.
+     */
+    char *opcodes;
+};
+
+/**
+ * A source line, from -data-disassemble in source mode.
+ *
+ * In source mode GDB groups the instructions by the source line they
+ * were generated from, ie. src_and_asm_line={line="5",file="main.c",
+ * line_asm_insn=[...]}.
+ */
+struct gdbwire_mi_source_line {
+    /** The line number. */
+    int line;
+
+    /** The file the line is in. */
+    char *file;
+
+    /** The absolute path to the file or NULL if GDB did not output it. */
+    char *fullname;
+
+    /** The index of the first instruction of the line. */
+    size_t first;
+
+    /** The number of instructions of the line, possibly 0. */
+    size_t count;
+};
+
+/** The state of a thread, from -thread-info. */
+enum gdbwire_mi_thread_state {
+    /** stopped */
+    GDBWIRE_MI_THREAD_STATE_STOPPED,
+    /** running */
+    GDBWIRE_MI_THREAD_STATE_RUNNING,
+    /** A state gdbwire does not know about. */
+    GDBWIRE_MI_THREAD_STATE_UNSUPPORTED
+};
+
+/** A thread, from -thread-info. */
+struct gdbwire_mi_thread {
+    /** The global thread id. */
+    int id;
+
+    /** The target's thread id, ie. "Thread 0x7ffff7fc1740 (LWP 1234)". */
+    char *target_id;
+
+    /** The name of the thread or NULL if it does not have one. */
+    char *name;
+
+    /** Extra information about the thread or NULL if there is none. */
+    char *details;
+
+    /** If the thread is stopped or running. */
+    enum gdbwire_mi_thread_state state;
+
+    /** The processor core the thread was last seen on, or -1 if unknown. */
+    int core;
+
+    /** True if the thread is stopped and frame is valid. */
+    unsigned char has_frame:1;
+
+    /** The frame the thread is stopped at, if has_frame is true. */
+    struct gdbwire_mi_stack_frame frame;
+};
+
+/**
+ * A symbol, from the -symbol-info-functions, -symbol-info-variables
+ * and -symbol-info-types commands.
+ */
+struct gdbwire_mi_symbol {
+    /** The line the symbol is defined on or 0 for a non-debug symbol. */
+    int line;
+
+    /** The name of the symbol. */
+    char *name;
+
+    /** The type of the symbol or NULL for types and non-debug symbols. */
+    char *type;
+
+    /**
+     * The declaration of the symbol, ie. "void f(int);", or NULL for
+     * types and non-debug symbols.
+     */
+    char *description;
+
+    /** The address of a non-debug symbol or 0 for a debug symbol. */
+    uint64_t address;
+};
+
+/** The debug symbols of a symbol file, from the -symbol-info-* commands. */
+struct gdbwire_mi_symbol_file {
+    /** The file name, as recorded in the debug information. */
+    char *filename;
+
+    /** The absolute path to the file or NULL if GDB did not output it. */
+    char *fullname;
+
+    /** The symbols defined in the file. NULL if there are none. */
+    struct gdbwire_mi_symbol *symbols;
+
+    /** The number of symbols in the symbols array. */
+    size_t symbols_size;
+};
+
+/** A line table entry, from -symbol-list-lines. */
+struct gdbwire_mi_line {
+    /** The address of the first instruction generated for the line. */
+    uint64_t pc;
+
+    /** The line number. */
+    int line;
+};
+
+/**
+ * The line table of a source file, from -symbol-list-lines.
+ *
+ * The entries are kept sorted both ways, so that an address can be
+ * mapped to a line, ie. to show where the target stopped, and a line can
+ * be mapped to addresses, ie. to set a breakpoint at the cursor, with a
+ * binary search. A line can have several addresses, ie. a for loop, and
+ * an address can be listed for several lines.
+ */
+struct gdbwire_mi_line_table {
+    /** The entries sorted by address, and then by line. */
+    struct gdbwire_mi_line *by_address;
+
+    /** The same entries sorted by line, and then by address. */
+    struct gdbwire_mi_line *by_line;
+
+    /** The number of entries in each array. */
+    size_t size;
+};
+
 /**
  * Represents a GDB/MI command.
  */
@@ -354,6 +806,246 @@ struct gdbwire_mi_command {
              */
             struct gdbwire_mi_source_file *files;
         } file_list_exec_source_files;
+
+        /** When kind == GDBWIRE_MI_STACK_LIST_FRAMES */
+        struct {
+            /**
+             * The frames, in the order GDB output them.
+             *
+             * The frames are in one array, rather than a list, since a
+             * deep recursion can easily produce hundreds of thousands
+             * of them.
+             *
+             * When -stack-list-frames is given a low-frame and high-frame,
+             * GDB only outputs the frames in that window. The level of
+             * each frame is still it's level in the whole stack, so
+             * frames[0].level is the low-frame and the frame at level L
+             * is at frames[L - frames[0].level].
+             */
+            struct gdbwire_mi_stack_frame *frames;
+
+            /** The number of frames in the frames array. */
+            size_t frames_size;
+
+            /**
+             * The strings the frames point to.
+             *
+             * The address, func, file, fullname and from fields of the
+             * frames are interned in this pool. Equal strings are shared,
+             * so each function of a recursion is only stored once.
+             * These strings must not be modified.
+             */
+            struct gdbwire_intern *strings;
+        } stack_list_frames;
+
+        /** When kind == GDBWIRE_MI_VAR_CREATE */
+        struct {
+            /** The variable object that was created, never NULL. */
+            struct gdbwire_mi_varobj *varobj;
+        } var_create;
+
+        /** When kind == GDBWIRE_MI_VAR_LIST_CHILDREN */
+        struct {
+            /** The number of children listed. */
+            int numchild;
+
+            /** The children, NULL if there are none. */
+            struct gdbwire_mi_varobj *children;
+
+            /** True if a dynamic variable object has more children. */
+            unsigned char has_more:1;
+        } var_list_children;
+
+        /** When kind == GDBWIRE_MI_VAR_UPDATE */
+        struct {
+            /**
+             * The changelist, NULL if no variable object changed.
+             *
+             * Only the variable objects that changed are in the list.
+             */
+            struct gdbwire_mi_varobj_change *changes;
+        } var_update;
+
+        /** When kind == GDBWIRE_MI_DATA_READ_MEMORY_BYTES */
+        struct {
+            /**
+             * The memory blocks that could be read.
+             *
+             * GDB splits the requested region into several blocks when
+             * parts of it can not be read. NULL if there are none.
+             */
+            struct gdbwire_mi_memory_block *blocks;
+        } data_read_memory_bytes;
+
+        /** When kind == GDBWIRE_MI_DATA_LIST_REGISTER_NAMES */
+        struct {
+            /**
+             * The register names, indexed by register number.
+             *
+             * GDB outputs an empty name for register numbers that are
+             * not used, those are NULL. NULL if there are no registers.
+             */
+            char **names;
+
+            /** The number of names in the names array. */
+            size_t names_size;
+        } data_list_register_names;
+
+        /** When kind == GDBWIRE_MI_DATA_LIST_REGISTER_VALUES */
+        struct {
+            /**
+             * The register values, in the order GDB output them.
+             *
+             * NULL if there are no register values.
+             */
+            struct gdbwire_mi_register_value *values;
+
+            /** The number of values in the values array. */
+            size_t values_size;
+        } data_list_register_values;
+
+        /** When kind == GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS */
+        struct {
+            /**
+             * The numbers of the registers that changed since the last
+             * -data-list-changed-registers. NULL if none changed.
+             */
+            int *numbers;
+
+            /** The number of register numbers in the numbers array. */
+            size_t numbers_size;
+        } data_list_changed_registers;
+
+        /** When kind == GDBWIRE_MI_DATA_DISASSEMBLE */
+        struct {
+            /**
+             * The instructions, in the order GDB output them.
+             *
+             * The instructions are in one array, rather than a list,
+             * since disassembling a large function produces thousands
+             * of them. NULL if there are no instructions.
+             *
+             * GDB outputs the instructions in address order, except for
+             * the deprecated source mode 1 (/m), which outputs them in
+             * source line order.
+             */
+            struct gdbwire_mi_instruction *instructions;
+
+            /** The number of instructions in the instructions array. */
+            size_t instructions_size;
+
+            /**
+             * The source lines, when disassembling in source mode.
+             *
+             * Each source line refers to it's instructions by their
+             * index in the instructions array. NULL when not disassembling
+             * in source mode.
+             */
+            struct gdbwire_mi_source_line *source_lines;
+
+            /** The number of source lines in the source_lines array. */
+            size_t source_lines_size;
+
+            /**
+             * The strings the instructions and source lines point to.
+             *
+             * The func_name, inst and opcodes fields of the instructions
+             * and the file and fullname fields of the source lines are
+             * interned in this pool. A function name is stored once,
+             * rather than once for each of it's instructions.
+             * These strings must not be modified.
+             */
+            struct gdbwire_intern *strings;
+        } data_disassemble;
+
+        /** When kind == GDBWIRE_MI_THREAD_INFO */
+        struct {
+            /**
+             * The threads, in the order GDB output them.
+             *
+             * The threads are in one array, rather than a list, since
+             * a server can easily have tens of thousands of them.
+             * Use gdbwire_mi_thread_info_find to look a thread up by id.
+             * NULL if there are no threads.
+             */
+            struct gdbwire_mi_thread *threads;
+
+            /** The number of threads in the threads array. */
+            size_t threads_size;
+
+            /** The id of the current thread or -1 if there is none. */
+            int current_thread_id;
+
+            /**
+             * The thread index, used by gdbwire_mi_thread_info_find.
+             *
+             * An open addressing hash table of thread ids. Each slot holds
+             * an index into the threads array plus one, or 0 if empty.
+             */
+            size_t *slots;
+
+            /** The number of slots, always a power of two. */
+            size_t slots_size;
+
+            /**
+             * The strings the threads point to.
+             *
+             * The target_id, name and details fields of the threads and
+             * the strings of their frames are interned in this pool.
+             * These strings must not be modified.
+             */
+            struct gdbwire_intern *strings;
+        } thread_info;
+
+        /**
+         * When kind == GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS,
+         * GDBWIRE_MI_SYMBOL_INFO_VARIABLES or GDBWIRE_MI_SYMBOL_INFO_TYPES
+         *
+         * For large programs, consider gdbwire_stream_symbols instead,
+         * which does not need the whole output in memory at once.
+         */
+        struct {
+            /** The symbol files with debug symbols, NULL if none. */
+            struct gdbwire_mi_symbol_file *files;
+
+            /** The number of files in the files array. */
+            size_t files_size;
+
+            /**
+             * All of the debug symbols. The symbols of each file point
+             * into this array. NULL if there are none.
+             */
+            struct gdbwire_mi_symbol *symbols;
+
+            /** The number of symbols in the symbols array. */
+            size_t symbols_size;
+
+            /**
+             * The non-debug symbols, only output when GDB is asked to
+             * include them. NULL if there are none.
+             */
+            struct gdbwire_mi_symbol *nondebug;
+
+            /** The number of symbols in the nondebug array. */
+            size_t nondebug_size;
+
+            /**
+             * The strings the files and symbols point to.
+             * These strings must not be modified.
+             */
+            struct gdbwire_intern *strings;
+        } symbol_info;
+
+        /** When kind == GDBWIRE_MI_SYMBOL_LIST_LINES */
+        struct {
+            /**
+             * The line table, never NULL.
+             *
+             * Free it with gdbwire_mi_line_table_free if it is taken
+             * from the command.
+             */
+            struct gdbwire_mi_line_table *table;
+        } symbol_list_lines;
         
     } variant;
 };
@@ -380,6 +1072,361 @@ enum gdbwire_result gdbwire_get_mi_command(
         struct gdbwire_mi_result_record *result_record,
         struct gdbwire_mi_command **out_mi_command);
 
+/**
+ * Get a gdbwire MI source file from a source file tuple.
+ *
+ * The -file-list-exec-source-files command outputs a list of source file
+ * tuples, ie. files=[{file="...",fullname="..."},...]. This function
+ * converts one such tuple into a source file, with out allocating any
+ * memory. The strings in out_file point into the parse tree and are
+ * only valid as long as mi_result is. The next field is always NULL.
+ *
+ * @param mi_result
+ * The source file tuple.
+ *
+ * @param out_file
+ * The source file to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_source_file(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_source_file *out_file);
+
+/**
+ * Get a gdbwire MI breakpoint from a breakpoint tuple.
+ *
+ * Breakpoint tuples, ie. bkpt={...}, show up in the output of the
+ * -break-info and -break-insert commands and in the =breakpoint-created
+ * and =breakpoint-modified asynchronous records. This function converts
+ * such a tuple into a breakpoint.
+ *
+ * The locations of a multiple location breakpoint are attached to it,
+ * both when GDB puts them in the locations field (mi3) and when it puts
+ * them in the unnamed tuples following the breakpoint tuple (mi2).
+ *
+ * @param mi_result
+ * The breakpoint tuple.
+ *
+ * @param out_breakpoint
+ * Will return an allocated breakpoint if GDBWIRE_OK is returned
+ * from this function. You should free this memory with
+ * gdbwire_mi_breakpoint_free when you are done with it.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_breakpoint(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_breakpoint **out_breakpoint);
+
+/**
+ * Free a gdbwire mi breakpoint and it's locations.
+ *
+ * The breakpoints following it in the next list are not freed.
+ *
+ * @param breakpoint
+ * The breakpoint to free, OK to pass in NULL.
+ */
+void gdbwire_mi_breakpoint_free(struct gdbwire_mi_breakpoint *breakpoint);
+
+/**
+ * Get a gdbwire MI stack frame from a frame tuple.
+ *
+ * Frame tuples, ie. frame={...}, show up in several places in the
+ * GDB/MI output. For example, in the *stopped and =thread-selected
+ * asynchronous records. This function converts the contents of
+ * such a tuple into a stack frame.
+ *
+ * The level field is optional, it is 0 when it is not in the tuple.
+ *
+ * @param mi_result
+ * The contents of the frame tuple.
+ *
+ * @param out_frame
+ * Will return an allocated stack frame if GDBWIRE_OK is returned
+ * from this function. You should free this memory with
+ * gdbwire_mi_stack_frame_free when you are done with it.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_stack_frame(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_stack_frame **out_frame);
+
+/**
+ * Free a gdbwire mi stack frame.
+ *
+ * @param frame
+ * The frame to free, OK to pass in NULL.
+ */
+void gdbwire_mi_stack_frame_free(struct gdbwire_mi_stack_frame *frame);
+
+/**
+ * Get a gdbwire MI memory block from a memory tuple.
+ *
+ * The -data-read-memory-bytes command outputs a list of memory tuples,
+ * ie. memory=[{begin="0x...",offset="0x...",end="0x...",contents="..."}].
+ * This function converts one such tuple into a memory block, decoding
+ * the contents into a buffer provided by the caller rather than
+ * allocating one. The next field is always NULL.
+ *
+ * @param mi_result
+ * The contents of the memory tuple.
+ *
+ * @param buffer
+ * The buffer to decode the contents into. The contents field of
+ * out_block points to this buffer on success.
+ *
+ * @param buffer_size
+ * The size of buffer. It must be at least end - begin bytes,
+ * otherwise GDBWIRE_LOGIC is returned.
+ *
+ * @param out_block
+ * The memory block to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_memory_block(
+        struct gdbwire_mi_result *mi_result,
+        unsigned char *buffer, size_t buffer_size,
+        struct gdbwire_mi_memory_block *out_block);
+
+/**
+ * Get a gdbwire MI instruction from an instruction tuple.
+ *
+ * The -data-disassemble command outputs a tuple for each instruction,
+ * ie. {address="0x...",func-name="main",offset="4",inst="..."}.
+ * This function converts one such tuple into an instruction, with out
+ * allocating any memory. The strings in out_instruction point into the
+ * parse tree and are only valid as long as mi_result is.
+ *
+ * @param mi_result
+ * The instruction tuple.
+ *
+ * @param out_instruction
+ * The instruction to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_instruction(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_instruction *out_instruction);
+
+/**
+ * Get a gdbwire MI symbol from a symbol tuple.
+ *
+ * The -symbol-info-* commands output a tuple for each symbol,
+ * ie. {line="36",name="f4",type="void (int *)",description="..."} for
+ * debug symbols and {address="0x...",name="_init"} for non-debug symbols.
+ * This function converts one such tuple into a symbol, with out
+ * allocating any memory. The strings in out_symbol point into the
+ * parse tree and are only valid as long as mi_result is.
+ *
+ * @param mi_result
+ * The symbol tuple.
+ *
+ * @param out_symbol
+ * The symbol to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_symbol(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol *out_symbol);
+
+/**
+ * Get a gdbwire MI symbol file from a symbol file tuple.
+ *
+ * The -symbol-info-* commands output a tuple for each symbol file,
+ * ie. {filename="f.c",fullname="/src/f.c",symbols=[...]}.
+ * The strings in out_file point into the parse tree and are only valid
+ * as long as mi_result is. The symbols array is allocated, free it with
+ * gdbwire_mi_symbol_file_free_symbols when done with it.
+ *
+ * @param mi_result
+ * The symbol file tuple.
+ *
+ * @param out_file
+ * The symbol file to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_symbol_file(
+        struct gdbwire_mi_result *mi_result,
+        struct gdbwire_mi_symbol_file *out_file);
+
+/**
+ * Free the symbols array filled in by gdbwire_get_mi_symbol_file.
+ *
+ * @param file
+ * The symbol file whose symbols array to free, OK to pass in NULL.
+ */
+void gdbwire_mi_symbol_file_free_symbols(
+        struct gdbwire_mi_symbol_file *file);
+
+/**
+ * Find the line an address belongs to.
+ *
+ * @param table
+ * The line table to search.
+ *
+ * @param pc
+ * The address to search for.
+ *
+ * @return
+ * The entry with the highest address that is less than or equal to pc,
+ * or NULL if pc is before the first entry. When several lines start at
+ * that address, the entry with the highest line is returned.
+ */
+const struct gdbwire_mi_line *gdbwire_mi_line_table_find_address(
+        const struct gdbwire_mi_line_table *table, uint64_t pc);
+
+/**
+ * Find the addresses of a line.
+ *
+ * Not every line has code, so this finds the first line at or after
+ * the line asked for that does, ie. where a breakpoint would go.
+ *
+ * @param table
+ * The line table to search.
+ *
+ * @param line
+ * The line to search for.
+ *
+ * @param count
+ * The number of entries for the line that was found on the way out,
+ * they are in the by_line array starting at the returned entry.
+ * 0 if no entry was found.
+ *
+ * @return
+ * The first entry, by address, of the first line at or after line,
+ * or NULL if there is no such line.
+ */
+const struct gdbwire_mi_line *gdbwire_mi_line_table_find_line(
+        const struct gdbwire_mi_line_table *table, int line, size_t *count);
+
+/**
+ * Free a gdbwire mi line table.
+ *
+ * @param table
+ * The line table to free, OK to pass in NULL.
+ */
+void gdbwire_mi_line_table_free(struct gdbwire_mi_line_table *table);
+
+/**
+ * Find a thread in a -thread-info command by it's id.
+ *
+ * This takes constant time, no matter how many threads there are.
+ *
+ * @param mi_command
+ * The decoded -thread-info command, of kind GDBWIRE_MI_THREAD_INFO.
+ *
+ * @param id
+ * The global thread id to search for.
+ *
+ * @return
+ * The thread or NULL if the command has no thread with that id.
+ */
+struct gdbwire_mi_thread *gdbwire_mi_thread_info_find(
+        struct gdbwire_mi_command *mi_command, int id);
+
+/**
+ * Free a gdbwire mi variable object.
+ *
+ * The variable objects following it in the next list are not freed.
+ *
+ * @param varobj
+ * The variable object to free, OK to pass in NULL.
+ */
+void gdbwire_mi_varobj_free(struct gdbwire_mi_varobj *varobj);
+
+/**
+ * Decode a *stopped asynchronous record.
+ *
+ * This function does not allocate any memory. The strings in
+ * out_stopped point into the parse tree of async_record.
+ *
+ * @param async_record
+ * The asynchronous record, it's async_class must be
+ * GDBWIRE_MI_ASYNC_STOPPED.
+ *
+ * @param out_stopped
+ * The decoded *stopped record to fill in.
+ *
+ * @return
+ * The result of this function.
+ */
+enum gdbwire_result gdbwire_get_mi_async_stopped(
+        struct gdbwire_mi_async_record *async_record,
+        struct gdbwire_mi_async_stopped *out_stopped);
+
+/**
+ * Get the value of a cstring field of an asynchronous record.
+ *
+ * @param mi_result
+ * The results of the asynchronous record, ie. async_record->result.
+ *
+ * @param variable
+ * The name of the field, ie. "thread-id".
+ *
+ * @return
+ * The value of the field, pointing into the parse tree, or NULL if the
+ * field is not present or is not a cstring.
+ */
+char *gdbwire_get_mi_cstring(struct gdbwire_mi_result *mi_result,
+        const char *variable);
+
+/** A decoded =memory-changed asynchronous record. */
+struct gdbwire_mi_memory_changed {
+    /** The address of the first byte that changed, the addr field. */
+    uint64_t address;
+
+    /** The number of bytes that changed, the len field. */
+    uint64_t size;
+};
+
+/**
+ * Decode a =memory-changed asynchronous record.
+ *
+ * ie. =memory-changed,thread-group="i1",addr="0x601040",len="0x4"
+ *
+ * @param async_record
+ * The asynchronous record, it's async_class must be
+ * GDBWIRE_MI_ASYNC_MEMORY_CHANGED.
+ *
+ * @param out_changed
+ * The decoded range of memory that changed.
+ *
+ * @return
+ * GDBWIRE_OK on success, GDBWIRE_ASSERT if the addr or len field is
+ * missing or is not a hexadecimal number.
+ */
+enum gdbwire_result gdbwire_get_mi_memory_changed(
+        struct gdbwire_mi_async_record *async_record,
+        struct gdbwire_mi_memory_changed *out_changed);
+
+/**
+ * Get the end of a range of memory.
+ *
+ * @param address
+ * The address of the first byte of the range.
+ *
+ * @param size
+ * The number of bytes in the range.
+ *
+ * @return
+ * The address after the last byte of the range. Memory that wraps
+ * around the address space goes up to the end, UINT64_MAX.
+ */
+uint64_t gdbwire_mi_memory_end(uint64_t address, uint64_t size);
+
 /**
  * Free the gdbwire mi command.
  *
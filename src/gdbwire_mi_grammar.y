@@ -10,10 +10,83 @@
 typedef void *yyscan_t;
 #endif
 
+#include <stdint.h>
+
     struct gdbwire_mi_output;
+    struct gdbwire_mi_result;
+
+    /**
+     * The state the grammar actions share with the GDB/MI parser.
+     *
+     * The parser resets this state before each line it parses.
+     */
+    struct gdbwire_mi_grammar_state {
+        /** The number of tuples and lists currently open. */
+        int depth;
+
+        /** The context pointer passed to list_element_fn. */
+        void *context;
+
+        /**
+         * Called with each list element as soon as it is parsed, or NULL.
+         *
+         * See gdbwire_mi_parser_set_list_element_fn for details.
+         */
+        int (*list_element_fn)(void *context, const char *variable,
+            int depth, struct gdbwire_mi_result *element);
+
+        /** The number of list elements list_element_fn took this line. */
+        uint64_t elements_taken;
+
+        /**
+         * Non zero while list_element_fn is running.
+         *
+         * The parser is in the middle of a grammar action then, so it
+         * can not be pushed more data until list_element_fn returns.
+         */
+        int in_list_element;
+
+        /** The number of allocations the grammar actions made. */
+        uint64_t allocations;
+
+        /** The number of bytes requested by those allocations. */
+        uint64_t bytes_allocated;
+    };
+}
+%code provides {
+    /* Remove the GDB/MI escaping from a c-string, ie. the CSTRING token */
+    char *gdbwire_mi_unescape_cstring(char *str);
+
+/* The flex lexer functions, declared by the lexer itself in it's unit */
+#ifndef FLEX_SCANNER
+
+#ifndef YY_TYPEDEF_YY_BUFFER_STATE
+#define YY_TYPEDEF_YY_BUFFER_STATE
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+#endif
+
+    /* Lexer set/destroy buffer to parse */
+    YY_BUFFER_STATE gdbwire_mi__scan_string(const char *yy_str,
+        yyscan_t yyscanner);
+    YY_BUFFER_STATE gdbwire_mi__scan_bytes(const char *yy_bytes, int yy_len,
+        yyscan_t yyscanner);
+    void gdbwire_mi__delete_buffer(YY_BUFFER_STATE state,
+        yyscan_t yyscanner);
+
+    /* Lexer get token function */
+    int gdbwire_mi_lex(yyscan_t yyscanner);
+    char *gdbwire_mi_get_text(yyscan_t yyscanner);
+    void gdbwire_mi_set_column(int column_no, yyscan_t yyscanner);
+
+    /* Lexer state create/destroy functions */
+    int gdbwire_mi_lex_init(yyscan_t *scanner);
+    int gdbwire_mi_lex_destroy(yyscan_t scanner);
+
+#endif
 }
 %parse-param {yyscan_t yyscanner}
 %parse-param {struct gdbwire_mi_output **gdbwire_mi_output}
+%parse-param {struct gdbwire_mi_grammar_state *state}
 
 %{
 #include <string.h>
@@ -27,6 +100,15 @@ typedef void *yyscan_t;
 char *gdbwire_mi_get_text(yyscan_t yyscanner);
 struct gdbwire_mi_position gdbwire_mi_get_extra(yyscan_t yyscanner);
 
+/**
+ * Count an allocation of size bytes in the grammar state.
+ *
+ * Every rule that allocates memory uses this, so that the parser can
+ * report how much memory the parse trees cost.
+ */
+#define GDBWIRE_MI_COUNT_ALLOC(size) \
+    (state->allocations++, state->bytes_allocated += (size))
+
 /**
  * Used only in the parser to build a gdbwire_mi_result list.
  *
@@ -74,8 +156,46 @@ void gdbwire_mi_result_list_push_back(struct gdbwire_mi_result_list *list,
     list->tail = &result->next;
 }
 
+/**
+ * Offer a list element to the list element function.
+ *
+ * @param state
+ * The grammar state.
+ *
+ * @param variable
+ * The variable name of the list the element belongs to, or NULL.
+ *
+ * @param element
+ * The list element.
+ *
+ * @return
+ * Non zero if the list element function took the element.
+ */
+static int
+gdbwire_mi_offer_list_element(struct gdbwire_mi_grammar_state *state,
+        const char *variable, struct gdbwire_mi_result *element)
+{
+    int taken;
+
+    if (!state->list_element_fn) {
+        return 0;
+    }
+
+    state->in_list_element = 1;
+    taken = state->list_element_fn(state->context, variable, state->depth,
+        element);
+    state->in_list_element = 0;
+
+    if (taken) {
+        state->elements_taken++;
+    }
+
+    return taken;
+}
+
 void gdbwire_mi_error(yyscan_t yyscanner,
-    struct gdbwire_mi_output **gdbwire_mi_output, const char *s)
+    struct gdbwire_mi_output **gdbwire_mi_output,
+    struct gdbwire_mi_grammar_state *state, const char *s)
 { 
     char *text = gdbwire_mi_get_text(yyscanner);
     struct gdbwire_mi_position pos = gdbwire_mi_get_extra(yyscanner);
@@ -83,6 +203,8 @@ void gdbwire_mi_error(yyscan_t yyscanner,
     *gdbwire_mi_output = gdbwire_mi_output_alloc();
     (*gdbwire_mi_output)->kind = GDBWIRE_MI_OUTPUT_PARSE_ERROR;
     (*gdbwire_mi_output)->variant.error.token = gdbwire_strdup(text);
+    GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_output));
+    GDBWIRE_MI_COUNT_ALLOC(strlen(text) + 1);
     (*gdbwire_mi_output)->variant.error.pos = pos;
 }
 
@@ -109,7 +231,7 @@ void gdbwire_mi_error(yyscan_t yyscanner,
  * @return
  * An allocated strng representing str with the escaping undone.
  */
-static char *gdbwire_mi_unescape_cstring(char *str)
+char *gdbwire_mi_unescape_cstring(char *str)
 {
     char *result;
     size_t r, s, length;
@@ -223,7 +345,7 @@ static char *gdbwire_mi_unescape_cstring(char *str)
 %type <u_result_class> result_class
 %type <u_async_record_kind> async_record_class
 %type <u_variable> opt_variable variable
-%type <u_result_list> result_list
+%type <u_result_list> result_list list_elements
 %type <u_result> result
 %type <u_token> opt_token token
 %type <u_async_record> async_record
@@ -232,6 +354,7 @@ static char *gdbwire_mi_unescape_cstring(char *str)
 %type <u_cstring> cstring
 %type <u_tuple> tuple
 %type <u_list> list
+%type <u_variable> list_open
 %type <u_stream_record_kind> stream_record_class
 
 /** 
@@ -253,6 +376,7 @@ static char *gdbwire_mi_unescape_cstring(char *str)
  */
 %destructor { gdbwire_mi_output_free($$); } output_variant
 %destructor { gdbwire_mi_result_free($$->head); free($$); } result_list
+%destructor { gdbwire_mi_result_free($$->head); free($$); } list_elements
 %destructor { gdbwire_mi_result_free($$); } result
 %destructor { free($$); } opt_variable
 %destructor { free($$); } variable
@@ -277,12 +401,14 @@ output: error NEWLINE {
 
 output_variant: oob_record {
   $$ = gdbwire_mi_output_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_output));
   $$->kind = GDBWIRE_MI_OUTPUT_OOB;
   $$->variant.oob_record = $1;
 }
 
 output_variant: result_record {
   $$ = gdbwire_mi_output_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_output));
   $$->kind = GDBWIRE_MI_OUTPUT_RESULT;
   $$->variant.result_record = $1;
 }
@@ -290,17 +416,19 @@ output_variant: result_record {
 output_variant: OPEN_PAREN variable {
       if (strcmp("gdb", $2) != 0) {
           /* Destructor will be called to free $2 on error */
-          yyerror(yyscanner, gdbwire_mi_output, "");
+          yyerror(yyscanner, gdbwire_mi_output, state, "");
           YYERROR;
       }
     } CLOSED_PAREN {
       $$ = gdbwire_mi_output_alloc();
+      GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_output));
       $$->kind = GDBWIRE_MI_OUTPUT_PROMPT;
       free($2);
     }
 
 result_record: opt_token CARROT result_class {
   $$ = gdbwire_mi_result_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result_record));
   $$->token = $1;
   $$->result_class = $3;
   $$->result = NULL;
@@ -308,6 +436,7 @@ result_record: opt_token CARROT result_class {
 
 result_record: opt_token CARROT result_class COMMA result_list {
   $$ = gdbwire_mi_result_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result_record));
   $$->token = $1;
   $$->result_class = $3;
   $$->result = $5->head;
@@ -316,18 +445,21 @@ result_record: opt_token CARROT result_class COMMA result_list {
 
 oob_record: async_record {
   $$ = gdbwire_mi_oob_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_oob_record));
   $$->kind = GDBWIRE_MI_ASYNC;
   $$->variant.async_record = $1;
 };
 
 oob_record: stream_record {
   $$ = gdbwire_mi_oob_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_oob_record));
   $$->kind = GDBWIRE_MI_STREAM;
   $$->variant.stream_record = $1;
 };
 
 async_record: opt_token async_record_class async_class {
   $$ = gdbwire_mi_async_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_async_record));
   $$->token = $1;
   $$->kind = $2;
   $$->async_class = $3;
@@ -336,6 +468,7 @@ async_record: opt_token async_record_class async_class {
 
 async_record: opt_token async_record_class async_class COMMA result_list {
   $$ = gdbwire_mi_async_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_async_record));
   $$->token = $1;
   $$->kind = $2;
   $$->async_class = $3;
@@ -435,6 +568,7 @@ opt_variable: variable EQUAL_SIGN {
 
 result_list: result {
   $$ = gdbwire_mi_result_list_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result_list));
   gdbwire_mi_result_list_push_back($$, $1);
 };
 
@@ -445,6 +579,7 @@ result_list: result_list COMMA result {
 
 result: opt_variable cstring {
   $$ = gdbwire_mi_result_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result));
   $$->variable = $1;
   $$->kind = GDBWIRE_MI_CSTRING;
   $$->variant.cstring = $2;
@@ -452,6 +587,7 @@ result: opt_variable cstring {
 
 result: opt_variable tuple {
   $$ = gdbwire_mi_result_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result));
   $$->variable = $1;
   $$->kind = GDBWIRE_MI_TUPLE;
   $$->variant.result = $2;
@@ -459,6 +595,7 @@ result: opt_variable tuple {
 
 result: opt_variable list {
   $$ = gdbwire_mi_result_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result));
   $$->variable = $1;
   $$->kind = GDBWIRE_MI_LIST;
   $$->variant.result = $2;
@@ -467,33 +604,75 @@ result: opt_variable list {
 variable: STRING_LITERAL {
   char *text = gdbwire_mi_get_text(yyscanner);
   $$ = gdbwire_strdup(text);
+  GDBWIRE_MI_COUNT_ALLOC(strlen(text) + 1);
 };
 
 cstring: CSTRING {
   char *text = gdbwire_mi_get_text(yyscanner);
   $$ = gdbwire_mi_unescape_cstring(text);
+  GDBWIRE_MI_COUNT_ALLOC(strlen(text) + 1);
 };
 
-tuple: OPEN_BRACE CLOSED_BRACE {
+tuple: tuple_open CLOSED_BRACE {
+  state->depth--;
   $$ = NULL;
 };
 
-tuple: OPEN_BRACE result_list CLOSED_BRACE {
+tuple: tuple_open result_list CLOSED_BRACE {
+  state->depth--;
   $$ = $2->head;
   free($2);
 };
 
-list: OPEN_BRACKET CLOSED_BRACKET {
+tuple_open: OPEN_BRACE {
+  state->depth++;
+};
+
+list: list_open CLOSED_BRACKET {
+  state->depth--;
   $$ = NULL;
 };
 
-list: OPEN_BRACKET result_list CLOSED_BRACKET {
+list: list_open list_elements CLOSED_BRACKET {
+  state->depth--;
   $$ = $2->head;
   free($2);
 };
 
+/**
+ * A list is always preceded by it's opt_variable in the result rule.
+ * Remember the variable name, without taking ownership of it, so that
+ * list_element_fn can be told which list an element belongs to.
+ */
+list_open: OPEN_BRACKET {
+  state->depth++;
+  $$ = $<u_variable>0;
+};
+
+/**
+ * The elements of a list are the same as a result_list, except that
+ * each element is offered to list_element_fn as soon as it is parsed.
+ * If list_element_fn takes ownership of the element, it is not added
+ * to the parse tree. In both rules, $0 is the list_open value.
+ */
+list_elements: result {
+  $$ = gdbwire_mi_result_list_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_result_list));
+  if (!gdbwire_mi_offer_list_element(state, $<u_variable>0, $1)) {
+    gdbwire_mi_result_list_push_back($$, $1);
+  }
+};
+
+list_elements: list_elements COMMA result {
+  if (!gdbwire_mi_offer_list_element(state, $<u_variable>0, $3)) {
+    gdbwire_mi_result_list_push_back($1, $3);
+  }
+  $$ = $1;
+};
+
 stream_record: stream_record_class cstring {
   $$ = gdbwire_mi_stream_record_alloc();
+  GDBWIRE_MI_COUNT_ALLOC(sizeof(struct gdbwire_mi_stream_record));
   $$->kind = $1;
   $$->cstring = $2;
 };
@@ -521,4 +700,5 @@ opt_token: token {
 token: INTEGER_LITERAL {
   char *text = gdbwire_mi_get_text(yyscanner);
   $$ = gdbwire_strdup(text);
+  GDBWIRE_MI_COUNT_ALLOC(strlen(text) + 1);
 };
@@ -1,48 +1,73 @@
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 #include "gdbwire_sys.h"
 #include "gdbwire_assert.h"
+#include "gdbwire_probe.h"
 #include "gdbwire_mi_grammar.h"
 #include "gdbwire_mi_parser.h"
 #include "gdbwire_string.h"
 
-/* flex prototypes used in this unit */
-#ifndef YY_TYPEDEF_YY_SCANNER_T
-#define YY_TYPEDEF_YY_SCANNER_T
-typedef void *yyscan_t;
-#endif
-
-#ifndef YY_TYPEDEF_YY_BUFFER_STATE
-#define YY_TYPEDEF_YY_BUFFER_STATE
-typedef struct yy_buffer_state *YY_BUFFER_STATE;
-#endif
+/**
+ * gdbwire_mi_parser_read_fd reads straight into the end of the buffer,
+ * growing it first to hold the bytes waiting on the file descriptor.
+ * More than GDBWIRE_MI_PARSER_READ_MAX bytes waiting are read over
+ * several calls, so a burst of output does not grow the buffer without
+ * bound.
+ */
+#define GDBWIRE_MI_PARSER_READ_MAX (1024 * 1024)
 
-/* Lexer set/destroy buffer to parse */
-extern YY_BUFFER_STATE gdbwire_mi__scan_string(
-    const char *yy_str, yyscan_t yyscanner);
-extern void gdbwire_mi__delete_buffer(YY_BUFFER_STATE state,
-    yyscan_t yyscanner);
+/**
+ * The room gdbwire_mi_parser_read_fd makes in the buffer when the file
+ * descriptor can not say how many bytes are waiting on it.
+ */
+#define GDBWIRE_MI_PARSER_READ_MIN 4096
 
-/* Lexer get token function */
-extern int gdbwire_mi_lex(yyscan_t yyscanner);
-extern char *gdbwire_mi_get_text(yyscan_t yyscanner);
-extern void gdbwire_mi_set_column(int column_no, yyscan_t yyscanner);
+/**
+ * The capacity the buffer is trimmed back to once the lines in it are
+ * parsed. The buffer grows to hold a large line or a burst of output, and
+ * would otherwise keep that memory for the life of the parser.
+ */
+#define GDBWIRE_MI_PARSER_BUFFER_KEEP (16 * 1024)
 
-/* Lexer state create/destroy functions */
-extern int gdbwire_mi_lex_init(yyscan_t *scanner);
-extern int gdbwire_mi_lex_destroy(yyscan_t scanner);
+/**
+ * The most bytes of a line kept in it's output command once list elements
+ * were taken from it by the list element function. The line may be many
+ * megabytes, and keeping a copy of it would double the memory streaming
+ * is meant to save.
+ */
+#define GDBWIRE_MI_PARSER_STREAMED_LINE_MAX 256
 
 struct gdbwire_mi_parser {
     /* The buffer pushed into the parser from the user */
     struct gdbwire_string *buffer;
+    /* The number of bytes at the front of buffer already parsed */
+    size_t parsed;
+    /* The number of bytes at the front of buffer searched for a newline */
+    size_t scanned;
     /* The GDB/MI lexer state */
     yyscan_t mils;
     /* The GDB/MI push parser state */
     gdbwire_mi_pstate *mipst;
     /* The client parser callbacks */
     struct gdbwire_mi_parser_callbacks callbacks;
+    /* The state shared with the grammar actions */
+    struct gdbwire_mi_grammar_state state;
+    /* The runtime statistics, less the allocations counted in state */
+    struct gdbwire_stats stats;
+    /* Non zero to time the lexer, the parser and the output callback */
+    int timing;
+    /* Non zero to take the arrival time of each line */
+    int arrival_times;
+    /* The arrival time of the first byte in buffer */
+    uint64_t buffer_arrival;
+    /* The arrival time of the first byte of the line being parsed */
+    uint64_t line_arrival;
 };
 
 struct gdbwire_mi_parser *
@@ -125,6 +150,71 @@ gdbwire_mi_parser_get_callbacks(struct gdbwire_mi_parser *parser)
     return parser->callbacks;
 }
 
+/**
+ * Add the time since start to a timing statistic.
+ *
+ * @param start
+ * The clock reading the time is measured from.
+ *
+ * @param total
+ * The timing statistic to add to.
+ *
+ * @return
+ * The current clock reading, to measure the next step from.
+ */
+static uint64_t
+gdbwire_mi_parser_lap(uint64_t start, uint64_t *total)
+{
+    uint64_t now = gdbwire_clock_ns();
+    *total += now - start;
+    return now;
+}
+
+/**
+ * Count an output command in the statistics and fire it's probe.
+ *
+ * @param parser
+ * The parser that produced the output command.
+ *
+ * @param output
+ * The output command the parser produced.
+ */
+static void
+gdbwire_mi_parser_count_output(struct gdbwire_mi_parser *parser,
+        struct gdbwire_mi_output *output)
+{
+    struct gdbwire_stats *stats = &parser->stats;
+    struct gdbwire_mi_oob_record *oob_record;
+    int record_class = -1;
+
+    stats->outputs[output->kind]++;
+
+    switch (output->kind) {
+        case GDBWIRE_MI_OUTPUT_OOB:
+            oob_record = output->variant.oob_record;
+            if (oob_record->kind == GDBWIRE_MI_ASYNC) {
+                record_class = oob_record->variant.async_record->async_class;
+                stats->async_records[record_class]++;
+            } else {
+                stats->stream_records[
+                    oob_record->variant.stream_record->kind]++;
+            }
+            break;
+        case GDBWIRE_MI_OUTPUT_RESULT:
+            record_class = output->variant.result_record->result_class;
+            stats->result_records[record_class]++;
+            break;
+        case GDBWIRE_MI_OUTPUT_PROMPT:
+            break;
+        case GDBWIRE_MI_OUTPUT_PARSE_ERROR:
+            stats->parse_errors++;
+            break;
+    }
+
+    GDBWIRE_PROBE4(record__parsed, parser, output, (int)output->kind,
+        record_class);
+}
+
 /**
  * Parse a single line of output in GDB/MI format.
  *
@@ -135,37 +225,63 @@ gdbwire_mi_parser_get_callbacks(struct gdbwire_mi_parser *parser)
  * The parser context to operate on.
  *
  * @param line
- * A line of output in GDB/MI format to be parsed.
+ * A line of output in GDB/MI format to be parsed, including it's newline.
+ * The line does not need to be NUL terminated.
+ *
+ * @param length
+ * The length of line in bytes.
  *
  * \return
  * GDBWIRE_OK on success or appropriate error result on failure.
  */
 static enum gdbwire_result
 gdbwire_mi_parser_parse_line(struct gdbwire_mi_parser *parser,
-    const char *line)
+    const char *line, size_t length)
 {
     struct gdbwire_mi_parser_callbacks callbacks =
         gdbwire_mi_parser_get_callbacks(parser);
     struct gdbwire_mi_output *output = 0;
     YY_BUFFER_STATE state = 0;
+    char *copy;
     int pattern, mi_status;
+    uint64_t start = 0, tokens;
 
     GDBWIRE_ASSERT(parser && line);
 
+    /* A previous line may have had a parse error in a tuple or list */
+    parser->state.depth = 0;
+    parser->state.elements_taken = 0;
+
     /* Create a new input buffer for flex. */
-    state = gdbwire_mi__scan_string(line, parser->mils);
+    state = gdbwire_mi__scan_bytes(line, (int)length, parser->mils);
     GDBWIRE_ASSERT(state);
     gdbwire_mi_set_column(1, parser->mils);
 
+    if (parser->timing) {
+        start = gdbwire_clock_ns();
+    }
+
+    GDBWIRE_PROBE2(lex__begin, parser, line);
+    tokens = parser->stats.tokens;
+
     /* Iterate over all the tokens found in the scanner buffer */
     do {
         pattern = gdbwire_mi_lex(parser->mils);
+        if (parser->timing) {
+            start = gdbwire_mi_parser_lap(start, &parser->stats.lex_ns);
+        }
         if (pattern == 0)
             break;
+        parser->stats.tokens++;
         mi_status = gdbwire_mi_push_parse(parser->mipst, pattern, NULL,
-            parser->mils, &output);
+            parser->mils, &output, &parser->state);
+        if (parser->timing) {
+            start = gdbwire_mi_parser_lap(start, &parser->stats.parse_ns);
+        }
     } while (mi_status == YYPUSH_MORE);
 
+    GDBWIRE_PROBE3(lex__end, parser, line, parser->stats.tokens - tokens);
+
     /* Free the scanners buffer */
     gdbwire_mi__delete_buffer(state, parser->mils);
 
@@ -191,141 +307,351 @@ gdbwire_mi_parser_parse_line(struct gdbwire_mi_parser *parser,
 
     /* Each GDB/MI line should produce an output command */
     GDBWIRE_ASSERT(output);
-    output->line = gdbwire_strdup(line);
+    if (parser->state.elements_taken > 0 &&
+            length > GDBWIRE_MI_PARSER_STREAMED_LINE_MAX) {
+        length = GDBWIRE_MI_PARSER_STREAMED_LINE_MAX;
+    }
+    copy = (char *)malloc(length + 1);
+    if (!copy) {
+        gdbwire_mi_output_free(output);
+    }
+    GDBWIRE_ASSERT(copy);
+    memcpy(copy, line, length);
+    copy[length] = 0;
+    output->line = copy;
+    parser->stats.allocations++;
+    parser->stats.bytes_allocated += length + 1;
+
+    gdbwire_mi_parser_count_output(parser, output);
+
+    if (parser->timing) {
+        start = gdbwire_clock_ns();
+    }
 
     callbacks.gdbwire_mi_output_callback(callbacks.context, output);
 
+    if (parser->timing) {
+        gdbwire_mi_parser_lap(start, &parser->stats.callback_ns);
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_mi_parser_set_list_element_fn(struct gdbwire_mi_parser *parser,
+        gdbwire_mi_list_element_fn list_element_fn, void *context)
+{
+    GDBWIRE_ASSERT(parser);
+
+    parser->state.list_element_fn = list_element_fn;
+    parser->state.context = context;
+
     return GDBWIRE_OK;
 }
 
+enum gdbwire_result
+gdbwire_mi_parser_get_stats(struct gdbwire_mi_parser *parser,
+        struct gdbwire_stats *stats)
+{
+    GDBWIRE_ASSERT(parser && stats);
+
+    *stats = parser->stats;
+    stats->allocations += parser->state.allocations;
+    stats->bytes_allocated += parser->state.bytes_allocated;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_mi_parser_reset_stats(struct gdbwire_mi_parser *parser)
+{
+    GDBWIRE_ASSERT(parser);
+
+    memset(&parser->stats, 0, sizeof(parser->stats));
+    parser->stats.buffer_high_water = gdbwire_string_size(parser->buffer);
+    parser->state.allocations = 0;
+    parser->state.bytes_allocated = 0;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_mi_parser_set_timing(struct gdbwire_mi_parser *parser, int enable)
+{
+    GDBWIRE_ASSERT(parser);
+
+    parser->timing = enable;
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_mi_parser_set_arrival_times(struct gdbwire_mi_parser *parser,
+        int enable)
+{
+    GDBWIRE_ASSERT(parser);
+
+    /* Data already in the buffer is attributed to now */
+    if (enable && !parser->arrival_times) {
+        parser->buffer_arrival = gdbwire_clock_ns();
+    } else if (!enable) {
+        parser->buffer_arrival = 0;
+        parser->line_arrival = 0;
+    }
+    parser->arrival_times = enable;
+
+    return GDBWIRE_OK;
+}
+
+uint64_t
+gdbwire_mi_parser_get_line_arrival(struct gdbwire_mi_parser *parser)
+{
+    return parser->line_arrival;
+}
+
+enum gdbwire_result
+gdbwire_mi_parser_push(struct gdbwire_mi_parser *parser, const char *data)
+{
+    return gdbwire_mi_parser_push_data(parser, data, strlen(data));
+}
+
 /**
- * Get the next line available in the buffer.
+ * Take the arrival time of data about to be added to the buffer.
  *
- * @param buffer
- * The entire buffer the user has pushed onto the gdbwire_mi parser
- * through gdbwire_mi_parser_push. If a line is found, the returned line
- * will be removed from this buffer.
+ * A line is attributed to the arrival of it's first byte. This is
+ * now, unless the buffer already holds the start of a line.
  *
- * @param line
- * Will return as an allocated line if a line is available or NULL
- * otherwise. If this function does not return GDBWIRE_OK then ignore
- * the output of this parameter. It is the callers responsibility to
- * free the memory.
+ * @param parser
+ * The parser the data is being added to.
+ *
+ * @return
+ * The arrival time of the data, or 0 if arrival times are not enabled.
+ */
+static uint64_t
+gdbwire_mi_parser_arrival(struct gdbwire_mi_parser *parser)
+{
+    uint64_t now = 0;
+
+    if (parser->arrival_times) {
+        now = gdbwire_clock_ns();
+        if (gdbwire_string_size(parser->buffer) == 0) {
+            parser->buffer_arrival = now;
+        }
+    }
+
+    return now;
+}
+
+/**
+ * Parse each complete line in the buffer.
+ *
+ * No need to parse an MI command until a newline occurs.
+ *
+ * A gdb/mi command may be a very long line, often pushed a few bytes
+ * at a time. For this reason, the bytes scanned by previous pushes are
+ * not scanned again. Only the data added now can end a line.
+ *
+ * Each line is parsed straight out of the buffer, and the parsed lines
+ * are removed from the front of the buffer once, after the last one.
+ *
+ * The output callback may push more data, parsing the lines after the
+ * one being dispatched and moving the buffer. The line is marked parsed
+ * before it is dispatched and the buffer is looked up again after.
+ *
+ * @param parser
+ * The parser context to operate on.
+ *
+ * @param size
+ * The number of bytes just added to the end of the buffer.
+ *
+ * @param now
+ * The arrival time of the bytes added, from gdbwire_mi_parser_arrival.
+ *
+ * @param lines
+ * If not NULL, the number of lines parsed.
  *
  * @return
  * GDBWIRE_OK on success or appropriate error result on failure.
  */
 static enum gdbwire_result
-gdbwire_mi_parser_get_next_line(struct gdbwire_string *buffer,
-        struct gdbwire_string **line)
+gdbwire_mi_parser_parse_lines(struct gdbwire_mi_parser *parser, size_t size,
+        uint64_t now, size_t *lines)
 {
     enum gdbwire_result result = GDBWIRE_OK;
+    char *buffer = gdbwire_string_data(parser->buffer);
+    size_t buffer_size = gdbwire_string_size(parser->buffer);
+    size_t start, pos, end, parsed = 0;
+
+    parser->stats.bytes_pushed += size;
+    if (buffer_size > parser->stats.buffer_high_water) {
+        parser->stats.buffer_high_water = buffer_size;
+    }
 
-    GDBWIRE_ASSERT(buffer && line);
+    for (pos = parser->scanned; pos < buffer_size; ++pos) {
+        if (buffer[pos] != '\n' && buffer[pos] != '\r') {
+            continue;
+        }
+
+        /* The line ends after the \r or \n, or after the \n of \r\n */
+        end = (buffer[pos] == '\r' && pos + 1 < buffer_size &&
+                buffer[pos + 1] == '\n') ? pos + 2 : pos + 1;
+
+        start = parser->parsed;
+        parser->parsed = end;
+        parser->scanned = end;
+
+        /* The following lines started in this data */
+        parser->line_arrival = parser->buffer_arrival;
+        parser->buffer_arrival = now;
+
+        parser->stats.lines++;
+        parsed++;
+        GDBWIRE_PROBE3(line__framed, parser, buffer + start, end - start);
+        result = gdbwire_mi_parser_parse_line(parser, buffer + start,
+            end - start);
+        GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
+
+        /* The output callback may have pushed data */
+        buffer = gdbwire_string_data(parser->buffer);
+        buffer_size = gdbwire_string_size(parser->buffer);
+        pos = parser->scanned - 1;
+    }
 
-    char *data = gdbwire_string_data(buffer);
-    size_t size = gdbwire_string_size(buffer);
-    size_t pos = gdbwire_string_find_first_of(buffer, "\r\n");
+    parser->scanned = buffer_size;
 
+cleanup:
     /**
-     * Search to see if a newline has been reached in gdb/mi.
-     * If a line of data has been recieved, process it.
+     * On error, the lines after the failed one stay in the buffer
+     * unscanned, to be parsed by the next push.
      */
-    if (pos != size) {
-        int status;
-
-        /**
-         * We have the position of the newline character from
-         * gdbwire_string_find_first_of. However, the length must be
-         * calculated to make a copy of the line.
-         *
-         * This is either pos + 1 (for \r or \n) or pos + 1 + 1 for (\r\n).
-         * Check for\r\n for the special case.
-         */
-        size_t line_length = (data[pos] == '\r' && (pos + 1 < size) &&
-                data[pos + 1] == '\n') ? pos + 2 : pos + 1;
-
-        /**
-         * - allocate the buffer
-         * - append the new line
-         * - append a null terminating character
-         * - if successful, delete the new line found from buffer
-         * - any failures cleanup and return an error
-         */
-        *line = gdbwire_string_create();
-        GDBWIRE_ASSERT(*line);
-
-        status = gdbwire_string_append_data(*line, data, line_length);
-        GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
-
-        status = gdbwire_string_append_data(*line, "\0", 1);
-        GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
-
-        status = gdbwire_string_erase(buffer, 0, line_length);
-        GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
+    if (parser->parsed > 0) {
+        gdbwire_string_erase(parser->buffer, 0, parser->parsed);
+        parser->scanned -= parser->parsed;
+        parser->parsed = 0;
     }
 
-    return result;
+    /**
+     * Give back the memory of a large line or a burst of output. A buffer
+     * still holding much of a partial line is left alone, since the rest
+     * of the line would only grow it again. Failing to trim is harmless.
+     */
+    if (gdbwire_string_capacity(parser->buffer) >
+            GDBWIRE_MI_PARSER_BUFFER_KEEP &&
+            gdbwire_string_size(parser->buffer) <=
+            GDBWIRE_MI_PARSER_BUFFER_KEEP / 2) {
+        gdbwire_string_shrink(parser->buffer, GDBWIRE_MI_PARSER_BUFFER_KEEP);
+    }
 
-cleanup:
-    gdbwire_string_destroy(*line);
-    *line = 0;
-    return result;
+    if (lines) {
+        *lines = parsed;
+    }
 
+    return result;
 }
 
 enum gdbwire_result
-gdbwire_mi_parser_push(struct gdbwire_mi_parser *parser, const char *data)
+gdbwire_mi_parser_push_data(struct gdbwire_mi_parser *parser, const char *data,
+    size_t size)
 {
-    return gdbwire_mi_parser_push_data(parser, data, strlen(data));
+    enum gdbwire_result result;
+    uint64_t now;
+
+    GDBWIRE_ASSERT(parser && data);
+
+    /* The list element function runs in the middle of parsing a line */
+    if (parser->state.in_list_element) {
+        return GDBWIRE_LOGIC;
+    }
+
+    GDBWIRE_PROBE3(push__begin, parser, data, size);
+
+    now = gdbwire_mi_parser_arrival(parser);
+
+    GDBWIRE_ASSERT(gdbwire_string_append_data(parser->buffer, data, size) == 0);
+
+    result = gdbwire_mi_parser_parse_lines(parser, size, now, NULL);
+
+    GDBWIRE_PROBE3(push__end, parser, (int)result,
+        gdbwire_string_size(parser->buffer));
+    return result;
 }
 
 enum gdbwire_result
-gdbwire_mi_parser_push_data(struct gdbwire_mi_parser *parser, const char *data,
-    size_t size)
+gdbwire_mi_parser_read_fd(struct gdbwire_mi_parser *parser, int fd,
+        size_t max_bytes, enum gdbwire_read_status *status)
 {
-    struct gdbwire_string *line = 0;
-    enum gdbwire_result result = GDBWIRE_OK;
-    int has_newline = 0;
-    size_t index;
+    enum gdbwire_result result;
+    ssize_t count;
+    size_t size, lines, want, room;
+#ifdef FIONREAD
+    int available;
+#endif
+    uint64_t now;
+    char *tail;
 
-    GDBWIRE_ASSERT(parser && data);
+    GDBWIRE_ASSERT(parser && status && max_bytes > 0);
+
+    if (parser->state.in_list_element) {
+        return GDBWIRE_LOGIC;
+    }
 
     /**
-     * No need to parse an MI command until a newline occurs.
-     *
-     * A gdb/mi command may be a very long line. For this reason, it is
-     * better to check the data passed into this function once for a newline
-     * rather than checking all the data every time this function is called.
-     * This optimizes the case where this function is called one character
-     * at a time.
+     * Make room in the buffer for the bytes waiting, to read them in place.
+     * Making room for max_bytes instead would keep that much allocated for
+     * every parser, however little GDB writes.
      */
-    for (index = size; index > 0; --index) {
-        if (data[index-1] == '\n' || data[index-1] == '\r') {
-            has_newline = 1;
-            break;
-        }
+    want = GDBWIRE_MI_PARSER_READ_MIN;
+#ifdef FIONREAD
+    if (ioctl(fd, FIONREAD, &available) == 0 && available > 0) {
+        want = (size_t)available;
+    }
+#endif
+    if (want > GDBWIRE_MI_PARSER_READ_MAX) {
+        want = GDBWIRE_MI_PARSER_READ_MAX;
+    }
+    if (want > max_bytes) {
+        want = max_bytes;
     }
 
-    GDBWIRE_ASSERT(gdbwire_string_append_data(parser->buffer, data, size) == 0);
+    tail = gdbwire_string_reserve(parser->buffer, want);
+    GDBWIRE_ASSERT(tail);
 
-    if (has_newline) {
-        for (;;) {
-            result = gdbwire_mi_parser_get_next_line(parser->buffer, &line);
-            GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
-
-            if (line) {
-                result = gdbwire_mi_parser_parse_line(parser,
-                    gdbwire_string_data(line));
-                gdbwire_string_destroy(line);
-                line = 0;
-                GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
-            } else {
-                break;
-            }
-        }
+    /* Read into all of the room there is, up to max_bytes */
+    room = gdbwire_string_capacity(parser->buffer) -
+        gdbwire_string_size(parser->buffer);
+    if (room > max_bytes) {
+        room = max_bytes;
     }
 
-cleanup:
+    do {
+        count = read(fd, tail, room);
+    } while (count == -1 && errno == EINTR);
+
+    if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        *status = GDBWIRE_READ_AGAIN;
+        return GDBWIRE_OK;
+    }
+    if (count == -1) {
+        gdbwire_error("read failed, errno[%d], strerror[%s]",
+            errno, strerror(errno));
+        return GDBWIRE_LOGIC;
+    }
+    if (count == 0) {
+        *status = GDBWIRE_READ_EOF;
+        return GDBWIRE_OK;
+    }
+
+    now = gdbwire_mi_parser_arrival(parser);
+    size = gdbwire_string_size(parser->buffer);
+    GDBWIRE_ASSERT(gdbwire_string_commit(parser->buffer, count) == 0);
+
+    GDBWIRE_PROBE3(push__begin, parser, gdbwire_string_data(parser->buffer) +
+        size, (size_t)count);
+
+    result = gdbwire_mi_parser_parse_lines(parser, count, now, &lines);
+    *status = (lines > 0) ? GDBWIRE_READ_RECORDS : GDBWIRE_READ_PARTIAL;
+
+    GDBWIRE_PROBE3(push__end, parser, (int)result,
+        gdbwire_string_size(parser->buffer));
     return result;
 }
@@ -5,8 +5,10 @@
 extern "C" { 
 #endif 
 
+#include <stdint.h>
 #include "gdbwire_result.h"
 #include "gdbwire_mi_pt.h"
+#include "gdbwire_stats.h"
 
 /* The opaque GDB/MI parser context */
 struct gdbwire_mi_parser;
@@ -44,6 +46,46 @@ struct gdbwire_mi_parser_callbacks {
         struct gdbwire_mi_output *output);
 };
 
+/**
+ * A list element is available.
+ *
+ * Some GDB/MI commands, like -file-list-exec-source-files, output a
+ * single line with a list of hundreds of thousands of elements. Rather
+ * than building the entire parse tree of the line, this function is
+ * called with each element of a list as soon as the parser has parsed it.
+ *
+ * A line is only parsed once all of it has arrived, so the elements are
+ * not available any sooner and the parser still buffers the whole line.
+ * What is saved is the parse tree of the elements taken. The output
+ * command of a line that elements were taken from keeps only the first
+ * 256 bytes of the line, rather than a second copy of all of it.
+ *
+ * The function is called from the middle of the parse of a line, so it
+ * can not push data into the parser. gdbwire_mi_parser_push_data and
+ * gdbwire_mi_parser_read_fd return GDBWIRE_LOGIC while it runs.
+ *
+ * @param context
+ * The context pointer passed to gdbwire_mi_parser_set_list_element_fn.
+ *
+ * @param variable
+ * The variable name of the list the element belongs to, ie. "files"
+ * for files=[...], or NULL if the list does not have a variable name.
+ *
+ * @param depth
+ * The number of tuples and lists the element is in, including it's own
+ * list. In ^done,files=[{...},{...}] the tuples are at depth 1.
+ *
+ * @param element
+ * The list element.
+ *
+ * @return
+ * Non zero if the function takes ownership of the element, in which
+ * case it is left out of the parse tree. Zero to have the parser add
+ * the element to the parse tree as usual.
+ */
+typedef int (*gdbwire_mi_list_element_fn)(void *context,
+        const char *variable, int depth, struct gdbwire_mi_result *element);
+
 /**
  * Create a GDB/MI parser context.
  *
@@ -66,6 +108,110 @@ struct gdbwire_mi_parser *gdbwire_mi_parser_create(
  */
 void gdbwire_mi_parser_destroy(struct gdbwire_mi_parser *parser);
 
+/**
+ * Set the function called with each list element as it is parsed.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @param list_element_fn
+ * The function to call with each list element or NULL to build the
+ * complete parse tree, which is the default.
+ *
+ * @param context
+ * An arbitrary pointer passed to list_element_fn.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_mi_parser_set_list_element_fn(
+        struct gdbwire_mi_parser *parser,
+        gdbwire_mi_list_element_fn list_element_fn, void *context);
+
+/**
+ * Get a snapshot of the runtime statistics of the parser.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @param stats
+ * The statistics since the parser was created, or since they were
+ * last reset.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_mi_parser_get_stats(
+        struct gdbwire_mi_parser *parser, struct gdbwire_stats *stats);
+
+/**
+ * Reset the runtime statistics of the parser to zero.
+ *
+ * The buffer high water mark is reset to the amount of data currently
+ * waiting for a newline.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_mi_parser_reset_stats(
+        struct gdbwire_mi_parser *parser);
+
+/**
+ * Enable or disable the timing statistics of the parser.
+ *
+ * Timing reads a clock before and after each token, which is a
+ * noticeable cost on a large parse, so it is disabled by default.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @param enable
+ * Non zero to time the lexer, the parser and the output callback.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_mi_parser_set_timing(
+        struct gdbwire_mi_parser *parser, int enable);
+
+/**
+ * Enable or disable taking the arrival time of each line.
+ *
+ * When enabled, the parser reads gdbwire_clock_ns as data is pushed and
+ * remembers when the first byte of each line arrived. A line that is
+ * pushed in pieces is attributed to the arrival of it's first piece.
+ * This is disabled by default.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @param enable
+ * Non zero to take arrival times, zero to stop.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_mi_parser_set_arrival_times(
+        struct gdbwire_mi_parser *parser, int enable);
+
+/**
+ * Get the arrival time of the line being parsed.
+ *
+ * This is meant to be called from the output callback, to measure how
+ * long the line took to be delivered.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @return
+ * The gdbwire_clock_ns reading when the first byte of the line was
+ * pushed, or 0 if arrival times are not enabled.
+ */
+uint64_t gdbwire_mi_parser_get_line_arrival(struct gdbwire_mi_parser *parser);
+
 /**
  * Push a null terminated string onto the parser.
  *
@@ -101,10 +247,48 @@ enum gdbwire_result gdbwire_mi_parser_push(struct gdbwire_mi_parser *parser,
  *
  * @return
  * GDBWIRE_OK on success or appropriate error result on failure.
+ * GDBWIRE_LOGIC if called from the list element function.
  */
 enum gdbwire_result gdbwire_mi_parser_push_data(
         struct gdbwire_mi_parser *parser, const char *data, size_t size);
 
+/**
+ * Read parse data from a file descriptor directly into the parser.
+ *
+ * This does what a read(2) followed by gdbwire_mi_parser_push_data does,
+ * without copying the data. The parser's buffer is grown to hold the
+ * bytes waiting on the file descriptor, up to max_bytes or 1MB if that
+ * is less, and read(2) reads into the end of it. The buffer is trimmed
+ * back once the lines read are parsed. A single call reads once, so
+ * call it again while it reports GDBWIRE_READ_RECORDS or
+ * GDBWIRE_READ_PARTIAL to drain a nonblocking file descriptor.
+ *
+ * See gdbwire_mi_parser_push for details on function behavior.
+ *
+ * @param parser
+ * The gdbwire_mi parser context to operate on.
+ *
+ * @param fd
+ * The file descriptor to read, ie. the read end of GDB's stdout.
+ * It may be blocking or nonblocking. A read interrupted by a signal
+ * is retried.
+ *
+ * @param max_bytes
+ * The most bytes to read.
+ *
+ * @param status
+ * What the read found. When the file descriptor is nonblocking and has
+ * no data, this is GDBWIRE_READ_AGAIN and GDBWIRE_OK is returned.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ * If the read fails, GDBWIRE_LOGIC is returned and errno is left set.
+ * GDBWIRE_LOGIC is also returned if called from the list element function.
+ */
+enum gdbwire_result gdbwire_mi_parser_read_fd(
+        struct gdbwire_mi_parser *parser, int fd, size_t max_bytes,
+        enum gdbwire_read_status *status);
+
 #ifdef __cplusplus 
 }
 #endif 
@@ -87,6 +87,8 @@ struct gdbwire_mi_output {
      * this particular output structure.
      *
      * This field is always available and never NULL, even for a parse error.
+     * If list elements were taken from the line by a list element function,
+     * only the first 256 bytes of the line are kept.
      */
     char *line;
 
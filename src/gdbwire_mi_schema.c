@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_mi_schema.h"
+
+/**
+ * Find the field of a key.
+ *
+ * The schemas are small, so comparing the precomputed key lengths
+ * first rejects nearly every other field with out touching it's key.
+ *
+ * @param schema
+ * The schema to search.
+ *
+ * @param key
+ * The key to search for.
+ *
+ * @return
+ * The index of the field or fields_size if the key is not in the schema.
+ */
+static size_t
+gdbwire_mi_schema_find(const struct gdbwire_mi_schema *schema,
+        const char *key)
+{
+    size_t index, size = strlen(key);
+
+    for (index = 0; index < schema->fields_size; ++index) {
+        const struct gdbwire_mi_field *field = &schema->fields[index];
+        if (field->key_size == size && field->key[0] == key[0] &&
+                memcmp(field->key, key, size) == 0) {
+            break;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Convert the value of a field and store it in a struct.
+ *
+ * @param field
+ * The field the value belongs to.
+ *
+ * @param mi_result
+ * The value.
+ *
+ * @param out
+ * The struct to store the value in.
+ *
+ * @return
+ * GDBWIRE_OK on success or the appropriate error code.
+ */
+static enum gdbwire_result
+gdbwire_mi_schema_field(const struct gdbwire_mi_field *field,
+        struct gdbwire_mi_result *mi_result, char *out)
+{
+    void *member = out + field->offset;
+    char *cstring = 0, *end_ptr;
+    size_t index;
+
+    if (field->kind == GDBWIRE_MI_FIELD_LIST) {
+        GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_LIST);
+        *(struct gdbwire_mi_result **)member = mi_result->variant.result;
+        return GDBWIRE_OK;
+    }
+
+    if (field->kind == GDBWIRE_MI_FIELD_TUPLE) {
+        GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_TUPLE);
+        *(struct gdbwire_mi_result **)member = mi_result->variant.result;
+        return GDBWIRE_OK;
+    }
+
+    if (field->kind == GDBWIRE_MI_FIELD_RESULT) {
+        *(struct gdbwire_mi_result **)member = mi_result;
+        return GDBWIRE_OK;
+    }
+
+    GDBWIRE_ASSERT(mi_result->kind == GDBWIRE_MI_CSTRING);
+    cstring = mi_result->variant.cstring;
+
+    switch (field->kind) {
+        case GDBWIRE_MI_FIELD_STRING:
+            *(char **)member = cstring;
+            break;
+        case GDBWIRE_MI_FIELD_INT:
+            *(int *)member = atoi(cstring);
+            break;
+        case GDBWIRE_MI_FIELD_ULONG:
+            errno = 0;
+            *(unsigned long *)member = strtoul(cstring, &end_ptr, 10);
+            GDBWIRE_ASSERT(errno == 0 && end_ptr != cstring && !*end_ptr);
+            break;
+        case GDBWIRE_MI_FIELD_ADDRESS:
+            errno = 0;
+            *(uint64_t *)member = strtoull(cstring, &end_ptr, 16);
+            GDBWIRE_ASSERT(errno == 0 && end_ptr != cstring && !*end_ptr);
+            break;
+        case GDBWIRE_MI_FIELD_ENUM:
+            for (index = 0; field->values[index]; ++index) {
+                if (strcmp(field->values[index], cstring) == 0) {
+                    *(int *)member = (int)index;
+                    return GDBWIRE_OK;
+                }
+            }
+            if (field->flags & GDBWIRE_MI_FIELD_STRICT) {
+                return GDBWIRE_LOGIC;
+            }
+            break;
+        case GDBWIRE_MI_FIELD_BOOL:
+            *(int *)member = cstring[0] == 'y';
+            break;
+        default:
+            GDBWIRE_ASSERT(0);
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_mi_schema_decode(const struct gdbwire_mi_schema *schema,
+        struct gdbwire_mi_result *mi_result, void *out)
+{
+    enum gdbwire_result result;
+    unsigned long seen = 0;
+    size_t index;
+
+    GDBWIRE_ASSERT(schema);
+    GDBWIRE_ASSERT(schema->fields_size <= GDBWIRE_MI_SCHEMA_MAX_FIELDS);
+    GDBWIRE_ASSERT(out);
+
+    for (; mi_result; mi_result = mi_result->next) {
+        GDBWIRE_ASSERT(mi_result->variable);
+
+        index = gdbwire_mi_schema_find(schema, mi_result->variable);
+        if (index == schema->fields_size) {
+            continue;
+        }
+
+        result = gdbwire_mi_schema_field(&schema->fields[index], mi_result,
+            out);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        seen |= 1ul << index;
+    }
+
+    for (index = 0; index < schema->fields_size; ++index) {
+        if (schema->fields[index].flags & GDBWIRE_MI_FIELD_REQUIRED) {
+            GDBWIRE_ASSERT(seen & (1ul << index));
+        }
+    }
+
+    return GDBWIRE_OK;
+}
@@ -0,0 +1,186 @@
+#ifndef GDBWIRE_MI_SCHEMA_H
+#define GDBWIRE_MI_SCHEMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+
+/**
+ * Declarative decoding of the fields of a GDB/MI tuple.
+ *
+ * Most GDB/MI output is a tuple of named fields, ie. bkpt={number="1",...}
+ * or frame={level="0",...}. Instead of hand writing a strcmp chain for
+ * each tuple, a decoder describes the fields it wants in a schema, which
+ * maps each key to the offset of a member of a struct and how to convert
+ * the value. gdbwire_mi_schema_decode then fills in the struct in a
+ * single pass over the tuple.
+ *
+ * A schema is written as an X-macro list, with one line per field:
+ *
+ *   #define FRAME_FIELDS(X, T) \
+ *       X(T, "level", INT,    level,   0,                         0) \
+ *       X(T, "addr",  STRING, address, GDBWIRE_MI_FIELD_REQUIRED, 0)
+ *
+ *   GDBWIRE_MI_SCHEMA(frame_schema, struct frame, FRAME_FIELDS);
+ *
+ * The same list can declare the struct the fields are decoded into,
+ * with GDBWIRE_MI_FIELD_MEMBER, so adding a field is a one line change.
+ *
+ * The strings are not copied, they point into the parse tree.
+ */
+
+/** How the value of a field is converted. */
+enum gdbwire_mi_field_kind {
+    /** A char *, the cstring itself. */
+    GDBWIRE_MI_FIELD_STRING,
+
+    /** An int, converted with atoi, 0 if it is not a number. */
+    GDBWIRE_MI_FIELD_INT,
+
+    /** An unsigned long, in decimal. Anything else is an error. */
+    GDBWIRE_MI_FIELD_ULONG,
+
+    /** A uint64_t, in hexadecimal. Anything else is an error. */
+    GDBWIRE_MI_FIELD_ADDRESS,
+
+    /**
+     * An int, the index of the cstring in the field's values array.
+     *
+     * Values that are not in the array are ignored, or are an error
+     * if the field is GDBWIRE_MI_FIELD_STRICT.
+     */
+    GDBWIRE_MI_FIELD_ENUM,
+
+    /** An int, 1 if the cstring is "y" and 0 otherwise. */
+    GDBWIRE_MI_FIELD_BOOL,
+
+    /** A struct gdbwire_mi_result *, the contents of a list. */
+    GDBWIRE_MI_FIELD_LIST,
+
+    /** A struct gdbwire_mi_result *, the contents of a tuple. */
+    GDBWIRE_MI_FIELD_TUPLE,
+
+    /**
+     * A struct gdbwire_mi_result *, the field itself, for a field that
+     * may be a cstring or a list, ie. stopped-threads.
+     */
+    GDBWIRE_MI_FIELD_RESULT
+};
+
+/** The field must be present in the tuple. */
+#define GDBWIRE_MI_FIELD_REQUIRED 0x1
+
+/** An enum value that is not in the values array is an error. */
+#define GDBWIRE_MI_FIELD_STRICT 0x2
+
+/** The C types of the field kinds, for use by GDBWIRE_MI_FIELD_MEMBER. */
+#define GDBWIRE_MI_FIELD_TYPE_STRING char *
+#define GDBWIRE_MI_FIELD_TYPE_INT int
+#define GDBWIRE_MI_FIELD_TYPE_ULONG unsigned long
+#define GDBWIRE_MI_FIELD_TYPE_ADDRESS uint64_t
+#define GDBWIRE_MI_FIELD_TYPE_ENUM int
+#define GDBWIRE_MI_FIELD_TYPE_BOOL int
+#define GDBWIRE_MI_FIELD_TYPE_LIST struct gdbwire_mi_result *
+#define GDBWIRE_MI_FIELD_TYPE_TUPLE struct gdbwire_mi_result *
+#define GDBWIRE_MI_FIELD_TYPE_RESULT struct gdbwire_mi_result *
+
+/** A field of a schema. */
+struct gdbwire_mi_field {
+    /** The key of the field, ie. "addr". */
+    const char *key;
+
+    /** The length of key, compared before the key itself. */
+    size_t key_size;
+
+    /** How the value of the field is converted. */
+    enum gdbwire_mi_field_kind kind;
+
+    /** The offset of the member the value is stored in. */
+    size_t offset;
+
+    /** GDBWIRE_MI_FIELD_REQUIRED and GDBWIRE_MI_FIELD_STRICT flags. */
+    int flags;
+
+    /** The NULL terminated values of a GDBWIRE_MI_FIELD_ENUM field. */
+    const char *const *values;
+};
+
+/** A schema, the fields of a tuple. */
+struct gdbwire_mi_schema {
+    /** The fields, at most GDBWIRE_MI_SCHEMA_MAX_FIELDS of them. */
+    const struct gdbwire_mi_field *fields;
+
+    /** The number of fields. */
+    size_t fields_size;
+};
+
+/** The maximum number of fields in a schema. */
+#define GDBWIRE_MI_SCHEMA_MAX_FIELDS 32
+
+/** Expand an X-macro line to a struct gdbwire_mi_field initializer. */
+#define GDBWIRE_MI_FIELD(type, key, kind, member, flags, values) \
+    { key, sizeof(key) - 1, GDBWIRE_MI_FIELD_##kind, \
+        offsetof(type, member), flags, values },
+
+/** Expand an X-macro line to a struct member declaration. */
+#define GDBWIRE_MI_FIELD_MEMBER(type, key, kind, member, flags, values) \
+    GDBWIRE_MI_FIELD_TYPE_##kind member;
+
+/**
+ * Define a static schema from an X-macro list of fields.
+ *
+ * @param name
+ * The name of the struct gdbwire_mi_schema to define.
+ *
+ * @param type
+ * The struct the fields are decoded into.
+ *
+ * @param fields
+ * The X-macro list of fields, taking the X macro and the type.
+ */
+#define GDBWIRE_MI_SCHEMA(name, type, fields) \
+    static const struct gdbwire_mi_field name##_fields[] = { \
+        fields(GDBWIRE_MI_FIELD, type) \
+    }; \
+    static const struct gdbwire_mi_schema name = { \
+        name##_fields, sizeof(name##_fields) / sizeof(name##_fields[0]) \
+    }
+
+/**
+ * Decode the fields of a tuple.
+ *
+ * The fields that are not in the tuple are left as they are, so the
+ * caller initializes out with the defaults first. Keys that are not in
+ * the schema are skipped. If a key is in the tuple more than once, the
+ * last one is used.
+ *
+ * @param schema
+ * The schema describing the fields.
+ *
+ * @param mi_result
+ * The contents of the tuple, ie. the first field.
+ *
+ * @param out
+ * The struct to decode the fields into.
+ *
+ * @return
+ * GDBWIRE_OK on success. GDBWIRE_ASSERT if a required field is missing,
+ * a field is unnamed, not a cstring, list or tuple when it should be,
+ * or not a number when it should be. GDBWIRE_LOGIC if a strict enum
+ * field has a value that is not in it's values array.
+ */
+enum gdbwire_result gdbwire_mi_schema_decode(
+        const struct gdbwire_mi_schema *schema,
+        struct gdbwire_mi_result *mi_result, void *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef GDBWIRE_PROBE_H
+#define GDBWIRE_PROBE_H
+
+/**
+ * Static tracepoints, for tracing gdbwire with perf, bpftrace or SystemTap.
+ *
+ * When gdbwire is compiled with GDBWIRE_USDT defined (configure
+ * --enable-usdt), each probe is a USDT probe from <sys/sdt.h>, in the
+ * gdbwire provider. An unused probe is a single nop instruction, so the
+ * probes stay compiled in. Without GDBWIRE_USDT, the probes compile to
+ * nothing.
+ *
+ * The probes, with their arguments, are:
+ *
+ * - push__begin(parser, data, size)
+ *   gdbwire_mi_parser_push_data was called.
+ * - push__end(parser, result, buffered)
+ *   gdbwire_mi_parser_push_data is returning, buffered is the number of
+ *   bytes left waiting for a newline.
+ * - line__framed(parser, line, size)
+ *   A complete line was found in the buffer, size includes the newline.
+ *   The line is not NUL terminated, read size bytes of it.
+ * - lex__begin(parser, line)
+ *   The line framed by line__framed is about to be lexed and parsed.
+ * - lex__end(parser, line, tokens)
+ *   The line was lexed and parsed, into tokens tokens.
+ * - record__parsed(parser, output, kind, class)
+ *   The line produced an output command. kind is the
+ *   gdbwire_mi_output_kind, class is the gdbwire_mi_result_class or
+ *   the gdbwire_mi_async_class of a record, or -1.
+ * - command__decoded(kind, result, command)
+ *   gdbwire_get_mi_command decoded a gdbwire_mi_command_kind, command is
+ *   NULL unless result is GDBWIRE_OK.
+ * - callback__dispatch(wire, kind, record)
+ *   A gdbwire callback is about to be called with record, kind is the
+ *   gdbwire_latency_kind of the record.
+ *
+ * For example, to count the records gdbwire parses by kind:
+ *
+ *   bpftrace -e 'usdt:./libgdbwire.so:gdbwire:record__parsed
+ *       { @[arg2] = count(); }'
+ */
+
+#ifdef GDBWIRE_USDT
+
+#include <sys/sdt.h>
+
+#define GDBWIRE_PROBE2(name, a1, a2) \
+    DTRACE_PROBE2(gdbwire, name, a1, a2)
+#define GDBWIRE_PROBE3(name, a1, a2, a3) \
+    DTRACE_PROBE3(gdbwire, name, a1, a2, a3)
+#define GDBWIRE_PROBE4(name, a1, a2, a3, a4) \
+    DTRACE_PROBE4(gdbwire, name, a1, a2, a3, a4)
+
+#else
+
+/* The arguments are used, so that variables kept for a probe are too */
+#define GDBWIRE_PROBE2(name, a1, a2) \
+    do { (void)(a1); (void)(a2); } while (0)
+#define GDBWIRE_PROBE3(name, a1, a2, a3) \
+    do { (void)(a1); (void)(a2); (void)(a3); } while (0)
+#define GDBWIRE_PROBE4(name, a1, a2, a3, a4) \
+    do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_register_cache.h"
+
+struct gdbwire_register_cache {
+    /* The registers, indexed by register number */
+    struct gdbwire_register *registers;
+    /* The number of registers */
+    size_t registers_size;
+
+    /* The register names, owned by the cache, indexed by register number */
+    char **names;
+    /* The register values, owned by the cache, indexed by register number */
+    char **values;
+
+    /* The stale register numbers, filled in by gdbwire_register_cache_stale */
+    int *stale;
+};
+
+struct gdbwire_register_cache *
+gdbwire_register_cache_create(void)
+{
+    return calloc(1, sizeof(struct gdbwire_register_cache));
+}
+
+/**
+ * Free all of the registers in the register cache.
+ *
+ * @param cache
+ * The register cache.
+ */
+static void
+gdbwire_register_cache_free_registers(struct gdbwire_register_cache *cache)
+{
+    size_t index;
+
+    for (index = 0; index < cache->registers_size; ++index) {
+        free(cache->names[index]);
+        free(cache->values[index]);
+    }
+
+    free(cache->registers);
+    free(cache->names);
+    free(cache->values);
+    free(cache->stale);
+
+    cache->registers = NULL;
+    cache->registers_size = 0;
+    cache->names = NULL;
+    cache->values = NULL;
+    cache->stale = NULL;
+}
+
+void
+gdbwire_register_cache_destroy(struct gdbwire_register_cache *cache)
+{
+    if (cache) {
+        gdbwire_register_cache_free_registers(cache);
+        free(cache);
+    }
+}
+
+enum gdbwire_result
+gdbwire_register_cache_register_names(struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_register *registers = NULL;
+    char **values = NULL;
+    int *stale = NULL;
+    size_t index, size;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_DATA_LIST_REGISTER_NAMES);
+
+    size = mi_command->variant.data_list_register_names.names_size;
+    if (size > 0) {
+        registers = calloc(size, sizeof(struct gdbwire_register));
+        values = calloc(size, sizeof(char *));
+        stale = calloc(size, sizeof(int));
+        if (!registers || !values || !stale) {
+            free(registers);
+            free(values);
+            free(stale);
+            return GDBWIRE_NOMEM;
+        }
+    }
+
+    gdbwire_register_cache_free_registers(cache);
+
+    cache->registers = registers;
+    cache->registers_size = size;
+    cache->names = mi_command->variant.data_list_register_names.names;
+    cache->values = values;
+    cache->stale = stale;
+    mi_command->variant.data_list_register_names.names = NULL;
+    mi_command->variant.data_list_register_names.names_size = 0;
+
+    for (index = 0; index < size; ++index) {
+        registers[index].number = (int)index;
+        registers[index].name = cache->names[index];
+        registers[index].stale = cache->names[index] != NULL;
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_register_cache_register_values(struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_mi_register_value *value;
+    size_t index, number;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_DATA_LIST_REGISTER_VALUES);
+
+    for (index = 0;
+            index < mi_command->variant.data_list_register_values.values_size;
+            ++index) {
+        value = &mi_command->variant.data_list_register_values.values[index];
+        number = (size_t)value->number;
+        if (value->number < 0 || number >= cache->registers_size) {
+            continue;
+        }
+
+        /* Swap the value in rather than copying it */
+        free(cache->values[number]);
+        cache->values[number] = value->value;
+        value->value = NULL;
+
+        cache->registers[number].value = cache->values[number];
+        cache->registers[number].stale = 0;
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_register_cache_changed_registers(struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    int *numbers;
+    size_t index, size, number;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(
+        mi_command->kind == GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS);
+
+    numbers = mi_command->variant.data_list_changed_registers.numbers;
+    size = mi_command->variant.data_list_changed_registers.numbers_size;
+    for (index = 0; index < size; ++index) {
+        number = (size_t)numbers[index];
+        if (numbers[index] >= 0 && number < cache->registers_size &&
+                cache->registers[number].name) {
+            cache->registers[number].stale = 1;
+        }
+    }
+
+    return GDBWIRE_OK;
+}
+
+const int *
+gdbwire_register_cache_stale(struct gdbwire_register_cache *cache,
+        size_t *size)
+{
+    size_t index;
+
+    *size = 0;
+
+    if (cache) {
+        for (index = 0; index < cache->registers_size; ++index) {
+            if (cache->registers[index].stale) {
+                cache->stale[(*size)++] = (int)index;
+            }
+        }
+    }
+
+    return (*size > 0) ? cache->stale : NULL;
+}
+
+const struct gdbwire_register *
+gdbwire_register_cache_registers(struct gdbwire_register_cache *cache,
+        size_t *size)
+{
+    *size = (cache) ? cache->registers_size : 0;
+
+    return (*size > 0) ? cache->registers : NULL;
+}
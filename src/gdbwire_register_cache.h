@@ -0,0 +1,177 @@
+#ifndef GDBWIRE_REGISTER_CACHE_H
+#define GDBWIRE_REGISTER_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A cache of register values.
+ *
+ * Fetching every register with -data-list-register-values after each
+ * stop is expensive on targets with many registers. GDB can report
+ * which registers changed since it was last asked, with
+ * -data-list-changed-registers, so only those need to be fetched again.
+ *
+ * The register cache is indexed by register number. It is filled
+ * from the decoded -data-list-register-names and -data-list-register-values
+ * commands, and -data-list-changed-registers marks the registers that have
+ * to be fetched again as stale.
+ *
+ * The typical flow is,
+ *   -data-list-register-names            -> register_names
+ *   -data-list-register-values x         -> register_values
+ *   *stopped
+ *   -data-list-changed-registers         -> changed_registers
+ *   -data-list-register-values x <stale> -> register_values
+ */
+struct gdbwire_register_cache;
+
+/** A register in the register cache. */
+struct gdbwire_register {
+    /** The register number, which is also its index in the cache. */
+    int number;
+
+    /** The register name or NULL if the register number is not used. */
+    const char *name;
+
+    /** The last value fetched or NULL if the value was never fetched. */
+    const char *value;
+
+    /**
+     * True if the register changed since the value was fetched, or if the
+     * value was never fetched. Registers without a name are never stale.
+     */
+    unsigned char stale:1;
+};
+
+/**
+ * Create a register cache instance.
+ *
+ * @return
+ * A new register cache instance or NULL on error.
+ */
+struct gdbwire_register_cache *gdbwire_register_cache_create(void);
+
+/**
+ * Destroy a register cache instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param cache
+ * The instance to destroy.
+ */
+void gdbwire_register_cache_destroy(struct gdbwire_register_cache *cache);
+
+/**
+ * Set the registers from the output of -data-list-register-names.
+ *
+ * This forgets all of the register values, all of the named registers
+ * are stale afterwards.
+ *
+ * The register cache takes ownership of the names in the command,
+ * the names field of the command is NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The register cache.
+ *
+ * @param mi_command
+ * The decoded -data-list-register-names command,
+ * of kind GDBWIRE_MI_DATA_LIST_REGISTER_NAMES.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_register_cache_register_names(
+        struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Update the register values from the output of -data-list-register-values.
+ *
+ * The registers in the command are no longer stale. Values for register
+ * numbers the cache does not know about are ignored.
+ *
+ * The register cache takes ownership of the values in the command,
+ * the value fields of the command are NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The register cache.
+ *
+ * @param mi_command
+ * The decoded -data-list-register-values command,
+ * of kind GDBWIRE_MI_DATA_LIST_REGISTER_VALUES.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_register_cache_register_values(
+        struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Mark the registers reported by -data-list-changed-registers as stale.
+ *
+ * @param cache
+ * The register cache.
+ *
+ * @param mi_command
+ * The decoded -data-list-changed-registers command,
+ * of kind GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_register_cache_changed_registers(
+        struct gdbwire_register_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Get the numbers of the stale registers.
+ *
+ * These are the register numbers to pass to -data-list-register-values.
+ *
+ * The array is only valid until the register cache is updated again.
+ *
+ * @param cache
+ * The register cache.
+ *
+ * @param size
+ * Will return the number of register numbers in the array.
+ *
+ * @return
+ * The stale register numbers, in increasing order, or NULL if no
+ * register is stale.
+ */
+const int *gdbwire_register_cache_stale(struct gdbwire_register_cache *cache,
+        size_t *size);
+
+/**
+ * Get all of the registers.
+ *
+ * The registers are indexed by register number. The array is only valid
+ * until the register cache is updated again.
+ *
+ * @param cache
+ * The register cache.
+ *
+ * @param size
+ * Will return the number of registers in the array.
+ *
+ * @return
+ * The registers or NULL if there are none.
+ */
+const struct gdbwire_register *gdbwire_register_cache_registers(
+        struct gdbwire_register_cache *cache, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
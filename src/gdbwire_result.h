@@ -35,4 +35,24 @@ enum gdbwire_result {
     GDBWIRE_NOMEM
 };
 
+/**
+ * What a read from GDB's output file descriptor found.
+ *
+ * See gdbwire_read_fd and gdbwire_mi_parser_read_fd.
+ */
+enum gdbwire_read_status {
+    /* Data was read, but it did not complete a record */
+    GDBWIRE_READ_PARTIAL,
+
+    /* Data was read and completed at least one record, which was parsed
+       and handed to the callbacks */
+    GDBWIRE_READ_RECORDS,
+
+    /* No data was available on the nonblocking file descriptor */
+    GDBWIRE_READ_AGAIN,
+
+    /* The end of file was reached, GDB closed it's output */
+    GDBWIRE_READ_EOF
+};
+
 #endif /* GDBWIRE_RESULT_H */
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_hash.h"
+#include "gdbwire_intern.h"
+#include "gdbwire_source_file_index.h"
+
+struct gdbwire_source_file_index {
+    /* The strings of the source files */
+    struct gdbwire_intern *strings;
+
+    /**
+     * The source files indexed by file and by fullname.
+     *
+     * The keys are the interned strings and the values are the position
+     * of the source file in the files array plus one, so that a source
+     * file at position 0 is not mistaken for a missing one.
+     */
+    struct gdbwire_hash *by_file;
+    struct gdbwire_hash *by_fullname;
+
+    /* The source files in a dense array */
+    struct gdbwire_mi_source_file *files;
+    /* The number of source files */
+    size_t files_size;
+    /* The number of source files allocated in files */
+    size_t files_capacity;
+};
+
+struct gdbwire_source_file_index *
+gdbwire_source_file_index_create(void)
+{
+    struct gdbwire_source_file_index *index;
+
+    index = calloc(1, sizeof(struct gdbwire_source_file_index));
+    if (!index) {
+        return NULL;
+    }
+
+    index->strings = gdbwire_intern_create();
+    index->by_file = gdbwire_hash_create(NULL);
+    index->by_fullname = gdbwire_hash_create(NULL);
+    if (!index->strings || !index->by_file || !index->by_fullname) {
+        gdbwire_source_file_index_destroy(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+void
+gdbwire_source_file_index_destroy(struct gdbwire_source_file_index *index)
+{
+    if (index) {
+        gdbwire_hash_destroy(index->by_file);
+        gdbwire_hash_destroy(index->by_fullname);
+        gdbwire_intern_destroy(index->strings);
+        free(index->files);
+        free(index);
+    }
+}
+
+/**
+ * Find a source file in one of the hash tables.
+ *
+ * @param index
+ * The source file index.
+ *
+ * @param hash
+ * The by_file or by_fullname hash table.
+ *
+ * @param key
+ * The file or fullname to search for.
+ *
+ * @return
+ * The source file or NULL if not found.
+ */
+static struct gdbwire_mi_source_file *
+gdbwire_source_file_index_find(struct gdbwire_source_file_index *index,
+        struct gdbwire_hash *hash, const char *key)
+{
+    size_t position = (size_t)gdbwire_hash_find(hash, key);
+    return (position) ? &index->files[position - 1] : NULL;
+}
+
+enum gdbwire_result
+gdbwire_source_file_index_add(struct gdbwire_source_file_index *index,
+        const struct gdbwire_mi_source_file *file)
+{
+    struct gdbwire_mi_source_file *existing;
+    const char *file_str, *fullname_str = 0;
+    void *position;
+
+    GDBWIRE_ASSERT(index);
+    GDBWIRE_ASSERT(file);
+    GDBWIRE_ASSERT(file->file);
+
+    existing = (file->fullname) ?
+        gdbwire_source_file_index_find(index, index->by_fullname,
+            file->fullname) : NULL;
+    if (!existing) {
+        existing = gdbwire_source_file_index_find(index, index->by_file,
+            file->file);
+
+        /* A file with a different fullname is a different source file */
+        if (existing && file->fullname && existing->fullname) {
+            existing = NULL;
+        }
+    }
+
+    if (existing) {
+        /* The fullname of a file first added with out one is learned */
+        if (file->fullname && !existing->fullname) {
+            fullname_str = gdbwire_intern_string(index->strings,
+                file->fullname);
+            if (!fullname_str || gdbwire_hash_insert_borrowed(
+                    index->by_fullname, fullname_str,
+                    (void *)(size_t)(existing - index->files + 1)) == -1) {
+                return GDBWIRE_NOMEM;
+            }
+            existing->fullname = (char *)fullname_str;
+        }
+        if (existing->debug_fully_read ==
+                GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN) {
+            existing->debug_fully_read = file->debug_fully_read;
+        }
+        return GDBWIRE_OK;
+    }
+
+    if (index->files_size == index->files_capacity) {
+        size_t capacity = (index->files_capacity) ?
+            index->files_capacity * 2 : 64;
+        struct gdbwire_mi_source_file *files = realloc(index->files,
+            capacity * sizeof(struct gdbwire_mi_source_file));
+        if (!files) {
+            return GDBWIRE_NOMEM;
+        }
+        index->files = files;
+        index->files_capacity = capacity;
+    }
+
+    file_str = gdbwire_intern_string(index->strings, file->file);
+    if (!file_str) {
+        return GDBWIRE_NOMEM;
+    }
+    if (file->fullname) {
+        fullname_str = gdbwire_intern_string(index->strings, file->fullname);
+        if (!fullname_str) {
+            return GDBWIRE_NOMEM;
+        }
+    }
+
+    /* The keys are interned, so the hash tables do not need a copy */
+    position = (void *)(index->files_size + 1);
+    if (fullname_str && gdbwire_hash_insert_borrowed(index->by_fullname,
+            fullname_str, position) == -1) {
+        return GDBWIRE_NOMEM;
+    }
+    if (!gdbwire_hash_find(index->by_file, file_str) &&
+            gdbwire_hash_insert_borrowed(index->by_file,
+                file_str, position) == -1) {
+        if (fullname_str) {
+            gdbwire_hash_remove(index->by_fullname, fullname_str);
+        }
+        return GDBWIRE_NOMEM;
+    }
+
+    existing = &index->files[index->files_size++];
+    existing->file = (char *)file_str;
+    existing->fullname = (char *)fullname_str;
+    existing->debug_fully_read = file->debug_fully_read;
+    existing->next = 0;
+
+    return GDBWIRE_OK;
+}
+
+const struct gdbwire_mi_source_file *
+gdbwire_source_file_index_find_file(struct gdbwire_source_file_index *index,
+        const char *file)
+{
+    return (index && file) ?
+        gdbwire_source_file_index_find(index, index->by_file, file) : NULL;
+}
+
+const struct gdbwire_mi_source_file *
+gdbwire_source_file_index_find_fullname(
+        struct gdbwire_source_file_index *index, const char *fullname)
+{
+    return (index && fullname) ? gdbwire_source_file_index_find(index,
+        index->by_fullname, fullname) : NULL;
+}
+
+const struct gdbwire_mi_source_file *
+gdbwire_source_file_index_files(struct gdbwire_source_file_index *index,
+        size_t *size)
+{
+    *size = (index) ? index->files_size : 0;
+    return (*size) ? index->files : NULL;
+}
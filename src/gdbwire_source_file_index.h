@@ -0,0 +1,128 @@
+#ifndef GDBWIRE_SOURCE_FILE_INDEX_H
+#define GDBWIRE_SOURCE_FILE_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A deduplicated index of source files.
+ *
+ * The -file-list-exec-source-files output of a large program has
+ * hundreds of thousands of source files, many of them listed more than
+ * once, and many sharing the same relative name. The source file index
+ * keeps one copy of each source file, with it's strings interned, and
+ * indexes them by file and by fullname so that resolving a path is a
+ * single hash lookup.
+ *
+ * Source files can be added from a decoded -file-list-exec-source-files
+ * command or directly from gdbwire_stream_source_files.
+ */
+struct gdbwire_source_file_index;
+
+/**
+ * Create a source file index.
+ *
+ * @return
+ * A new source file index or NULL on error.
+ */
+struct gdbwire_source_file_index *gdbwire_source_file_index_create(void);
+
+/**
+ * Destroy a source file index.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param index
+ * The source file index to destroy.
+ */
+void gdbwire_source_file_index_destroy(
+        struct gdbwire_source_file_index *index);
+
+/**
+ * Add a source file to the index.
+ *
+ * Source files with a fullname are the same if their fullnames are the
+ * same. A source file with out a fullname is the same as the first one
+ * added with it's file. Adding a source file that is already in the
+ * index does nothing, except that an unknown debug_fully_read is
+ * updated, and a missing fullname is filled in.
+ *
+ * @param index
+ * The source file index.
+ *
+ * @param file
+ * The source file to add. The index keeps a copy of it, the next
+ * field is ignored.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_source_file_index_add(
+        struct gdbwire_source_file_index *index,
+        const struct gdbwire_mi_source_file *file);
+
+/**
+ * Find a source file by it's relative path.
+ *
+ * Different source files can have the same relative path, ie. "main.c".
+ * In that case, the first one added to the index is found.
+ *
+ * @param index
+ * The source file index.
+ *
+ * @param file
+ * The relative path, as in the file field of the source file.
+ *
+ * @return
+ * The source file or NULL if not found. It is valid until the next
+ * source file is added or the index is destroyed.
+ */
+const struct gdbwire_mi_source_file *gdbwire_source_file_index_find_file(
+        struct gdbwire_source_file_index *index, const char *file);
+
+/**
+ * Find a source file by it's absolute path.
+ *
+ * @param index
+ * The source file index.
+ *
+ * @param fullname
+ * The absolute path, as in the fullname field of the source file.
+ *
+ * @return
+ * The source file or NULL if not found. It is valid until the next
+ * source file is added or the index is destroyed.
+ */
+const struct gdbwire_mi_source_file *gdbwire_source_file_index_find_fullname(
+        struct gdbwire_source_file_index *index, const char *fullname);
+
+/**
+ * Get all of the source files in the index.
+ *
+ * The source files are in the order they were added. The strings of
+ * the source files are interned, so equal strings are the same pointer.
+ * The next fields are NULL.
+ *
+ * @param index
+ * The source file index.
+ *
+ * @param size
+ * Will return the number of source files in the array.
+ *
+ * @return
+ * An array of source files or NULL if there are none. It is valid until
+ * the next source file is added or the index is destroyed.
+ */
+const struct gdbwire_mi_source_file *gdbwire_source_file_index_files(
+        struct gdbwire_source_file_index *index, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
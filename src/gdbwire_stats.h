@@ -0,0 +1,84 @@
+#ifndef GDBWIRE_STATS_H
+#define GDBWIRE_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "gdbwire_mi_pt.h"
+
+/**
+ * The runtime statistics of a parser.
+ *
+ * The counters are cumulative, since the parser was created or since
+ * they were last reset. They are cheap to keep, a few additions per
+ * line, so they are always on. The timings take a clock reading around
+ * each token and each callback, so they are only kept when enabled.
+ */
+struct gdbwire_stats {
+    /** The number of bytes pushed onto the parser. */
+    uint64_t bytes_pushed;
+
+    /** The number of lines framed from the bytes pushed. */
+    uint64_t lines;
+
+    /** The number of tokens the lexer produced. */
+    uint64_t tokens;
+
+    /** The number of lines that failed to parse. */
+    uint64_t parse_errors;
+
+    /** The number of output commands, by gdbwire_mi_output_kind. */
+    uint64_t outputs[GDBWIRE_MI_OUTPUT_PARSE_ERROR + 1];
+
+    /** The number of result records, by gdbwire_mi_result_class. */
+    uint64_t result_records[GDBWIRE_MI_UNSUPPORTED + 1];
+
+    /** The number of asynchronous records, by gdbwire_mi_async_class. */
+    uint64_t async_records[GDBWIRE_MI_ASYNC_UNSUPPORTED + 1];
+
+    /** The number of stream records, by gdbwire_mi_stream_record_kind. */
+    uint64_t stream_records[GDBWIRE_MI_LOG + 1];
+
+    /**
+     * The number of allocations made building the parse trees.
+     *
+     * This includes the temporary lists the grammar builds and the
+     * elements handed to a list element function, even though they do
+     * not end up in the parse tree.
+     */
+    uint64_t allocations;
+
+    /** The number of bytes requested by those allocations. */
+    uint64_t bytes_allocated;
+
+    /** The largest the buffer of unframed data has been, in bytes. */
+    size_t buffer_high_water;
+
+    /** The nanoseconds spent in the lexer, when timing is enabled. */
+    uint64_t lex_ns;
+
+    /**
+     * The nanoseconds spent in the parser, when timing is enabled.
+     *
+     * The parse trees are built by the grammar actions as the tokens
+     * are parsed, so this includes the time spent building them.
+     */
+    uint64_t parse_ns;
+
+    /**
+     * The nanoseconds spent in the output callback, when timing is enabled.
+     *
+     * With a gdbwire context this includes decoding, updating the
+     * attached caches and the client's callbacks.
+     */
+    uint64_t callback_ns;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
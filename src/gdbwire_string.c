@@ -56,30 +56,49 @@ gdbwire_string_clear(struct gdbwire_string *string)
  * @param string
  * The string to increase the capacity.
  *
+ * @param size
+ * The least number of bytes the string must have room for after it's
+ * current size. The capacity is grown with a single realloc.
+ *
  * @return
  * 0 on success or -1 on error.
  */
 static int
-gdbwire_string_increase_capacity(struct gdbwire_string *string)
+gdbwire_string_increase_capacity(struct gdbwire_string *string, size_t size)
 {
+    size_t capacity = string->capacity;
+    char *data;
+
     /**
      * The algorithm chosen to increase the capacity is arbitrary.
      * It starts at 128 bytes. It then doubles it's size in bytes like this,
      *   128, 256, 512, 1024, 2048, 4096
      * After it reaches 4096 it then grows by 4096 bytes at a time.
      */
-    if (string->capacity == 0) {
-        string->capacity = 128;
-    } else if (string->capacity < 4096) {
-        string->capacity *= 2;
-    } else {
-        string->capacity += 4096;
+    while (capacity - string->size < size) {
+        if (capacity == 0) {
+            capacity = 128;
+        } else if (capacity < 4096) {
+            capacity *= 2;
+        } else {
+            capacity += 4096;
+        }
     }
 
-    /* At this point string->capacity is set to the new size, so realloc */
-    string->data = (char*)realloc(string->data, string->capacity);
+    if (capacity == string->capacity) {
+        return 0;
+    }
 
-    return (string->data) ? 0 : -1;
+    /* At this point capacity is set to the new size, so realloc */
+    data = (char*)realloc(string->data, capacity);
+    if (!data) {
+        return -1;
+    }
+
+    string->data = data;
+    string->capacity = capacity;
+
+    return 0;
 }
 
 int
@@ -113,17 +132,40 @@ gdbwire_string_append_data(struct gdbwire_string *string, const char *data,
         size_t size)
 {
     int result = (string && data) ? 0 : -1;
-    size_t data_index = 0;
 
-    for (; string && data && data_index < size; ++data_index, ++string->size) {
-        if (string->size >= string->capacity) {
-            result = gdbwire_string_increase_capacity(string);
-            if (result == -1) {
-                break;
-            }
-        }
+    /* Make room for all of the data, then copy it at once */
+    if (result == 0) {
+        result = gdbwire_string_increase_capacity(string, size);
+    }
 
-        string->data[string->size] = data[data_index];
+    if (result == 0 && size > 0) {
+        memcpy(string->data + string->size, data, size);
+        string->size += size;
+    }
+
+    return result;
+}
+
+char *
+gdbwire_string_reserve(struct gdbwire_string *string, size_t size)
+{
+    int result = (string) ? 0 : -1;
+
+    if (result == 0) {
+        result = gdbwire_string_increase_capacity(string, size);
+    }
+
+    return (result == 0 && string->data) ? string->data + string->size : NULL;
+}
+
+int
+gdbwire_string_commit(struct gdbwire_string *string, size_t size)
+{
+    int result = -1;
+
+    if (string && size <= string->capacity - string->size) {
+        string->size += size;
+        result = 0;
     }
 
     return result;
@@ -204,12 +246,8 @@ gdbwire_string_erase(struct gdbwire_string *string, size_t pos, size_t count)
             /* If so, move characters from the from position
                to the to position */
             } else {
-                char *to_cur = &data[pos], *from_cur = &data[from_pos];
-
                 /* shift everything after the erase request to the left */
-                for (; from_pos < data_size; ++from_pos, ++to_cur, ++from_cur) {
-                    *to_cur = *from_cur;
-                }
+                memmove(&data[pos], &data[from_pos], data_size - from_pos);
             }
             string->size -= count_erased;
             result = 0;
@@ -218,3 +256,29 @@ gdbwire_string_erase(struct gdbwire_string *string, size_t pos, size_t count)
 
     return result;
 }
+
+int
+gdbwire_string_shrink(struct gdbwire_string *string, size_t capacity)
+{
+    char *data;
+
+    if (!string) {
+        return -1;
+    }
+
+    /* Keep room for the data and the NUL character after it */
+    if (capacity <= string->size) {
+        capacity = string->size + 1;
+    }
+
+    if (capacity < string->capacity) {
+        data = realloc(string->data, capacity);
+        if (!data) {
+            return -1;
+        }
+        string->data = data;
+        string->capacity = capacity;
+    }
+
+    return 0;
+}
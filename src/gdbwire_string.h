@@ -108,6 +108,41 @@ int gdbwire_string_append_cstr(struct gdbwire_string *string, const char *cstr);
 int gdbwire_string_append_data(struct gdbwire_string *string,
         const char *data, size_t size);
 
+/**
+ * Make room at the end of this string to write bytes into directly.
+ *
+ * This allows data to be read into the string, with read(2) for instance,
+ * without copying it in from another buffer. Write up to size bytes at
+ * the returned position and then call gdbwire_string_commit() with the
+ * number of bytes written.
+ *
+ * @param string
+ * The string instance to make room in.
+ *
+ * @param size
+ * The least number of bytes to make room for.
+ *
+ * @return
+ * The end of the string, with room for at least size bytes, or NULL on
+ * failure. The room available is gdbwire_string_capacity() less
+ * gdbwire_string_size().
+ */
+char *gdbwire_string_reserve(struct gdbwire_string *string, size_t size);
+
+/**
+ * Append the bytes written to the room made by gdbwire_string_reserve().
+ *
+ * @param string
+ * The string instance to append the bytes to.
+ *
+ * @param size
+ * The number of bytes written at the end of the string.
+ *
+ * @return
+ * 0 on success or -1 if size is more than the room available.
+ */
+int gdbwire_string_commit(struct gdbwire_string *string, size_t size);
+
 /**
  * Get the data associated with this string.
  *
@@ -200,6 +235,27 @@ size_t gdbwire_string_find_first_of(struct gdbwire_string *string,
 int gdbwire_string_erase(struct gdbwire_string *string, size_t pos,
         size_t count);
 
+/**
+ * Release the memory a string holds beyond what it needs.
+ *
+ * gdbwire_string_erase and gdbwire_string_clear leave the capacity
+ * unchanged, so a string that once held a lot of data keeps the memory
+ * for it. This gives that memory back.
+ *
+ * @param string
+ * The string instance to shrink.
+ *
+ * @param capacity
+ * The capacity to shrink the string to. If the string needs more than
+ * this to hold it's data, and the NUL character after it, it is shrunk
+ * to what it needs instead. A string with no more capacity than this
+ * is left unchanged.
+ *
+ * @return
+ * 0 on success or -1 on error. The string is unchanged on error.
+ */
+int gdbwire_string_shrink(struct gdbwire_string *string, size_t capacity);
+
 #ifdef __cplusplus 
 }
 #endif 
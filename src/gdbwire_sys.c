@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "gdbwire_sys.h"
 
@@ -17,3 +18,16 @@ char *gdbwire_strdup(const char *str)
 
     return result;
 }
+
+uint64_t gdbwire_clock_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec now;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+        return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+    }
+#endif
+
+    return (uint64_t)clock() * (1000000000 / CLOCKS_PER_SEC);
+}
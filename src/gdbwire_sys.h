@@ -9,6 +9,8 @@
 extern "C" { 
 #endif 
 
+#include <stdint.h>
+
 /**
  * Duplicate a string.
  *
@@ -21,6 +23,15 @@ extern "C" {
  */
 char *gdbwire_strdup(const char *str);
 
+/**
+ * Read a monotonic clock.
+ *
+ * @return
+ * The current time in nanoseconds, from an arbitrary starting point.
+ * Only the difference between two readings is meaningful.
+ */
+uint64_t gdbwire_clock_ns(void);
+
 #ifdef __cplusplus 
 }
 #endif 
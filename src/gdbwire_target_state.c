@@ -0,0 +1,1110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_sys.h"
+#include "gdbwire_assert.h"
+#include "gdbwire_hash.h"
+#include "gdbwire_target_state.h"
+
+/** The size of a thread id formatted as a key, ie. "2147483647". */
+#define GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE 16
+
+/**
+ * The thread as stored in the target state.
+ *
+ * The public thread must be the first member so that a pointer to
+ * the public thread can be converted back into this structure.
+ */
+struct gdbwire_target_state_thread {
+    struct gdbwire_thread thread;
+    /* The index of this thread in the target state threads array */
+    size_t index;
+};
+
+/* The library as stored in the target state, see above. */
+struct gdbwire_target_state_library {
+    struct gdbwire_library library;
+    /* The index of this library in the target state libraries array */
+    size_t index;
+    /* The next library with the same id, loaded in another thread group */
+    struct gdbwire_target_state_library *next;
+};
+
+struct gdbwire_target_state {
+    /* The client callback functions */
+    struct gdbwire_target_state_callbacks callbacks;
+
+    /**
+     * The threads indexed by thread id, in decimal, does not own them.
+     *
+     * GDB never reuses a thread id, so a hash table keeps the index the
+     * size of the live threads rather than of the largest id seen.
+     */
+    struct gdbwire_hash *threads_by_id;
+
+    /* The threads in a dense array for iteration */
+    struct gdbwire_thread **threads;
+    /* The number of threads */
+    size_t threads_size;
+    /* The number of entries allocated in threads */
+    size_t threads_capacity;
+
+    /* The selected thread id or 0 if no thread is selected */
+    int selected_thread;
+
+    /* The thread groups indexed by id, owns the thread groups */
+    struct gdbwire_hash *thread_groups;
+
+    /**
+     * The libraries indexed by id, does not own the libraries.
+     *
+     * Each thread group loads it's own copy of a library, so the value is
+     * the first of the libraries with that id, linked by their next field.
+     * The key is borrowed from the id of that first library.
+     */
+    struct gdbwire_hash *libraries_by_id;
+    /* The libraries in a dense array for iteration, owns the libraries */
+    struct gdbwire_library **libraries;
+    /* The number of libraries */
+    size_t libraries_size;
+    /* The number of entries allocated in libraries */
+    size_t libraries_capacity;
+};
+
+static void
+gdbwire_thread_free(struct gdbwire_thread *thread)
+{
+    if (thread) {
+        free(thread->group_id);
+        free(thread->stop_reason);
+        gdbwire_mi_stack_frame_free(thread->frame);
+        free(thread);
+    }
+}
+
+static void
+gdbwire_thread_group_free(void *value)
+{
+    struct gdbwire_thread_group *thread_group =
+        (struct gdbwire_thread_group *)value;
+    if (thread_group) {
+        free(thread_group->id);
+        free(thread_group);
+    }
+}
+
+static void
+gdbwire_library_free(struct gdbwire_library *library)
+{
+    if (library) {
+        free(library->id);
+        free(library->target_name);
+        free(library->host_name);
+        free(library->thread_group);
+        free(library);
+    }
+}
+
+/**
+ * Grow a dense pointer array so that it can hold one more item.
+ *
+ * @param array
+ * The array to grow.
+ *
+ * @param size
+ * The number of items in the array.
+ *
+ * @param capacity
+ * The number of items allocated in the array, updated on success.
+ *
+ * @return
+ * 0 on success or -1 on error.
+ */
+static int
+gdbwire_target_state_reserve(void ***array, size_t size, size_t *capacity)
+{
+    if (size == *capacity) {
+        size_t new_capacity = (*capacity) ? *capacity * 2 : 16;
+        void **new_array = realloc(*array, new_capacity * sizeof(void *));
+        if (!new_array) {
+            return -1;
+        }
+        *array = new_array;
+        *capacity = new_capacity;
+    }
+
+    return 0;
+}
+
+struct gdbwire_target_state *
+gdbwire_target_state_create(struct gdbwire_target_state_callbacks callbacks)
+{
+    struct gdbwire_target_state *state;
+
+    state = calloc(1, sizeof(struct gdbwire_target_state));
+    if (!state) {
+        return NULL;
+    }
+
+    state->callbacks = callbacks;
+    state->threads_by_id = gdbwire_hash_create(NULL);
+    state->thread_groups = gdbwire_hash_create(gdbwire_thread_group_free);
+    state->libraries_by_id = gdbwire_hash_create(NULL);
+    if (!state->threads_by_id || !state->thread_groups ||
+            !state->libraries_by_id) {
+        gdbwire_target_state_destroy(state);
+        return NULL;
+    }
+
+    return state;
+}
+
+void
+gdbwire_target_state_destroy(struct gdbwire_target_state *state)
+{
+    size_t index;
+
+    if (state) {
+        for (index = 0; index < state->threads_size; ++index) {
+            gdbwire_thread_free(state->threads[index]);
+        }
+        free(state->threads);
+        gdbwire_hash_destroy(state->threads_by_id);
+
+        gdbwire_hash_destroy(state->thread_groups);
+
+        /* The keys of libraries_by_id are borrowed from the libraries */
+        gdbwire_hash_destroy(state->libraries_by_id);
+        for (index = 0; index < state->libraries_size; ++index) {
+            gdbwire_library_free(state->libraries[index]);
+        }
+        free(state->libraries);
+
+        free(state);
+    }
+}
+
+/**
+ * Find a result in a result list by it's variable name.
+ *
+ * @param mi_result
+ * The result list to search.
+ *
+ * @param variable
+ * The variable name to search for.
+ *
+ * @return
+ * The result or NULL if not found.
+ */
+static struct gdbwire_mi_result *
+gdbwire_target_state_find(struct gdbwire_mi_result *mi_result,
+        const char *variable)
+{
+    while (mi_result) {
+        if (mi_result->variable &&
+                strcmp(mi_result->variable, variable) == 0) {
+            return mi_result;
+        }
+        mi_result = mi_result->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * Replace a string field with a copy of a new value.
+ *
+ * @param field
+ * The field to replace, the old value is freed.
+ *
+ * @param value
+ * The new value or NULL.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_NOMEM.
+ */
+static enum gdbwire_result
+gdbwire_target_state_set_string(char **field, const char *value)
+{
+    char *copy = 0;
+
+    if (value) {
+        copy = gdbwire_strdup(value);
+        if (!copy) {
+            return GDBWIRE_NOMEM;
+        }
+    }
+
+    free(*field);
+    *field = copy;
+
+    return GDBWIRE_OK;
+}
+
+static void
+gdbwire_target_state_notify_thread(struct gdbwire_target_state *state,
+        enum gdbwire_target_state_change change, struct gdbwire_thread *thread)
+{
+    if (state->callbacks.gdbwire_thread_fn) {
+        state->callbacks.gdbwire_thread_fn(state->callbacks.context,
+            change, thread);
+    }
+}
+
+static void
+gdbwire_target_state_notify_thread_group(struct gdbwire_target_state *state,
+        enum gdbwire_target_state_change change,
+        struct gdbwire_thread_group *thread_group)
+{
+    if (state->callbacks.gdbwire_thread_group_fn) {
+        state->callbacks.gdbwire_thread_group_fn(state->callbacks.context,
+            change, thread_group);
+    }
+}
+
+static void
+gdbwire_target_state_notify_library(struct gdbwire_target_state *state,
+        enum gdbwire_target_state_change change,
+        struct gdbwire_library *library)
+{
+    if (state->callbacks.gdbwire_library_fn) {
+        state->callbacks.gdbwire_library_fn(state->callbacks.context,
+            change, library);
+    }
+}
+
+/**
+ * Convert a thread id string to a thread id.
+ *
+ * @param str
+ * The thread id string, may be NULL.
+ *
+ * @return
+ * The thread id, or 0 if str is not a valid thread id.
+ */
+static int
+gdbwire_target_state_thread_id(const char *str)
+{
+    char *end_ptr;
+    long id;
+
+    if (!str) {
+        return 0;
+    }
+
+    id = strtol(str, &end_ptr, 10);
+    if (str == end_ptr || *end_ptr != '\0' || id <= 0 || id > 0x7fffffffL) {
+        return 0;
+    }
+
+    return (int)id;
+}
+
+/**
+ * Format a thread id as a key of threads_by_id.
+ *
+ * @param id
+ * The thread id.
+ *
+ * @param key
+ * The key, GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE characters.
+ */
+static void
+gdbwire_target_state_thread_key(int id, char *key)
+{
+    snprintf(key, GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE, "%d", id);
+}
+
+struct gdbwire_thread *
+gdbwire_target_state_thread(struct gdbwire_target_state *state, int id)
+{
+    char key[GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE];
+
+    if (!state || id <= 0) {
+        return NULL;
+    }
+
+    gdbwire_target_state_thread_key(id, key);
+    return gdbwire_hash_find(state->threads_by_id, key);
+}
+
+struct gdbwire_thread **
+gdbwire_target_state_threads(struct gdbwire_target_state *state,
+        size_t *size)
+{
+    if (!state || !size) {
+        return NULL;
+    }
+
+    *size = state->threads_size;
+
+    return (state->threads_size) ? state->threads : NULL;
+}
+
+struct gdbwire_thread *
+gdbwire_target_state_selected_thread(struct gdbwire_target_state *state)
+{
+    return (state) ?
+        gdbwire_target_state_thread(state, state->selected_thread) : NULL;
+}
+
+struct gdbwire_thread_group *
+gdbwire_target_state_thread_group(struct gdbwire_target_state *state,
+        const char *id)
+{
+    return (state) ? gdbwire_hash_find(state->thread_groups, id) : NULL;
+}
+
+/**
+ * Find a library by it's thread group and id.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param thread_group
+ * The thread group the library is loaded into, or NULL if unknown.
+ *
+ * @param id
+ * The library id.
+ *
+ * @return
+ * The library or NULL if it is not loaded into the thread group.
+ */
+static struct gdbwire_target_state_library *
+gdbwire_target_state_find_library(struct gdbwire_target_state *state,
+        const char *thread_group, const char *id)
+{
+    struct gdbwire_target_state_library *library =
+        gdbwire_hash_find(state->libraries_by_id, id);
+
+    for (; library; library = library->next) {
+        const char *group = library->library.thread_group;
+        if ((group && thread_group) ? strcmp(group, thread_group) == 0 :
+                group == thread_group) {
+            break;
+        }
+    }
+
+    return library;
+}
+
+struct gdbwire_library *
+gdbwire_target_state_library(struct gdbwire_target_state *state,
+        const char *thread_group, const char *id)
+{
+    struct gdbwire_target_state_library *library = (state && id) ?
+        gdbwire_target_state_find_library(state, thread_group, id) : NULL;
+
+    return (library) ? &library->library : NULL;
+}
+
+struct gdbwire_library **
+gdbwire_target_state_libraries(struct gdbwire_target_state *state,
+        size_t *size)
+{
+    if (!state || !size) {
+        return NULL;
+    }
+
+    *size = state->libraries_size;
+
+    return (state->libraries_size) ? state->libraries : NULL;
+}
+
+/**
+ * Add a thread to the target state.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param id
+ * The thread id, must not already be in the target state.
+ *
+ * @param out
+ * The new thread on success.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_add_thread(struct gdbwire_target_state *state, int id,
+        struct gdbwire_thread **out)
+{
+    struct gdbwire_target_state_thread *thread;
+    char key[GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE];
+
+    GDBWIRE_ASSERT(id > 0);
+    GDBWIRE_ASSERT(!gdbwire_target_state_thread(state, id));
+
+    if (gdbwire_target_state_reserve((void ***)&state->threads,
+            state->threads_size, &state->threads_capacity) == -1) {
+        return GDBWIRE_NOMEM;
+    }
+
+    thread = calloc(1, sizeof(struct gdbwire_target_state_thread));
+    if (!thread) {
+        return GDBWIRE_NOMEM;
+    }
+
+    gdbwire_target_state_thread_key(id, key);
+    if (gdbwire_hash_insert(state->threads_by_id, key, thread) == -1) {
+        free(thread);
+        return GDBWIRE_NOMEM;
+    }
+
+    thread->thread.id = id;
+    thread->thread.state = GDBWIRE_THREAD_RUNNING;
+    thread->index = state->threads_size;
+
+    state->threads[state->threads_size++] = &thread->thread;
+
+    *out = &thread->thread;
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Find a thread, or add it if the target state does not know about it.
+ *
+ * Threads that GDB reports before the target state was created are
+ * implicitly added when they are first mentioned.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param id
+ * The thread id.
+ *
+ * @param out
+ * The thread on success.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_get_thread(struct gdbwire_target_state *state, int id,
+        struct gdbwire_thread **out)
+{
+    enum gdbwire_result result;
+
+    *out = gdbwire_target_state_thread(state, id);
+    if (*out) {
+        return GDBWIRE_OK;
+    }
+
+    result = gdbwire_target_state_add_thread(state, id, out);
+    if (result == GDBWIRE_OK) {
+        gdbwire_target_state_notify_thread(state,
+            GDBWIRE_TARGET_STATE_ADDED, *out);
+    }
+
+    return result;
+}
+
+/**
+ * Remove a thread from the target state.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param id
+ * The thread id, OK if it is not in the target state.
+ */
+static void
+gdbwire_target_state_remove_thread(struct gdbwire_target_state *state,
+        int id)
+{
+    struct gdbwire_target_state_thread *thread, *last;
+    char key[GDBWIRE_TARGET_STATE_THREAD_KEY_SIZE];
+
+    thread = (struct gdbwire_target_state_thread *)
+        gdbwire_target_state_thread(state, id);
+    if (!thread) {
+        return;
+    }
+
+    gdbwire_target_state_notify_thread(state,
+        GDBWIRE_TARGET_STATE_REMOVED, &thread->thread);
+
+    /* Move the last thread into the hole left by the removed thread */
+    last = (struct gdbwire_target_state_thread *)
+        state->threads[--state->threads_size];
+    state->threads[thread->index] = &last->thread;
+    last->index = thread->index;
+
+    gdbwire_target_state_thread_key(id, key);
+    gdbwire_hash_remove(state->threads_by_id, key);
+    if (state->selected_thread == id) {
+        state->selected_thread = 0;
+    }
+
+    gdbwire_thread_free(&thread->thread);
+}
+
+/**
+ * Mark a thread as running.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param thread
+ * The thread that is now running.
+ */
+static void
+gdbwire_target_state_thread_running(struct gdbwire_target_state *state,
+        struct gdbwire_thread *thread)
+{
+    thread->state = GDBWIRE_THREAD_RUNNING;
+    free(thread->stop_reason);
+    thread->stop_reason = NULL;
+    gdbwire_mi_stack_frame_free(thread->frame);
+    thread->frame = NULL;
+
+    gdbwire_target_state_notify_thread(state,
+        GDBWIRE_TARGET_STATE_MODIFIED, thread);
+}
+
+/**
+ * Handle the *running asynchronous record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_running(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    enum gdbwire_result result;
+    char *thread_id = gdbwire_get_mi_cstring(mi_result, "thread-id");
+    struct gdbwire_thread *thread;
+    size_t index;
+
+    GDBWIRE_ASSERT(thread_id);
+
+    if (strcmp(thread_id, "all") == 0) {
+        for (index = 0; index < state->threads_size; ++index) {
+            gdbwire_target_state_thread_running(state,
+                state->threads[index]);
+        }
+    } else {
+        int id = gdbwire_target_state_thread_id(thread_id);
+        GDBWIRE_ASSERT(id);
+
+        result = gdbwire_target_state_get_thread(state, id, &thread);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        gdbwire_target_state_thread_running(state, thread);
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Mark a thread as stopped, with out a frame.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param thread
+ * The thread that is now stopped.
+ */
+static void
+gdbwire_target_state_thread_stopped(struct gdbwire_target_state *state,
+        struct gdbwire_thread *thread)
+{
+    if (thread->state != GDBWIRE_THREAD_STOPPED) {
+        thread->state = GDBWIRE_THREAD_STOPPED;
+        free(thread->stop_reason);
+        thread->stop_reason = NULL;
+        gdbwire_mi_stack_frame_free(thread->frame);
+        thread->frame = NULL;
+
+        gdbwire_target_state_notify_thread(state,
+            GDBWIRE_TARGET_STATE_MODIFIED, thread);
+    }
+}
+
+/**
+ * Handle the *stopped asynchronous record.
+ *
+ * The thread in the thread-id field is the thread that caused the stop.
+ * It gets the reason and frame from the record. The other threads
+ * in the stopped-threads field are stopped with an unknown frame.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_stopped(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    enum gdbwire_result result;
+    int id = gdbwire_target_state_thread_id(
+        gdbwire_get_mi_cstring(mi_result, "thread-id"));
+    char *reason = gdbwire_get_mi_cstring(mi_result, "reason");
+    struct gdbwire_mi_result *stopped_threads =
+        gdbwire_target_state_find(mi_result, "stopped-threads");
+    struct gdbwire_mi_result *frame_result =
+        gdbwire_target_state_find(mi_result, "frame");
+    struct gdbwire_thread *thread = 0;
+    struct gdbwire_mi_stack_frame *frame = 0;
+    size_t index;
+
+    if (frame_result && frame_result->kind == GDBWIRE_MI_TUPLE &&
+            frame_result->variant.result) {
+        result = gdbwire_get_mi_stack_frame(
+            frame_result->variant.result, &frame);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+    }
+
+    if (id) {
+        result = gdbwire_target_state_get_thread(state, id, &thread);
+        if (result != GDBWIRE_OK) {
+            gdbwire_mi_stack_frame_free(frame);
+            return result;
+        }
+    }
+
+    if (stopped_threads) {
+        if (stopped_threads->kind == GDBWIRE_MI_CSTRING &&
+                strcmp(stopped_threads->variant.cstring, "all") == 0) {
+            for (index = 0; index < state->threads_size; ++index) {
+                if (state->threads[index] != thread) {
+                    gdbwire_target_state_thread_stopped(state,
+                        state->threads[index]);
+                }
+            }
+        } else if (stopped_threads->kind == GDBWIRE_MI_LIST) {
+            struct gdbwire_mi_result *cur = stopped_threads->variant.result;
+            for (; cur; cur = cur->next) {
+                struct gdbwire_thread *stopped = 0;
+                int stopped_id = (cur->kind == GDBWIRE_MI_CSTRING) ?
+                    gdbwire_target_state_thread_id(cur->variant.cstring) : 0;
+                if (!stopped_id) {
+                    continue;
+                }
+                result = gdbwire_target_state_get_thread(state, stopped_id,
+                    &stopped);
+                if (result == GDBWIRE_OK && stopped != thread) {
+                    gdbwire_target_state_thread_stopped(state, stopped);
+                }
+            }
+        }
+    }
+
+    if (thread) {
+        thread->state = GDBWIRE_THREAD_STOPPED;
+        gdbwire_mi_stack_frame_free(thread->frame);
+        thread->frame = frame;
+        frame = 0;
+        result = gdbwire_target_state_set_string(&thread->stop_reason,
+            reason);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+        state->selected_thread = thread->id;
+        gdbwire_target_state_notify_thread(state,
+            GDBWIRE_TARGET_STATE_MODIFIED, thread);
+    }
+
+    gdbwire_mi_stack_frame_free(frame);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the =thread-created asynchronous record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_thread_created(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    enum gdbwire_result result;
+    int id = gdbwire_target_state_thread_id(
+        gdbwire_get_mi_cstring(mi_result, "id"));
+    char *group_id = gdbwire_get_mi_cstring(mi_result, "group-id");
+    struct gdbwire_thread *thread = gdbwire_target_state_thread(state, id);
+    int added = thread == 0;
+
+    GDBWIRE_ASSERT(id);
+
+    if (added) {
+        result = gdbwire_target_state_add_thread(state, id, &thread);
+        if (result != GDBWIRE_OK) {
+            return result;
+        }
+    }
+
+    result = gdbwire_target_state_set_string(&thread->group_id, group_id);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    gdbwire_target_state_notify_thread(state, (added) ?
+        GDBWIRE_TARGET_STATE_ADDED : GDBWIRE_TARGET_STATE_MODIFIED, thread);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the =thread-selected asynchronous record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_thread_selected(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    enum gdbwire_result result;
+    int id = gdbwire_target_state_thread_id(
+        gdbwire_get_mi_cstring(mi_result, "id"));
+    struct gdbwire_thread *thread;
+
+    GDBWIRE_ASSERT(id);
+
+    result = gdbwire_target_state_get_thread(state, id, &thread);
+    if (result != GDBWIRE_OK) {
+        return result;
+    }
+
+    state->selected_thread = id;
+
+    if (state->callbacks.gdbwire_thread_selected_fn) {
+        state->callbacks.gdbwire_thread_selected_fn(
+            state->callbacks.context, thread);
+    }
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Remove a library from the target state.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param library
+ * The library to remove, it is freed.
+ */
+static void
+gdbwire_target_state_remove_library(struct gdbwire_target_state *state,
+        struct gdbwire_target_state_library *library)
+{
+    struct gdbwire_target_state_library *prev;
+    struct gdbwire_library *last;
+
+    gdbwire_target_state_notify_library(state,
+        GDBWIRE_TARGET_STATE_REMOVED, &library->library);
+
+    prev = gdbwire_hash_find(state->libraries_by_id, library->library.id);
+    if (prev == library) {
+        /**
+         * The key is borrowed from the library, so the entry is removed
+         * and the next library, if any, is inserted with it's own id.
+         * That insert does not grow the hash table, so it can not fail.
+         */
+        gdbwire_hash_remove(state->libraries_by_id, library->library.id);
+        if (library->next) {
+            gdbwire_hash_insert_borrowed(state->libraries_by_id,
+                library->next->library.id, library->next);
+        }
+    } else {
+        while (prev->next != library) {
+            prev = prev->next;
+        }
+        prev->next = library->next;
+    }
+
+    /* Move the last library into the hole left by the removed one */
+    last = state->libraries[--state->libraries_size];
+    state->libraries[library->index] = last;
+    ((struct gdbwire_target_state_library *)last)->index = library->index;
+
+    gdbwire_library_free(&library->library);
+}
+
+/**
+ * Handle the =thread-group-* asynchronous records.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param async_class
+ * The asynchronous class, one of the thread group classes.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_thread_group_record(struct gdbwire_target_state *state,
+        enum gdbwire_mi_async_class async_class,
+        struct gdbwire_mi_result *mi_result)
+{
+    char *id = gdbwire_get_mi_cstring(mi_result, "id");
+    char *pid = gdbwire_get_mi_cstring(mi_result, "pid");
+    char *exit_code = gdbwire_get_mi_cstring(mi_result, "exit-code");
+    struct gdbwire_thread_group *thread_group;
+    int added = 0;
+
+    GDBWIRE_ASSERT(id);
+
+    thread_group = gdbwire_hash_find(state->thread_groups, id);
+
+    if (async_class == GDBWIRE_MI_ASYNC_THREAD_GROUP_REMOVED) {
+        if (thread_group) {
+            gdbwire_target_state_notify_thread_group(state,
+                GDBWIRE_TARGET_STATE_REMOVED, thread_group);
+            gdbwire_hash_remove(state->thread_groups, id);
+        }
+        return GDBWIRE_OK;
+    }
+
+    if (!thread_group) {
+        thread_group = calloc(1, sizeof(struct gdbwire_thread_group));
+        if (!thread_group) {
+            return GDBWIRE_NOMEM;
+        }
+        thread_group->id = gdbwire_strdup(id);
+        if (!thread_group->id ||
+                gdbwire_hash_insert(state->thread_groups, id,
+                    thread_group) == -1) {
+            gdbwire_thread_group_free(thread_group);
+            return GDBWIRE_NOMEM;
+        }
+        added = 1;
+    }
+
+    if (async_class == GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED) {
+        thread_group->started = 1;
+        thread_group->exited = 0;
+        thread_group->exit_code = 0;
+        thread_group->pid = (pid) ? atoi(pid) : 0;
+    } else if (async_class == GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED) {
+        size_t index = 0;
+
+        thread_group->started = 0;
+        thread_group->pid = 0;
+        thread_group->exited = exit_code != 0;
+        /* GDB outputs the exit code in octal, ie. exit-code="01" */
+        thread_group->exit_code =
+            (exit_code) ? (int)strtol(exit_code, 0, 0) : 0;
+
+        /* The libraries of the exited process are gone as well */
+        while (index < state->libraries_size) {
+            struct gdbwire_library *library = state->libraries[index];
+            if (library->thread_group &&
+                    strcmp(library->thread_group, id) == 0) {
+                gdbwire_target_state_remove_library(state,
+                    (struct gdbwire_target_state_library *)library);
+            } else {
+                ++index;
+            }
+        }
+    }
+
+    gdbwire_target_state_notify_thread_group(state, (added) ?
+        GDBWIRE_TARGET_STATE_ADDED : GDBWIRE_TARGET_STATE_MODIFIED,
+            thread_group);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the =library-loaded asynchronous record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_library_loaded(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    char *id = gdbwire_get_mi_cstring(mi_result, "id");
+    char *target_name =
+        gdbwire_get_mi_cstring(mi_result, "target-name");
+    char *host_name = gdbwire_get_mi_cstring(mi_result, "host-name");
+    char *thread_group =
+        gdbwire_get_mi_cstring(mi_result, "thread-group");
+    char *symbols_loaded =
+        gdbwire_get_mi_cstring(mi_result, "symbols-loaded");
+    struct gdbwire_target_state_library *found, *first;
+    struct gdbwire_library *library;
+    int added = 0;
+
+    GDBWIRE_ASSERT(id);
+
+    found = gdbwire_target_state_find_library(state, thread_group, id);
+    if (found) {
+        library = &found->library;
+    } else {
+        struct gdbwire_target_state_library *new_library;
+
+        if (gdbwire_target_state_reserve((void ***)&state->libraries,
+                state->libraries_size, &state->libraries_capacity) == -1) {
+            return GDBWIRE_NOMEM;
+        }
+
+        new_library = calloc(1, sizeof(struct gdbwire_target_state_library));
+        if (!new_library) {
+            return GDBWIRE_NOMEM;
+        }
+        library = &new_library->library;
+        library->id = gdbwire_strdup(id);
+        if (!library->id || gdbwire_target_state_set_string(
+                &library->thread_group, thread_group) != GDBWIRE_OK) {
+            gdbwire_library_free(library);
+            return GDBWIRE_NOMEM;
+        }
+
+        /* The same library in another thread group is linked after it */
+        first = gdbwire_hash_find(state->libraries_by_id, id);
+        if (first) {
+            new_library->next = first->next;
+            first->next = new_library;
+        } else if (gdbwire_hash_insert_borrowed(state->libraries_by_id,
+                library->id, new_library) == -1) {
+            gdbwire_library_free(library);
+            return GDBWIRE_NOMEM;
+        }
+        new_library->index = state->libraries_size;
+        state->libraries[state->libraries_size++] = library;
+        added = 1;
+    }
+
+    if (gdbwire_target_state_set_string(&library->target_name,
+            target_name) != GDBWIRE_OK ||
+        gdbwire_target_state_set_string(&library->host_name,
+            host_name) != GDBWIRE_OK) {
+        return GDBWIRE_NOMEM;
+    }
+    library->symbols_loaded = symbols_loaded && symbols_loaded[0] == '1';
+
+    gdbwire_target_state_notify_library(state, (added) ?
+        GDBWIRE_TARGET_STATE_ADDED : GDBWIRE_TARGET_STATE_MODIFIED, library);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Handle the =library-unloaded asynchronous record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param mi_result
+ * The results of the asynchronous record.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_target_state_library_unloaded(struct gdbwire_target_state *state,
+        struct gdbwire_mi_result *mi_result)
+{
+    char *id = gdbwire_get_mi_cstring(mi_result, "id");
+    char *thread_group =
+        gdbwire_get_mi_cstring(mi_result, "thread-group");
+    struct gdbwire_target_state_library *library;
+
+    GDBWIRE_ASSERT(id);
+
+    library = gdbwire_target_state_find_library(state, thread_group, id);
+    if (library) {
+        gdbwire_target_state_remove_library(state, library);
+    }
+
+    return GDBWIRE_OK;
+}
+
+enum gdbwire_result
+gdbwire_target_state_async_record(struct gdbwire_target_state *state,
+        struct gdbwire_mi_async_record *async_record)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_result *mi_result;
+
+    GDBWIRE_ASSERT(state);
+    GDBWIRE_ASSERT(async_record);
+
+    mi_result = async_record->result;
+
+    switch (async_record->async_class) {
+        case GDBWIRE_MI_ASYNC_RUNNING:
+            result = gdbwire_target_state_running(state, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_STOPPED:
+            result = gdbwire_target_state_stopped(state, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_CREATED:
+            result = gdbwire_target_state_thread_created(state, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_EXITED: {
+            int id = gdbwire_target_state_thread_id(
+                gdbwire_get_mi_cstring(mi_result, "id"));
+            GDBWIRE_ASSERT(id);
+            gdbwire_target_state_remove_thread(state, id);
+            break;
+        }
+        case GDBWIRE_MI_ASYNC_THREAD_SELECTED:
+            result = gdbwire_target_state_thread_selected(state, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_ADDED:
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_REMOVED:
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED:
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED:
+            result = gdbwire_target_state_thread_group_record(state,
+                async_record->async_class, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_LIBRARY_LOADED:
+            result = gdbwire_target_state_library_loaded(state, mi_result);
+            break;
+        case GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED:
+            result = gdbwire_target_state_library_unloaded(state, mi_result);
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
@@ -0,0 +1,349 @@
+#ifndef GDBWIRE_TARGET_STATE_H
+#define GDBWIRE_TARGET_STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_pt.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A model of the target built incrementally from asynchronous records.
+ *
+ * GDB tells the front end about threads starting, stopping and exiting,
+ * thread groups (inferiors) coming and going and shared libraries being
+ * loaded and unloaded through asynchronous records. The target state
+ * consumes those records and keeps,
+ * - a thread table indexed by thread id, with the frame each
+ *   thread last stopped at
+ * - a thread group table indexed by thread group id
+ * - a library table indexed by thread group and library id
+ *
+ * A front end can then answer questions like "what threads exist" or
+ * "where did thread 3 stop" without issuing -thread-info or
+ * -stack-info-frame after every *stopped record.
+ *
+ * The target state only knows what it has been told. If it is created
+ * after GDB has already started the inferior, the front end should still
+ * seed itself with a -thread-info command once.
+ */
+struct gdbwire_target_state;
+
+/** The execution state of a thread. */
+enum gdbwire_thread_state {
+    /** The thread is running */
+    GDBWIRE_THREAD_RUNNING,
+    /** The thread is stopped */
+    GDBWIRE_THREAD_STOPPED
+};
+
+/** A thread in the target. */
+struct gdbwire_thread {
+    /** The global thread id, as used by the GDB/MI thread-id fields. */
+    int id;
+
+    /** The thread group the thread belongs to, ie. "i1", or NULL. */
+    char *group_id;
+
+    /** If the thread is running or stopped. */
+    enum gdbwire_thread_state state;
+
+    /**
+     * The reason the thread last stopped, ie. "breakpoint-hit".
+     *
+     * NULL if the thread is running or if GDB did not provide a reason.
+     */
+    char *stop_reason;
+
+    /**
+     * The frame the thread last stopped at.
+     *
+     * NULL if the thread is running or the frame is unknown.
+     */
+    struct gdbwire_mi_stack_frame *frame;
+};
+
+/** A thread group in the target. */
+struct gdbwire_thread_group {
+    /** The thread group id, ie. "i1". */
+    char *id;
+
+    /** The process id of the thread group or 0 if not started. */
+    int pid;
+
+    /** True if the thread group has a running process, otherwise false. */
+    unsigned char started:1;
+
+    /** True if the exit_code field is valid, otherwise false. */
+    unsigned char exited:1;
+
+    /** The exit code of the last process of this thread group. */
+    int exit_code;
+};
+
+/** A shared library loaded into the target. */
+struct gdbwire_library {
+    /** The library id, never NULL. */
+    char *id;
+
+    /** The name of the library on the target or NULL if unknown. */
+    char *target_name;
+
+    /** The name of the library on the host or NULL if unknown. */
+    char *host_name;
+
+    /** The thread group the library is loaded into or NULL if unknown. */
+    char *thread_group;
+
+    /** True if GDB has loaded the debug symbols for the library. */
+    unsigned char symbols_loaded:1;
+};
+
+/** The changes the target state reports through it's callbacks. */
+enum gdbwire_target_state_change {
+    /** A thread, thread group or library was added. */
+    GDBWIRE_TARGET_STATE_ADDED,
+    /** A thread, thread group or library was modified. */
+    GDBWIRE_TARGET_STATE_MODIFIED,
+    /**
+     * A thread, thread group or library is being removed.
+     *
+     * The object is still valid during the callback, but is freed
+     * right after it.
+     */
+    GDBWIRE_TARGET_STATE_REMOVED
+};
+
+/**
+ * The change notifications of the target state.
+ *
+ * All of the callbacks are optional, NULL callbacks are not called.
+ */
+struct gdbwire_target_state_callbacks {
+    /**
+     * An arbitrary pointer to associate with the callbacks.
+     *
+     * This pointer will be passed back to the caller in each callback.
+     */
+    void *context;
+
+    /**
+     * A thread changed.
+     *
+     * For instance, it was created, it started running, it stopped
+     * or it exited.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param change
+     * How the thread changed.
+     *
+     * @param thread
+     * The thread that changed.
+     */
+    void (*gdbwire_thread_fn)(void *context,
+            enum gdbwire_target_state_change change,
+            struct gdbwire_thread *thread);
+
+    /**
+     * A thread group changed.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param change
+     * How the thread group changed.
+     *
+     * @param thread_group
+     * The thread group that changed.
+     */
+    void (*gdbwire_thread_group_fn)(void *context,
+            enum gdbwire_target_state_change change,
+            struct gdbwire_thread_group *thread_group);
+
+    /**
+     * A library was loaded or unloaded.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param change
+     * How the library changed.
+     *
+     * @param library
+     * The library that changed.
+     */
+    void (*gdbwire_library_fn)(void *context,
+            enum gdbwire_target_state_change change,
+            struct gdbwire_library *library);
+
+    /**
+     * The selected thread changed.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param thread
+     * The newly selected thread.
+     */
+    void (*gdbwire_thread_selected_fn)(void *context,
+            struct gdbwire_thread *thread);
+};
+
+/**
+ * Create a target state instance.
+ *
+ * @param callbacks
+ * The change notifications to invoke.
+ *
+ * @return
+ * A new target state instance or NULL on error.
+ */
+struct gdbwire_target_state *gdbwire_target_state_create(
+        struct gdbwire_target_state_callbacks callbacks);
+
+/**
+ * Destroy a target state instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param state
+ * The instance to destroy.
+ */
+void gdbwire_target_state_destroy(struct gdbwire_target_state *state);
+
+/**
+ * Update the target state with an asynchronous record.
+ *
+ * Asynchronous records that do not affect the target state are ignored.
+ *
+ * If the target state is attached to a gdbwire instance with
+ * gdbwire_set_target_state, gdbwire calls this function for you.
+ *
+ * @param state
+ * The target state to update.
+ *
+ * @param async_record
+ * The asynchronous record GDB output.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_target_state_async_record(
+        struct gdbwire_target_state *state,
+        struct gdbwire_mi_async_record *async_record);
+
+/**
+ * Find a thread by it's id.
+ *
+ * @param state
+ * The target state to search.
+ *
+ * @param id
+ * The global thread id.
+ *
+ * @return
+ * The thread or NULL if there is no thread with that id.
+ */
+struct gdbwire_thread *gdbwire_target_state_thread(
+        struct gdbwire_target_state *state, int id);
+
+/**
+ * Get all of the threads.
+ *
+ * The threads are in no particular order. The array is only valid until
+ * the target state is updated again.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param size
+ * Will return the number of threads in the array.
+ *
+ * @return
+ * An array of threads or NULL if there are no threads.
+ */
+struct gdbwire_thread **gdbwire_target_state_threads(
+        struct gdbwire_target_state *state, size_t *size);
+
+/**
+ * Get the selected thread.
+ *
+ * This is the thread from the last =thread-selected or *stopped record.
+ *
+ * @param state
+ * The target state.
+ *
+ * @return
+ * The selected thread or NULL if no thread is selected.
+ */
+struct gdbwire_thread *gdbwire_target_state_selected_thread(
+        struct gdbwire_target_state *state);
+
+/**
+ * Find a thread group by it's id.
+ *
+ * @param state
+ * The target state to search.
+ *
+ * @param id
+ * The thread group id, ie. "i1".
+ *
+ * @return
+ * The thread group or NULL if there is no thread group with that id.
+ */
+struct gdbwire_thread_group *gdbwire_target_state_thread_group(
+        struct gdbwire_target_state *state, const char *id);
+
+/**
+ * Find a library by it's thread group and id.
+ *
+ * Each thread group loads it's own copy of a library, so the same
+ * library id may be loaded into several thread groups at once.
+ *
+ * @param state
+ * The target state to search.
+ *
+ * @param thread_group
+ * The thread group the library is loaded into, ie. "i1", or NULL for
+ * a library GDB did not give a thread group.
+ *
+ * @param id
+ * The library id.
+ *
+ * @return
+ * The library or NULL if there is no library with that id loaded into
+ * the thread group.
+ */
+struct gdbwire_library *gdbwire_target_state_library(
+        struct gdbwire_target_state *state, const char *thread_group,
+        const char *id);
+
+/**
+ * Get all of the loaded libraries.
+ *
+ * The libraries are in the order they were loaded, except that
+ * unloading a library moves the last library into it's place.
+ * The array is only valid until the target state is updated again.
+ *
+ * @param state
+ * The target state.
+ *
+ * @param size
+ * Will return the number of libraries in the array.
+ *
+ * @return
+ * An array of libraries or NULL if there are no libraries.
+ */
+struct gdbwire_library **gdbwire_target_state_libraries(
+        struct gdbwire_target_state *state, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
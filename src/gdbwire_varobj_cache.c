@@ -0,0 +1,384 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_assert.h"
+#include "gdbwire_hash.h"
+#include "gdbwire_varobj_cache.h"
+
+/**
+ * The variable object as stored in the cache.
+ *
+ * The public variable object must be the first member so that a pointer
+ * to the public variable object can be converted back into this structure.
+ */
+struct gdbwire_varobj_cache_entry {
+    struct gdbwire_varobj varobj;
+    /* The number of entries allocated in the children array */
+    size_t children_capacity;
+};
+
+struct gdbwire_varobj_cache {
+    /* The client callback functions */
+    struct gdbwire_varobj_cache_callbacks callbacks;
+
+    /* The variable objects indexed by name, owns the variable objects */
+    struct gdbwire_hash *varobjs;
+};
+
+/**
+ * Free a variable object cache entry.
+ *
+ * The children are not freed, they are entries of their own.
+ *
+ * @param value
+ * The entry to free.
+ */
+static void
+gdbwire_varobj_cache_entry_free(void *value)
+{
+    struct gdbwire_varobj *varobj = (struct gdbwire_varobj *)value;
+    gdbwire_mi_varobj_free(varobj->varobj);
+    free(varobj->children);
+    free(varobj);
+}
+
+static void
+gdbwire_varobj_cache_notify(struct gdbwire_varobj_cache *cache,
+        enum gdbwire_varobj_cache_change change,
+        struct gdbwire_varobj *varobj)
+{
+    if (cache->callbacks.gdbwire_varobj_fn) {
+        cache->callbacks.gdbwire_varobj_fn(cache->callbacks.context,
+            change, varobj);
+    }
+}
+
+struct gdbwire_varobj_cache *
+gdbwire_varobj_cache_create(struct gdbwire_varobj_cache_callbacks callbacks)
+{
+    struct gdbwire_varobj_cache *cache;
+
+    cache = calloc(1, sizeof(struct gdbwire_varobj_cache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->callbacks = callbacks;
+    cache->varobjs = gdbwire_hash_create(gdbwire_varobj_cache_entry_free);
+    if (!cache->varobjs) {
+        free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void
+gdbwire_varobj_cache_destroy(struct gdbwire_varobj_cache *cache)
+{
+    if (cache) {
+        gdbwire_hash_destroy(cache->varobjs);
+        free(cache);
+    }
+}
+
+/**
+ * Delete a variable object and all of it's children from the cache.
+ *
+ * The variable object is not removed from the children of it's parent,
+ * see gdbwire_varobj_cache_detach.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param varobj
+ * The variable object to delete.
+ */
+static void
+gdbwire_varobj_cache_delete_tree(struct gdbwire_varobj_cache *cache,
+        struct gdbwire_varobj *varobj)
+{
+    size_t index;
+
+    for (index = 0; index < varobj->children_size; ++index) {
+        gdbwire_varobj_cache_delete_tree(cache, varobj->children[index]);
+    }
+    varobj->children_size = 0;
+
+    gdbwire_varobj_cache_notify(cache, GDBWIRE_VAROBJ_CACHE_DELETED, varobj);
+    gdbwire_hash_remove(cache->varobjs, varobj->varobj->name);
+}
+
+/**
+ * Remove a variable object from the children of it's parent.
+ *
+ * @param varobj
+ * The variable object to remove.
+ */
+static void
+gdbwire_varobj_cache_detach(struct gdbwire_varobj *varobj)
+{
+    struct gdbwire_varobj *parent = varobj->parent;
+    size_t index;
+
+    if (!parent) {
+        return;
+    }
+
+    for (index = 0; index < parent->children_size; ++index) {
+        if (parent->children[index] == varobj) {
+            memmove(&parent->children[index], &parent->children[index + 1],
+                (parent->children_size - index - 1) *
+                    sizeof(struct gdbwire_varobj *));
+            parent->children_size--;
+            break;
+        }
+    }
+}
+
+/**
+ * Add or modify a variable object in the cache.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param parent
+ * The parent of the variable object or NULL if it is a root.
+ *
+ * @param mi_varobj
+ * The variable object as GDB reported it. The cache takes ownership
+ * of it, even on failure.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_varobj_cache_add(struct gdbwire_varobj_cache *cache,
+        struct gdbwire_varobj *parent, struct gdbwire_mi_varobj *mi_varobj)
+{
+    struct gdbwire_varobj_cache_entry *entry;
+    struct gdbwire_varobj_cache_entry *parent_entry =
+        (struct gdbwire_varobj_cache_entry *)parent;
+
+    mi_varobj->next = 0;
+
+    entry = gdbwire_hash_find(cache->varobjs, mi_varobj->name);
+    if (entry) {
+        gdbwire_mi_varobj_free(entry->varobj.varobj);
+        entry->varobj.varobj = mi_varobj;
+        entry->varobj.in_scope = GDBWIRE_MI_VAROBJ_IN_SCOPE;
+        gdbwire_varobj_cache_notify(cache,
+            GDBWIRE_VAROBJ_CACHE_MODIFIED, &entry->varobj);
+        return GDBWIRE_OK;
+    }
+
+    if (parent_entry &&
+            parent->children_size == parent_entry->children_capacity) {
+        size_t capacity = (parent_entry->children_capacity) ?
+            parent_entry->children_capacity * 2 : 8;
+        struct gdbwire_varobj **children = realloc(parent->children,
+            capacity * sizeof(struct gdbwire_varobj *));
+        if (!children) {
+            gdbwire_mi_varobj_free(mi_varobj);
+            return GDBWIRE_NOMEM;
+        }
+        parent->children = children;
+        parent_entry->children_capacity = capacity;
+    }
+
+    entry = calloc(1, sizeof(struct gdbwire_varobj_cache_entry));
+    if (!entry) {
+        gdbwire_mi_varobj_free(mi_varobj);
+        return GDBWIRE_NOMEM;
+    }
+    entry->varobj.varobj = mi_varobj;
+    entry->varobj.in_scope = GDBWIRE_MI_VAROBJ_IN_SCOPE;
+    entry->varobj.parent = parent;
+
+    if (gdbwire_hash_insert(cache->varobjs, mi_varobj->name, entry) == -1) {
+        gdbwire_varobj_cache_entry_free(entry);
+        return GDBWIRE_NOMEM;
+    }
+
+    if (parent) {
+        parent->children[parent->children_size++] = &entry->varobj;
+    }
+
+    gdbwire_varobj_cache_notify(cache,
+        GDBWIRE_VAROBJ_CACHE_ADDED, &entry->varobj);
+
+    return GDBWIRE_OK;
+}
+
+/**
+ * Add a list of children to a variable object.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param parent
+ * The variable object the children belong to.
+ *
+ * @param children
+ * The children. The cache takes ownership of them, even on failure.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+static enum gdbwire_result
+gdbwire_varobj_cache_add_children(struct gdbwire_varobj_cache *cache,
+        struct gdbwire_varobj *parent, struct gdbwire_mi_varobj *children)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_varobj *cur, *next;
+
+    for (cur = children; cur; cur = next) {
+        next = cur->next;
+        if (result == GDBWIRE_OK) {
+            result = gdbwire_varobj_cache_add(cache, parent, cur);
+        } else {
+            gdbwire_mi_varobj_free(cur);
+        }
+    }
+
+    return result;
+}
+
+enum gdbwire_result
+gdbwire_varobj_cache_var_create(struct gdbwire_varobj_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_mi_varobj *varobj;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_VAR_CREATE);
+    GDBWIRE_ASSERT(mi_command->variant.var_create.varobj);
+
+    varobj = mi_command->variant.var_create.varobj;
+    mi_command->variant.var_create.varobj = 0;
+
+    return gdbwire_varobj_cache_add(cache, NULL, varobj);
+}
+
+enum gdbwire_result
+gdbwire_varobj_cache_var_list_children(struct gdbwire_varobj_cache *cache,
+        const char *parent, struct gdbwire_mi_command *mi_command)
+{
+    struct gdbwire_varobj *varobj;
+    struct gdbwire_mi_varobj *children;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(parent);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_VAR_LIST_CHILDREN);
+
+    varobj = gdbwire_hash_find(cache->varobjs, parent);
+    if (!varobj) {
+        return GDBWIRE_LOGIC;
+    }
+
+    children = mi_command->variant.var_list_children.children;
+    mi_command->variant.var_list_children.children = 0;
+
+    varobj->varobj->has_more = mi_command->variant.var_list_children.has_more;
+
+    return gdbwire_varobj_cache_add_children(cache, varobj, children);
+}
+
+enum gdbwire_result
+gdbwire_varobj_cache_var_update(struct gdbwire_varobj_cache *cache,
+        struct gdbwire_mi_command *mi_command)
+{
+    enum gdbwire_result result = GDBWIRE_OK;
+    struct gdbwire_mi_varobj_change *change;
+    struct gdbwire_varobj *varobj;
+    struct gdbwire_mi_varobj *mi_varobj;
+    struct gdbwire_mi_varobj *new_children;
+    char *tmp;
+    size_t index;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(mi_command);
+    GDBWIRE_ASSERT(mi_command->kind == GDBWIRE_MI_VAR_UPDATE);
+
+    change = mi_command->variant.var_update.changes;
+    for (; change && result == GDBWIRE_OK; change = change->next) {
+        varobj = gdbwire_hash_find(cache->varobjs, change->name);
+        if (!varobj) {
+            continue;
+        }
+
+        mi_varobj = varobj->varobj;
+        varobj->in_scope = change->in_scope;
+
+        /* GDB deletes the children of a variable object whose type changed */
+        if (change->type_changed) {
+            for (index = 0; index < varobj->children_size; ++index) {
+                gdbwire_varobj_cache_delete_tree(cache,
+                    varobj->children[index]);
+            }
+            varobj->children_size = 0;
+
+            if (change->new_type) {
+                tmp = mi_varobj->type;
+                mi_varobj->type = change->new_type;
+                change->new_type = tmp;
+            }
+        }
+
+        if (change->value) {
+            tmp = mi_varobj->value;
+            mi_varobj->value = change->value;
+            change->value = tmp;
+        }
+
+        if (change->new_num_children >= 0) {
+            mi_varobj->numchild = change->new_num_children;
+        }
+        mi_varobj->has_more = change->has_more;
+
+        gdbwire_varobj_cache_notify(cache,
+            GDBWIRE_VAROBJ_CACHE_MODIFIED, varobj);
+
+        new_children = change->new_children;
+        change->new_children = 0;
+        result = gdbwire_varobj_cache_add_children(cache, varobj,
+            new_children);
+    }
+
+    return result;
+}
+
+enum gdbwire_result
+gdbwire_varobj_cache_delete(struct gdbwire_varobj_cache *cache,
+        const char *name)
+{
+    struct gdbwire_varobj *varobj;
+
+    GDBWIRE_ASSERT(cache);
+    GDBWIRE_ASSERT(name);
+
+    varobj = gdbwire_hash_find(cache->varobjs, name);
+    if (!varobj) {
+        return GDBWIRE_LOGIC;
+    }
+
+    gdbwire_varobj_cache_detach(varobj);
+    gdbwire_varobj_cache_delete_tree(cache, varobj);
+
+    return GDBWIRE_OK;
+}
+
+struct gdbwire_varobj *
+gdbwire_varobj_cache_find(struct gdbwire_varobj_cache *cache,
+        const char *name)
+{
+    return (cache && name) ? gdbwire_hash_find(cache->varobjs, name) : NULL;
+}
+
+size_t
+gdbwire_varobj_cache_size(struct gdbwire_varobj_cache *cache)
+{
+    return (cache) ? gdbwire_hash_size(cache->varobjs) : 0;
+}
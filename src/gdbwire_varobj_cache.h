@@ -0,0 +1,239 @@
+#ifndef GDBWIRE_VAROBJ_CACHE_H
+#define GDBWIRE_VAROBJ_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "gdbwire_result.h"
+#include "gdbwire_mi_command.h"
+
+/**
+ * A cache of GDB variable objects.
+ *
+ * Watch windows typically run -var-update after every step. GDB only
+ * reports the variable objects that changed in the changelist, so by
+ * keeping the variable objects in a cache indexed by name, a refresh
+ * only costs as much as the number of variable objects that changed,
+ * rather than the number of variable objects being watched.
+ *
+ * The cache is filled from the decoded -var-create and -var-list-children
+ * commands and updated in place from the decoded -var-update command.
+ */
+struct gdbwire_varobj_cache;
+
+/** A variable object in the cache. */
+struct gdbwire_varobj {
+    /**
+     * The variable object as GDB last reported it.
+     *
+     * This is never NULL. The next field is always NULL.
+     */
+    struct gdbwire_mi_varobj *varobj;
+
+    /** If the variable object is in scope, as of the last -var-update. */
+    enum gdbwire_mi_varobj_scope in_scope;
+
+    /** The parent variable object or NULL if this is a root. */
+    struct gdbwire_varobj *parent;
+
+    /**
+     * The children of the variable object that have been listed,
+     * in the order they were listed. NULL if there are none.
+     */
+    struct gdbwire_varobj **children;
+
+    /** The number of children in the children array. */
+    size_t children_size;
+};
+
+/** The changes the variable object cache reports through it's callbacks. */
+enum gdbwire_varobj_cache_change {
+    /** A variable object was added. */
+    GDBWIRE_VAROBJ_CACHE_ADDED,
+    /** A variable object was modified. */
+    GDBWIRE_VAROBJ_CACHE_MODIFIED,
+    /**
+     * A variable object is being deleted.
+     *
+     * The variable object is still valid during the callback, but is
+     * freed right after it. The children of a variable object are
+     * deleted before the variable object itself.
+     */
+    GDBWIRE_VAROBJ_CACHE_DELETED
+};
+
+/**
+ * The change notifications of the variable object cache.
+ *
+ * All of the callbacks are optional, NULL callbacks are not called.
+ */
+struct gdbwire_varobj_cache_callbacks {
+    /**
+     * An arbitrary pointer to associate with the callbacks.
+     *
+     * This pointer will be passed back to the caller in each callback.
+     */
+    void *context;
+
+    /**
+     * A variable object changed.
+     *
+     * @param context
+     * The context pointer above.
+     *
+     * @param change
+     * How the variable object changed.
+     *
+     * @param varobj
+     * The variable object that changed.
+     */
+    void (*gdbwire_varobj_fn)(void *context,
+            enum gdbwire_varobj_cache_change change,
+            struct gdbwire_varobj *varobj);
+};
+
+/**
+ * Create a variable object cache instance.
+ *
+ * @param callbacks
+ * The change notifications to invoke.
+ *
+ * @return
+ * A new variable object cache instance or NULL on error.
+ */
+struct gdbwire_varobj_cache *gdbwire_varobj_cache_create(
+        struct gdbwire_varobj_cache_callbacks callbacks);
+
+/**
+ * Destroy a variable object cache instance.
+ *
+ * This function will do nothing if the instance is NULL.
+ *
+ * @param cache
+ * The instance to destroy.
+ */
+void gdbwire_varobj_cache_destroy(struct gdbwire_varobj_cache *cache);
+
+/**
+ * Add the variable object created by -var-create to the cache.
+ *
+ * The cache takes ownership of the variable object in the command,
+ * the varobj field of the command is NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param mi_command
+ * The decoded -var-create command, of kind GDBWIRE_MI_VAR_CREATE.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_varobj_cache_var_create(
+        struct gdbwire_varobj_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Add the children listed by -var-list-children to the cache.
+ *
+ * The -var-list-children output does not say which variable object the
+ * children belong to, so the caller passes in the name it listed.
+ * Children that are already in the cache are modified, the rest are
+ * added after the children the parent already has.
+ *
+ * The cache takes ownership of the children in the command,
+ * the children field of the command is NULL on the way out.
+ * The caller still has to free the command with gdbwire_mi_command_free.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param parent
+ * The name of the variable object whose children were listed.
+ *
+ * @param mi_command
+ * The decoded -var-list-children command,
+ * of kind GDBWIRE_MI_VAR_LIST_CHILDREN.
+ *
+ * @return
+ * GDBWIRE_OK on success, GDBWIRE_LOGIC if the parent is not in the
+ * cache, or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_varobj_cache_var_list_children(
+        struct gdbwire_varobj_cache *cache, const char *parent,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Apply the -var-update changelist to the cache.
+ *
+ * Only the variable objects in the changelist are touched. A variable
+ * object whose type changed loses it's children, as it does in GDB.
+ * Changes to variable objects that are not in the cache are ignored.
+ *
+ * The new values in the changelist are moved into the cache, the value
+ * fields of the changes are left holding the old values.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param mi_command
+ * The decoded -var-update command, of kind GDBWIRE_MI_VAR_UPDATE.
+ *
+ * @return
+ * GDBWIRE_OK on success or appropriate error result on failure.
+ */
+enum gdbwire_result gdbwire_varobj_cache_var_update(
+        struct gdbwire_varobj_cache *cache,
+        struct gdbwire_mi_command *mi_command);
+
+/**
+ * Delete a variable object and it's children from the cache.
+ *
+ * This is to be called after a successful -var-delete.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @param name
+ * The name of the variable object to delete.
+ *
+ * @return
+ * GDBWIRE_OK on success or GDBWIRE_LOGIC if it is not in the cache.
+ */
+enum gdbwire_result gdbwire_varobj_cache_delete(
+        struct gdbwire_varobj_cache *cache, const char *name);
+
+/**
+ * Find a variable object by it's name.
+ *
+ * @param cache
+ * The variable object cache to search.
+ *
+ * @param name
+ * The variable object name, ie. "var1.count".
+ *
+ * @return
+ * The variable object or NULL if there is none with that name.
+ */
+struct gdbwire_varobj *gdbwire_varobj_cache_find(
+        struct gdbwire_varobj_cache *cache, const char *name);
+
+/**
+ * Get the number of variable objects in the cache.
+ *
+ * @param cache
+ * The variable object cache.
+ *
+ * @return
+ * The number of variable objects, including children.
+ */
+size_t gdbwire_varobj_cache_size(struct gdbwire_varobj_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
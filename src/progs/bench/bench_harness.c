@@ -0,0 +1,91 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "gdbwire_sys.h"
+#include "bench_harness.h"
+
+/**
+ * Compare two doubles for qsort.
+ */
+static int
+bench_compare_double(const void *left, const void *right)
+{
+    double l = *(const double *)left, r = *(const double *)right;
+    return (l < r) ? -1 : (l > r);
+}
+
+/**
+ * Time a batch of calls to a benchmark.
+ *
+ * @param fn
+ * The benchmark.
+ *
+ * @param context
+ * The context passed to fn.
+ *
+ * @param batch
+ * The number of times to call fn.
+ *
+ * @return
+ * The nanoseconds the batch took.
+ */
+static uint64_t
+bench_time_batch(bench_fn fn, void *context, long batch)
+{
+    uint64_t start = gdbwire_clock_ns();
+    long index;
+
+    for (index = 0; index < batch; ++index) {
+        fn(context);
+    }
+
+    return gdbwire_clock_ns() - start;
+}
+
+int
+bench_run(const struct bench_options *options, bench_fn fn,
+        void *context, struct bench_result *result)
+{
+    double *times, sum = 0, variance = 0;
+    int repetitions = (options->repetitions > 0) ? options->repetitions : 1;
+    int index;
+    long batch = 1;
+
+    times = malloc(sizeof(double) * repetitions);
+    if (!times) {
+        return -1;
+    }
+
+    /* Finding the batch size also warms up */
+    while (bench_time_batch(fn, context, batch) < options->min_batch_ns) {
+        batch *= 2;
+    }
+
+    for (index = 0; index < options->warmup; ++index) {
+        bench_time_batch(fn, context, batch);
+    }
+
+    for (index = 0; index < repetitions; ++index) {
+        times[index] = (double)bench_time_batch(fn, context, batch) / batch;
+        sum += times[index];
+    }
+
+    qsort(times, repetitions, sizeof(double), bench_compare_double);
+
+    result->repetitions = repetitions;
+    result->batch = batch;
+    result->min_ns = times[0];
+    result->median_ns = (repetitions % 2) ? times[repetitions / 2] :
+        (times[repetitions / 2 - 1] + times[repetitions / 2]) / 2;
+    result->mean_ns = sum / repetitions;
+    for (index = 0; index < repetitions; ++index) {
+        double difference = times[index] - result->mean_ns;
+        variance += difference * difference;
+    }
+    result->stddev_ns = (repetitions > 1) ?
+        sqrt(variance / (repetitions - 1)) : 0;
+
+    free(times);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <stdint.h>
+
+/**
+ * The benchmark harness.
+ *
+ * A benchmark is a function that does one iteration of the work being
+ * measured. The harness calls it a number of times to warm up the caches
+ * and the allocator, then times a number of repetitions and summarizes
+ * the times.
+ *
+ * Work that takes less time than the clock can measure well is timed in
+ * batches. The harness doubles the number of calls in a batch until a
+ * batch takes at least min_batch_ns, and reports the time per call.
+ */
+
+/** How a benchmark is run. */
+struct bench_options {
+    /** The number of untimed iterations run first. */
+    int warmup;
+
+    /** The number of timed iterations. */
+    int repetitions;
+
+    /** The shortest time to measure at once, 0 to time each call. */
+    uint64_t min_batch_ns;
+};
+
+/** The summary of the timed iterations, in nanoseconds per call. */
+struct bench_result {
+    /** The number of timed iterations. */
+    int repetitions;
+
+    /** The number of calls timed together in each iteration. */
+    long batch;
+
+    /** The fastest iteration. */
+    double min_ns;
+
+    /** The median iteration, the figure to compare between runs. */
+    double median_ns;
+
+    /** The mean of the iterations. */
+    double mean_ns;
+
+    /** The standard deviation of the iterations. */
+    double stddev_ns;
+};
+
+/**
+ * Do one iteration of a benchmark.
+ *
+ * @param context
+ * The context passed to bench_run.
+ */
+typedef void (*bench_fn)(void *context);
+
+/**
+ * Run a benchmark.
+ *
+ * @param options
+ * How to run the benchmark.
+ *
+ * @param fn
+ * The benchmark.
+ *
+ * @param context
+ * An arbitrary pointer passed to fn.
+ *
+ * @param result
+ * The summary of the timed iterations.
+ *
+ * @return
+ * 0 on success or -1 if out of memory.
+ */
+int bench_run(const struct bench_options *options, bench_fn fn,
+        void *context, struct bench_result *result);
+
+#endif
@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdbwire_sys.h"
+#include "gdbwire_mi_grammar.h"
+#include "gdbwire_mi_parser.h"
+#include "gdbwire_mi_pt_alloc.h"
+#include "gdbwire_mi_command.h"
+#include "bench_stages.h"
+
+/** A line of GDB/MI output to lex and parse. */
+struct bench_line {
+    /** The name of the line in the report. */
+    const char *name;
+
+    /** The line, with it's newline. */
+    const char *line;
+};
+
+static const struct bench_line bench_lines[] = {
+    { "stopped",
+        "*stopped,reason=\"breakpoint-hit\",disp=\"keep\",bkptno=\"1\","
+        "frame={addr=\"0x0000000000400501\",func=\"main\",args=[{name="
+        "\"argc\",value=\"1\"},{name=\"argv\",value=\"0x7fffffffe0b8\"}],"
+        "file=\"main.c\",fullname=\"/home/foo/main.c\",line=\"10\","
+        "arch=\"i386:x86-64\"},thread-id=\"1\",stopped-threads=\"all\","
+        "core=\"2\"\n" },
+    { "stream",
+        "~\"Breakpoint 1, main (argc=1, argv=0x7fffffffe0b8) at "
+        "main.c:10\\n\"\n" },
+    { "table",
+        "^done,BreakpointTable={nr_rows=\"2\",nr_cols=\"6\",hdr=[{width="
+        "\"7\",alignment=\"-1\",col_name=\"number\",colhdr=\"Num\"},{width="
+        "\"14\",alignment=\"-1\",col_name=\"type\",colhdr=\"Type\"}],body=["
+        "bkpt={number=\"1\",type=\"breakpoint\",disp=\"keep\",enabled="
+        "\"y\",addr=\"0x0000000000400501\",func=\"main(int, char**)\","
+        "file=\"main.cpp\",fullname=\"/home/foo/main.cpp\",line=\"10\","
+        "thread-groups=[\"i1\"],times=\"0\",original-location=\"main\"},"
+        "bkpt={number=\"2\",type=\"breakpoint\",disp=\"keep\",enabled="
+        "\"y\",addr=\"0x00000000004004eb\",func=\"foo(double)\",file="
+        "\"main.cpp\",fullname=\"/home/foo/main.cpp\",line=\"6\","
+        "thread-groups=[\"i1\"],times=\"0\",original-location="
+        "\"main.cpp:6\"}]}\n" },
+    { NULL, NULL }
+};
+
+/** A result record to decode into a command. */
+struct bench_command {
+    /** The name of the command in the report. */
+    const char *name;
+
+    /** The kind of command to decode. */
+    enum gdbwire_mi_command_kind kind;
+
+    /** The result record, with it's newline. */
+    const char *line;
+};
+
+static const struct bench_command bench_commands[] = {
+    { "break-info", GDBWIRE_MI_BREAK_INFO, NULL },
+    { "stack-info-frame", GDBWIRE_MI_STACK_INFO_FRAME,
+        "^done,frame={level=\"0\",addr=\"0x0000000000400501\",func=\"main\","
+        "file=\"main.cpp\",fullname=\"/home/foo/main.cpp\",line=\"10\"}\n" },
+    { "exec-source-file", GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILE,
+        "^done,line=\"33\",file=\"test.cpp\",fullname=\"/home/foo/test.cpp\","
+        "macro-info=\"0\"\n" },
+    { "exec-source-files", GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILES,
+        "^done,files=[{file=\"a.cpp\",fullname=\"/tmp/a.cpp\"},"
+        "{file=\"b.cpp\",fullname=\"/tmp/b.cpp\"}]\n" },
+    { "stack-list-frames", GDBWIRE_MI_STACK_LIST_FRAMES,
+        "^done,stack=[frame={level=\"0\",addr=\"0x0000000000400501\","
+        "func=\"sum\",file=\"main.c\",fullname=\"/home/foo/main.c\","
+        "line=\"4\",arch=\"i386:x86-64\"},frame={level=\"1\",addr="
+        "\"0x00007ffff7a2e830\",func=\"__libc_start_main\",from="
+        "\"/lib/libc.so.6\",arch=\"i386:x86-64\"}]\n" },
+    { "var-create", GDBWIRE_MI_VAR_CREATE,
+        "^done,name=\"var1\",numchild=\"2\",value=\"{...}\",type="
+        "\"struct point\",thread-id=\"1\",has_more=\"0\"\n" },
+    { "var-list-children", GDBWIRE_MI_VAR_LIST_CHILDREN,
+        "^done,numchild=\"2\",children=[child={name=\"var1.x\",exp=\"x\","
+        "numchild=\"0\",value=\"3\",type=\"int\",thread-id=\"1\"},child="
+        "{name=\"var1.y\",exp=\"y\",numchild=\"0\",value=\"4\",type=\"int\","
+        "thread-id=\"1\"}],has_more=\"0\"\n" },
+    { "var-update", GDBWIRE_MI_VAR_UPDATE,
+        "^done,changelist=[{name=\"var1.x\",value=\"5\",in_scope=\"true\","
+        "type_changed=\"false\",has_more=\"0\"},{name=\"var3\",value="
+        "\"0x601010\",in_scope=\"true\",type_changed=\"true\",new_type="
+        "\"char *\",new_num_children=\"1\",has_more=\"0\"}]\n" },
+    { "read-memory-bytes", GDBWIRE_MI_DATA_READ_MEMORY_BYTES,
+        "^done,memory=[{begin=\"0x0000000000601040\",offset="
+        "\"0x0000000000000000\",end=\"0x0000000000601060\",contents="
+        "\"0100000002000000030000000400000005000000060000000700000008000000"
+        "\"}]\n" },
+    { "register-names", GDBWIRE_MI_DATA_LIST_REGISTER_NAMES,
+        "^done,register-names=[\"rax\",\"rbx\",\"rcx\",\"rdx\",\"rsi\","
+        "\"rdi\",\"rbp\",\"rsp\",\"\",\"\",\"rip\"]\n" },
+    { "register-values", GDBWIRE_MI_DATA_LIST_REGISTER_VALUES,
+        "^done,register-values=[{number=\"0\",value=\"0x1c\"},{number=\"5\","
+        "value=\"0x4004f8 <main+4>\"},{number=\"16\",value=\"0x4004f8\"}]\n" },
+    { "changed-registers", GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS,
+        "^done,changed-registers=[\"0\",\"5\",\"16\",\"17\"]\n" },
+    { "disassemble", GDBWIRE_MI_DATA_DISASSEMBLE,
+        "^done,asm_insns=[{address=\"0x000000000040052d\",func-name=\"main\","
+        "offset=\"0\",inst=\"push   %rbp\"},{address=\"0x000000000040052e\","
+        "func-name=\"main\",offset=\"1\",inst=\"mov    %rsp,%rbp\"},"
+        "{address=\"0x0000000000400531\",func-name=\"main\",offset=\"4\","
+        "inst=\"sub    $0x10,%rsp\"}]\n" },
+    { "thread-info", GDBWIRE_MI_THREAD_INFO,
+        "^done,threads=[{id=\"1\",target-id=\"Thread 0x7ffff7fc1740 "
+        "(LWP 1234)\",frame={level=\"0\",addr=\"0x00000000004004f8\","
+        "func=\"main\",args=[],file=\"main.c\",fullname=\"/tmp/main.c\","
+        "line=\"5\",arch=\"i386:x86-64\"},state=\"stopped\",core=\"0\"}],"
+        "current-thread-id=\"1\"\n" },
+    { "symbol-functions", GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS,
+        "^done,symbols={debug=[{filename=\"/project/f1.c\",fullname="
+        "\"/project/f1.c\",symbols=[{line=\"36\",name=\"f4\",type="
+        "\"void (int *)\",description=\"void f4(int *);\"},{line=\"42\","
+        "name=\"main\",type=\"int (void)\",description=\"int main();\"}]}],"
+        "nondebug=[{address=\"0x0000000000400398\",name=\"_init\"}]}\n" },
+    { "symbol-variables", GDBWIRE_MI_SYMBOL_INFO_VARIABLES,
+        "^done,symbols={debug=[{filename=\"/project/f1.c\",fullname="
+        "\"/project/f1.c\",symbols=[{line=\"5\",name=\"global\",type="
+        "\"int\",description=\"int global;\"}]}]}\n" },
+    { "symbol-types", GDBWIRE_MI_SYMBOL_INFO_TYPES,
+        "^done,symbols={debug=[{filename=\"/project/f1.c\",fullname="
+        "\"/project/f1.c\",symbols=[{name=\"float\"},{line=\"27\","
+        "name=\"my_int_t\"}]}]}\n" },
+    { "symbol-list-lines", GDBWIRE_MI_SYMBOL_LIST_LINES,
+        "^done,lines=[{pc=\"0x0000000000400500\",line=\"3\"},{pc="
+        "\"0x0000000000400504\",line=\"4\"},{pc=\"0x000000000040050e\","
+        "line=\"5\"},{pc=\"0x0000000000400520\",line=\"4\"}]\n" },
+    { NULL, GDBWIRE_MI_BREAK_INFO, NULL }
+};
+
+/** The lexer and parser state, for the lex and parse stages. */
+struct bench_scanner {
+    /** The GDB/MI lexer state. */
+    yyscan_t scanner;
+
+    /** The GDB/MI push parser state. */
+    gdbwire_mi_pstate *pstate;
+
+    /** The state shared with the grammar actions. */
+    struct gdbwire_mi_grammar_state state;
+
+    /** The line to lex or parse. */
+    const char *line;
+};
+
+/**
+ * Lex a line, discarding the tokens.
+ *
+ * @param context
+ * The struct bench_scanner.
+ */
+static void
+bench_lex(void *context)
+{
+    struct bench_scanner *scanner = (struct bench_scanner *)context;
+    YY_BUFFER_STATE buffer;
+
+    buffer = gdbwire_mi__scan_string(scanner->line, scanner->scanner);
+    while (gdbwire_mi_lex(scanner->scanner) != 0) {
+    }
+    gdbwire_mi__delete_buffer(buffer, scanner->scanner);
+}
+
+/**
+ * Lex and parse a line, the way gdbwire_mi_parser does, and free the
+ * parse tree.
+ *
+ * @param context
+ * The struct bench_scanner.
+ */
+static void
+bench_parse(void *context)
+{
+    struct bench_scanner *scanner = (struct bench_scanner *)context;
+    struct gdbwire_mi_output *output = 0;
+    YY_BUFFER_STATE buffer;
+    int pattern, status;
+
+    scanner->state.depth = 0;
+    buffer = gdbwire_mi__scan_string(scanner->line, scanner->scanner);
+    do {
+        pattern = gdbwire_mi_lex(scanner->scanner);
+        if (pattern == 0) {
+            break;
+        }
+        status = gdbwire_mi_push_parse(scanner->pstate, pattern, NULL,
+            scanner->scanner, &output, &scanner->state);
+    } while (status == YYPUSH_MORE);
+    gdbwire_mi__delete_buffer(buffer, scanner->scanner);
+
+    gdbwire_mi_output_free(output);
+}
+
+/**
+ * Allocate and free a parse tree.
+ *
+ * The tree is a result record with a list of 32 tuples of 4 c-strings,
+ * about the size of a short -stack-list-frames result.
+ *
+ * @param context
+ * Unused.
+ */
+static void
+bench_tree(void *context)
+{
+    static const char *variables[] = { "level", "addr", "func", "line" };
+    struct gdbwire_mi_output *output = gdbwire_mi_output_alloc();
+    struct gdbwire_mi_result **tuple, **field;
+    int tuples, fields;
+
+    output->kind = GDBWIRE_MI_OUTPUT_RESULT;
+    output->variant.result_record = gdbwire_mi_result_record_alloc();
+    output->variant.result_record->result_class = GDBWIRE_MI_DONE;
+    output->variant.result_record->result = gdbwire_mi_result_alloc();
+    output->variant.result_record->result->kind = GDBWIRE_MI_LIST;
+    output->variant.result_record->result->variable =
+        gdbwire_strdup("stack");
+
+    tuple = &output->variant.result_record->result->variant.result;
+    for (tuples = 0; tuples < 32; ++tuples) {
+        *tuple = gdbwire_mi_result_alloc();
+        (*tuple)->kind = GDBWIRE_MI_TUPLE;
+        (*tuple)->variable = gdbwire_strdup("frame");
+
+        field = &(*tuple)->variant.result;
+        for (fields = 0; fields < 4; ++fields) {
+            *field = gdbwire_mi_result_alloc();
+            (*field)->kind = GDBWIRE_MI_CSTRING;
+            (*field)->variable = gdbwire_strdup(variables[fields]);
+            (*field)->variant.cstring = gdbwire_strdup("0x0000000000400501");
+            field = &(*field)->next;
+        }
+
+        tuple = &(*tuple)->next;
+    }
+
+    gdbwire_mi_output_free(output);
+}
+
+/**
+ * Unescape a c-string and free the result.
+ *
+ * @param context
+ * The c-string, with it's quotes.
+ */
+static void
+bench_unescape(void *context)
+{
+    free(gdbwire_mi_unescape_cstring((char *)context));
+}
+
+/** A decoder and the result record it decodes. */
+struct bench_decode {
+    /** The kind of command to decode. */
+    enum gdbwire_mi_command_kind kind;
+
+    /** The parsed result record. */
+    struct gdbwire_mi_output *output;
+
+    /** The result of the last decode. */
+    enum gdbwire_result result;
+};
+
+/**
+ * Decode a result record and free the command.
+ *
+ * @param context
+ * The struct bench_decode.
+ */
+static void
+bench_decode(void *context)
+{
+    struct bench_decode *decode = (struct bench_decode *)context;
+    struct gdbwire_mi_command *command;
+
+    decode->result = gdbwire_get_mi_command(decode->kind,
+        decode->output->variant.result_record, &command);
+    gdbwire_mi_command_free(command);
+}
+
+/**
+ * Keep the output of the parser, for the decode stage.
+ *
+ * @param context
+ * Where to store the output.
+ *
+ * @param output
+ * The output of the parser.
+ */
+static void
+bench_keep_output(void *context, struct gdbwire_mi_output *output)
+{
+    struct gdbwire_mi_output **kept = (struct gdbwire_mi_output **)context;
+    gdbwire_mi_output_free(*kept);
+    *kept = output;
+}
+
+/**
+ * Run a microbenchmark and print it's row.
+ *
+ * @param options
+ * How to run the microbenchmark.
+ *
+ * @param stage
+ * The stage being measured.
+ *
+ * @param name
+ * The name of the input.
+ *
+ * @param fn
+ * The microbenchmark.
+ *
+ * @param context
+ * The context passed to fn.
+ *
+ * @param result
+ * The result of the microbenchmark.
+ *
+ * @return
+ * 0 on success or -1 if out of memory.
+ */
+static int
+bench_stage_row(const struct bench_options *options, const char *stage,
+        const char *name, bench_fn fn, void *context,
+        struct bench_result *result)
+{
+    if (bench_run(options, fn, context, result) == -1) {
+        return -1;
+    }
+
+    printf("%-9s %-18s %10.1f %10.1f %10.1f %6.1f%% %9ld\n", stage, name,
+        result->median_ns, result->min_ns, result->mean_ns,
+        (result->mean_ns > 0) ? result->stddev_ns / result->mean_ns * 100 : 0,
+        result->batch);
+    fflush(stdout);
+
+    return 0;
+}
+
+/**
+ * Run the lex and parse stages over each line.
+ *
+ * The scanner and the parser run interleaved, so the parse stage
+ * includes lexing. The parse only row subtracts the lex stage.
+ */
+static int
+bench_stage_lex_parse(const struct bench_options *options, int lex,
+        int parse)
+{
+    const struct bench_line *line;
+    struct bench_scanner scanner;
+    struct bench_result lexed, parsed;
+    int status = 0;
+
+    memset(&scanner, 0, sizeof(scanner));
+    if (gdbwire_mi_lex_init(&scanner.scanner) != 0) {
+        return -1;
+    }
+    scanner.pstate = gdbwire_mi_pstate_new();
+    if (!scanner.pstate) {
+        gdbwire_mi_lex_destroy(scanner.scanner);
+        return -1;
+    }
+
+    for (line = bench_lines; line->name && status == 0; ++line) {
+        scanner.line = line->line;
+        if (lex) {
+            status = bench_stage_row(options, "lex", line->name, bench_lex,
+                &scanner, &lexed);
+        }
+        if (parse && status == 0) {
+            status = bench_stage_row(options, "parse", line->name,
+                bench_parse, &scanner, &parsed);
+        }
+        if (lex && parse && status == 0) {
+            printf("%-9s %-18s %10.1f\n", "parse", "  less lex",
+                parsed.median_ns - lexed.median_ns);
+        }
+    }
+
+    gdbwire_mi_pstate_delete(scanner.pstate);
+    gdbwire_mi_lex_destroy(scanner.scanner);
+
+    return status;
+}
+
+/**
+ * Run the unescape stage on a short and a long c-string.
+ */
+static int
+bench_stage_unescape(const struct bench_options *options)
+{
+    char *cstring, *short_cstring =
+        "\"main.c:10: \\\"quoted\\\"\\tand a newline\\n\"";
+    struct bench_result result;
+    size_t index, size = 4096;
+    int status;
+
+    status = bench_stage_row(options, "unescape", "short", bench_unescape,
+        short_cstring, &result);
+
+    /* A long c-string, with an escape every 64 bytes */
+    cstring = malloc(size + 3);
+    if (!cstring) {
+        return -1;
+    }
+    cstring[0] = '"';
+    for (index = 1; index <= size; ++index) {
+        cstring[index] = (index % 64 == 63) ? '\\' :
+            (index % 64 == 0) ? 'n' : 'a' + index % 26;
+    }
+    cstring[size + 1] = '"';
+    cstring[size + 2] = 0;
+
+    if (status == 0) {
+        status = bench_stage_row(options, "unescape", "4KB", bench_unescape,
+            cstring, &result);
+    }
+
+    free(cstring);
+
+    return status;
+}
+
+/**
+ * Run the decode stage on each kind of command.
+ */
+static int
+bench_stage_decode(const struct bench_options *options)
+{
+    const struct bench_command *command;
+    struct gdbwire_mi_parser_callbacks callbacks;
+    struct gdbwire_mi_parser *parser;
+    struct bench_decode decode;
+    struct bench_result result;
+    struct gdbwire_mi_output *output = 0;
+    int status = 0;
+
+    callbacks.context = &output;
+    callbacks.gdbwire_mi_output_callback = bench_keep_output;
+    parser = gdbwire_mi_parser_create(callbacks);
+    if (!parser) {
+        return -1;
+    }
+
+    for (command = bench_commands; command->name && status == 0; ++command) {
+        const char *line = (command->line) ? command->line :
+            bench_lines[2].line;
+
+        if (gdbwire_mi_parser_push(parser, line) != GDBWIRE_OK || !output ||
+                output->kind != GDBWIRE_MI_OUTPUT_RESULT) {
+            fprintf(stderr, "decode %s: bad result record\n", command->name);
+            status = -1;
+            break;
+        }
+
+        decode.kind = command->kind;
+        decode.output = output;
+        decode.result = GDBWIRE_OK;
+        status = bench_stage_row(options, "decode", command->name,
+            bench_decode, &decode, &result);
+        if (status == 0 && decode.result != GDBWIRE_OK) {
+            fprintf(stderr, "decode %s: failed\n", command->name);
+            status = -1;
+        }
+    }
+
+    gdbwire_mi_output_free(output);
+    gdbwire_mi_parser_destroy(parser);
+
+    return status;
+}
+
+int
+bench_stages(const struct bench_options *options, const char *name)
+{
+    struct bench_result result;
+    int lex = !name || strcmp(name, "lex") == 0;
+    int parse = !name || strcmp(name, "parse") == 0;
+    int tree = !name || strcmp(name, "tree") == 0;
+    int unescape = !name || strcmp(name, "unescape") == 0;
+    int decode = !name || strcmp(name, "decode") == 0;
+
+    printf("%-9s %-18s %10s %10s %10s %7s %9s\n", "stage", "input",
+        "median ns", "min ns", "mean ns", "stddev", "batch");
+
+    if ((lex || parse) && bench_stage_lex_parse(options, lex, parse) == -1) {
+        return -1;
+    }
+    if (tree && bench_stage_row(options, "tree", "32x4 tuples", bench_tree,
+            NULL, &result) == -1) {
+        return -1;
+    }
+    if (unescape && bench_stage_unescape(options) == -1) {
+        return -1;
+    }
+    if (decode && bench_stage_decode(options) == -1) {
+        return -1;
+    }
+
+    return lex + parse + tree + unescape + decode;
+}
@@ -0,0 +1,30 @@
+#ifndef BENCH_STAGES_H
+#define BENCH_STAGES_H
+
+#include "bench_harness.h"
+
+/**
+ * Run the per-stage microbenchmarks and print a row for each.
+ *
+ * Each stage of gdbwire is measured on it's own, so that a change in
+ * the end to end throughput can be traced to the stage that moved.
+ * The stages are,
+ * - lex, the flex scanner alone over a line
+ * - parse, the scanner and the bison push parser over a line,
+ *   including building and freeing the parse tree
+ * - tree, allocating and freeing a parse tree with gdbwire_mi_pt_alloc
+ * - unescape, gdbwire_mi_unescape_cstring
+ * - decode, each gdbwire_get_mi_command decoder and freeing it's command
+ *
+ * @param options
+ * How to run each microbenchmark.
+ *
+ * @param name
+ * The only stage to run, ie. "lex", or NULL to run them all.
+ *
+ * @return
+ * The number of stages run, or -1 on error.
+ */
+int bench_stages(const struct bench_options *options, const char *name);
+
+#endif
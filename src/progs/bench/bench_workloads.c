@@ -0,0 +1,206 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "bench_workloads.h"
+
+/**
+ * Append formatted text to a string.
+ *
+ * @param out
+ * The string to append to.
+ *
+ * @param format
+ * The printf format, the text must be shorter than 1024 bytes.
+ *
+ * @return
+ * 0 on success or -1 if out of memory.
+ */
+static int
+bench_append(struct gdbwire_string *out, const char *format, ...)
+{
+    char text[1024];
+    va_list ap;
+
+    va_start(ap, format);
+    vsnprintf(text, sizeof(text), format, ap);
+    va_end(ap);
+
+    return gdbwire_string_append_cstr(out, text);
+}
+
+/**
+ * Stepping bursts, ie. the output of a user holding down "next".
+ *
+ * Each step is a ^running result record, a *running and a *stopped
+ * async record with a frame, and two prompts.
+ */
+static int
+bench_stepping(struct gdbwire_string *out, int scale)
+{
+    int step, steps = 2500 * scale;
+
+    for (step = 0; step < steps; ++step) {
+        if (bench_append(out,
+                "^running\n"
+                "*running,thread-id=\"all\"\n"
+                "(gdb)\n"
+                "*stopped,reason=\"end-stepping-range\",frame={"
+                "addr=\"0x%016x\",func=\"main\",args=[],file=\"main.c\","
+                "fullname=\"/home/user/project/src/main.c\",line=\"%d\","
+                "arch=\"i386:x86-64\"},thread-id=\"1\","
+                "stopped-threads=\"all\",core=\"%d\"\n"
+                "(gdb)\n", 0x401000u + step * 4, step % 2000 + 1,
+                step % 8) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * A flood of console stream records, ie. "info functions" run through
+ * the console interpreter.
+ */
+static int
+bench_stream_flood(struct gdbwire_string *out, int scale)
+{
+    int line, lines = 20000 * scale;
+
+    for (line = 0; line < lines; ++line) {
+        if (bench_append(out,
+                "~\"%d:\\tstatic void function_number_%d(int, char **);\\n\"\n",
+                line % 1000, line) == -1) {
+            return -1;
+        }
+    }
+
+    return bench_append(out, "^done\n(gdb)\n");
+}
+
+/**
+ * A giant -file-list-exec-source-files result, one line with a
+ * files=[...] list of source files.
+ */
+static int
+bench_giant_files(struct gdbwire_string *out, int scale)
+{
+    int file, files = 10000 * scale;
+
+    if (bench_append(out, "^done,files=[") == -1) {
+        return -1;
+    }
+
+    for (file = 0; file < files; ++file) {
+        if (bench_append(out,
+                "%s{file=\"src/module%d/file%d.c\","
+                "fullname=\"/home/user/project/src/module%d/file%d.c\","
+                "debug-fully-read=\"false\"}", (file) ? "," : "",
+                file / 100, file, file / 100, file) == -1) {
+            return -1;
+        }
+    }
+
+    return bench_append(out, "]\n(gdb)\n");
+}
+
+/**
+ * Deeply nested tuples, ie. the value of a nested structure printed
+ * with -var-evaluate-expression or a pretty printer.
+ */
+static int
+bench_nested_tuples(struct gdbwire_string *out, int scale)
+{
+    int line, lines = 1000 * scale, depth, max_depth = 128;
+
+    for (line = 0; line < lines; ++line) {
+        if (bench_append(out, "^done,value=") == -1) {
+            return -1;
+        }
+        for (depth = 0; depth < max_depth; ++depth) {
+            if (bench_append(out, "{level=\"%d\",next=", depth) == -1) {
+                return -1;
+            }
+        }
+        if (bench_append(out, "\"leaf\"") == -1) {
+            return -1;
+        }
+        for (depth = 0; depth < max_depth; ++depth) {
+            if (gdbwire_string_append_char(out, '}') == -1) {
+                return -1;
+            }
+        }
+        if (bench_append(out, "\n") == -1) {
+            return -1;
+        }
+    }
+
+    return bench_append(out, "(gdb)\n");
+}
+
+/**
+ * A breakpoint with thousands of locations, ie. a breakpoint on a
+ * template function or an inline function.
+ */
+static int
+bench_breakpoint_locations(struct gdbwire_string *out, int scale)
+{
+    int location, locations = 5000 * scale;
+
+    if (bench_append(out,
+            "^done,bkpt={number=\"1\",type=\"breakpoint\",disp=\"keep\","
+            "enabled=\"y\",addr=\"<MULTIPLE>\",times=\"0\","
+            "original-location=\"inline_helper\",locations=[") == -1) {
+        return -1;
+    }
+
+    for (location = 0; location < locations; ++location) {
+        if (bench_append(out,
+                "%s{number=\"1.%d\",enabled=\"y\",addr=\"0x%016x\","
+                "func=\"inline_helper<%d>(int)\",file=\"helper.h\","
+                "fullname=\"/home/user/project/include/helper.h\","
+                "line=\"42\",thread-groups=[\"i1\"]}",
+                (location) ? "," : "", location + 1,
+                0x401000u + location * 64, location) == -1) {
+            return -1;
+        }
+    }
+
+    return bench_append(out, "]}\n(gdb)\n");
+}
+
+/**
+ * A storm of =library-loaded records, ie. starting a program that
+ * links against hundreds of shared libraries, many times over.
+ */
+static int
+bench_library_storm(struct gdbwire_string *out, int scale)
+{
+    int library, libraries = 5000 * scale;
+
+    for (library = 0; library < libraries; ++library) {
+        if (bench_append(out,
+                "=library-loaded,id=\"/usr/lib/x86_64-linux-gnu/lib%d.so\","
+                "target-name=\"/usr/lib/x86_64-linux-gnu/lib%d.so\","
+                "host-name=\"/usr/lib/x86_64-linux-gnu/lib%d.so\","
+                "symbols-loaded=\"0\",thread-group=\"i1\","
+                "ranges=[{from=\"0x%016x\",to=\"0x%016x\"}]\n",
+                library, library, library, 0x7f000000u + library * 0x1000,
+                0x7f000800u + library * 0x1000) == -1) {
+            return -1;
+        }
+    }
+
+    return bench_append(out, "(gdb)\n");
+}
+
+const struct bench_workload bench_workloads[] = {
+    { "stepping", "*running/*stopped stepping bursts", bench_stepping },
+    { "stream", "console stream record flood", bench_stream_flood },
+    { "files", "giant files=[...] list", bench_giant_files },
+    { "nested", "deeply nested tuples", bench_nested_tuples },
+    { "locations", "breakpoint with thousands of locations",
+        bench_breakpoint_locations },
+    { "libraries", "=library-loaded storm", bench_library_storm },
+    { NULL, NULL, NULL }
+};
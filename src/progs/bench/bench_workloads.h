@@ -0,0 +1,41 @@
+#ifndef BENCH_WORKLOADS_H
+#define BENCH_WORKLOADS_H
+
+#include "gdbwire_string.h"
+
+/**
+ * The synthetic GDB/MI workloads.
+ *
+ * Each workload generates GDB/MI output shaped like real GDB traffic
+ * that stresses a different part of gdbwire, ie. many small records,
+ * or one enormous record.
+ */
+
+/** A workload. */
+struct bench_workload {
+    /** The name of the workload, to select it on the command line. */
+    const char *name;
+
+    /** What the workload is made of. */
+    const char *description;
+
+    /**
+     * Generate the workload.
+     *
+     * @param out
+     * The string to append the GDB/MI output to.
+     *
+     * @param scale
+     * The size of the workload, 1 for the default size of roughly
+     * a megabyte.
+     *
+     * @return
+     * 0 on success or -1 if out of memory.
+     */
+    int (*generate)(struct gdbwire_string *out, int scale);
+};
+
+/** The workloads, terminated by an entry with a NULL name. */
+extern const struct bench_workload bench_workloads[];
+
+#endif
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gdbwire.h"
+#include "gdbwire_string.h"
+#include "bench_harness.h"
+#include "bench_stages.h"
+#include "bench_workloads.h"
+
+/** The smallest and largest push granularity, in bytes. */
+#define BENCH_MIN_GRANULARITY 1
+#define BENCH_MAX_GRANULARITY 65536
+
+/** A workload pushed through gdbwire at a push granularity. */
+struct bench_push {
+    /** The GDB/MI output of the workload. */
+    const char *data;
+
+    /** The size of data. */
+    size_t size;
+
+    /** The number of bytes given to each gdbwire_push_data call. */
+    size_t granularity;
+
+    /** The statistics of the last iteration. */
+    struct gdbwire_stats stats;
+
+    /** Non zero if gdbwire failed during an iteration. */
+    int failed;
+};
+
+/**
+ * Push a workload through a new gdbwire instance.
+ *
+ * The instance has no callbacks, so this measures gdbwire itself.
+ *
+ * @param context
+ * The struct bench_push to run.
+ */
+static void
+bench_push_workload(void *context)
+{
+    struct bench_push *push = (struct bench_push *)context;
+    struct gdbwire_callbacks callbacks;
+    struct gdbwire *wire;
+    size_t offset, size;
+
+    memset(&callbacks, 0, sizeof(callbacks));
+    wire = gdbwire_create(callbacks);
+    if (!wire) {
+        push->failed = 1;
+        return;
+    }
+
+    for (offset = 0; offset < push->size; offset += size) {
+        size = push->size - offset;
+        if (size > push->granularity) {
+            size = push->granularity;
+        }
+        if (gdbwire_push_data(wire, push->data + offset, size) !=
+                GDBWIRE_OK) {
+            push->failed = 1;
+            break;
+        }
+    }
+
+    gdbwire_get_stats(wire, &push->stats);
+    gdbwire_destroy(wire);
+}
+
+/**
+ * Get the number of records in the statistics.
+ *
+ * @param stats
+ * The statistics of a run.
+ *
+ * @return
+ * The number of output commands gdbwire parsed.
+ */
+static uint64_t
+bench_records(const struct gdbwire_stats *stats)
+{
+    uint64_t records = 0;
+    size_t kind;
+
+    for (kind = 0; kind < sizeof(stats->outputs) / sizeof(stats->outputs[0]);
+            ++kind) {
+        records += stats->outputs[kind];
+    }
+
+    return records;
+}
+
+/**
+ * Run a workload at each push granularity and print a row for each.
+ *
+ * @param workload
+ * The workload to run.
+ *
+ * @param options
+ * How to run each granularity.
+ *
+ * @param scale
+ * The size of the workload.
+ *
+ * @param granularity
+ * The only push granularity to run, or 0 to run them all.
+ *
+ * @return
+ * 0 on success or -1 on error.
+ */
+static int
+bench_workload(const struct bench_workload *workload,
+        const struct bench_options *options, int scale, size_t granularity)
+{
+    struct gdbwire_string *data = gdbwire_string_create();
+    struct bench_result result;
+    struct bench_push push;
+    uint64_t records;
+    size_t min = BENCH_MIN_GRANULARITY, max = BENCH_MAX_GRANULARITY;
+    int status = 0;
+
+    if (!data || workload->generate(data, scale) == -1) {
+        fprintf(stderr, "%s: out of memory\n", workload->name);
+        gdbwire_string_destroy(data);
+        return -1;
+    }
+
+    if (granularity) {
+        min = max = granularity;
+    }
+
+    for (granularity = min; granularity <= max; granularity *= 2) {
+        memset(&push, 0, sizeof(push));
+        push.data = gdbwire_string_data(data);
+        push.size = gdbwire_string_size(data);
+        push.granularity = granularity;
+
+        if (bench_run(options, bench_push_workload, &push, &result) == -1 ||
+                push.failed) {
+            fprintf(stderr, "%s: gdbwire failed\n", workload->name);
+            status = -1;
+            break;
+        }
+
+        records = bench_records(&push.stats);
+        printf("%-10s %6lu %9.1f %12.0f %10.1f %8.2f %8.0f %8lu\n",
+            workload->name, (unsigned long)granularity,
+            (double)push.size / result.median_ns * 1e9 / (1024 * 1024),
+            (double)records / result.median_ns * 1e9,
+            result.median_ns / (double)records,
+            (double)push.stats.allocations / (double)records,
+            (double)push.stats.bytes_allocated / (double)records,
+            (unsigned long)(push.stats.buffer_high_water + 1023) / 1024);
+        fflush(stdout);
+    }
+
+    gdbwire_string_destroy(data);
+
+    return status;
+}
+
+/**
+ * Print the usage of the benchmark.
+ *
+ * @param program
+ * The name of the program.
+ */
+static void
+bench_usage(const char *program)
+{
+    const struct bench_workload *workload;
+
+    fprintf(stderr,
+        "usage: %s [-m] [-w workload] [-g bytes] [-r repetitions] "
+        "[-s scale]\n"
+        "\n"
+        "  -m              run the per-stage microbenchmarks instead\n"
+        "  -w workload     run only this workload, or stage with -m\n"
+        "  -g bytes        push only this many bytes at a time\n"
+        "  -r repetitions  time this many runs of each, default 3, 21 with -m\n"
+        "  -s scale        multiply the size of the workloads, default 1\n"
+        "\n"
+        "workloads:\n", program);
+
+    for (workload = bench_workloads; workload->name; ++workload) {
+        fprintf(stderr, "  %-10s %s\n", workload->name,
+            workload->description);
+    }
+
+    fprintf(stderr, "\nstages: lex, parse, tree, unescape, decode\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const struct bench_workload *workload;
+    struct bench_options options = { 1, 3, 0 };
+    const char *name = NULL;
+    size_t granularity = 0;
+    int scale = 1, option, status = 0, ran = 0, stages = 0, repetitions = 0;
+
+    while ((option = getopt(argc, argv, "mw:g:r:s:h")) != -1) {
+        switch (option) {
+            case 'm':
+                stages = 1;
+                break;
+            case 'w':
+                name = optarg;
+                break;
+            case 'g':
+                granularity = (size_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                options.repetitions = repetitions = atoi(optarg);
+                break;
+            case 's':
+                scale = atoi(optarg);
+                break;
+            default:
+                bench_usage(argv[0]);
+                return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    if (scale < 1 || options.repetitions < 1) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (stages) {
+        /* Each call is far shorter than the clock resolution, so batch */
+        struct bench_options stage_options = { 1, 21, 1000000 };
+        if (repetitions) {
+            stage_options.repetitions = repetitions;
+        }
+
+        ran = bench_stages(&stage_options, name);
+        if (ran == 0) {
+            bench_usage(argv[0]);
+        }
+        return (ran > 0) ? 0 : 1;
+    }
+
+    /*
+     * The memory columns are per run, from gdbwire_get_stats, not the
+     * process: the allocations and bytes gdbwire requested per record and
+     * the largest its buffer of unframed data was.
+     */
+    printf("%-10s %6s %9s %12s %10s %8s %8s %8s\n", "workload", "push",
+        "MB/s", "records/s", "ns/record", "allocs", "bytes", "buffer");
+    printf("%-10s %6s %9s %12s %10s %8s %8s %8s\n", "", "bytes",
+        "", "", "", "/record", "/record", "peak KB");
+
+    for (workload = bench_workloads; workload->name; ++workload) {
+        if (!name || strcmp(name, workload->name) == 0) {
+            if (bench_workload(workload, &options, scale, granularity) == -1) {
+                status = 1;
+            }
+            ran = 1;
+        }
+    }
+
+    if (!ran) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    return status;
+}
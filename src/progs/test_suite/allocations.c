@@ -0,0 +1,213 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocations.h"
+
+/** Non zero while counting. */
+static int allocations_counting;
+
+/** The allocations counted so far. */
+static struct allocations allocations_counted;
+
+/** The size malloc fails for, or 0 */
+static size_t allocations_failing;
+
+#ifdef __linux__
+
+/** The real allocator, found with dlsym. */
+static void *(*real_malloc)(size_t size);
+static void *(*real_calloc)(size_t nmemb, size_t size);
+static void *(*real_realloc)(void *ptr, size_t size);
+static void (*real_free)(void *ptr);
+
+/**
+ * Memory for the allocations made while finding the real allocator.
+ *
+ * dlsym may allocate, which calls back into the interposed functions
+ * before the real allocator is known. Those allocations are served from
+ * here and never freed.
+ */
+static char allocations_bootstrap[4096];
+static size_t allocations_bootstrap_used;
+
+/**
+ * Allocate from the bootstrap memory.
+ *
+ * @param size
+ * The number of bytes to allocate.
+ *
+ * @return
+ * Zeroed memory, or NULL if the bootstrap memory is exhausted.
+ */
+static void *
+allocations_bootstrap_alloc(size_t size)
+{
+    size_t aligned = (size + 15) & ~(size_t)15;
+    void *ptr;
+
+    if (aligned > sizeof(allocations_bootstrap) - allocations_bootstrap_used) {
+        return NULL;
+    }
+
+    ptr = allocations_bootstrap + allocations_bootstrap_used;
+    allocations_bootstrap_used += aligned;
+    return ptr;
+}
+
+/**
+ * Determine if memory came from the bootstrap memory.
+ *
+ * @param ptr
+ * The memory to check.
+ *
+ * @return
+ * Non zero if ptr is bootstrap memory, 0 otherwise.
+ */
+static int
+allocations_is_bootstrap(void *ptr)
+{
+    char *cptr = (char *)ptr;
+    return cptr >= allocations_bootstrap &&
+        cptr < allocations_bootstrap + sizeof(allocations_bootstrap);
+}
+
+/**
+ * Find the real allocator, the next definition after the test suite.
+ */
+static void
+allocations_resolve(void)
+{
+    static int resolving;
+
+    if (resolving || real_free) {
+        return;
+    }
+
+    resolving = 1;
+    real_malloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+    real_calloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+    real_realloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+    real_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    resolving = 0;
+}
+
+void *
+malloc(size_t size)
+{
+    allocations_resolve();
+    if (!real_malloc) {
+        return allocations_bootstrap_alloc(size);
+    }
+
+    if (allocations_failing && size == allocations_failing) {
+        return NULL;
+    }
+
+    if (allocations_counting) {
+        allocations_counted.mallocs++;
+        allocations_counted.bytes += size;
+    }
+
+    return real_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+    allocations_resolve();
+    if (!real_calloc) {
+        return allocations_bootstrap_alloc(nmemb * size);
+    }
+
+    if (allocations_counting) {
+        allocations_counted.callocs++;
+        allocations_counted.bytes += nmemb * size;
+    }
+
+    return real_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    void *result;
+
+    allocations_resolve();
+    if (!real_realloc) {
+        return NULL;
+    }
+
+    if (allocations_counting) {
+        allocations_counted.reallocs++;
+        allocations_counted.bytes += size;
+    }
+
+    /* Move bootstrap memory to the real allocator */
+    if (allocations_is_bootstrap(ptr)) {
+        size_t available = allocations_bootstrap +
+            sizeof(allocations_bootstrap) - (char *)ptr;
+        result = real_malloc(size);
+        if (result) {
+            memcpy(result, ptr, (size < available) ? size : available);
+        }
+        return result;
+    }
+
+    return real_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+    if (!ptr || allocations_is_bootstrap(ptr)) {
+        return;
+    }
+
+    allocations_resolve();
+
+    if (allocations_counting) {
+        allocations_counted.frees++;
+    }
+
+    real_free(ptr);
+}
+
+int
+allocations_supported(void)
+{
+    return 1;
+}
+
+#else
+
+int
+allocations_supported(void)
+{
+    return 0;
+}
+
+#endif
+
+void
+allocations_start(void)
+{
+    memset(&allocations_counted, 0, sizeof(allocations_counted));
+    allocations_counting = 1;
+}
+
+void
+allocations_stop(struct allocations *counted)
+{
+    allocations_counting = 0;
+    *counted = allocations_counted;
+}
+
+void
+allocations_fail_size(size_t size)
+{
+    allocations_failing = size;
+}
@@ -0,0 +1,85 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Count the allocations a test makes.
+ *
+ * The test suite interposes malloc, calloc, realloc and free, forwarding
+ * each call to the real allocator. While counting, each call is counted
+ * along with the bytes requested. This lets a test assert an allocation
+ * budget for the code it runs, so that a change that allocates more
+ * fails the test suite.
+ *
+ * Everything in the process is counted, including the test framework,
+ * so only the code under test should run while counting.
+ *
+ * Sanitizers that intercept libc functions, like strdup, allocate for
+ * them without calling malloc, so counts can be lower under a sanitizer.
+ *
+ * Interposing the allocator requires the dynamic linker to resolve
+ * malloc to the test suite first, which is the case on Linux. On other
+ * systems nothing is counted and allocations_supported returns 0.
+ */
+
+/** The allocations counted. */
+struct allocations {
+    /** The number of calls to malloc. */
+    unsigned long mallocs;
+
+    /** The number of calls to calloc. */
+    unsigned long callocs;
+
+    /** The number of calls to realloc. */
+    unsigned long reallocs;
+
+    /** The number of calls to free with a non NULL pointer. */
+    unsigned long frees;
+
+    /** The bytes requested by malloc, calloc and realloc. */
+    unsigned long long bytes;
+};
+
+/**
+ * Determine if allocations can be counted on this system.
+ *
+ * @return
+ * Non zero if allocations are counted, 0 otherwise.
+ */
+int allocations_supported(void);
+
+/**
+ * Reset the counts and start counting allocations.
+ */
+void allocations_start(void);
+
+/**
+ * Stop counting allocations.
+ *
+ * @param counted
+ * The allocations counted since allocations_start.
+ */
+void allocations_stop(struct allocations *counted);
+
+/**
+ * Make malloc fail for one size of allocation.
+ *
+ * This lets a test run out of memory at a chosen allocation, picked by
+ * a size nothing else in the test allocates. Only supported where
+ * allocations_supported returns non zero.
+ *
+ * @param size
+ * The size malloc returns NULL for, or 0 to stop failing.
+ */
+void allocations_fail_size(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
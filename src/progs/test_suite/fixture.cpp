@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include "config.h"
 #include "catch.hpp"
 #include "fixture.h"
@@ -33,3 +34,43 @@ Fixture::sourceTestPath()
     resultPath = resultPath + "/" + testName();
     return resultPath;
 }
+
+std::string
+Fixture::sourceFixturePath(const std::string &name)
+{
+    std::string fixture = testName();
+    fixture = fixture.substr(0, fixture.find('/'));
+    return data() + "/" + fixture + "/" + name;
+}
+
+std::string
+Fixture::getFileContents(const std::string &path)
+{
+    std::string result;
+    FILE *fd;
+    int c;
+
+    fd = fopen(path.c_str(), "r");
+    REQUIRE(fd);
+
+    while ((c = fgetc(fd)) != EOF) {
+        result.push_back((char)c);
+    }
+    fclose(fd);
+
+    return result;
+}
+
+void
+Fixture::startCountingAllocations()
+{
+    allocations_start();
+}
+
+allocations
+Fixture::stopCountingAllocations()
+{
+    allocations counted;
+    allocations_stop(&counted);
+    return counted;
+}
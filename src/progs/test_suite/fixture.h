@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "allocations.h"
+
 /**
  * Provides functionality above and beyond the normal Test.
  *
@@ -78,10 +80,69 @@ class Fixture {
          * This may be read-only.
          */
         std::string sourceTestPath();
+
+        /**
+         * Get a path in the test fixture's directory in the source tree.
+         *
+         * This is for tests that read more than one file, or a file that
+         * other tests read too. For example, with a name of read.mi
+         *   $abs_top_srcdir/progs/test_suite/data/FixtureName/read.mi
+         * where FixtureName is the first piece of testName().
+         *
+         * @param name
+         * The path relative to the fixture's directory.
+         *
+         * @return
+         * The absolute path in the source tree. This may be read-only.
+         */
+        std::string sourceFixturePath(const std::string &name);
+
+        /**
+         * Get the contents of a file.
+         *
+         * The test fails if the file can not be opened.
+         *
+         * @param path
+         * The path to the file, ie. sourceTestPath().
+         *
+         * @return
+         * The contents of the file.
+         */
+        std::string getFileContents(const std::string &path);
+
+        /**
+         * Start counting the allocations the test makes.
+         *
+         * Only the code under test should run until
+         * stopCountingAllocations, the test framework allocates too.
+         * So keep assertions out of the counted code.
+         */
+        void startCountingAllocations();
+
+        /**
+         * Stop counting the allocations the test makes.
+         *
+         * @return
+         * The allocations made since startCountingAllocations. All zero
+         * if allocations can not be counted on this system.
+         */
+        allocations stopCountingAllocations();
 };
 
 // A convience macro for creating unit tests.
 #define TEST_CASE_METHOD_N(Fixture, name) \
     TEST_CASE_METHOD(Fixture, #Fixture "/" #name)
 
+// Require that counted allocations are within a budget.
+//
+// The budget is the number of calls to malloc, calloc and realloc.
+// Lower the budget when an optimization makes it lower, so that it
+// keeps catching regressions.
+#define REQUIRE_ALLOCATIONS_AT_MOST(counted, budget) \
+    do { \
+        INFO("bytes allocated: " << (counted).bytes); \
+        REQUIRE((counted).mallocs + (counted).callocs + \
+            (counted).reallocs <= (budget)); \
+    } while (0)
+
 #endif /* __FIXTURE_H__ */
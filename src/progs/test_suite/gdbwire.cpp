@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <vector>
 #include "catch.hpp"
 #include "fixture.h"
 #include "gdbwire.h"
@@ -24,7 +26,11 @@ namespace {
             };
 
             callbacks = init_callbacks;
+            callbacks.context = (void*)this;
             streamRecordKind = (gdbwire_mi_stream_record_kind)-1;
+            streamRecordCount = 0;
+            streamDisables = false;
+            wire = NULL;
             asyncRecordKind = (gdbwire_mi_async_record_kind)-1;
             asyncClass = GDBWIRE_MI_ASYNC_UNSUPPORTED;
             resultClass = GDBWIRE_MI_UNSUPPORTED;
@@ -40,7 +46,21 @@ namespace {
             REQUIRE(stream_record);
             streamRecordKind = stream_record->kind;
             streamString = stream_record->cstring;
-
+            streamRecordCount++;
+            events.push_back("stream[" + streamString + "]");
+
+            // Push more output, or disable coalescing, from the callback
+            if (!streamPush.empty()) {
+                std::string mi = streamPush;
+                streamPush.clear();
+                REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) ==
+                    GDBWIRE_OK);
+            }
+            if (streamDisables) {
+                streamDisables = false;
+                REQUIRE(gdbwire_set_stream_coalescing(wire, 0, 0, 0) ==
+                    GDBWIRE_OK);
+            }
         }
 
         static void gdbwire_async_record(void *context,
@@ -74,6 +94,7 @@ namespace {
         void gdbwire_prompt(const char *prompt) {
             REQUIRE(prompt);
             promptString = prompt;
+            events.push_back("prompt");
         }
 
         static void gdbwire_parse_error(void *context,
@@ -92,9 +113,18 @@ namespace {
 
         gdbwire_callbacks callbacks;
 
+        // The instance the stream callback pushes to
+        struct gdbwire *wire;
+
+        // The stream and prompt callbacks, in order
+        std::vector<std::string> events;
+
         // Used for the stream callback
         gdbwire_mi_stream_record_kind streamRecordKind;
         std::string streamString;
+        int streamRecordCount;
+        std::string streamPush;
+        bool streamDisables;
 
         // Used for the async callback
         gdbwire_mi_async_record_kind asyncRecordKind;
@@ -150,22 +180,6 @@ namespace {
     };
 
     struct GdbwireBasicTest: public Fixture {};
-
-    std::string get_file_contents(const std::string &path) {
-        std::string result;
-        FILE *fd;
-        int c;
-
-        fd = fopen(path.c_str(), "r");
-        REQUIRE(fd);
-
-        while ((c = fgetc(fd)) != EOF) {
-            result.push_back((char)c);
-        }
-        fclose(fd);
-
-        return result;
-    }
 }
 
 TEST_CASE_METHOD_N(GdbwireBasicTest, create/normal)
@@ -222,7 +236,7 @@ TEST_CASE_METHOD_N(GdbwireTest, callbacks/parse_error/basic.mi)
 
 TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/basic.mi)
 {
-    std::string mi = get_file_contents(sourceTestPath());
+    std::string mi = getFileContents(sourceTestPath());
     enum gdbwire_result result;
     struct gdbwire_mi_command *mi_command = 0;
 
@@ -235,7 +249,7 @@ TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/basic.mi)
 
 TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/error.mi)
 {
-    std::string mi = get_file_contents(sourceTestPath());
+    std::string mi = getFileContents(sourceTestPath());
     enum gdbwire_result result;
     struct gdbwire_mi_command *mi_command = 0;
 
@@ -259,7 +273,7 @@ TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/empty_error)
 
 TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/command_and_stream.mi)
 {
-    std::string mi = get_file_contents(sourceTestPath());
+    std::string mi = getFileContents(sourceTestPath());
     enum gdbwire_result result;
     struct gdbwire_mi_command *mi_command = 0;
 
@@ -271,7 +285,7 @@ TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/command_and_stream.mi)
 
 TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/command_and_prompt.mi)
 {
-    std::string mi = get_file_contents(sourceTestPath());
+    std::string mi = getFileContents(sourceTestPath());
     enum gdbwire_result result;
     struct gdbwire_mi_command *mi_command = 0;
 
@@ -280,3 +294,441 @@ TEST_CASE_METHOD_N(GdbwireBasicTest, interpreter_exec/command_and_prompt.mi)
     REQUIRE(result == GDBWIRE_LOGIC);
     REQUIRE(!mi_command);
 }
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/disabled.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 3);
+    REQUIRE(callbacks.streamRecordKind == GDBWIRE_MI_CONSOLE);
+    REQUIRE(callbacks.streamString == "line 3\n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/basic.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 1);
+    REQUIRE(callbacks.streamRecordKind == GDBWIRE_MI_CONSOLE);
+    REQUIRE(callbacks.streamString == "line 1\nline 2\nline 3\n");
+    REQUIRE(callbacks.promptString == "(gdb) \n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/kinds.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 3);
+    REQUIRE(callbacks.streamRecordKind == GDBWIRE_MI_LOG);
+    REQUIRE(callbacks.streamString == "log 1\nlog 2\n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/async.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+
+    /* The async record must flush the console output before it */
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 2);
+    REQUIRE(callbacks.streamString == "after\n");
+    REQUIRE(callbacks.asyncClass == GDBWIRE_MI_ASYNC_RUNNING);
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/max_records)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("stream_coalescing/basic.mi"));
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 2) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 2);
+    REQUIRE(callbacks.streamString == "line 3\n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/max_bytes)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("stream_coalescing/basic.mi"));
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 7, 0) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 3);
+    REQUIRE(callbacks.streamString == "line 3\n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/disable_flushes)
+{
+    std::string mi = "~\"line 1\\n\"\n~\"line 2\\n\"\n";
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 0);
+
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 0, 0, 0) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 1);
+    REQUIRE(callbacks.streamString == "line 1\nline 2\n");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/flush)
+{
+    std::string mi = "~\"line 1\\n\"\n~\"line 2\\n\"\n";
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    // Nothing is pending, with or without coalescing
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 0);
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 1);
+    REQUIRE(callbacks.streamString == "line 1\nline 2\n");
+
+    // Coalescing carries on after the flush
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 1);
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(callbacks.streamRecordCount == 2);
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_coalescing/push_from_callback)
+{
+    std::string mi = "~\"first\"\n";
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    callbacks.wire = wire;
+
+    // The record pushed from the callback is sent on it's own
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 1) == GDBWIRE_OK);
+    callbacks.streamPush = "~\"second\"\n(gdb)\n";
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.events.size() == 3);
+    REQUIRE(callbacks.events[0] == "stream[first]");
+    REQUIRE(callbacks.events[1] == "stream[second]");
+    REQUIRE(callbacks.events[2] == "prompt");
+
+    // Without a limit, it waits for the next flush instead of being lost
+    callbacks.events.clear();
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+    callbacks.streamPush = "~\"second\"\n";
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(callbacks.events.size() == 1);
+    REQUIRE(callbacks.events[0] == "stream[first]");
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(callbacks.events.size() == 2);
+    REQUIRE(callbacks.events[1] == "stream[second]");
+
+    // Disabling coalescing from the callback delivers the rest directly
+    callbacks.events.clear();
+    callbacks.streamDisables = true;
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_flush_stream_records(wire) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.events.size() == 2);
+    REQUIRE(callbacks.events[0] == "stream[first]");
+    REQUIRE(callbacks.events[1] == "stream[first]");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, latency/histograms)
+{
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    const gdbwire_histogram *result, *async;
+    std::string mi = "*stopped\n^done\n(gdb)\n";
+
+    REQUIRE(wire);
+    REQUIRE(!gdbwire_get_latency(wire, GDBWIRE_LATENCY_RESULT));
+    REQUIRE(gdbwire_set_latency_tracking(wire, 1) == GDBWIRE_OK);
+
+    /* The result record waits for the rest of it's line */
+    REQUIRE(gdbwire_push_data(wire, "^do", 3) == GDBWIRE_OK);
+    usleep(2000);
+    REQUIRE(gdbwire_push_data(wire, "ne\n", 3) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+
+    result = gdbwire_get_latency(wire, GDBWIRE_LATENCY_RESULT);
+    async = gdbwire_get_latency(wire, GDBWIRE_LATENCY_ASYNC);
+    REQUIRE(result);
+    REQUIRE(async);
+    REQUIRE(gdbwire_histogram_count(result) == 2);
+    REQUIRE(gdbwire_histogram_count(async) == 1);
+    REQUIRE(gdbwire_histogram_count(gdbwire_get_latency(wire,
+        GDBWIRE_LATENCY_PROMPT)) == 1);
+    REQUIRE(gdbwire_histogram_count(gdbwire_get_latency(wire,
+        GDBWIRE_LATENCY_STREAM)) == 0);
+
+    /* It is measured from the arrival of it's first byte */
+    REQUIRE(gdbwire_histogram_max(result) >= 2000000);
+    REQUIRE(gdbwire_histogram_quantile(result, 0.999) ==
+        gdbwire_histogram_max(result));
+    REQUIRE(gdbwire_histogram_max(async) < gdbwire_histogram_max(result));
+
+    REQUIRE(gdbwire_reset_stats(wire) == GDBWIRE_OK);
+    REQUIRE(gdbwire_histogram_count(result) == 0);
+
+    REQUIRE(gdbwire_set_latency_tracking(wire, 0) == GDBWIRE_OK);
+    REQUIRE(!gdbwire_get_latency(wire, GDBWIRE_LATENCY_RESULT));
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, latency/coalesced_stream)
+{
+    GdbwireCallbacks callbacks;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    const gdbwire_histogram *stream;
+    std::string mi = "~\"line 1\\n\"\n";
+
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_latency_tracking(wire, 1) == GDBWIRE_OK);
+    REQUIRE(gdbwire_set_stream_coalescing(wire, 1, 0, 0) == GDBWIRE_OK);
+
+    /* The coalesced records are measured from the first of them */
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    usleep(2000);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, "(gdb)\n", 6) == GDBWIRE_OK);
+
+    stream = gdbwire_get_latency(wire, GDBWIRE_LATENCY_STREAM);
+    REQUIRE(callbacks.streamRecordCount == 1);
+    REQUIRE(gdbwire_histogram_count(stream) == 1);
+    REQUIRE(gdbwire_histogram_max(stream) >= 2000000);
+
+    gdbwire_destroy(wire);
+}
+
+namespace {
+    struct GdbwireSourceFiles {
+        static void source_file(void *context,
+                gdbwire_mi_source_file *file) {
+            GdbwireSourceFiles *files = (GdbwireSourceFiles *)context;
+            REQUIRE(file);
+            REQUIRE(file->file);
+            REQUIRE(!file->next);
+            files->names.push_back(file->file);
+        }
+
+        /* Tries to push more output while the line is being parsed */
+        static void push_source_file(void *context,
+                gdbwire_mi_source_file *file) {
+            GdbwireSourceFiles *files = (GdbwireSourceFiles *)context;
+            std::string mi = "*running,thread-id=\"all\"\n";
+            files->names.push_back(file->file);
+            files->results.push_back(gdbwire_push_data(files->wire,
+                mi.data(), mi.size()));
+        }
+
+        struct gdbwire *wire;
+        std::vector<std::string> names;
+        std::vector<gdbwire_result> results;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_source_files/basic.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    GdbwireSourceFiles files;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    REQUIRE(gdbwire_stream_source_files(wire,
+        GdbwireSourceFiles::source_file, &files) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.resultClass == GDBWIRE_MI_DONE);
+
+    /* Streaming stops after the first result record */
+    REQUIRE(files.names.size() == 3);
+    REQUIRE(files.names[0] == "a.cpp");
+    REQUIRE(files.names[1] == "b.cpp");
+    REQUIRE(files.names[2] == "a.cpp");
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_source_files/push_from_callback)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("stream_source_files/basic.mi"));
+    GdbwireCallbacks callbacks;
+    GdbwireSourceFiles files;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+    files.wire = wire;
+
+    /* The parser is in the middle of the line, it can not be pushed to */
+    REQUIRE(gdbwire_stream_source_files(wire,
+        GdbwireSourceFiles::push_source_file, &files) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.resultClass == GDBWIRE_MI_DONE);
+    REQUIRE(files.names.size() == 3);
+    REQUIRE(files.results.size() == 3);
+    REQUIRE(files.results[0] == GDBWIRE_LOGIC);
+    REQUIRE(files.results[1] == GDBWIRE_LOGIC);
+    REQUIRE(files.results[2] == GDBWIRE_LOGIC);
+
+    /* Once the line is parsed, pushing works again */
+    REQUIRE(gdbwire_push_data(wire, "^done\n", 6) == GDBWIRE_OK);
+
+    gdbwire_destroy(wire);
+}
+
+namespace {
+    struct GdbwireInstructions {
+        static void instruction(void *context,
+                gdbwire_mi_instruction *instruction) {
+            GdbwireInstructions *instructions =
+                (GdbwireInstructions *)context;
+            REQUIRE(instruction);
+            REQUIRE(instruction->inst);
+            instructions->addresses.push_back(instruction->address);
+        }
+
+        std::vector<uint64_t> addresses;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_instructions/basic.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    GdbwireInstructions instructions;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    REQUIRE(gdbwire_stream_instructions(wire,
+        GdbwireInstructions::instruction, &instructions) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.resultClass == GDBWIRE_MI_DONE);
+
+    /* Streaming stops after the first result record */
+    REQUIRE(instructions.addresses.size() == 2);
+    REQUIRE(instructions.addresses[0] == 0x40052d);
+    REQUIRE(instructions.addresses[1] == 0x40052e);
+
+    gdbwire_destroy(wire);
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_instructions/source.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    GdbwireInstructions instructions;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    REQUIRE(gdbwire_stream_instructions(wire,
+        GdbwireInstructions::instruction, &instructions) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.resultClass == GDBWIRE_MI_DONE);
+
+    REQUIRE(instructions.addresses.size() == 2);
+    REQUIRE(instructions.addresses[0] == 0x40052d);
+    REQUIRE(instructions.addresses[1] == 0x40052e);
+
+    gdbwire_destroy(wire);
+}
+
+namespace {
+    struct GdbwireSymbols {
+        static void symbol_file(void *context,
+                gdbwire_mi_symbol_file *file) {
+            GdbwireSymbols *symbols = (GdbwireSymbols *)context;
+            REQUIRE(file);
+            REQUIRE(file->filename);
+            symbols->files.push_back(file->filename);
+            for (size_t index = 0; index < file->symbols_size; ++index) {
+                symbols->names.push_back(file->symbols[index].name);
+            }
+        }
+
+        static void nondebug_symbol(void *context,
+                gdbwire_mi_symbol *symbol) {
+            GdbwireSymbols *symbols = (GdbwireSymbols *)context;
+            REQUIRE(symbol);
+            REQUIRE(symbol->address);
+            symbols->nondebug.push_back(symbol->name);
+        }
+
+        std::vector<std::string> files;
+        std::vector<std::string> names;
+        std::vector<std::string> nondebug;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireBasicTest, stream_symbols/basic.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    GdbwireCallbacks callbacks;
+    GdbwireSymbols symbols;
+    struct gdbwire *wire = gdbwire_create(callbacks.callbacks);
+    REQUIRE(wire);
+
+    REQUIRE(gdbwire_stream_symbols(wire, GdbwireSymbols::symbol_file,
+        GdbwireSymbols::nondebug_symbol, &symbols) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    REQUIRE(callbacks.resultClass == GDBWIRE_MI_DONE);
+
+    /* Streaming stops after the first result record */
+    REQUIRE(symbols.files.size() == 2);
+    REQUIRE(symbols.files[0] == "/project/f1.c");
+    REQUIRE(symbols.files[1] == "/project/f2.c");
+    REQUIRE(symbols.names.size() == 3);
+    REQUIRE(symbols.names[0] == "f4");
+    REQUIRE(symbols.names[1] == "main");
+    REQUIRE(symbols.names[2] == "f2");
+    REQUIRE(symbols.nondebug.size() == 1);
+    REQUIRE(symbols.nondebug[0] == "_init");
+
+    gdbwire_destroy(wire);
+}
@@ -0,0 +1,204 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireBreakpointTableTest : public Fixture {
+        GdbwireBreakpointTableTest() {
+            struct gdbwire_callbacks wire_callbacks;
+            struct gdbwire_breakpoint_table_callbacks table_callbacks;
+
+            memset(&wire_callbacks, 0, sizeof(wire_callbacks));
+            memset(&table_callbacks, 0, sizeof(table_callbacks));
+            table_callbacks.context = (void*)this;
+            table_callbacks.gdbwire_breakpoint_fn =
+                GdbwireBreakpointTableTest::gdbwire_breakpoint;
+
+            added = modified = deleted = 0;
+
+            table = gdbwire_breakpoint_table_create(table_callbacks);
+            REQUIRE(table);
+            wire = gdbwire_create(wire_callbacks);
+            REQUIRE(wire);
+            REQUIRE(gdbwire_set_breakpoint_table(wire, table) == GDBWIRE_OK);
+        }
+
+        ~GdbwireBreakpointTableTest() {
+            gdbwire_destroy(wire);
+            gdbwire_breakpoint_table_destroy(table);
+        }
+
+        static void gdbwire_breakpoint(void *context,
+                enum gdbwire_breakpoint_table_change change,
+                struct gdbwire_breakpoint *breakpoint) {
+            GdbwireBreakpointTableTest *test =
+                (GdbwireBreakpointTableTest *)context;
+            REQUIRE(breakpoint);
+            REQUIRE(breakpoint->breakpoint);
+            switch (change) {
+                case GDBWIRE_BREAKPOINT_TABLE_ADDED:
+                    test->added++;
+                    break;
+                case GDBWIRE_BREAKPOINT_TABLE_MODIFIED:
+                    test->modified++;
+                    break;
+                case GDBWIRE_BREAKPOINT_TABLE_DELETED:
+                    test->deleted++;
+                    break;
+            }
+        }
+
+        /**
+         * Resynchronize the breakpoint table with a -break-info file.
+         *
+         * @param path
+         * The path to the -break-info output.
+         */
+        void break_info(const std::string &path) {
+            std::string mi = getFileContents(path);
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(),
+                GDBWIRE_MI_BREAK_INFO, &mi_command) == GDBWIRE_OK);
+            REQUIRE(mi_command);
+            REQUIRE(gdbwire_breakpoint_table_break_info(table,
+                mi_command) == GDBWIRE_OK);
+            REQUIRE(!mi_command->variant.break_info.breakpoints);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        gdbwire *wire;
+        gdbwire_breakpoint_table *table;
+
+        int added, modified, deleted;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireBreakpointTableTest, destroy/null_instance)
+{
+    gdbwire_breakpoint_table_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireBreakpointTableTest, async/lifecycle.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    struct gdbwire_breakpoint **breakpoints, *breakpoint;
+    struct gdbwire_mi_breakpoint *location;
+    size_t size;
+
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+
+    REQUIRE(added == 3);
+    REQUIRE(modified == 1);
+    REQUIRE(deleted == 1);
+
+    breakpoints = gdbwire_breakpoint_table_breakpoints(table, &size);
+    REQUIRE(breakpoints);
+    REQUIRE(size == 2);
+    REQUIRE(std::string(breakpoints[0]->breakpoint->number) == "1");
+    REQUIRE(std::string(breakpoints[1]->breakpoint->number) == "3");
+
+    breakpoint = gdbwire_breakpoint_table_find(table, "1");
+    REQUIRE(breakpoint == breakpoints[0]);
+    REQUIRE(breakpoint->breakpoint->times == 1);
+    REQUIRE(!breakpoint->locations);
+    REQUIRE(breakpoint->locations_size == 0);
+
+    REQUIRE(!gdbwire_breakpoint_table_find(table, "2"));
+    REQUIRE(!gdbwire_breakpoint_table_location(table, "2.1"));
+
+    breakpoint = gdbwire_breakpoint_table_find(table, "3");
+    REQUIRE(breakpoint);
+    REQUIRE(breakpoint->breakpoint->multi);
+    REQUIRE(breakpoint->locations_size == 3);
+    REQUIRE(breakpoint->locations[0] ==
+        breakpoint->breakpoint->multi_breakpoints);
+
+    location = gdbwire_breakpoint_table_location(table, "3.3");
+    REQUIRE(location == breakpoint->locations[2]);
+    REQUIRE(location->multi_breakpoint == breakpoint->breakpoint);
+    REQUIRE(std::string(location->func_name) == "S<char>::sum(int, int)");
+    REQUIRE(!location->enabled);
+
+    REQUIRE(!gdbwire_breakpoint_table_location(table, "3.4"));
+    REQUIRE(!gdbwire_breakpoint_table_location(table, "3"));
+}
+
+TEST_CASE_METHOD_N(GdbwireBreakpointTableTest, async/mi2_locations)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("async/lifecycle.mi"));
+    struct gdbwire_breakpoint *breakpoint;
+
+    /* Stop before the =breakpoint-deleted record */
+    mi = mi.substr(0, mi.find("=breakpoint-deleted"));
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+
+    breakpoint = gdbwire_breakpoint_table_find(table, "2");
+    REQUIRE(breakpoint);
+    REQUIRE(breakpoint->locations_size == 2);
+    REQUIRE(std::string(breakpoint->locations[0]->number) == "2.1");
+    REQUIRE(std::string(breakpoint->locations[1]->number) == "2.2");
+    REQUIRE(breakpoint->locations[1]->multi_breakpoint ==
+        breakpoint->breakpoint);
+    REQUIRE(gdbwire_breakpoint_table_location(table, "2.2") ==
+        breakpoint->locations[1]);
+}
+
+TEST_CASE_METHOD_N(GdbwireBreakpointTableTest, async/delete_moves_last)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("async/lifecycle.mi"));
+    struct gdbwire_breakpoint **breakpoints;
+    size_t size;
+
+    /* Stop before the =breakpoint-deleted record */
+    mi = mi.substr(0, mi.find("=breakpoint-deleted"));
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+
+    /* The last breakpoint takes the place of the deleted one */
+    mi = "=breakpoint-deleted,id=\"1\"\n";
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    breakpoints = gdbwire_breakpoint_table_breakpoints(table, &size);
+    REQUIRE(size == 2);
+    REQUIRE(std::string(breakpoints[0]->breakpoint->number) == "3");
+    REQUIRE(std::string(breakpoints[1]->breakpoint->number) == "2");
+
+    /* Deleting the moved breakpoint finds it in it's new place */
+    mi = "=breakpoint-deleted,id=\"3\"\n"
+         "=breakpoint-deleted,id=\"4\"\n";
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    breakpoints = gdbwire_breakpoint_table_breakpoints(table, &size);
+    REQUIRE(size == 1);
+    REQUIRE(std::string(breakpoints[0]->breakpoint->number) == "2");
+    REQUIRE(!gdbwire_breakpoint_table_find(table, "3"));
+    REQUIRE(deleted == 2);
+}
+
+TEST_CASE_METHOD_N(GdbwireBreakpointTableTest, break_info/resync)
+{
+    std::string dir = sourceFixturePath("break_info/");
+    struct gdbwire_breakpoint **breakpoints;
+    size_t size;
+
+    break_info(dir + "two_bkpts.mi");
+    REQUIRE(added == 2);
+    REQUIRE(gdbwire_breakpoint_table_breakpoints(table, &size));
+    REQUIRE(size == 2);
+    REQUIRE(gdbwire_breakpoint_table_location(table, "2.1"));
+
+    /* Breakpoint 1 was deleted and breakpoint 2 modified behind our back */
+    break_info(dir + "one_bkpt.mi");
+    REQUIRE(added == 2);
+    REQUIRE(modified == 1);
+    REQUIRE(deleted == 1);
+
+    breakpoints = gdbwire_breakpoint_table_breakpoints(table, &size);
+    REQUIRE(size == 1);
+    REQUIRE(std::string(breakpoints[0]->breakpoint->number) == "2");
+    REQUIRE(!breakpoints[0]->breakpoint->enabled);
+    REQUIRE(breakpoints[0]->breakpoint->times == 4);
+    REQUIRE(breakpoints[0]->locations_size == 2);
+    REQUIRE(!gdbwire_breakpoint_table_find(table, "1"));
+}
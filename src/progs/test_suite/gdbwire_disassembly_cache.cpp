@@ -0,0 +1,183 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireDisassemblyCacheTest : public Fixture {
+        GdbwireDisassemblyCacheTest() {
+            cache = gdbwire_disassembly_cache_create();
+            REQUIRE(cache);
+        }
+
+        ~GdbwireDisassemblyCacheTest() {
+            gdbwire_disassembly_cache_destroy(cache);
+        }
+
+        /**
+         * Add the output of -data-disassemble to the cache.
+         *
+         * @param name
+         * The name of the file in the GdbwireDisassemblyCacheTest directory.
+         *
+         * @param begin
+         * The start address that was disassembled.
+         *
+         * @param end
+         * The end address that was disassembled.
+         */
+        void add(const std::string &name, uint64_t begin, uint64_t end) {
+            std::string mi = getFileContents(sourceFixturePath(name));
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(),
+                GDBWIRE_MI_DATA_DISASSEMBLE, &mi_command) == GDBWIRE_OK);
+            REQUIRE(gdbwire_disassembly_cache_data_disassemble(cache,
+                begin, end, mi_command) == GDBWIRE_OK);
+            REQUIRE(!mi_command->variant.data_disassemble.instructions);
+            REQUIRE(!mi_command->variant.data_disassemble.strings);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        /**
+         * Get the instruction at an address from the cache.
+         *
+         * @param address
+         * The address of the instruction.
+         *
+         * @return
+         * The instruction or an empty string if it is not cached.
+         */
+        std::string inst(uint64_t address) {
+            const gdbwire_mi_instruction *instruction =
+                gdbwire_disassembly_cache_instruction(cache, address);
+            return (instruction) ? instruction->inst : "";
+        }
+
+        gdbwire_disassembly_cache *cache;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, destroy/null_instance)
+{
+    gdbwire_disassembly_cache_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, find/ranges)
+{
+    const gdbwire_disassembly *disassembly;
+
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400500));
+
+    add("f.mi", 0x400520, 0x400523);
+    add("main.mi", 0x400500, 0x40050b);
+
+    disassembly = gdbwire_disassembly_cache_find(cache, 0x400500);
+    REQUIRE(disassembly);
+    REQUIRE(disassembly->begin == 0x400500);
+    REQUIRE(disassembly->end == 0x40050b);
+    REQUIRE(disassembly->instructions_size == 5);
+    REQUIRE(disassembly->instructions[4].address == 0x40050a);
+    REQUIRE(!disassembly->source_lines);
+
+    disassembly = gdbwire_disassembly_cache_find(cache, 0x400522);
+    REQUIRE(disassembly);
+    REQUIRE(disassembly->begin == 0x400520);
+    REQUIRE(disassembly->instructions_size == 3);
+
+    /* Between and after the ranges */
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x40050b));
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400523));
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x4004ff));
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, instruction/lookup)
+{
+    add("main.mi", 0x400500, 0x40050b);
+
+    REQUIRE(inst(0x400500) == "push   %rbp");
+    REQUIRE(inst(0x400504) == "callq  0x400520 <f>");
+    REQUIRE(inst(0x40050a) == "retq");
+
+    /* In the range, but not the start of an instruction */
+    REQUIRE(inst(0x400502) == "");
+    REQUIRE(inst(0x400520) == "");
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, instruction/source_order)
+{
+    const gdbwire_disassembly *disassembly;
+
+    add("source_order.mi", 0x400500, 0x40050b);
+
+    disassembly = gdbwire_disassembly_cache_find(cache, 0x400500);
+    REQUIRE(disassembly);
+    REQUIRE(disassembly->source_lines_size == 2);
+    REQUIRE(disassembly->source_lines[0].line == 7);
+
+    REQUIRE(inst(0x400509) == "pop    %rbp");
+    REQUIRE(inst(0x400500) == "push   %rbp");
+    REQUIRE(inst(0x400501) == "mov    %rsp,%rbp");
+    REQUIRE(inst(0x400504) == "");
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, data_disassemble/replace)
+{
+    const gdbwire_disassembly *disassembly;
+
+    add("main.mi", 0x400500, 0x40050b);
+    add("f.mi", 0x400520, 0x400523);
+
+    /* A range overlapping both replaces them */
+    add("main.mi", 0x400508, 0x400521);
+
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400500));
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400522));
+    disassembly = gdbwire_disassembly_cache_find(cache, 0x400520);
+    REQUIRE(disassembly);
+    REQUIRE(disassembly->begin == 0x400508);
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, invalidate/overlap)
+{
+    add("main.mi", 0x400500, 0x40050b);
+    add("f.mi", 0x400520, 0x400523);
+
+    gdbwire_disassembly_cache_invalidate(cache, 0x40050b, 0x16);
+    REQUIRE(inst(0x400500) == "push   %rbp");
+    REQUIRE(inst(0x400520) == "");
+
+    gdbwire_disassembly_cache_invalidate(cache, UINT64_MAX, 2);
+    REQUIRE(inst(0x400500) == "push   %rbp");
+
+    gdbwire_disassembly_cache_clear(cache);
+    REQUIRE(inst(0x400500) == "");
+}
+
+TEST_CASE_METHOD_N(GdbwireDisassemblyCacheTest, async/changed_and_unloaded.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    std::string changed = mi.substr(0, mi.find("=library-unloaded"));
+    std::string unloaded = mi.substr(changed.size());
+    struct gdbwire_callbacks callbacks;
+    struct gdbwire *wire;
+
+    add("main.mi", 0x400500, 0x40050b);
+    add("f.mi", 0x400520, 0x400523);
+
+    memset(&callbacks, 0, sizeof(callbacks));
+    wire = gdbwire_create(callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_disassembly_cache(wire, cache) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, changed.data(), changed.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(inst(0x400500) == "push   %rbp");
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400520));
+
+    REQUIRE(gdbwire_push_data(wire, unloaded.data(), unloaded.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(!gdbwire_disassembly_cache_find(cache, 0x400500));
+
+    gdbwire_destroy(wire);
+}
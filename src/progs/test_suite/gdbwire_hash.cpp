@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_hash.h"
+
+namespace {
+    struct GdbwireHashTest : public Fixture {
+        GdbwireHashTest() {
+            hash = gdbwire_hash_create(NULL);
+            REQUIRE(hash);
+        }
+
+        ~GdbwireHashTest() {
+            gdbwire_hash_destroy(hash);
+        }
+
+        static void count(void *context, const char *key, void *value) {
+            int *total = (int *)context;
+            *total += (int)(size_t)value;
+        }
+
+        static void free_value(void *value) {
+            freed++;
+        }
+
+        static int freed;
+
+        gdbwire_hash *hash;
+    };
+
+    int GdbwireHashTest::freed;
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, destroy/null_instance)
+{
+    gdbwire_hash_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, insert/null)
+{
+    REQUIRE(gdbwire_hash_insert(NULL, "a", NULL) == -1);
+    REQUIRE(gdbwire_hash_insert(hash, NULL, NULL) == -1);
+    REQUIRE(gdbwire_hash_size(hash) == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, insert/replace)
+{
+    int one = 1, two = 2;
+
+    REQUIRE(gdbwire_hash_insert(hash, "key", &one) == 0);
+    REQUIRE(gdbwire_hash_find(hash, "key") == &one);
+    REQUIRE(gdbwire_hash_insert(hash, "key", &two) == 0);
+    REQUIRE(gdbwire_hash_find(hash, "key") == &two);
+    REQUIRE(gdbwire_hash_size(hash) == 1);
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, find/data)
+{
+    int one = 1;
+    const char *buffer = "thread-id=\"1\"";
+
+    REQUIRE(gdbwire_hash_insert(hash, "thread-id", &one) == 0);
+    REQUIRE(gdbwire_hash_find_data(hash, buffer, 9) == &one);
+    REQUIRE(gdbwire_hash_find_data(hash, buffer, 6) == NULL);
+    REQUIRE(gdbwire_hash_find(hash, "thread") == NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, remove/many)
+{
+    char key[32];
+    int index, total = 0;
+
+    // Insert enough keys to grow the table a few times
+    for (index = 1; index <= 1000; ++index) {
+        snprintf(key, sizeof(key), "key%d", index);
+        REQUIRE(gdbwire_hash_insert(hash, key, (void*)(size_t)index) == 0);
+    }
+    REQUIRE(gdbwire_hash_size(hash) == 1000);
+
+    // Remove the even keys, the odd keys must still be reachable
+    for (index = 2; index <= 1000; index += 2) {
+        snprintf(key, sizeof(key), "key%d", index);
+        REQUIRE(gdbwire_hash_remove(hash, key) == 0);
+        REQUIRE(gdbwire_hash_remove(hash, key) == -1);
+    }
+    REQUIRE(gdbwire_hash_size(hash) == 500);
+
+    for (index = 1; index <= 1000; ++index) {
+        snprintf(key, sizeof(key), "key%d", index);
+        if (index % 2) {
+            REQUIRE(gdbwire_hash_find(hash, key) == (void*)(size_t)index);
+        } else {
+            REQUIRE(gdbwire_hash_find(hash, key) == NULL);
+        }
+    }
+
+    gdbwire_hash_foreach(hash, GdbwireHashTest::count, &total);
+    REQUIRE(total == 500 * 500);
+}
+
+TEST_CASE_METHOD_N(GdbwireHashTest, free_fn)
+{
+    gdbwire_hash *owner = gdbwire_hash_create(GdbwireHashTest::free_value);
+    REQUIRE(owner);
+    freed = 0;
+
+    REQUIRE(gdbwire_hash_insert(owner, "a", (void*)1) == 0);
+    REQUIRE(gdbwire_hash_insert(owner, "b", (void*)2) == 0);
+    REQUIRE(gdbwire_hash_insert(owner, "a", (void*)3) == 0);
+    REQUIRE(freed == 1);
+    REQUIRE(gdbwire_hash_remove(owner, "b") == 0);
+    REQUIRE(freed == 2);
+
+    gdbwire_hash_destroy(owner);
+    REQUIRE(freed == 3);
+}
@@ -0,0 +1,93 @@
+#include <string.h>
+#include <string>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_hex.h"
+
+namespace {
+    struct GdbwireHexTest : public Fixture {
+        /**
+         * Encode bytes as hexadecimal digits, the way GDB does.
+         *
+         * @param bytes
+         * The bytes to encode.
+         *
+         * @param upper
+         * True to use upper case digits, otherwise lower case.
+         *
+         * @return
+         * The hexadecimal digits.
+         */
+        std::string encode(const std::string &bytes, bool upper) {
+            const char *digits = upper ? "0123456789ABCDEF" :
+                "0123456789abcdef";
+            std::string result;
+            size_t index;
+
+            for (index = 0; index < bytes.size(); ++index) {
+                unsigned char byte = (unsigned char)bytes[index];
+                result.push_back(digits[byte >> 4]);
+                result.push_back(digits[byte & 0xF]);
+            }
+
+            return result;
+        }
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireHexTest, decode/basic)
+{
+    unsigned char out[4];
+
+    REQUIRE(gdbwire_hex_decode("00ff7Fa0", 8, out) == 0);
+    REQUIRE(out[0] == 0x00);
+    REQUIRE(out[1] == 0xff);
+    REQUIRE(out[2] == 0x7f);
+    REQUIRE(out[3] == 0xa0);
+
+    REQUIRE(gdbwire_hex_decode("", 0, out) == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireHexTest, decode/invalid)
+{
+    unsigned char out[4];
+
+    REQUIRE(gdbwire_hex_decode("0", 1, out) == -1);
+    REQUIRE(gdbwire_hex_decode("0g", 2, out) == -1);
+    REQUIRE(gdbwire_hex_decode("x0", 2, out) == -1);
+    REQUIRE(gdbwire_hex_decode("0\xb0", 2, out) == -1);
+}
+
+TEST_CASE_METHOD_N(GdbwireHexTest, decode/long)
+{
+    std::string bytes, hex;
+    std::string out;
+    size_t index, size;
+
+    for (index = 0; index < 1000; ++index) {
+        bytes.push_back((char)(index * 7 + index / 256));
+    }
+
+    // Every size, so that each part of the decoder is used
+    for (size = 0; size <= 100; ++size) {
+        hex = encode(bytes.substr(0, size), size % 2 == 0);
+        out.assign(size, '\0');
+        REQUIRE(gdbwire_hex_decode(hex.data(), hex.size(),
+            (unsigned char *)&out[0]) == 0);
+        REQUIRE(out == bytes.substr(0, size));
+    }
+
+    hex = encode(bytes, false);
+    out.assign(bytes.size(), '\0');
+    REQUIRE(gdbwire_hex_decode(hex.data(), hex.size(),
+        (unsigned char *)&out[0]) == 0);
+    REQUIRE(out == bytes);
+
+    // A bad digit anywhere is found, including in the middle of a block
+    for (index = 0; index < 100; ++index) {
+        std::string bad = hex;
+        bad[index] = (index % 3) ? 'g' : '/';
+        REQUIRE(gdbwire_hex_decode(bad.data(), bad.size(),
+            (unsigned char *)&out[0]) == -1);
+    }
+}
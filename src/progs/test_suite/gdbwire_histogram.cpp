@@ -0,0 +1,79 @@
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_histogram.h"
+
+namespace {
+    struct GdbwireHistogramTest : public Fixture {
+        GdbwireHistogramTest() {
+            histogram = gdbwire_histogram_create();
+            REQUIRE(histogram);
+        }
+
+        ~GdbwireHistogramTest() {
+            gdbwire_histogram_destroy(histogram);
+        }
+
+        gdbwire_histogram *histogram;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireHistogramTest, quantile/empty)
+{
+    REQUIRE(gdbwire_histogram_count(histogram) == 0);
+    REQUIRE(gdbwire_histogram_max(histogram) == 0);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 0.5) == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireHistogramTest, quantile/exact)
+{
+    uint64_t value;
+
+    /* Small values each have their own bucket */
+    for (value = 1; value <= 10; ++value) {
+        gdbwire_histogram_record(histogram, value);
+    }
+
+    REQUIRE(gdbwire_histogram_count(histogram) == 10);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 0) == 1);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 0.5) == 5);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 0.99) == 10);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 1) == 10);
+}
+
+TEST_CASE_METHOD_N(GdbwireHistogramTest, quantile/tail)
+{
+    uint64_t p50, p99, p999;
+    int index;
+
+    /* 1000 values of 1ms, with a tail of 10 at 1s */
+    for (index = 0; index < 990; ++index) {
+        gdbwire_histogram_record(histogram, 1000000);
+    }
+    for (index = 0; index < 10; ++index) {
+        gdbwire_histogram_record(histogram, 1000000000);
+    }
+
+    p50 = gdbwire_histogram_quantile(histogram, 0.5);
+    p99 = gdbwire_histogram_quantile(histogram, 0.99);
+    p999 = gdbwire_histogram_quantile(histogram, 0.999);
+
+    /* A bucket is at most a sixteenth of it's values wide */
+    REQUIRE(p50 >= 1000000);
+    REQUIRE(p50 < 1000000 + 1000000 / GDBWIRE_HISTOGRAM_SUB_BUCKETS);
+    REQUIRE(p99 == p50);
+    REQUIRE(p999 == 1000000000);
+    REQUIRE(gdbwire_histogram_max(histogram) == 1000000000);
+}
+
+TEST_CASE_METHOD_N(GdbwireHistogramTest, record/limits)
+{
+    gdbwire_histogram_record(histogram, 0);
+    gdbwire_histogram_record(histogram, ~(uint64_t)0);
+
+    REQUIRE(gdbwire_histogram_quantile(histogram, 0.5) == 0);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 1) == ~(uint64_t)0);
+
+    gdbwire_histogram_clear(histogram);
+    REQUIRE(gdbwire_histogram_count(histogram) == 0);
+    REQUIRE(gdbwire_histogram_quantile(histogram, 1) == 0);
+}
@@ -0,0 +1,125 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireLineTableCacheTest : public Fixture {
+        GdbwireLineTableCacheTest() {
+            cache = gdbwire_line_table_cache_create();
+            REQUIRE(cache);
+        }
+
+        ~GdbwireLineTableCacheTest() {
+            gdbwire_line_table_cache_destroy(cache);
+        }
+
+        /**
+         * Add the output of -symbol-list-lines to the cache.
+         *
+         * @param name
+         * The name of the file in the GdbwireLineTableCacheTest directory.
+         *
+         * @param fullname
+         * The source file that was listed.
+         *
+         * @param objfile
+         * The object file the source file belongs to or NULL.
+         */
+        void add(const std::string &name, const char *fullname,
+                const char *objfile) {
+            std::string mi = getFileContents(sourceFixturePath(name));
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(),
+                GDBWIRE_MI_SYMBOL_LIST_LINES, &mi_command) == GDBWIRE_OK);
+            REQUIRE(gdbwire_line_table_cache_symbol_list_lines(cache,
+                fullname, objfile, mi_command) == GDBWIRE_OK);
+            REQUIRE(!mi_command->variant.symbol_list_lines.table);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        gdbwire_line_table_cache *cache;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireLineTableCacheTest, destroy/null_instance)
+{
+    gdbwire_line_table_cache_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireLineTableCacheTest, find/files)
+{
+    const gdbwire_mi_line_table *table;
+
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/main.c"));
+
+    add("main.mi", "/project/main.c", NULL);
+    add("lib.mi", "/project/f.c", "/usr/lib/libf.so");
+
+    table = gdbwire_line_table_cache_find(cache, "/project/main.c");
+    REQUIRE(table);
+    REQUIRE(table->size == 2);
+    REQUIRE(table->by_address[1].pc == 0x400504);
+
+    table = gdbwire_line_table_cache_find(cache, "/project/f.c");
+    REQUIRE(table);
+    REQUIRE(table->size == 1);
+    REQUIRE(table->by_line[0].line == 12);
+
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/g.c"));
+
+    /* Listing a file again replaces it's line table */
+    add("lib.mi", "/project/main.c", NULL);
+    table = gdbwire_line_table_cache_find(cache, "/project/main.c");
+    REQUIRE(table);
+    REQUIRE(table->size == 1);
+}
+
+TEST_CASE_METHOD_N(GdbwireLineTableCacheTest, invalidate/objfile)
+{
+    add("main.mi", "/project/main.c", NULL);
+    add("lib.mi", "/project/f.c", "/usr/lib/libf.so");
+    add("lib.mi", "/project/g.c", "/usr/lib/libf.so");
+    add("lib.mi", "/project/h.c", "/usr/lib/libh.so");
+
+    gdbwire_line_table_cache_invalidate(cache, "/usr/lib/libf.so");
+    REQUIRE(gdbwire_line_table_cache_find(cache, "/project/main.c"));
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/f.c"));
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/g.c"));
+    REQUIRE(gdbwire_line_table_cache_find(cache, "/project/h.c"));
+
+    gdbwire_line_table_cache_clear(cache);
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/main.c"));
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/h.c"));
+}
+
+TEST_CASE_METHOD_N(GdbwireLineTableCacheTest, async/loaded_and_unloaded.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    std::string loaded = mi.substr(0, mi.find("=library-unloaded"));
+    std::string unloaded = mi.substr(loaded.size());
+    struct gdbwire_callbacks callbacks;
+    struct gdbwire *wire;
+
+    add("main.mi", "/project/main.c", NULL);
+    add("lib.mi", "/project/f.c", "/sysroot/usr/lib/libf.so");
+
+    memset(&callbacks, 0, sizeof(callbacks));
+    wire = gdbwire_create(callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_line_table_cache(wire, cache) == GDBWIRE_OK);
+
+    /* Another library does not affect the cached line tables */
+    REQUIRE(gdbwire_push_data(wire, loaded.data(), loaded.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(gdbwire_line_table_cache_find(cache, "/project/f.c"));
+
+    /* The library is matched by it's host name */
+    REQUIRE(gdbwire_push_data(wire, unloaded.data(), unloaded.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(!gdbwire_line_table_cache_find(cache, "/project/f.c"));
+    REQUIRE(gdbwire_line_table_cache_find(cache, "/project/main.c"));
+
+    gdbwire_destroy(wire);
+}
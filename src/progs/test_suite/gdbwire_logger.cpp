@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_logger.h"
+
+namespace {
+    struct GdbwireLoggerTest : public Fixture {
+        GdbwireLoggerTest() {
+            /* Start from an empty log */
+            gdbwire_logger_drain(NULL, NULL);
+        }
+
+        ~GdbwireLoggerTest() {
+            gdbwire_logger_set_level(GDBWIRE_LOGGER_NONE);
+            gdbwire_logger_drain(NULL, NULL);
+        }
+
+        static void sink(void *context,
+                const gdbwire_logger_record *record) {
+            GdbwireLoggerTest *test = (GdbwireLoggerTest *)context;
+            test->levels.push_back(record->level);
+            test->messages.push_back(record->message);
+        }
+
+        size_t drain() {
+            return gdbwire_logger_drain(sink, this);
+        }
+
+        std::vector<gdbwire_logger_level> levels;
+        std::vector<std::string> messages;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireLoggerTest, log/level)
+{
+    gdbwire_logger_set_level(GDBWIRE_LOGGER_WARN);
+
+    gdbwire_debug("debug %d", 1);
+    gdbwire_info("info %d", 2);
+    gdbwire_warn("warn %d", 3);
+    gdbwire_error("error %s", "four");
+
+    REQUIRE(drain() == 2);
+    REQUIRE(levels[0] == GDBWIRE_LOGGER_WARN);
+    REQUIRE(messages[0] == "warn 3");
+    REQUIRE(levels[1] == GDBWIRE_LOGGER_ERROR);
+    REQUIRE(messages[1] == "error four");
+
+    /* Draining again finds nothing */
+    REQUIRE(drain() == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoggerTest, log/none)
+{
+    gdbwire_logger_set_level(GDBWIRE_LOGGER_NONE);
+
+    gdbwire_error("error");
+
+    REQUIRE(drain() == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoggerTest, log/truncated)
+{
+    std::string message(GDBWIRE_LOGGER_MESSAGE_SIZE * 2, 'x');
+
+    gdbwire_logger_set_level(GDBWIRE_LOGGER_DEBUG);
+    gdbwire_debug("%s", message.c_str());
+
+    REQUIRE(drain() == 1);
+    REQUIRE(messages[0] == message.substr(0, GDBWIRE_LOGGER_MESSAGE_SIZE - 1));
+}
+
+TEST_CASE_METHOD_N(GdbwireLoggerTest, log/full)
+{
+    size_t dropped = gdbwire_logger_dropped();
+    char last[16];
+    int index;
+
+    gdbwire_logger_set_level(GDBWIRE_LOGGER_DEBUG);
+    for (index = 0; index < GDBWIRE_LOGGER_RING_SIZE + 3; ++index) {
+        gdbwire_debug("%d", index);
+    }
+
+    /* The newest messages are dropped, the log keeps the oldest */
+    REQUIRE(gdbwire_logger_dropped() == dropped + 3);
+    REQUIRE(drain() == GDBWIRE_LOGGER_RING_SIZE);
+    REQUIRE(messages[0] == "0");
+    snprintf(last, sizeof(last), "%d", GDBWIRE_LOGGER_RING_SIZE - 1);
+    REQUIRE(messages[GDBWIRE_LOGGER_RING_SIZE - 1] == last);
+
+    /* The slots are reused after they are drained */
+    gdbwire_debug("again");
+    REQUIRE(drain() == 1);
+    REQUIRE(messages.back() == "again");
+}
@@ -0,0 +1,274 @@
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_loop.h"
+
+namespace {
+    /** A fake GDB, a pair of pipes standing in for it's stdin and stdout. */
+    struct GdbwireLoopGdb {
+        GdbwireLoopGdb() : loop(0), session(0), streamsWhenClosed(0),
+                prompts(0), closed(0),
+                closedResult(GDBWIRE_OK), removeOnResult(false) {
+            REQUIRE(pipe(in) == 0);
+            REQUIRE(pipe(out) == 0);
+        }
+
+        ~GdbwireLoopGdb() {
+            close(in[0]);
+            close(in[1]);
+            close(out[0]);
+            if (out[1] != -1) {
+                close(out[1]);
+            }
+        }
+
+        /** Write GDB output for the session to read. */
+        void output(const std::string &data) {
+            REQUIRE(write(out[1], data.data(), data.size()) ==
+                (ssize_t)data.size());
+        }
+
+        /** Read what the session wrote to GDB. */
+        std::string input() {
+            char buffer[4096];
+            ssize_t count = read(in[0], buffer, sizeof(buffer));
+            return (count > 0) ? std::string(buffer, count) : "";
+        }
+
+        static void gdbwire_result_record_fn(void *context,
+                gdbwire_mi_result_record *result_record) {
+            GdbwireLoopGdb *gdb = (GdbwireLoopGdb *)context;
+            gdb->results.push_back(result_record->result_class);
+            if (gdb->removeOnResult) {
+                REQUIRE(gdbwire_loop_remove(gdb->loop, gdb->session) ==
+                    GDBWIRE_OK);
+            }
+        }
+
+        static void gdbwire_stream_record_fn(void *context,
+                gdbwire_mi_stream_record *stream_record) {
+            GdbwireLoopGdb *gdb = (GdbwireLoopGdb *)context;
+            gdb->streams.push_back(stream_record->cstring);
+        }
+
+        static void gdbwire_prompt_fn(void *context, const char *prompt) {
+            GdbwireLoopGdb *gdb = (GdbwireLoopGdb *)context;
+            gdb->prompts++;
+        }
+
+        static void gdbwire_session_closed_fn(void *context,
+                gdbwire_session *session, gdbwire_result result) {
+            GdbwireLoopGdb *gdb = (GdbwireLoopGdb *)context;
+            gdb->closed++;
+            gdb->closedResult = result;
+            gdb->streamsWhenClosed = gdb->streams.size();
+        }
+
+        gdbwire_callbacks callbacks() {
+            gdbwire_callbacks callbacks;
+            memset(&callbacks, 0, sizeof(callbacks));
+            callbacks.context = this;
+            callbacks.gdbwire_result_record_fn = gdbwire_result_record_fn;
+            callbacks.gdbwire_stream_record_fn = gdbwire_stream_record_fn;
+            callbacks.gdbwire_prompt_fn = gdbwire_prompt_fn;
+            return callbacks;
+        }
+
+        int in[2], out[2];
+        gdbwire_loop *loop;
+        gdbwire_session *session;
+        std::vector<gdbwire_mi_result_class> results;
+        std::vector<std::string> streams;
+        size_t streamsWhenClosed;
+        int prompts;
+        int closed;
+        gdbwire_result closedResult;
+        bool removeOnResult;
+    };
+
+    struct GdbwireLoopTest : public Fixture {
+        GdbwireLoopTest() {
+            loop = gdbwire_loop_create(0);
+            REQUIRE(loop);
+        }
+
+        ~GdbwireLoopTest() {
+            gdbwire_loop_destroy(loop);
+        }
+
+        void add(GdbwireLoopGdb &gdb) {
+            gdb.loop = loop;
+            REQUIRE(gdbwire_loop_add(loop, gdb.callbacks(), gdb.in[1],
+                gdb.out[0], GdbwireLoopGdb::gdbwire_session_closed_fn,
+                &gdb.session) == GDBWIRE_OK);
+        }
+
+        gdbwire_loop *loop;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, run_once/dispatch)
+{
+    GdbwireLoopGdb first, second;
+    int serviced;
+
+    add(first);
+    add(second);
+    REQUIRE(gdbwire_loop_size(loop) == 2);
+
+    REQUIRE(gdbwire_loop_run_once(loop, 0, &serviced) == GDBWIRE_OK);
+    REQUIRE(serviced == 0);
+
+    first.output("^done\n(gdb)\n");
+    second.output("^error,msg=\"No symbol table is loaded.\"\n");
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, &serviced) == GDBWIRE_OK);
+    REQUIRE(serviced == 2);
+
+    REQUIRE(first.results.size() == 1);
+    REQUIRE(first.results[0] == GDBWIRE_MI_DONE);
+    REQUIRE(first.prompts == 1);
+    REQUIRE(second.results.size() == 1);
+    REQUIRE(second.results[0] == GDBWIRE_MI_ERROR);
+    REQUIRE(second.prompts == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, run_once/budget)
+{
+    GdbwireLoopGdb gdb;
+
+    gdbwire_loop_destroy(loop);
+    loop = gdbwire_loop_create(8);
+    REQUIRE(loop);
+    add(gdb);
+
+    // Each time through the loop reads at most 8 bytes
+    gdb.output("^done\n(gdb)\n");
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.results.size() == 1);
+    REQUIRE(gdb.prompts == 0);
+
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.prompts == 1);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, session/send)
+{
+    GdbwireLoopGdb gdb;
+    std::string command = "-break-info\n", big(1 << 20, 'x'), received;
+
+    add(gdb);
+    REQUIRE(gdbwire_session_get_wire(gdb.session));
+
+    REQUIRE(gdbwire_session_send(gdb.session, command.data(),
+        command.size()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_session_pending(gdb.session) == 0);
+    REQUIRE(gdb.input() == command);
+
+    // More than the pipe holds waits for GDB to read it
+    REQUIRE(gdbwire_session_send(gdb.session, big.data(), big.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(gdbwire_session_pending(gdb.session) > 0);
+
+    while (received.size() < big.size()) {
+        received += gdb.input();
+        REQUIRE(gdbwire_loop_run_once(loop, 0, NULL) == GDBWIRE_OK);
+    }
+    REQUIRE(received == big);
+    REQUIRE(gdbwire_session_pending(gdb.session) == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, session/closed)
+{
+    GdbwireLoopGdb gdb;
+
+    add(gdb);
+
+    gdb.output("^done\n");
+    close(gdb.out[1]);
+    gdb.out[1] = -1;
+
+    // The output is read before the end of file
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.results.size() == 1);
+    REQUIRE(gdb.closed == 1);
+    REQUIRE(gdb.closedResult == GDBWIRE_OK);
+
+    // A stopped session is not watched and takes no commands
+    REQUIRE(gdbwire_loop_run_once(loop, 0, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.closed == 1);
+    REQUIRE(gdbwire_session_send(gdb.session, "-gdb-exit\n", 10) ==
+        GDBWIRE_LOGIC);
+
+    REQUIRE(gdbwire_loop_remove(loop, gdb.session) == GDBWIRE_OK);
+    REQUIRE(gdbwire_loop_size(loop) == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, session/closed_flushes_stream)
+{
+    GdbwireLoopGdb gdb;
+
+    add(gdb);
+    REQUIRE(gdbwire_set_stream_coalescing(gdbwire_session_get_wire(
+        gdb.session), 1, 0, 0) == GDBWIRE_OK);
+
+    // GDB exits before the prompt that would flush the stream data
+    gdb.output("~\"line 1\\n\"\n~\"line 2\\n\"\n");
+    close(gdb.out[1]);
+    gdb.out[1] = -1;
+
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.closed == 1);
+    REQUIRE(gdb.streams.size() == 1);
+    REQUIRE(gdb.streams[0] == "line 1\nline 2\n");
+    REQUIRE(gdb.streamsWhenClosed == 1);
+
+    REQUIRE(gdbwire_loop_remove(loop, gdb.session) == GDBWIRE_OK);
+    REQUIRE(gdb.streams.size() == 1);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, remove/flushes_stream)
+{
+    GdbwireLoopGdb gdb;
+
+    add(gdb);
+    REQUIRE(gdbwire_set_stream_coalescing(gdbwire_session_get_wire(
+        gdb.session), 1, 0, 0) == GDBWIRE_OK);
+
+    gdb.output("~\"line 1\\n\"\n");
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdb.streams.empty());
+
+    REQUIRE(gdbwire_loop_remove(loop, gdb.session) == GDBWIRE_OK);
+    REQUIRE(gdbwire_loop_size(loop) == 0);
+    REQUIRE(gdb.streams.size() == 1);
+    REQUIRE(gdb.streams[0] == "line 1\n");
+    REQUIRE(gdb.closed == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireLoopTest, remove/from_callback)
+{
+    GdbwireLoopGdb first, second;
+
+    add(first);
+    add(second);
+    first.removeOnResult = true;
+
+    // The session is destroyed once it's output read so far is dispatched
+    first.output("^done\n(gdb)\n");
+    second.output("^done\n(gdb)\n");
+    REQUIRE(gdbwire_loop_run_once(loop, 1000, NULL) == GDBWIRE_OK);
+    REQUIRE(gdbwire_loop_size(loop) == 1);
+    REQUIRE(first.results.size() == 1);
+    REQUIRE(first.prompts == 1);
+    REQUIRE(second.results.size() == 1);
+    REQUIRE(second.prompts == 1);
+
+    first.output("^done\n");
+    REQUIRE(gdbwire_loop_run_once(loop, 0, NULL) == GDBWIRE_OK);
+    REQUIRE(first.results.size() == 1);
+}
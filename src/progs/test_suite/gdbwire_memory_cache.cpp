@@ -0,0 +1,168 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireMemoryCacheTest : public Fixture {
+        GdbwireMemoryCacheTest() {
+            cache = gdbwire_memory_cache_create();
+            REQUIRE(cache);
+        }
+
+        ~GdbwireMemoryCacheTest() {
+            gdbwire_memory_cache_destroy(cache);
+        }
+
+        /**
+         * Add the output of -data-read-memory-bytes to the cache.
+         *
+         * @param name
+         * The name of the file in the GdbwireMemoryCacheTest directory.
+         */
+        void add(const std::string &name) {
+            std::string mi = getFileContents(sourceFixturePath(name));
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(),
+                GDBWIRE_MI_DATA_READ_MEMORY_BYTES, &mi_command) ==
+                    GDBWIRE_OK);
+            REQUIRE(gdbwire_memory_cache_data_read_memory_bytes(cache,
+                mi_command) == GDBWIRE_OK);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        /**
+         * Read a byte from the cache.
+         *
+         * @param address
+         * The address of the byte.
+         *
+         * @return
+         * The byte or -1 if it is not cached.
+         */
+        int byte(uint64_t address) {
+            unsigned char value;
+            if (gdbwire_memory_cache_read(cache, address, 1, &value) != 0) {
+                return -1;
+            }
+            return value;
+        }
+
+        gdbwire_memory_cache *cache;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireMemoryCacheTest, destroy/null_instance)
+{
+    gdbwire_memory_cache_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireMemoryCacheTest, read/overlapping)
+{
+    unsigned char buffer[24];
+    gdbwire_memory_cache_stats stats;
+
+    add("read.mi");
+
+    REQUIRE(gdbwire_memory_cache_read(cache, 0x601002, 4, buffer) == 0);
+    REQUIRE(buffer[0] == 0x02);
+    REQUIRE(buffer[3] == 0x05);
+
+    /* The gap between the two blocks is not cached */
+    REQUIRE(gdbwire_memory_cache_read(cache, 0x601006, 4, buffer) == -1);
+    REQUIRE(gdbwire_memory_cache_read(cache, 0x600fff, 2, buffer) == -1);
+    REQUIRE(gdbwire_memory_cache_read(cache, 0x601010, 9, buffer) == -1);
+
+    gdbwire_memory_cache_get_stats(cache, &stats);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 3);
+    REQUIRE(stats.hit_bytes == 4);
+    REQUIRE(stats.regions == 2);
+    REQUIRE(stats.bytes == 16);
+
+    /* Filling the gap merges the blocks, the new memory wins */
+    add("fill.mi");
+    REQUIRE(gdbwire_memory_cache_read(cache, 0x601000, 24, buffer) == 0);
+    REQUIRE(buffer[5] == 0x05);
+    REQUIRE(buffer[6] == 0xa6);
+    REQUIRE(buffer[8] == 0x08);
+    REQUIRE(buffer[17] == 0xb1);
+    REQUIRE(buffer[18] == 0x12);
+    REQUIRE(buffer[23] == 0x17);
+
+    gdbwire_memory_cache_get_stats(cache, &stats);
+    REQUIRE(stats.regions == 1);
+    REQUIRE(stats.bytes == 24);
+}
+
+TEST_CASE_METHOD_N(GdbwireMemoryCacheTest, invalidate/split)
+{
+    gdbwire_memory_cache_stats stats;
+
+    add("read.mi");
+    add("fill.mi");
+
+    /* The middle of the region */
+    REQUIRE(gdbwire_memory_cache_invalidate(cache, 0x601008, 2) ==
+        GDBWIRE_OK);
+    REQUIRE(byte(0x601007) == 0xa7);
+    REQUIRE(byte(0x601008) == -1);
+    REQUIRE(byte(0x601009) == -1);
+    REQUIRE(byte(0x60100a) == 0x0a);
+
+    /* The start of one region and the end of another */
+    REQUIRE(gdbwire_memory_cache_invalidate(cache, 0x601006, 6) ==
+        GDBWIRE_OK);
+    REQUIRE(byte(0x601005) == 0x05);
+    REQUIRE(byte(0x601006) == -1);
+    REQUIRE(byte(0x60100b) == -1);
+    REQUIRE(byte(0x60100c) == 0x0c);
+
+    /* A whole region */
+    REQUIRE(gdbwire_memory_cache_invalidate(cache, 0x601000, 6) ==
+        GDBWIRE_OK);
+    REQUIRE(byte(0x601000) == -1);
+    REQUIRE(byte(0x601017) == 0x17);
+
+    gdbwire_memory_cache_get_stats(cache, &stats);
+    REQUIRE(stats.invalidations == 3);
+    REQUIRE(stats.regions == 1);
+    REQUIRE(stats.bytes == 12);
+}
+
+TEST_CASE_METHOD_N(GdbwireMemoryCacheTest, async/changed_and_running.mi)
+{
+    std::string mi = getFileContents(sourceTestPath());
+    std::string changed = mi.substr(0, mi.find("*running"));
+    std::string running = mi.substr(changed.size());
+    struct gdbwire_callbacks callbacks;
+    struct gdbwire *wire;
+    gdbwire_memory_cache_stats stats;
+
+    add("read.mi");
+
+    memset(&callbacks, 0, sizeof(callbacks));
+    wire = gdbwire_create(callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_set_memory_cache(wire, cache) == GDBWIRE_OK);
+
+    REQUIRE(gdbwire_push_data(wire, changed.data(), changed.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(byte(0x601003) == 0x03);
+    REQUIRE(byte(0x601004) == -1);
+    REQUIRE(byte(0x601007) == -1);
+    REQUIRE(byte(0x601010) == 0x10);
+
+    REQUIRE(gdbwire_push_data(wire, running.data(), running.size()) ==
+        GDBWIRE_OK);
+    REQUIRE(byte(0x601003) == -1);
+    REQUIRE(byte(0x601010) == -1);
+
+    gdbwire_memory_cache_get_stats(cache, &stats);
+    REQUIRE(stats.invalidations == 1);
+    REQUIRE(stats.clears == 1);
+    REQUIRE(stats.regions == 0);
+
+    gdbwire_destroy(wire);
+}
@@ -1,4 +1,5 @@
 #include <string>
+#include <string.h>
 #include <fstream>
 #include <streambuf>
 
@@ -94,6 +95,68 @@ namespace {
         gdbwire_mi_output *output;
         gdbwire_mi_result_record *result_record;
     };
+
+    struct GdbwireMiAsyncStoppedTest : public Fixture {
+        GdbwireMiAsyncStoppedTest() {
+            parser = gdbwire_mi_parser_create(parserCallback.callbacks);
+            REQUIRE(parser);
+
+            std::ifstream in(sourceTestPath().c_str());
+            std::string str((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+            REQUIRE(gdbwire_mi_parser_push_data(
+                    parser, str.data(), str.size()) == GDBWIRE_OK);
+
+            output = parserCallback.m_output;
+            REQUIRE(output);
+            REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_OOB);
+            REQUIRE(output->variant.oob_record->kind == GDBWIRE_MI_ASYNC);
+            async_record = output->variant.oob_record->variant.async_record;
+            REQUIRE(gdbwire_get_mi_async_stopped(async_record, &stopped) ==
+                GDBWIRE_OK);
+        }
+
+        ~GdbwireMiAsyncStoppedTest() {
+            gdbwire_mi_parser_destroy(parser);
+        }
+
+        GdbwireMiCommandCallback parserCallback;
+        gdbwire_mi_parser *parser;
+        gdbwire_mi_output *output;
+        gdbwire_mi_async_record *async_record;
+        gdbwire_mi_async_stopped stopped;
+    };
+
+    struct GdbwireMiMemoryChangedTest : public Fixture {
+        GdbwireMiMemoryChangedTest() {
+            parser = gdbwire_mi_parser_create(parserCallback.callbacks);
+            REQUIRE(parser);
+
+            std::ifstream in(sourceTestPath().c_str());
+            std::string str((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+            REQUIRE(gdbwire_mi_parser_push_data(
+                    parser, str.data(), str.size()) == GDBWIRE_OK);
+
+            output = parserCallback.m_output;
+            REQUIRE(output);
+            REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_OOB);
+            REQUIRE(output->variant.oob_record->kind == GDBWIRE_MI_ASYNC);
+            async_record = output->variant.oob_record->variant.async_record;
+            REQUIRE(gdbwire_get_mi_memory_changed(async_record, &changed) ==
+                GDBWIRE_OK);
+        }
+
+        ~GdbwireMiMemoryChangedTest() {
+            gdbwire_mi_parser_destroy(parser);
+        }
+
+        GdbwireMiCommandCallback parserCallback;
+        gdbwire_mi_parser *parser;
+        gdbwire_mi_output *output;
+        gdbwire_mi_async_record *async_record;
+        gdbwire_mi_memory_changed changed;
+    };
 }
 
 /**
@@ -386,9 +449,13 @@ TEST_CASE_METHOD_N(GdbwireMiCommandTest, break_info/two_bkpts.mi)
     gdbwire_result result;
     gdbwire_mi_command *com = 0;
     gdbwire_mi_breakpoint *breakpoint;
+    allocations decodeAllocations;
 
+    startCountingAllocations();
     result = gdbwire_get_mi_command(GDBWIRE_MI_BREAK_INFO, result_record, &com);
+    decodeAllocations = stopCountingAllocations();
     REQUIRE(result == GDBWIRE_OK);
+    REQUIRE_ALLOCATIONS_AT_MOST(decodeAllocations, 17);
 
     REQUIRE(com);
     REQUIRE(com->kind == GDBWIRE_MI_BREAK_INFO);
@@ -853,6 +920,89 @@ TEST_CASE_METHOD_N(GdbwireMiCommandTest, stack_info_frame/no_address.mi)
     REQUIRE(!com);
 }
 
+/**
+ * The -stack-list-frames command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, stack_list_frames/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_stack_frame *frames;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_STACK_LIST_FRAMES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_STACK_LIST_FRAMES);
+    REQUIRE(com->variant.stack_list_frames.frames_size == 3);
+    frames = com->variant.stack_list_frames.frames;
+    REQUIRE(frames);
+
+    REQUIRE(frames[0].level == 0);
+    REQUIRE(frames[0].address == std::string("0x0000000000400501"));
+    REQUIRE(frames[0].pc == 0x400501);
+    REQUIRE(frames[0].func == std::string("sum"));
+    REQUIRE(frames[0].file == std::string("main.c"));
+    REQUIRE(frames[0].fullname == std::string("/home/foo/main.c"));
+    REQUIRE(frames[0].line == 4);
+    REQUIRE(!frames[0].from);
+
+    REQUIRE(frames[1].level == 1);
+    REQUIRE(frames[1].pc == 0x7ffff7a2e830ULL);
+    REQUIRE(frames[1].func == std::string("__libc_start_main"));
+    REQUIRE(!frames[1].file);
+    REQUIRE(!frames[1].fullname);
+    REQUIRE(frames[1].line == 0);
+    REQUIRE(frames[1].from == std::string("/lib/libc.so.6"));
+
+    REQUIRE(frames[2].level == 2);
+    REQUIRE(!frames[2].address);
+    REQUIRE(frames[2].pc == 0);
+    REQUIRE(frames[2].func == std::string("??"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -stack-list-frames command, with a low-frame and high-frame.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, stack_list_frames/window.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_stack_frame *frames;
+    size_t index;
+    allocations decodeAllocations;
+
+    startCountingAllocations();
+    result = gdbwire_get_mi_command(GDBWIRE_MI_STACK_LIST_FRAMES,
+        result_record, &com);
+    decodeAllocations = stopCountingAllocations();
+    REQUIRE(result == GDBWIRE_OK);
+
+    // A few frames do not need a large block of strings
+    INFO("bytes allocated: " << decodeAllocations.bytes);
+    REQUIRE(decodeAllocations.bytes < 4096);
+
+    REQUIRE(com);
+    REQUIRE(com->variant.stack_list_frames.frames_size == 3);
+    frames = com->variant.stack_list_frames.frames;
+
+    for (index = 0; index < 3; ++index) {
+        REQUIRE(frames[index].level == 100 + index);
+        REQUIRE(frames[index].pc == 0x400520);
+        REQUIRE(frames[index].line == 7);
+    }
+
+    // The strings of a recursion are only stored once
+    REQUIRE(frames[0].func == frames[2].func);
+    REQUIRE(frames[0].fullname == frames[1].fullname);
+    REQUIRE(gdbwire_intern_size(com->variant.stack_list_frames.strings) == 4);
+
+    gdbwire_mi_command_free(com);
+}
+
 /**
  * The file list exec source file command.
  */
@@ -1227,3 +1377,832 @@ TEST_CASE_METHOD_N(GdbwireMiCommandTest, file_list_exec_source_files/large.mi)
 
     gdbwire_mi_command_free(com);
 }
+
+/**
+ * The -var-create command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, var_create/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_varobj *varobj;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_VAR_CREATE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_VAR_CREATE);
+    varobj = com->variant.var_create.varobj;
+    REQUIRE(varobj);
+    REQUIRE(varobj->name == std::string("var1"));
+    REQUIRE(!varobj->exp);
+    REQUIRE(varobj->numchild == 2);
+    REQUIRE(varobj->value == std::string("{...}"));
+    REQUIRE(varobj->type == std::string("struct point"));
+    REQUIRE(varobj->thread_id == 1);
+    REQUIRE(!varobj->displayhint);
+    REQUIRE(!varobj->dynamic);
+    REQUIRE(!varobj->has_more);
+    REQUIRE(!varobj->next);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -var-list-children command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, var_list_children/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_varobj *child;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_VAR_LIST_CHILDREN,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_VAR_LIST_CHILDREN);
+    REQUIRE(com->variant.var_list_children.numchild == 2);
+    REQUIRE(!com->variant.var_list_children.has_more);
+
+    child = com->variant.var_list_children.children;
+    REQUIRE(child);
+    REQUIRE(child->name == std::string("var1.x"));
+    REQUIRE(child->exp == std::string("x"));
+    REQUIRE(child->numchild == 0);
+    REQUIRE(child->value == std::string("3"));
+    REQUIRE(child->type == std::string("int"));
+
+    child = child->next;
+    REQUIRE(child);
+    REQUIRE(child->name == std::string("var1.y"));
+    REQUIRE(child->value == std::string("4"));
+    REQUIRE(!child->next);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -var-update command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, var_update/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_varobj_change *change;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_VAR_UPDATE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_VAR_UPDATE);
+
+    change = com->variant.var_update.changes;
+    REQUIRE(change);
+    REQUIRE(change->name == std::string("var1.x"));
+    REQUIRE(change->value == std::string("5"));
+    REQUIRE(change->in_scope == GDBWIRE_MI_VAROBJ_IN_SCOPE);
+    REQUIRE(!change->type_changed);
+    REQUIRE(!change->new_type);
+    REQUIRE(change->new_num_children == -1);
+
+    change = change->next;
+    REQUIRE(change);
+    REQUIRE(change->name == std::string("var2"));
+    REQUIRE(!change->value);
+    REQUIRE(change->in_scope == GDBWIRE_MI_VAROBJ_OUT_OF_SCOPE);
+
+    change = change->next;
+    REQUIRE(change);
+    REQUIRE(change->name == std::string("var3"));
+    REQUIRE(change->type_changed);
+    REQUIRE(change->new_type == std::string("char *"));
+    REQUIRE(change->new_num_children == 1);
+    REQUIRE(!change->new_children);
+    REQUIRE(!change->next);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-read-memory-bytes command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_read_memory_bytes/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_memory_block *block;
+    unsigned char expected[] = { 0x01, 0, 0, 0, 0xde, 0xad, 0xbe, 0xef };
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_READ_MEMORY_BYTES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_DATA_READ_MEMORY_BYTES);
+    block = com->variant.data_read_memory_bytes.blocks;
+    REQUIRE(block);
+    REQUIRE(block->begin == 0x601040);
+    REQUIRE(block->offset == 0);
+    REQUIRE(block->end == 0x601048);
+    REQUIRE(block->contents_size == 8);
+    REQUIRE(memcmp(block->contents, expected, sizeof(expected)) == 0);
+    REQUIRE(!block->next);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-read-memory-bytes command, with several blocks.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_read_memory_bytes/blocks.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_memory_block *block, decoded;
+    unsigned char buffer[100];
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_READ_MEMORY_BYTES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    block = com->variant.data_read_memory_bytes.blocks;
+    REQUIRE(block);
+    REQUIRE(block->begin == 0x7fffffffe000ULL);
+    REQUIRE(block->contents_size == 8);
+    REQUIRE(block->contents[7] == 7);
+
+    block = block->next;
+    REQUIRE(block);
+    REQUIRE(block->begin == 0x7fffffffe100ULL);
+    REQUIRE(block->offset == 0x100);
+    REQUIRE(block->end == 0x7fffffffe164ULL);
+    REQUIRE(block->contents_size == 100);
+    REQUIRE(block->contents[0] == 68);
+    REQUIRE(block->contents[3] == 60);
+    REQUIRE(block->contents[40] == 95);
+    REQUIRE(block->contents[41] == 151);
+    REQUIRE(block->contents[98] == 14);
+    REQUIRE(block->contents[99] == 117);
+    REQUIRE(!block->next);
+
+    /* Decode the second block again, into a buffer of our own */
+    gdbwire_mi_result *tuple = result_record->result->variant.result->next;
+    REQUIRE(gdbwire_get_mi_memory_block(tuple->variant.result,
+        buffer, 99, &decoded) == GDBWIRE_LOGIC);
+    REQUIRE(gdbwire_get_mi_memory_block(tuple->variant.result,
+        buffer, sizeof(buffer), &decoded) == GDBWIRE_OK);
+    REQUIRE(decoded.contents == buffer);
+    REQUIRE(decoded.contents_size == 100);
+    REQUIRE(decoded.begin == block->begin);
+    REQUIRE(memcmp(buffer, block->contents, 100) == 0);
+    REQUIRE(!decoded.next);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-read-memory-bytes command, with contents that are not hex.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest,
+        data_read_memory_bytes/bad_contents.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_READ_MEMORY_BYTES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_ASSERT);
+    REQUIRE(!com);
+}
+
+/**
+ * The -data-list-register-names command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_list_register_names/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    char **names;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_LIST_REGISTER_NAMES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_DATA_LIST_REGISTER_NAMES);
+    REQUIRE(com->variant.data_list_register_names.names_size == 6);
+    names = com->variant.data_list_register_names.names;
+    REQUIRE(names);
+    REQUIRE(names[0] == std::string("rax"));
+    REQUIRE(names[1] == std::string("rbx"));
+    REQUIRE(names[2] == std::string("rcx"));
+    REQUIRE(!names[3]);
+    REQUIRE(!names[4]);
+    REQUIRE(names[5] == std::string("rip"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-list-register-values command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_list_register_values/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_register_value *values;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_LIST_REGISTER_VALUES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_DATA_LIST_REGISTER_VALUES);
+    REQUIRE(com->variant.data_list_register_values.values_size == 3);
+    values = com->variant.data_list_register_values.values;
+    REQUIRE(values);
+    REQUIRE(values[0].number == 0);
+    REQUIRE(values[0].value == std::string("0x1c"));
+    REQUIRE(values[1].number == 5);
+    REQUIRE(values[1].value == std::string("0x4004f8 <main+4>"));
+    REQUIRE(values[2].number == 17);
+    REQUIRE(values[2].value ==
+        std::string("{v4_float = {0x0, 0x0, 0x0, 0x0}, uint128 = 0x0}"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-list-changed-registers command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest,
+        data_list_changed_registers/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    int *numbers;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS);
+    REQUIRE(com->variant.data_list_changed_registers.numbers_size == 3);
+    numbers = com->variant.data_list_changed_registers.numbers;
+    REQUIRE(numbers);
+    REQUIRE(numbers[0] == 0);
+    REQUIRE(numbers[1] == 5);
+    REQUIRE(numbers[2] == 17);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-list-changed-registers command, when no register changed.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest,
+        data_list_changed_registers/empty.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->variant.data_list_changed_registers.numbers_size == 0);
+    REQUIRE(!com->variant.data_list_changed_registers.numbers);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-disassemble command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_disassemble/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_instruction *instructions;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_DISASSEMBLE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_DATA_DISASSEMBLE);
+    REQUIRE(com->variant.data_disassemble.instructions_size == 4);
+    REQUIRE(!com->variant.data_disassemble.source_lines);
+    REQUIRE(com->variant.data_disassemble.source_lines_size == 0);
+
+    instructions = com->variant.data_disassemble.instructions;
+    REQUIRE(instructions);
+    REQUIRE(instructions[0].address == 0x40052d);
+    REQUIRE(instructions[0].offset == 0);
+    REQUIRE(instructions[0].func_name == std::string("main"));
+    REQUIRE(instructions[0].inst == std::string("push   %rbp"));
+    REQUIRE(!instructions[0].opcodes);
+    REQUIRE(instructions[2].address == 0x400531);
+    REQUIRE(instructions[2].offset == 4);
+    REQUIRE(instructions[2].inst == std::string("sub    $0x10,%rsp"));
+
+    /* The function name is only stored once */
+    REQUIRE(instructions[0].func_name == instructions[1].func_name);
+    REQUIRE(instructions[1].func_name == instructions[2].func_name);
+
+    /* An instruction outside of any function */
+    REQUIRE(instructions[3].address == 0x400540);
+    REQUIRE(instructions[3].offset == -1);
+    REQUIRE(!instructions[3].func_name);
+    REQUIRE(instructions[3].inst == std::string("nop"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-disassemble command, with raw opcodes.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_disassemble/opcodes.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_instruction *instructions;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_DISASSEMBLE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com->variant.data_disassemble.instructions_size == 2);
+    instructions = com->variant.data_disassemble.instructions;
+    REQUIRE(instructions[0].opcodes == std::string("55"));
+    REQUIRE(instructions[1].opcodes == std::string("48 89 e5"));
+    REQUIRE(instructions[1].inst == std::string("mov    %rsp,%rbp"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-disassemble command, in source mode.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_disassemble/source.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_instruction *instructions;
+    gdbwire_mi_source_line *source_lines;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_DISASSEMBLE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com->variant.data_disassemble.instructions_size == 3);
+    REQUIRE(com->variant.data_disassemble.source_lines_size == 3);
+    instructions = com->variant.data_disassemble.instructions;
+    source_lines = com->variant.data_disassemble.source_lines;
+    REQUIRE(source_lines);
+
+    REQUIRE(source_lines[0].line == 3);
+    REQUIRE(source_lines[0].file == std::string("main.c"));
+    REQUIRE(source_lines[0].fullname == std::string("/tmp/main.c"));
+    REQUIRE(source_lines[0].first == 0);
+    REQUIRE(source_lines[0].count == 2);
+    REQUIRE(instructions[source_lines[0].first + 1].address == 0x40052e);
+
+    /* A source line with out any instructions */
+    REQUIRE(source_lines[1].line == 4);
+    REQUIRE(source_lines[1].first == 2);
+    REQUIRE(source_lines[1].count == 0);
+
+    REQUIRE(source_lines[2].line == 5);
+    REQUIRE(source_lines[2].first == 2);
+    REQUIRE(source_lines[2].count == 1);
+    REQUIRE(instructions[2].inst == std::string("movl   $0x0,-0x4(%rbp)"));
+
+    /* The file name is only stored once */
+    REQUIRE(source_lines[0].file == source_lines[2].file);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -data-disassemble command, with an address that is not a number.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, data_disassemble/bad_address.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_DATA_DISASSEMBLE,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_ASSERT);
+    REQUIRE(!com);
+}
+
+/**
+ * The -thread-info command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, thread_info/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_thread *threads, *thread;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_THREAD_INFO,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_THREAD_INFO);
+    REQUIRE(com->variant.thread_info.current_thread_id == 1);
+    REQUIRE(com->variant.thread_info.threads_size == 3);
+    threads = com->variant.thread_info.threads;
+    REQUIRE(threads);
+
+    REQUIRE(threads[0].id == 2);
+    REQUIRE(threads[0].target_id ==
+        std::string("Thread 0x7ffff6fe6700 (LWP 1235)"));
+    REQUIRE(threads[0].name == std::string("worker"));
+    REQUIRE(!threads[0].details);
+    REQUIRE(threads[0].state == GDBWIRE_MI_THREAD_STATE_STOPPED);
+    REQUIRE(threads[0].core == 1);
+    REQUIRE(threads[0].has_frame);
+    REQUIRE(threads[0].frame.pc == 0x7ffff78c3c4dULL);
+    REQUIRE(threads[0].frame.func == std::string("__lll_lock_wait"));
+    REQUIRE(threads[0].frame.from ==
+        std::string("/lib/x86_64-linux-gnu/libpthread.so.0"));
+    REQUIRE(!threads[0].frame.file);
+
+    REQUIRE(threads[1].id == 1);
+    REQUIRE(!threads[1].name);
+    REQUIRE(threads[1].has_frame);
+    REQUIRE(threads[1].frame.level == 0);
+    REQUIRE(threads[1].frame.file == std::string("main.c"));
+    REQUIRE(threads[1].frame.line == 5);
+
+    REQUIRE(threads[2].id == 17);
+    REQUIRE(threads[2].details == std::string("Exiting"));
+    REQUIRE(threads[2].state == GDBWIRE_MI_THREAD_STATE_RUNNING);
+    REQUIRE(threads[2].core == -1);
+    REQUIRE(!threads[2].has_frame);
+
+    /* Look the threads up by id */
+    thread = gdbwire_mi_thread_info_find(com, 1);
+    REQUIRE(thread == &threads[1]);
+    thread = gdbwire_mi_thread_info_find(com, 2);
+    REQUIRE(thread == &threads[0]);
+    thread = gdbwire_mi_thread_info_find(com, 17);
+    REQUIRE(thread == &threads[2]);
+    REQUIRE(!gdbwire_mi_thread_info_find(com, 3));
+    REQUIRE(!gdbwire_mi_thread_info_find(com, 9));
+    REQUIRE(!gdbwire_mi_thread_info_find(com, -1));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -thread-info command, with out any threads.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, thread_info/no_threads.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_THREAD_INFO,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->variant.thread_info.current_thread_id == -1);
+    REQUIRE(com->variant.thread_info.threads_size == 0);
+    REQUIRE(!com->variant.thread_info.threads);
+    REQUIRE(!gdbwire_mi_thread_info_find(com, 1));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -symbol-info-functions command, with non-debug symbols.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_info/functions.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_symbol_file *files;
+    gdbwire_mi_symbol *nondebug;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_SYMBOL_INFO_FUNCTIONS);
+    REQUIRE(com->variant.symbol_info.files_size == 3);
+    REQUIRE(com->variant.symbol_info.symbols_size == 3);
+    files = com->variant.symbol_info.files;
+    REQUIRE(files);
+
+    REQUIRE(files[0].filename == std::string("/project/f1.c"));
+    REQUIRE(files[0].fullname == std::string("/project/f1.c"));
+    REQUIRE(files[0].symbols_size == 2);
+    REQUIRE(files[0].symbols == com->variant.symbol_info.symbols);
+    REQUIRE(files[0].symbols[0].line == 36);
+    REQUIRE(files[0].symbols[0].name == std::string("f4"));
+    REQUIRE(files[0].symbols[0].type == std::string("void (int *)"));
+    REQUIRE(files[0].symbols[0].description ==
+        std::string("void f4(int *);"));
+    REQUIRE(files[0].symbols[0].address == 0);
+    REQUIRE(files[0].symbols[1].name == std::string("main"));
+
+    REQUIRE(files[1].symbols_size == 1);
+    REQUIRE(files[1].symbols == &com->variant.symbol_info.symbols[2]);
+    REQUIRE(files[1].symbols[0].line == 34);
+
+    /* A file with out any symbols */
+    REQUIRE(files[2].filename == std::string("empty.c"));
+    REQUIRE(!files[2].fullname);
+    REQUIRE(!files[2].symbols);
+    REQUIRE(files[2].symbols_size == 0);
+
+    REQUIRE(com->variant.symbol_info.nondebug_size == 2);
+    nondebug = com->variant.symbol_info.nondebug;
+    REQUIRE(nondebug);
+    REQUIRE(nondebug[0].address == 0x400398);
+    REQUIRE(nondebug[0].name == std::string("_init"));
+    REQUIRE(nondebug[0].line == 0);
+    REQUIRE(!nondebug[0].type);
+    REQUIRE(nondebug[1].address == 0x4003b0);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -symbol-info-types command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_info/types.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_symbol *symbols;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_INFO_TYPES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com->kind == GDBWIRE_MI_SYMBOL_INFO_TYPES);
+    REQUIRE(com->variant.symbol_info.files_size == 1);
+    REQUIRE(com->variant.symbol_info.nondebug_size == 0);
+    REQUIRE(!com->variant.symbol_info.nondebug);
+
+    /* Base types do not have a line */
+    symbols = com->variant.symbol_info.files[0].symbols;
+    REQUIRE(symbols[0].line == 0);
+    REQUIRE(symbols[0].name == std::string("float"));
+    REQUIRE(!symbols[0].type);
+    REQUIRE(!symbols[0].description);
+    REQUIRE(symbols[1].line == 27);
+    REQUIRE(symbols[1].name == std::string("my_int_t"));
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -symbol-info-variables command, with a symbol that has no name.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_info/bad_symbol.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_INFO_VARIABLES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_ASSERT);
+    REQUIRE(!com);
+}
+
+/**
+ * The -symbol-list-lines command.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_list_lines/basic.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_line_table *table;
+    const gdbwire_mi_line *line;
+    size_t count;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_LIST_LINES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    REQUIRE(com->kind == GDBWIRE_MI_SYMBOL_LIST_LINES);
+    table = com->variant.symbol_list_lines.table;
+    REQUIRE(table);
+    REQUIRE(table->size == 7);
+
+    REQUIRE(table->by_address[0].pc == 0x400500);
+    REQUIRE(table->by_address[0].line == 3);
+    REQUIRE(table->by_address[2].pc == 0x400508);
+    REQUIRE(table->by_address[2].line == 6);
+    REQUIRE(table->by_address[3].line == 7);
+    REQUIRE(table->by_address[5].pc == 0x400520);
+    REQUIRE(table->by_address[6].pc == 0x400530);
+
+    REQUIRE(table->by_line[1].line == 4);
+    REQUIRE(table->by_line[1].pc == 0x400504);
+    REQUIRE(table->by_line[2].line == 4);
+    REQUIRE(table->by_line[2].pc == 0x400520);
+    REQUIRE(table->by_line[6].line == 9);
+
+    /* Map addresses to lines */
+    REQUIRE(!gdbwire_mi_line_table_find_address(table, 0x4004ff));
+    line = gdbwire_mi_line_table_find_address(table, 0x400500);
+    REQUIRE(line);
+    REQUIRE(line->line == 3);
+    line = gdbwire_mi_line_table_find_address(table, 0x40050d);
+    REQUIRE(line);
+    REQUIRE(line->line == 7);
+    line = gdbwire_mi_line_table_find_address(table, 0x400525);
+    REQUIRE(line);
+    REQUIRE(line->line == 4);
+    line = gdbwire_mi_line_table_find_address(table, UINT64_MAX);
+    REQUIRE(line);
+    REQUIRE(line->line == 9);
+
+    /* Map lines to addresses */
+    line = gdbwire_mi_line_table_find_line(table, 4, &count);
+    REQUIRE(line == &table->by_line[1]);
+    REQUIRE(count == 2);
+    line = gdbwire_mi_line_table_find_line(table, 0, &count);
+    REQUIRE(line);
+    REQUIRE(line->pc == 0x400500);
+    REQUIRE(count == 1);
+    line = gdbwire_mi_line_table_find_line(table, 8, &count);
+    REQUIRE(line);
+    REQUIRE(line->line == 9);
+    REQUIRE(count == 1);
+    REQUIRE(!gdbwire_mi_line_table_find_line(table, 10, &count));
+    REQUIRE(count == 0);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -symbol-list-lines command, for a file with out any code.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_list_lines/empty.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+    gdbwire_mi_line_table *table;
+    size_t count;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_LIST_LINES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_OK);
+
+    REQUIRE(com);
+    table = com->variant.symbol_list_lines.table;
+    REQUIRE(table);
+    REQUIRE(table->size == 0);
+    REQUIRE(!gdbwire_mi_line_table_find_address(table, 0x400500));
+    REQUIRE(!gdbwire_mi_line_table_find_line(table, 1, &count));
+    REQUIRE(count == 0);
+
+    gdbwire_mi_command_free(com);
+}
+
+/**
+ * The -symbol-list-lines command, with a pc that is not an address.
+ */
+TEST_CASE_METHOD_N(GdbwireMiCommandTest, symbol_list_lines/bad_pc.mi)
+{
+    gdbwire_result result;
+    gdbwire_mi_command *com = 0;
+
+    result = gdbwire_get_mi_command(GDBWIRE_MI_SYMBOL_LIST_LINES,
+        result_record, &com);
+    REQUIRE(result == GDBWIRE_ASSERT);
+    REQUIRE(!com);
+}
+
+/**
+ * The *stopped async record, at a breakpoint.
+ */
+TEST_CASE_METHOD_N(GdbwireMiAsyncStoppedTest, stopped/breakpoint_hit.mi)
+{
+    REQUIRE(stopped.reason == GDBWIRE_MI_STOP_REASON_BREAKPOINT_HIT);
+    REQUIRE(stopped.reason_text == std::string("breakpoint-hit"));
+    REQUIRE(stopped.breakpoint_number == 2);
+    REQUIRE(stopped.thread_id == 1);
+    REQUIRE(stopped.all_threads_stopped);
+    REQUIRE(!stopped.stopped_threads);
+    REQUIRE(stopped.core == 3);
+    REQUIRE(!stopped.signal_name);
+    REQUIRE(stopped.exit_code == 0);
+
+    REQUIRE(stopped.has_frame);
+    REQUIRE(stopped.frame.level == 0);
+    REQUIRE(stopped.frame.address == std::string("0x00000000004004f8"));
+    REQUIRE(stopped.frame.pc == 0x4004f8);
+    REQUIRE(stopped.frame.func == std::string("main"));
+    REQUIRE(stopped.frame.file == std::string("main.c"));
+    REQUIRE(stopped.frame.fullname == std::string("/home/foo/main.c"));
+    REQUIRE(stopped.frame.line == 5);
+    REQUIRE(!stopped.frame.from);
+}
+
+/**
+ * The *stopped async record, when the inferior exits.
+ *
+ * GDB outputs the exit code in octal.
+ */
+TEST_CASE_METHOD_N(GdbwireMiAsyncStoppedTest, stopped/exited.mi)
+{
+    REQUIRE(stopped.reason == GDBWIRE_MI_STOP_REASON_EXITED);
+    REQUIRE(stopped.exit_code == 9);
+    REQUIRE(stopped.thread_id == 0);
+    REQUIRE(stopped.core == -1);
+    REQUIRE(!stopped.all_threads_stopped);
+    REQUIRE(!stopped.has_frame);
+}
+
+/**
+ * The *stopped async record, on a signal in non-stop mode.
+ */
+TEST_CASE_METHOD_N(GdbwireMiAsyncStoppedTest, stopped/signal_received.mi)
+{
+    gdbwire_mi_result *thread;
+
+    REQUIRE(stopped.reason == GDBWIRE_MI_STOP_REASON_SIGNAL_RECEIVED);
+    REQUIRE(stopped.signal_name == std::string("SIGSEGV"));
+    REQUIRE(stopped.thread_id == 2);
+    REQUIRE(!stopped.all_threads_stopped);
+
+    thread = stopped.stopped_threads;
+    REQUIRE(thread);
+    REQUIRE(thread->kind == GDBWIRE_MI_CSTRING);
+    REQUIRE(thread->variant.cstring == std::string("2"));
+    REQUIRE(thread->next);
+    REQUIRE(thread->next->variant.cstring == std::string("3"));
+    REQUIRE(!thread->next->next);
+
+    REQUIRE(stopped.has_frame);
+    REQUIRE(!stopped.frame.address);
+    REQUIRE(stopped.frame.pc == 0);
+    REQUIRE(stopped.frame.func == std::string("??"));
+}
+
+/**
+ * The *stopped async record, with out a reason.
+ */
+TEST_CASE_METHOD_N(GdbwireMiAsyncStoppedTest, stopped/no_reason.mi)
+{
+    REQUIRE(stopped.reason == GDBWIRE_MI_STOP_REASON_NONE);
+    REQUIRE(!stopped.reason_text);
+    REQUIRE(stopped.has_frame);
+    REQUIRE(stopped.frame.pc == 0x7ffff7ad6e10ULL);
+    REQUIRE(stopped.frame.from == std::string("/lib/libc.so.6"));
+}
+
+/**
+ * The *stopped async record, with a reason gdbwire does not know about.
+ */
+TEST_CASE_METHOD_N(GdbwireMiAsyncStoppedTest, stopped/unsupported.mi)
+{
+    REQUIRE(stopped.reason == GDBWIRE_MI_STOP_REASON_UNSUPPORTED);
+    REQUIRE(stopped.reason_text == std::string("new-reason"));
+    REQUIRE(stopped.breakpoint_number == 0);
+}
+
+/**
+ * The =memory-changed async record.
+ */
+TEST_CASE_METHOD_N(GdbwireMiMemoryChangedTest, memory_changed/basic.mi)
+{
+    REQUIRE(changed.address == 0x601004);
+    REQUIRE(changed.size == 4);
+    REQUIRE(gdbwire_mi_memory_end(changed.address, changed.size) ==
+        0x601008);
+    REQUIRE(gdbwire_get_mi_cstring(async_record->result, "thread-group") ==
+        std::string("i1"));
+    REQUIRE(!gdbwire_get_mi_cstring(async_record->result, "type"));
+}
+
+/**
+ * The =memory-changed async record, for memory that wraps around the
+ * address space.
+ */
+TEST_CASE_METHOD_N(GdbwireMiMemoryChangedTest, memory_changed/wraps.mi)
+{
+    REQUIRE(changed.address == 0xfffffffffffffffeULL);
+    REQUIRE(changed.size == 4);
+    REQUIRE(gdbwire_mi_memory_end(changed.address, changed.size) ==
+        UINT64_MAX);
+}
@@ -1,13 +1,18 @@
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include "catch.hpp"
 #include "fixture.h"
 #include "gdbwire_mi_pt.h"
 #include "gdbwire_mi_parser.h"
+#include "gdbwire_mi_pt_alloc.h"
 
 namespace {
     struct GdbwireMiParserCallback {
-        GdbwireMiParserCallback() : m_output(0) {
+        GdbwireMiParserCallback() : m_output(0), parser(0),
+                resetStatsOnOutput(false) {
             callbacks.context = (void*)this;
             callbacks.gdbwire_mi_output_callback =
                     GdbwireMiParserCallback::gdbwire_mi_output_callback;
@@ -25,17 +30,34 @@ namespace {
         }
 
         void gdbwire_mi_output_callback(gdbwire_mi_output *output) {
+            std::string data;
+
             m_output = append_gdbwire_mi_output(m_output, output);
+
+            if (resetStatsOnOutput) {
+                REQUIRE(gdbwire_mi_parser_reset_stats(parser) == GDBWIRE_OK);
+            }
+
+            // Push more data from the callback, once
+            if (!pushOnOutput.empty()) {
+                data.swap(pushOnOutput);
+                REQUIRE(gdbwire_mi_parser_push_data(parser, data.data(),
+                    data.size()) == GDBWIRE_OK);
+            }
         }
 
         gdbwire_mi_parser_callbacks callbacks;
         gdbwire_mi_output *m_output;
+        gdbwire_mi_parser *parser;
+        std::string pushOnOutput;
+        bool resetStatsOnOutput;
     };
 
     struct GdbwireMiParserTest : public Fixture {
         GdbwireMiParserTest() {
             parser = gdbwire_mi_parser_create(parserCallback.callbacks);
             REQUIRE(parser);
+            parserCallback.parser = parser;
         }
         
         ~GdbwireMiParserTest() {
@@ -252,6 +274,273 @@ TEST_CASE_METHOD_N(GdbwireMiParserTest, push/crnl_supported_as_newline)
     test_two_output_item("^error\r\n^error\r\n");
 }
 
+/**
+ * Ensure each line keeps it's own text when a push ends several lines
+ * and starts another.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, push/lines_span_pushes)
+{
+    gdbwire_mi_output *output;
+
+    REQUIRE(gdbwire_mi_parser_push(parser, "^do") == GDBWIRE_OK);
+    REQUIRE(!parserCallback.m_output);
+    REQUIRE(gdbwire_mi_parser_push(parser,
+        "ne\r\n^error,msg=\"x\"\n^ru") == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser, "nning\n") == GDBWIRE_OK);
+
+    output = parserCallback.m_output;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^done\r\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^error,msg=\"x\"\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^running\n");
+    REQUIRE(!output->next);
+}
+
+/**
+ * Ensure the lines after a line that fails to parse are parsed by the
+ * next push, rather than joined with the data it pushes.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, push/error_keeps_later_lines)
+{
+    std::string done = "^done,value=\"the line copy fails\"\n";
+    std::string data = done + "^error,msg=\"x\"\n";
+    gdbwire_mi_output *output;
+    gdbwire_result result;
+
+    if (!allocations_supported()) {
+        return;
+    }
+
+    // Nothing else allocates the size of the copy of the first line
+    allocations_fail_size(done.size() + 1);
+    result = gdbwire_mi_parser_push(parser, data.c_str());
+    allocations_fail_size(0);
+    REQUIRE(result != GDBWIRE_OK);
+    REQUIRE(!parserCallback.m_output);
+
+    REQUIRE(gdbwire_mi_parser_push(parser, "(gdb)\n") == GDBWIRE_OK);
+
+    output = parserCallback.m_output;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^error,msg=\"x\"\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_PROMPT);
+    REQUIRE(!output->next);
+}
+
+/**
+ * Ensure the output callback can push data, which is parsed after the
+ * lines already in the parser, even when it moves the parser's buffer.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, push/from_output_callback)
+{
+    std::string stream = "~\"" + std::string(65536, 'x') + "\"\n";
+    gdbwire_mi_output *output;
+
+    parserCallback.pushOnOutput = "(gdb)\n" + stream;
+    REQUIRE(gdbwire_mi_parser_push(parser, "^done\n^error\n") ==
+        GDBWIRE_OK);
+    REQUIRE(parserCallback.pushOnOutput.empty());
+
+    output = parserCallback.m_output;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^done\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "^error\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == "(gdb)\n");
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == stream);
+    REQUIRE(!output->next);
+
+    REQUIRE(gdbwire_mi_parser_push(parser, "^exit\n") == GDBWIRE_OK);
+    REQUIRE(output->next);
+    REQUIRE(std::string(output->next->line) == "^exit\n");
+}
+
+/**
+ * Ensure reading from a file descriptor reports what was read.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, read_fd/status)
+{
+    gdbwire_read_status status;
+    int fds[2];
+
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK) == 0);
+
+    // Nothing written yet
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_AGAIN);
+
+    // The start of a record
+    REQUIRE(write(fds[1], "^do", 3) == 3);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_PARTIAL);
+    REQUIRE(!parserCallback.m_output);
+
+    // The rest of it and a prompt, read no more than max_bytes at a time
+    REQUIRE(write(fds[1], "ne\n(gdb)\n", 9) == 9);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 3, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(parserCallback.m_output);
+    REQUIRE(std::string(parserCallback.m_output->line) == "^done\n");
+    REQUIRE(!parserCallback.m_output->next);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(parserCallback.m_output->next);
+    REQUIRE(parserCallback.m_output->next->kind == GDBWIRE_MI_OUTPUT_PROMPT);
+
+    close(fds[1]);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_EOF);
+    close(fds[0]);
+
+    // A closed file descriptor
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_LOGIC);
+    REQUIRE(errno == EBADF);
+}
+
+/**
+ * Ensure a read larger than the room in the buffer is read in place, the
+ * buffer growing once to make room for it.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, read_fd/large)
+{
+    std::string data = oneHundredPrompts();
+    allocations counted;
+    gdbwire_mi_output *output;
+    gdbwire_read_status status;
+    int fds[2], count = 0;
+
+    // More than the room the buffer starts with
+    data = data + data + data + data + data + data + data + data + data;
+
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], data.data(), data.size()) == (ssize_t)data.size());
+
+    // Only the buffer reallocates after the first line
+    REQUIRE(gdbwire_mi_parser_push(parser, "(gdb)\n") == GDBWIRE_OK);
+    startCountingAllocations();
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], data.size(),
+        &status) == GDBWIRE_OK);
+    counted = stopCountingAllocations();
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(counted.reallocs <= 1);
+    close(fds[0]);
+    close(fds[1]);
+
+    for (output = parserCallback.m_output; output; output = output->next) {
+        REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_PROMPT);
+        ++count;
+    }
+    REQUIRE(count == 901);
+}
+
+/**
+ * Ensure a read makes room for the bytes waiting, not for max_bytes.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, read_fd/small)
+{
+    allocations counted;
+    gdbwire_read_status status;
+    int fds[2];
+
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], "^do", 3) == 3);
+
+    // The room the buffer starts with is enough
+    startCountingAllocations();
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 1024 * 1024,
+        &status) == GDBWIRE_OK);
+    counted = stopCountingAllocations();
+    REQUIRE(status == GDBWIRE_READ_PARTIAL);
+    REQUIRE(counted.reallocs == 0);
+
+    REQUIRE(write(fds[1], "ne\n", 3) == 3);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 1024 * 1024,
+        &status) == GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(parserCallback.m_output);
+    REQUIRE(std::string(parserCallback.m_output->line) == "^done\n");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/**
+ * Ensure the buffer is trimmed back after parsing a burst of output.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, read_fd/trim)
+{
+    std::string data, prompts = oneHundredPrompts();
+    allocations counted;
+    gdbwire_read_status status;
+    int fds[2], i;
+
+    // Far more than the buffer keeps, yet less than a pipe holds
+    for (i = 0; i < 50; ++i) {
+        data += prompts;
+    }
+
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], data.data(), data.size()) == (ssize_t)data.size());
+
+    // The buffer grows for the burst, then shrinks once it is parsed
+    REQUIRE(gdbwire_mi_parser_push(parser, "(gdb)\n") == GDBWIRE_OK);
+    startCountingAllocations();
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 1024 * 1024,
+        &status) == GDBWIRE_OK);
+    counted = stopCountingAllocations();
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(counted.reallocs == (allocations_supported() ? 2 : 0));
+
+    // The trimmed buffer still has room for the next read
+    REQUIRE(write(fds[1], "(gdb)\n", 6) == 6);
+    startCountingAllocations();
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 1024 * 1024,
+        &status) == GDBWIRE_OK);
+    counted = stopCountingAllocations();
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(counted.reallocs == 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/**
+ * Ensure the read status does not depend on the statistics, which the
+ * output callback may reset.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, read_fd/status_after_reset_stats)
+{
+    gdbwire_read_status status;
+    int fds[2];
+
+    parserCallback.resetStatsOnOutput = true;
+
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], "(gdb)\n", 6) == 6);
+    REQUIRE(gdbwire_mi_parser_read_fd(parser, fds[0], 64, &status) ==
+        GDBWIRE_OK);
+    REQUIRE(status == GDBWIRE_READ_RECORDS);
+    REQUIRE(parserCallback.m_output);
+    close(fds[0]);
+    close(fds[1]);
+}
+
 /**
  * Ensure that a syntax error is handled successfully.
  *
@@ -268,3 +557,160 @@ TEST_CASE_METHOD_N(GdbwireMiParserTest, push/syntax_error)
     REQUIRE(output);
     REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_PARSE_ERROR);
 }
+
+namespace {
+    /**
+     * A list element function that takes the elements of the
+     * "files" list at depth 1 and counts them.
+     */
+    int take_files(void *context, const char *variable, int depth,
+            gdbwire_mi_result *element) {
+        int *count = (int *)context;
+        if (depth == 1 && variable && strcmp(variable, "files") == 0) {
+            REQUIRE(element->kind == GDBWIRE_MI_TUPLE);
+            REQUIRE(!element->next);
+            (*count)++;
+            gdbwire_mi_result_free(element);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+/**
+ * Ensure that list elements can be taken out of the parse tree as they
+ * are parsed, with out affecting nested lists or other lists.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, set_list_element_fn/take)
+{
+    gdbwire_mi_output *output;
+    gdbwire_mi_result *mi_result;
+    int count = 0;
+
+    REQUIRE(gdbwire_mi_parser_set_list_element_fn(parser,
+        take_files, &count) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser,
+        "^done,files=[{file=\"a.c\",files=[\"x\"]},{file=\"b.c\"}],"
+        "other=[\"1\",\"2\"]\n") == GDBWIRE_OK);
+    REQUIRE(count == 2);
+
+    output = parserCallback.m_output;
+    REQUIRE(output);
+    REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_RESULT);
+    mi_result = output->variant.result_record->result;
+    REQUIRE(mi_result);
+    REQUIRE(std::string(mi_result->variable) == "files");
+    REQUIRE(mi_result->kind == GDBWIRE_MI_LIST);
+    REQUIRE(!mi_result->variant.result);
+
+    mi_result = mi_result->next;
+    REQUIRE(mi_result);
+    REQUIRE(std::string(mi_result->variable) == "other");
+    REQUIRE(mi_result->variant.result);
+    REQUIRE(mi_result->variant.result->next);
+
+    /* Without the function, the full parse tree is built again */
+    REQUIRE(gdbwire_mi_parser_set_list_element_fn(parser,
+        NULL, NULL) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser,
+        "^done,files=[{file=\"a.c\"}]\n") == GDBWIRE_OK);
+    REQUIRE(count == 2);
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(output->variant.result_record->result->variant.result);
+}
+
+/**
+ * Ensure a line that elements were taken from is not copied in full,
+ * while lines without elements taken still are.
+ */
+TEST_CASE_METHOD_N(GdbwireMiParserTest, set_list_element_fn/line_kept)
+{
+    std::string files = "^done,files=[", other = "~\"";
+    gdbwire_mi_output *output;
+    int count = 0, i;
+
+    for (i = 0; i < 100; ++i) {
+        files += (i == 0) ? "{file=\"a.c\"}" : ",{file=\"a.c\"}";
+    }
+    files += "]\n";
+    other += std::string(1000, 'x') + "\"\n";
+
+    REQUIRE(gdbwire_mi_parser_set_list_element_fn(parser,
+        take_files, &count) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser, other.c_str()) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser, files.c_str()) == GDBWIRE_OK);
+    REQUIRE(count == 100);
+
+    output = parserCallback.m_output;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == other);
+    output = output->next;
+    REQUIRE(output);
+    REQUIRE(std::string(output->line) == files.substr(0, 256));
+}
+
+TEST_CASE_METHOD_N(GdbwireMiParserTest, stats/counts)
+{
+    gdbwire_stats stats;
+    const char *data =
+        "^done,a=\"1\"\n"
+        "*stopped\n"
+        "~\"text\"\n"
+        "^running\n"
+        "(gdb)\n"
+        "bad\n"
+        "(gdb";
+
+    REQUIRE(gdbwire_mi_parser_push(parser, data) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_get_stats(parser, &stats) == GDBWIRE_OK);
+
+    REQUIRE(stats.bytes_pushed == strlen(data));
+    REQUIRE(stats.lines == 6);
+    REQUIRE(stats.buffer_high_water == strlen(data));
+    REQUIRE(stats.outputs[GDBWIRE_MI_OUTPUT_RESULT] == 2);
+    REQUIRE(stats.outputs[GDBWIRE_MI_OUTPUT_OOB] == 2);
+    REQUIRE(stats.outputs[GDBWIRE_MI_OUTPUT_PROMPT] == 1);
+    REQUIRE(stats.outputs[GDBWIRE_MI_OUTPUT_PARSE_ERROR] == 1);
+    REQUIRE(stats.parse_errors == 1);
+    REQUIRE(stats.result_records[GDBWIRE_MI_DONE] == 1);
+    REQUIRE(stats.result_records[GDBWIRE_MI_RUNNING] == 1);
+    REQUIRE(stats.async_records[GDBWIRE_MI_ASYNC_STOPPED] == 1);
+    REQUIRE(stats.stream_records[GDBWIRE_MI_CONSOLE] == 1);
+    REQUIRE(stats.tokens > stats.lines);
+    REQUIRE(stats.allocations > stats.lines);
+    REQUIRE(stats.bytes_allocated > stats.allocations);
+
+    /* Timing is disabled by default */
+    REQUIRE(stats.lex_ns == 0);
+    REQUIRE(stats.parse_ns == 0);
+    REQUIRE(stats.callback_ns == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireMiParserTest, stats/reset)
+{
+    gdbwire_stats stats;
+
+    REQUIRE(gdbwire_mi_parser_push(parser, "^done,a=\"1\"\n^er")
+        == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_reset_stats(parser) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_get_stats(parser, &stats) == GDBWIRE_OK);
+
+    /* The unframed data is still waiting in the buffer */
+    REQUIRE(stats.bytes_pushed == 0);
+    REQUIRE(stats.lines == 0);
+    REQUIRE(stats.tokens == 0);
+    REQUIRE(stats.allocations == 0);
+    REQUIRE(stats.bytes_allocated == 0);
+    REQUIRE(stats.buffer_high_water == 3);
+
+    REQUIRE(gdbwire_mi_parser_set_timing(parser, 1) == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_push(parser, "ror\n") == GDBWIRE_OK);
+    REQUIRE(gdbwire_mi_parser_get_stats(parser, &stats) == GDBWIRE_OK);
+
+    REQUIRE(stats.bytes_pushed == 4);
+    REQUIRE(stats.lines == 1);
+    REQUIRE(stats.result_records[GDBWIRE_MI_ERROR] == 1);
+    REQUIRE(stats.result_records[GDBWIRE_MI_DONE] == 0);
+    REQUIRE(stats.lex_ns + stats.parse_ns + stats.callback_ns > 0);
+}
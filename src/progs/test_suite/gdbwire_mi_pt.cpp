@@ -68,25 +68,34 @@ namespace {
          * @param input
          * The input file to parse
          *
+         * The allocations made while parsing are counted in
+         * parseAllocations.
+         *
          * @return
          * A gdbwire_mi_output structure representing the input file.
          * You are responsible for destroying this memory.
          */
         gdbwire_mi_output *parse(gdbwire_mi_parser *parser,
             const std::string &input) {
+            std::string str;
+            gdbwire_result result = GDBWIRE_OK;
             FILE *fd;
             int c;
 
             fd = fopen(input.c_str(), "r");
             REQUIRE(fd);
-
             while ((c = fgetc(fd)) != EOF) {
-                char ch = c;
-                REQUIRE(gdbwire_mi_parser_push_data(
-                    parser, &ch, 1) == GDBWIRE_OK);
+                str.push_back(c);
             }
             fclose(fd);
 
+            startCountingAllocations();
+            for (size_t i = 0; i < str.size() && result == GDBWIRE_OK; ++i) {
+                result = gdbwire_mi_parser_push_data(parser, &str[i], 1);
+            }
+            parseAllocations = stopCountingAllocations();
+            REQUIRE(result == GDBWIRE_OK);
+
             return parserCallback.m_output;
         }
 
@@ -352,6 +361,7 @@ namespace {
         GdbwireMiParserCallback parserCallback;
         gdbwire_mi_parser *parser;
         gdbwire_mi_output *output;
+        allocations parseAllocations;
     };
 }
 
@@ -369,6 +379,8 @@ TEST_CASE_METHOD_N(GdbwireMiPtTest, oob_record/stream/console/basic.mi)
     CHECK_STREAM_RECORD(stream, GDBWIRE_MI_CONSOLE, expected);
 
     CHECK_OUTPUT_AT_FINAL_PROMPT(output->next);
+
+    REQUIRE_ALLOCATIONS_AT_MOST(parseAllocations, 14);
 }
 
 /**
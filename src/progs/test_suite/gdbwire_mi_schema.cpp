@@ -0,0 +1,140 @@
+#include <string.h>
+#include <string>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire_mi_parser.h"
+#include "gdbwire_mi_schema.h"
+
+namespace {
+    const char *const test_colors[] = { "red", "green", "blue", 0 };
+
+    #define TEST_FIELDS(X, T) \
+        X(T, "name", STRING, name, GDBWIRE_MI_FIELD_REQUIRED, 0) \
+        X(T, "line", INT, line, 0, 0) \
+        X(T, "times", ULONG, times, 0, 0) \
+        X(T, "addr", ADDRESS, address, 0, 0) \
+        X(T, "color", ENUM, color, 0, test_colors) \
+        X(T, "strict-color", ENUM, strict_color, \
+            GDBWIRE_MI_FIELD_STRICT, test_colors) \
+        X(T, "enabled", BOOL, enabled, 0, 0) \
+        X(T, "items", LIST, items, 0, 0) \
+        X(T, "frame", TUPLE, frame, 0, 0) \
+        X(T, "threads", RESULT, threads, 0, 0)
+
+    struct test_fields {
+        TEST_FIELDS(GDBWIRE_MI_FIELD_MEMBER, struct test_fields)
+    };
+
+    GDBWIRE_MI_SCHEMA(test_schema, struct test_fields, TEST_FIELDS);
+
+    struct GdbwireMiSchemaTest : public Fixture {
+        GdbwireMiSchemaTest() : output(0) {
+            gdbwire_mi_parser_callbacks callbacks;
+            memset(&callbacks, 0, sizeof(callbacks));
+            callbacks.context = this;
+            callbacks.gdbwire_mi_output_callback = output_callback;
+            parser = gdbwire_mi_parser_create(callbacks);
+            REQUIRE(parser);
+
+            memset(&fields, 0, sizeof(fields));
+            fields.color = -1;
+        }
+
+        ~GdbwireMiSchemaTest() {
+            gdbwire_mi_output_free(output);
+            gdbwire_mi_parser_destroy(parser);
+        }
+
+        static void output_callback(void *context, gdbwire_mi_output *out) {
+            GdbwireMiSchemaTest *test = (GdbwireMiSchemaTest *)context;
+            gdbwire_mi_output_free(test->output);
+            test->output = out;
+        }
+
+        /**
+         * Decode the results of a ^done result record.
+         *
+         * @param results
+         * The results, ie. name="main",line="3".
+         *
+         * @return
+         * The result of gdbwire_mi_schema_decode.
+         */
+        gdbwire_result decode(const std::string &results) {
+            std::string line = "^done," + results + "\n";
+
+            REQUIRE(gdbwire_mi_parser_push(parser, line.c_str()) ==
+                GDBWIRE_OK);
+            REQUIRE(output);
+            REQUIRE(output->kind == GDBWIRE_MI_OUTPUT_RESULT);
+
+            return gdbwire_mi_schema_decode(&test_schema,
+                output->variant.result_record->result, &fields);
+        }
+
+        gdbwire_mi_parser *parser;
+        gdbwire_mi_output *output;
+        test_fields fields;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireMiSchemaTest, decode/all_kinds)
+{
+    REQUIRE(decode("name=\"main\",line=\"7\",times=\"42\","
+        "addr=\"0x00000000004004f4\",color=\"green\","
+        "strict-color=\"blue\",enabled=\"y\",items=[\"a\",\"b\"],"
+        "frame={level=\"0\"},threads=\"all\"") == GDBWIRE_OK);
+
+    REQUIRE(fields.name == std::string("main"));
+    REQUIRE(fields.line == 7);
+    REQUIRE(fields.times == 42);
+    REQUIRE(fields.address == 0x4004f4);
+    REQUIRE(fields.color == 1);
+    REQUIRE(fields.strict_color == 2);
+    REQUIRE(fields.enabled == 1);
+    REQUIRE(fields.items);
+    REQUIRE(fields.items->variant.cstring == std::string("a"));
+    REQUIRE(fields.items->next);
+    REQUIRE(!fields.items->next->next);
+    REQUIRE(fields.frame);
+    REQUIRE(fields.frame->variable == std::string("level"));
+    REQUIRE(fields.threads);
+    REQUIRE(fields.threads->kind == GDBWIRE_MI_CSTRING);
+
+    /* A result field takes any kind of value */
+    REQUIRE(decode("name=\"main\",threads=[\"1\",\"2\"]") == GDBWIRE_OK);
+    REQUIRE(fields.threads->kind == GDBWIRE_MI_LIST);
+}
+
+TEST_CASE_METHOD_N(GdbwireMiSchemaTest, decode/defaults)
+{
+    REQUIRE(decode("unknown={a=\"1\"},name=\"f\",enabled=\"n\",name=\"g\"")
+        == GDBWIRE_OK);
+
+    /* The last of a repeated key is used, missing fields are untouched */
+    REQUIRE(fields.name == std::string("g"));
+    REQUIRE(fields.enabled == 0);
+    REQUIRE(fields.line == 0);
+    REQUIRE(fields.color == -1);
+    REQUIRE(!fields.items);
+}
+
+TEST_CASE_METHOD_N(GdbwireMiSchemaTest, decode/enum_values)
+{
+    /* An unknown value is ignored, unless the field is strict */
+    REQUIRE(decode("name=\"f\",color=\"purple\"") == GDBWIRE_OK);
+    REQUIRE(fields.color == -1);
+
+    REQUIRE(decode("name=\"f\",strict-color=\"purple\"") == GDBWIRE_LOGIC);
+}
+
+TEST_CASE_METHOD_N(GdbwireMiSchemaTest, decode/errors)
+{
+    REQUIRE(decode("line=\"7\"") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=[]") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=\"f\",items=\"a\"") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=\"f\",frame=[]") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=\"f\",times=\"-\"") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=\"f\",times=\"4x\"") == GDBWIRE_ASSERT);
+    REQUIRE(decode("name=\"f\",addr=\"<unavailable>\"") == GDBWIRE_ASSERT);
+}
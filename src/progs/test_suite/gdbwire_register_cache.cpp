@@ -0,0 +1,182 @@
+#include <string>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireRegisterCacheTest : public Fixture {
+        GdbwireRegisterCacheTest() {
+            cache = gdbwire_register_cache_create();
+            REQUIRE(cache);
+        }
+
+        ~GdbwireRegisterCacheTest() {
+            gdbwire_register_cache_destroy(cache);
+        }
+
+        /**
+         * Decode a file in the GdbwireRegisterCacheTest directory.
+         *
+         * @param name
+         * The name of the file.
+         *
+         * @param kind
+         * The kind of command the file holds the output of.
+         *
+         * @return
+         * The command, free it with gdbwire_mi_command_free.
+         */
+        gdbwire_mi_command *command(const std::string &name,
+                gdbwire_mi_command_kind kind) {
+            std::string mi = getFileContents(sourceFixturePath(name));
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(), kind,
+                &mi_command) == GDBWIRE_OK);
+            REQUIRE(mi_command);
+
+            return mi_command;
+        }
+
+        void names() {
+            gdbwire_mi_command *mi_command = command("names.mi",
+                GDBWIRE_MI_DATA_LIST_REGISTER_NAMES);
+            REQUIRE(gdbwire_register_cache_register_names(cache,
+                mi_command) == GDBWIRE_OK);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        void values(const std::string &name) {
+            gdbwire_mi_command *mi_command = command(name,
+                GDBWIRE_MI_DATA_LIST_REGISTER_VALUES);
+            REQUIRE(gdbwire_register_cache_register_values(cache,
+                mi_command) == GDBWIRE_OK);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        void changed() {
+            gdbwire_mi_command *mi_command = command("changed.mi",
+                GDBWIRE_MI_DATA_LIST_CHANGED_REGISTERS);
+            REQUIRE(gdbwire_register_cache_changed_registers(cache,
+                mi_command) == GDBWIRE_OK);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        gdbwire_register_cache *cache;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, destroy/null_instance)
+{
+    gdbwire_register_cache_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, registers/empty)
+{
+    size_t size = 1;
+
+    REQUIRE(!gdbwire_register_cache_registers(cache, &size));
+    REQUIRE(size == 0);
+
+    size = 1;
+    REQUIRE(!gdbwire_register_cache_stale(cache, &size));
+    REQUIRE(size == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, registers/names)
+{
+    const gdbwire_register *registers;
+    const int *stale;
+    size_t size;
+
+    names();
+
+    registers = gdbwire_register_cache_registers(cache, &size);
+    REQUIRE(registers);
+    REQUIRE(size == 4);
+    REQUIRE(registers[0].number == 0);
+    REQUIRE(registers[0].name == std::string("rax"));
+    REQUIRE(!registers[0].value);
+    REQUIRE(registers[0].stale);
+    REQUIRE(registers[2].number == 2);
+    REQUIRE(!registers[2].name);
+    REQUIRE(!registers[2].stale);
+    REQUIRE(registers[3].name == std::string("rip"));
+
+    /* The unused register number is never fetched */
+    stale = gdbwire_register_cache_stale(cache, &size);
+    REQUIRE(stale);
+    REQUIRE(size == 3);
+    REQUIRE(stale[0] == 0);
+    REQUIRE(stale[1] == 1);
+    REQUIRE(stale[2] == 3);
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, registers/values)
+{
+    const gdbwire_register *registers;
+    size_t size;
+
+    names();
+    values("values.mi");
+
+    registers = gdbwire_register_cache_registers(cache, &size);
+    REQUIRE(size == 4);
+    REQUIRE(registers[0].value == std::string("0x1"));
+    REQUIRE(registers[1].value == std::string("0x2"));
+    REQUIRE(!registers[2].value);
+    REQUIRE(registers[3].value == std::string("0x400500"));
+
+    REQUIRE(!gdbwire_register_cache_stale(cache, &size));
+    REQUIRE(size == 0);
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, registers/changed)
+{
+    const gdbwire_register *registers;
+    const int *stale;
+    size_t size;
+
+    names();
+    values("values.mi");
+    changed();
+
+    /* Only the changed registers are fetched again */
+    stale = gdbwire_register_cache_stale(cache, &size);
+    REQUIRE(stale);
+    REQUIRE(size == 2);
+    REQUIRE(stale[0] == 0);
+    REQUIRE(stale[1] == 3);
+
+    /* The stale registers keep their last value until fetched */
+    registers = gdbwire_register_cache_registers(cache, &size);
+    REQUIRE(registers[0].stale);
+    REQUIRE(registers[0].value == std::string("0x1"));
+
+    values("changed_values.mi");
+
+    registers = gdbwire_register_cache_registers(cache, &size);
+    REQUIRE(registers[0].value == std::string("0x10"));
+    REQUIRE(registers[1].value == std::string("0x2"));
+    REQUIRE(registers[3].value == std::string("0x400510"));
+    REQUIRE(!gdbwire_register_cache_stale(cache, &size));
+}
+
+TEST_CASE_METHOD_N(GdbwireRegisterCacheTest, registers/names_again)
+{
+    const gdbwire_register *registers;
+    size_t size;
+
+    names();
+    values("values.mi");
+    names();
+
+    /* New register names forget the values */
+    registers = gdbwire_register_cache_registers(cache, &size);
+    REQUIRE(size == 4);
+    REQUIRE(!registers[0].value);
+    REQUIRE(registers[0].stale);
+
+    gdbwire_register_cache_stale(cache, &size);
+    REQUIRE(size == 3);
+}
@@ -0,0 +1,171 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+#include "gdbwire_intern.h"
+#include "gdbwire_source_file_index.h"
+
+namespace {
+    struct GdbwireSourceFileIndexTest : public Fixture {
+        GdbwireSourceFileIndexTest() {
+            index = gdbwire_source_file_index_create();
+            REQUIRE(index);
+        }
+
+        ~GdbwireSourceFileIndexTest() {
+            gdbwire_source_file_index_destroy(index);
+        }
+
+        static void source_file(void *context,
+                gdbwire_mi_source_file *file) {
+            gdbwire_source_file_index *index =
+                (gdbwire_source_file_index *)context;
+            REQUIRE(gdbwire_source_file_index_add(index, file) ==
+                GDBWIRE_OK);
+        }
+
+        /**
+         * Validate the index built from files.mi.
+         */
+        void validate() {
+            const gdbwire_mi_source_file *files, *file;
+            size_t size;
+
+            files = gdbwire_source_file_index_files(index, &size);
+            REQUIRE(files);
+            REQUIRE(size == 4);
+
+            file = gdbwire_source_file_index_find_fullname(index,
+                "/src/app/main.c");
+            REQUIRE(file == &files[0]);
+            REQUIRE(file->debug_fully_read ==
+                GDBWIRE_MI_DEBUG_FULLY_READ_TRUE);
+
+            /* The first main.c added is found by file */
+            REQUIRE(gdbwire_source_file_index_find_file(index,
+                "main.c") == &files[0]);
+            file = gdbwire_source_file_index_find_fullname(index,
+                "/src/lib/main.c");
+            REQUIRE(file == &files[2]);
+
+            /* Equal strings are interned */
+            REQUIRE(files[0].file == files[2].file);
+
+            file = gdbwire_source_file_index_find_file(index, "gen.c");
+            REQUIRE(file == &files[3]);
+            REQUIRE(!file->fullname);
+
+            REQUIRE(!gdbwire_source_file_index_find_file(index, "x.c"));
+            REQUIRE(!gdbwire_source_file_index_find_fullname(index,
+                "main.c"));
+        }
+
+        gdbwire_source_file_index *index;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, destroy/null_instance)
+{
+    gdbwire_source_file_index_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, add/command)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("files.mi"));
+    struct gdbwire_mi_command *mi_command = 0;
+    struct gdbwire_mi_source_file *cur;
+
+    mi = mi.substr(0, mi.find("(gdb)"));
+    REQUIRE(gdbwire_interpreter_exec(mi.c_str(),
+        GDBWIRE_MI_FILE_LIST_EXEC_SOURCE_FILES, &mi_command) == GDBWIRE_OK);
+
+    cur = mi_command->variant.file_list_exec_source_files.files;
+    for (; cur; cur = cur->next) {
+        REQUIRE(gdbwire_source_file_index_add(index, cur) == GDBWIRE_OK);
+    }
+    gdbwire_mi_command_free(mi_command);
+
+    validate();
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, add/stream)
+{
+    std::string mi = getFileContents(
+        sourceFixturePath("files.mi"));
+    struct gdbwire_callbacks callbacks;
+    struct gdbwire *wire;
+
+    memset(&callbacks, 0, sizeof(callbacks));
+    wire = gdbwire_create(callbacks);
+    REQUIRE(wire);
+    REQUIRE(gdbwire_stream_source_files(wire,
+        GdbwireSourceFileIndexTest::source_file, index) == GDBWIRE_OK);
+    REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) == GDBWIRE_OK);
+    gdbwire_destroy(wire);
+
+    validate();
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, add/fullname_missing)
+{
+    gdbwire_mi_source_file with = { (char *)"a.c", (char *)"/src/a.c",
+        GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN, 0 };
+    gdbwire_mi_source_file without = { (char *)"a.c", 0,
+        GDBWIRE_MI_DEBUG_FULLY_READ_TRUE, 0 };
+    const gdbwire_mi_source_file *files;
+    size_t size;
+
+    /* A file with out a fullname is the one already added */
+    REQUIRE(gdbwire_source_file_index_add(index, &with) == GDBWIRE_OK);
+    REQUIRE(gdbwire_source_file_index_add(index, &without) == GDBWIRE_OK);
+    REQUIRE(gdbwire_source_file_index_add(index, &without) == GDBWIRE_OK);
+    files = gdbwire_source_file_index_files(index, &size);
+    REQUIRE(size == 1);
+    REQUIRE(std::string(files[0].fullname) == "/src/a.c");
+    REQUIRE(files[0].debug_fully_read == GDBWIRE_MI_DEBUG_FULLY_READ_TRUE);
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, add/fullname_learned)
+{
+    gdbwire_mi_source_file without = { (char *)"a.c", 0,
+        GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN, 0 };
+    gdbwire_mi_source_file with = { (char *)"a.c", (char *)"/src/a.c",
+        GDBWIRE_MI_DEBUG_FULLY_READ_UNKNOWN, 0 };
+    const gdbwire_mi_source_file *files;
+    size_t size;
+
+    /* The fullname is filled in, and the file is found by it */
+    REQUIRE(gdbwire_source_file_index_add(index, &without) == GDBWIRE_OK);
+    REQUIRE(gdbwire_source_file_index_add(index, &with) == GDBWIRE_OK);
+    REQUIRE(gdbwire_source_file_index_add(index, &with) == GDBWIRE_OK);
+    files = gdbwire_source_file_index_files(index, &size);
+    REQUIRE(size == 1);
+    REQUIRE(gdbwire_source_file_index_find_fullname(index, "/src/a.c") ==
+        &files[0]);
+    REQUIRE(gdbwire_source_file_index_find_file(index, "a.c") == &files[0]);
+}
+
+TEST_CASE_METHOD_N(GdbwireSourceFileIndexTest, intern/basic)
+{
+    gdbwire_intern *intern = gdbwire_intern_create();
+    const char *a, *b;
+    std::string large(100000, 'x');
+
+    REQUIRE(intern);
+    a = gdbwire_intern_string(intern, "main.c");
+    REQUIRE(a);
+    REQUIRE(std::string(a) == "main.c");
+    b = gdbwire_intern_data(intern, "main.cpp", 6);
+    REQUIRE(a == b);
+    REQUIRE(gdbwire_intern_find(intern, "main.c") == a);
+    REQUIRE(!gdbwire_intern_find(intern, "main.cpp"));
+
+    /* Strings larger than a block still work */
+    b = gdbwire_intern_string(intern, large.c_str());
+    REQUIRE(b);
+    REQUIRE(large == b);
+    REQUIRE(gdbwire_intern_size(intern) == 2);
+
+    gdbwire_intern_destroy(intern);
+}
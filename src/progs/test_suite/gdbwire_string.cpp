@@ -163,6 +163,40 @@ TEST_CASE_METHOD_N(GdbwireStringTest, append_data/standard)
     validate(string, 129, 256, expected);
 }
 
+TEST_CASE_METHOD_N(GdbwireStringTest, reserve/standard)
+{
+    char *tail;
+
+    REQUIRE(gdbwire_string_append_data(string, "ab", 2) == 0);
+
+    // Room that is already there does not grow the string
+    tail = gdbwire_string_reserve(string, 10);
+    REQUIRE(tail - gdbwire_string_data(string) == 2);
+    validate(string, 2, 128, "ab");
+
+    // Room past the capacity does
+    tail = gdbwire_string_reserve(string, 200);
+    REQUIRE(tail - gdbwire_string_data(string) == 2);
+    validate(string, 2, 256, "ab");
+
+    memcpy(tail, "cd", 2);
+    REQUIRE(gdbwire_string_commit(string, 2) == 0);
+    validate(string, 4, 256, "abcd");
+}
+
+TEST_CASE_METHOD_N(GdbwireStringTest, reserve/null_instance)
+{
+    REQUIRE(!gdbwire_string_reserve(NULL, 1));
+}
+
+TEST_CASE_METHOD_N(GdbwireStringTest, commit/past_capacity)
+{
+    REQUIRE(gdbwire_string_commit(string, 129) == -1);
+    validate(string, 0, 128, "");
+
+    REQUIRE(gdbwire_string_commit(NULL, 0) == -1);
+}
+
 TEST_CASE_METHOD_N(GdbwireStringTest, append_cstr/mixed)
 {
     std::string expected;
@@ -397,3 +431,27 @@ TEST_CASE_METHOD_N(GdbwireStringTest, erase/standard)
         }
     }
 }
+
+TEST_CASE_METHOD_N(GdbwireStringTest, shrink/standard)
+{
+    REQUIRE(gdbwire_string_reserve(string, 1000));
+    REQUIRE(gdbwire_string_append_cstr(string, "abcd") == 0);
+    validate(string, 4, 1024, "abcd");
+
+    // The capacity is given back
+    REQUIRE(gdbwire_string_shrink(string, 64) == 0);
+    validate(string, 4, 64, "abcd");
+
+    // A larger capacity leaves the string unchanged
+    REQUIRE(gdbwire_string_shrink(string, 128) == 0);
+    validate(string, 4, 64, "abcd");
+
+    // Room is kept for the data and the NUL character after it
+    REQUIRE(gdbwire_string_shrink(string, 2) == 0);
+    validate(string, 4, 5, "abcd");
+}
+
+TEST_CASE_METHOD_N(GdbwireStringTest, shrink/null_instance)
+{
+    REQUIRE(gdbwire_string_shrink(NULL, 0) == -1);
+}
@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+
+namespace {
+    struct GdbwireTargetStateTest : public Fixture {
+        GdbwireTargetStateTest() {
+            struct gdbwire_callbacks wire_callbacks;
+            struct gdbwire_target_state_callbacks state_callbacks;
+
+            memset(&wire_callbacks, 0, sizeof(wire_callbacks));
+            memset(&state_callbacks, 0, sizeof(state_callbacks));
+            state_callbacks.context = (void*)this;
+            state_callbacks.gdbwire_thread_fn =
+                GdbwireTargetStateTest::gdbwire_thread;
+            state_callbacks.gdbwire_thread_group_fn =
+                GdbwireTargetStateTest::gdbwire_thread_group;
+            state_callbacks.gdbwire_library_fn =
+                GdbwireTargetStateTest::gdbwire_library;
+
+            threadAdded = threadModified = threadRemoved = 0;
+            threadGroupChanges = libraryChanges = 0;
+
+            state = gdbwire_target_state_create(state_callbacks);
+            REQUIRE(state);
+            wire = gdbwire_create(wire_callbacks);
+            REQUIRE(wire);
+            REQUIRE(gdbwire_set_target_state(wire, state) == GDBWIRE_OK);
+        }
+
+        ~GdbwireTargetStateTest() {
+            gdbwire_destroy(wire);
+            gdbwire_target_state_destroy(state);
+        }
+
+        static void gdbwire_thread(void *context,
+                enum gdbwire_target_state_change change,
+                struct gdbwire_thread *thread) {
+            GdbwireTargetStateTest *test = (GdbwireTargetStateTest *)context;
+            REQUIRE(thread);
+            switch (change) {
+                case GDBWIRE_TARGET_STATE_ADDED:
+                    test->threadAdded++;
+                    break;
+                case GDBWIRE_TARGET_STATE_MODIFIED:
+                    test->threadModified++;
+                    break;
+                case GDBWIRE_TARGET_STATE_REMOVED:
+                    test->threadRemoved++;
+                    break;
+            }
+        }
+
+        static void gdbwire_thread_group(void *context,
+                enum gdbwire_target_state_change change,
+                struct gdbwire_thread_group *thread_group) {
+            GdbwireTargetStateTest *test = (GdbwireTargetStateTest *)context;
+            REQUIRE(thread_group);
+            test->threadGroupChanges++;
+        }
+
+        static void gdbwire_library(void *context,
+                enum gdbwire_target_state_change change,
+                struct gdbwire_library *library) {
+            GdbwireTargetStateTest *test = (GdbwireTargetStateTest *)context;
+            REQUIRE(library);
+            test->libraryChanges++;
+        }
+
+        /**
+         * Read the GDB/MI file for this test and push it to gdbwire.
+         */
+        void parse() {
+            std::string mi;
+            FILE *fd;
+            int c;
+
+            fd = fopen(sourceTestPath().c_str(), "r");
+            REQUIRE(fd);
+            while ((c = fgetc(fd)) != EOF) {
+                mi.push_back((char)c);
+            }
+            fclose(fd);
+
+            REQUIRE(gdbwire_push_data(wire, mi.data(), mi.size()) ==
+                GDBWIRE_OK);
+        }
+
+        gdbwire *wire;
+        gdbwire_target_state *state;
+
+        int threadAdded, threadModified, threadRemoved;
+        int threadGroupChanges;
+        int libraryChanges;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, destroy/null_instance)
+{
+    gdbwire_target_state_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, initial_state)
+{
+    size_t size = 1;
+
+    REQUIRE(!gdbwire_target_state_threads(state, &size));
+    REQUIRE(size == 0);
+    REQUIRE(!gdbwire_target_state_libraries(state, &size));
+    REQUIRE(size == 0);
+    REQUIRE(!gdbwire_target_state_thread(state, 1));
+    REQUIRE(!gdbwire_target_state_selected_thread(state));
+    REQUIRE(!gdbwire_target_state_thread_group(state, "i1"));
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, threads/lifecycle.mi)
+{
+    struct gdbwire_thread *thread;
+    size_t size;
+
+    parse();
+
+    REQUIRE(threadAdded == 2);
+    REQUIRE(threadRemoved == 1);
+
+    REQUIRE(gdbwire_target_state_threads(state, &size));
+    REQUIRE(size == 1);
+    REQUIRE(!gdbwire_target_state_thread(state, 1));
+
+    thread = gdbwire_target_state_thread(state, 2);
+    REQUIRE(thread);
+    REQUIRE(thread->id == 2);
+    REQUIRE(std::string(thread->group_id) == "i1");
+    REQUIRE(thread->state == GDBWIRE_THREAD_STOPPED);
+    REQUIRE(std::string(thread->stop_reason) == "breakpoint-hit");
+    REQUIRE(thread->frame);
+    REQUIRE(std::string(thread->frame->address) == "0x00000000004004f8");
+    REQUIRE(std::string(thread->frame->func) == "main");
+    REQUIRE(std::string(thread->frame->file) == "test.c");
+    REQUIRE(thread->frame->line == 6);
+
+    REQUIRE(gdbwire_target_state_selected_thread(state) == thread);
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, threads/non_stop.mi)
+{
+    struct gdbwire_thread *thread;
+
+    parse();
+
+    thread = gdbwire_target_state_thread(state, 1);
+    REQUIRE(thread);
+    REQUIRE(thread->state == GDBWIRE_THREAD_STOPPED);
+    REQUIRE(std::string(thread->stop_reason) == "signal-received");
+    REQUIRE(thread->frame);
+    REQUIRE(std::string(thread->frame->func) == "loop");
+    REQUIRE(thread->frame->line == 12);
+
+    /* Only the threads in stopped-threads are stopped in non-stop mode */
+    thread = gdbwire_target_state_thread(state, 2);
+    REQUIRE(thread);
+    REQUIRE(thread->state == GDBWIRE_THREAD_RUNNING);
+    REQUIRE(!thread->frame);
+    REQUIRE(!thread->stop_reason);
+
+    REQUIRE(gdbwire_target_state_selected_thread(state) == thread);
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, thread_groups/exited.mi)
+{
+    struct gdbwire_thread_group *group;
+    size_t size;
+
+    parse();
+
+    group = gdbwire_target_state_thread_group(state, "i1");
+    REQUIRE(group);
+    REQUIRE(std::string(group->id) == "i1");
+    REQUIRE(!group->started);
+    REQUIRE(group->exited);
+    REQUIRE(group->exit_code == 3);
+    REQUIRE(threadGroupChanges == 3);
+
+    /* The libraries of the exited thread group are unloaded */
+    REQUIRE(!gdbwire_target_state_libraries(state, &size));
+    REQUIRE(size == 0);
+    REQUIRE(libraryChanges == 2);
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, libraries/loaded.mi)
+{
+    struct gdbwire_library **libraries, *library;
+    size_t size;
+
+    parse();
+
+    libraries = gdbwire_target_state_libraries(state, &size);
+    REQUIRE(libraries);
+    REQUIRE(size == 2);
+    REQUIRE(libraryChanges == 4);
+
+    REQUIRE(!gdbwire_target_state_library(state, "i1",
+        "/lib64/ld-linux-x86-64.so.2"));
+
+    library = gdbwire_target_state_library(state, "i1",
+        "/lib64/libc.so.6");
+    REQUIRE(library);
+    REQUIRE(std::string(library->target_name) == "/lib64/libc.so.6");
+    REQUIRE(std::string(library->host_name) == "/lib64/libc.so.6");
+    REQUIRE(std::string(library->thread_group) == "i1");
+    REQUIRE(library->symbols_loaded);
+
+    library = gdbwire_target_state_library(state, "i1",
+        "/lib64/libm.so.6");
+    REQUIRE(library);
+    REQUIRE(!library->symbols_loaded);
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, libraries/inferiors.mi)
+{
+    struct gdbwire_library **libraries, *library;
+    size_t size;
+
+    parse();
+
+    /* Each inferior loads and unloads it's own copy of a library */
+    REQUIRE(libraryChanges == 7);
+    libraries = gdbwire_target_state_libraries(state, &size);
+    REQUIRE(libraries);
+    REQUIRE(size == 1);
+
+    library = gdbwire_target_state_library(state, "i1",
+        "/lib64/libm.so.6");
+    REQUIRE(library == libraries[0]);
+    REQUIRE(std::string(library->thread_group) == "i1");
+    REQUIRE(library->symbols_loaded);
+
+    REQUIRE(!gdbwire_target_state_library(state, "i1",
+        "/lib64/libc.so.6"));
+    REQUIRE(!gdbwire_target_state_library(state, "i2",
+        "/lib64/libc.so.6"));
+    REQUIRE(!gdbwire_target_state_library(state, "i2",
+        "/lib64/libm.so.6"));
+    REQUIRE(!gdbwire_target_state_library(state, NULL,
+        "/lib64/libm.so.6"));
+}
+
+TEST_CASE_METHOD_N(GdbwireTargetStateTest, threads/ids.mi)
+{
+    struct gdbwire_thread **threads;
+    size_t size;
+
+    parse();
+
+    /* Invalid thread ids are rejected, large ones are fine */
+    REQUIRE(threadAdded == 2);
+    REQUIRE(threadRemoved == 1);
+    REQUIRE(!gdbwire_target_state_thread(state, 0));
+    REQUIRE(!gdbwire_target_state_thread(state, 2000000000));
+
+    threads = gdbwire_target_state_threads(state, &size);
+    REQUIRE(threads);
+    REQUIRE(size == 1);
+    REQUIRE(gdbwire_target_state_thread(state, 7) == threads[0]);
+    REQUIRE(threads[0]->id == 7);
+}
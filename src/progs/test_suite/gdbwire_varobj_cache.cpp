@@ -0,0 +1,214 @@
+#include <string.h>
+#include "catch.hpp"
+#include "fixture.h"
+#include "gdbwire.h"
+#include "gdbwire_varobj_cache.h"
+
+namespace {
+    struct GdbwireVarobjCacheTest : public Fixture {
+        GdbwireVarobjCacheTest() {
+            struct gdbwire_varobj_cache_callbacks callbacks;
+
+            memset(&callbacks, 0, sizeof(callbacks));
+            callbacks.context = (void*)this;
+            callbacks.gdbwire_varobj_fn = GdbwireVarobjCacheTest::varobj;
+
+            added = modified = deleted = 0;
+
+            cache = gdbwire_varobj_cache_create(callbacks);
+            REQUIRE(cache);
+        }
+
+        ~GdbwireVarobjCacheTest() {
+            gdbwire_varobj_cache_destroy(cache);
+        }
+
+        static void varobj(void *context,
+                enum gdbwire_varobj_cache_change change,
+                struct gdbwire_varobj *varobj) {
+            GdbwireVarobjCacheTest *test = (GdbwireVarobjCacheTest *)context;
+            REQUIRE(varobj);
+            REQUIRE(varobj->varobj);
+            switch (change) {
+                case GDBWIRE_VAROBJ_CACHE_ADDED:
+                    test->added++;
+                    break;
+                case GDBWIRE_VAROBJ_CACHE_MODIFIED:
+                    test->modified++;
+                    break;
+                case GDBWIRE_VAROBJ_CACHE_DELETED:
+                    test->deleted++;
+                    break;
+            }
+        }
+
+        /**
+         * Decode a GDB/MI command from a file in the test data directory.
+         *
+         * @param name
+         * The name of the file in the GdbwireVarobjCacheTest directory.
+         *
+         * @param kind
+         * The kind of command to decode.
+         *
+         * @return
+         * The decoded command, free it with gdbwire_mi_command_free.
+         */
+        gdbwire_mi_command *exec(const std::string &name,
+                enum gdbwire_mi_command_kind kind) {
+            std::string mi = getFileContents(sourceFixturePath(name));
+            struct gdbwire_mi_command *mi_command = 0;
+
+            REQUIRE(gdbwire_interpreter_exec(mi.c_str(), kind,
+                &mi_command) == GDBWIRE_OK);
+            REQUIRE(mi_command);
+            return mi_command;
+        }
+
+        /**
+         * Fill the cache with var1, it's children and var2.
+         */
+        void fill() {
+            gdbwire_mi_command *mi_command;
+
+            mi_command = exec("create.mi", GDBWIRE_MI_VAR_CREATE);
+            REQUIRE(gdbwire_varobj_cache_var_create(cache, mi_command) ==
+                GDBWIRE_OK);
+            REQUIRE(!mi_command->variant.var_create.varobj);
+            gdbwire_mi_command_free(mi_command);
+
+            mi_command = exec("list_children.mi",
+                GDBWIRE_MI_VAR_LIST_CHILDREN);
+            REQUIRE(gdbwire_varobj_cache_var_list_children(cache, "var1",
+                mi_command) == GDBWIRE_OK);
+            REQUIRE(!mi_command->variant.var_list_children.children);
+            gdbwire_mi_command_free(mi_command);
+
+            mi_command = exec("create_var2.mi", GDBWIRE_MI_VAR_CREATE);
+            REQUIRE(gdbwire_varobj_cache_var_create(cache, mi_command) ==
+                GDBWIRE_OK);
+            gdbwire_mi_command_free(mi_command);
+        }
+
+        gdbwire_varobj_cache *cache;
+
+        int added, modified, deleted;
+    };
+}
+
+TEST_CASE_METHOD_N(GdbwireVarobjCacheTest, destroy/null_instance)
+{
+    gdbwire_varobj_cache_destroy(NULL);
+}
+
+TEST_CASE_METHOD_N(GdbwireVarobjCacheTest, var_list_children/basic)
+{
+    struct gdbwire_varobj *var1, *x;
+
+    fill();
+    REQUIRE(added == 4);
+    REQUIRE(gdbwire_varobj_cache_size(cache) == 4);
+
+    var1 = gdbwire_varobj_cache_find(cache, "var1");
+    REQUIRE(var1);
+    REQUIRE(!var1->parent);
+    REQUIRE(var1->children_size == 2);
+
+    x = gdbwire_varobj_cache_find(cache, "var1.x");
+    REQUIRE(x == var1->children[0]);
+    REQUIRE(x->parent == var1);
+    REQUIRE(x->varobj->exp == std::string("x"));
+    REQUIRE(x->varobj->value == std::string("3"));
+
+    /* Listing the children again modifies them rather than adding */
+    gdbwire_mi_command *mi_command = exec("list_children.mi",
+        GDBWIRE_MI_VAR_LIST_CHILDREN);
+    REQUIRE(gdbwire_varobj_cache_var_list_children(cache, "var1",
+        mi_command) == GDBWIRE_OK);
+    gdbwire_mi_command_free(mi_command);
+    REQUIRE(added == 4);
+    REQUIRE(modified == 2);
+    REQUIRE(var1->children_size == 2);
+
+    /* The children of an unknown variable object are rejected */
+    mi_command = exec("list_children.mi", GDBWIRE_MI_VAR_LIST_CHILDREN);
+    REQUIRE(gdbwire_varobj_cache_var_list_children(cache, "var7",
+        mi_command) == GDBWIRE_LOGIC);
+    gdbwire_mi_command_free(mi_command);
+}
+
+TEST_CASE_METHOD_N(GdbwireVarobjCacheTest, var_update/values)
+{
+    struct gdbwire_varobj *x, *y, *var2;
+    gdbwire_mi_command *mi_command;
+
+    fill();
+    modified = 0;
+
+    mi_command = exec("update.mi", GDBWIRE_MI_VAR_UPDATE);
+    REQUIRE(gdbwire_varobj_cache_var_update(cache, mi_command) ==
+        GDBWIRE_OK);
+    /* The old value was moved into the change */
+    REQUIRE(mi_command->variant.var_update.changes->value ==
+        std::string("3"));
+    gdbwire_mi_command_free(mi_command);
+
+    /* Only the variable objects in the cache that changed are modified */
+    REQUIRE(modified == 2);
+    REQUIRE(added == 4);
+
+    x = gdbwire_varobj_cache_find(cache, "var1.x");
+    REQUIRE(x->varobj->value == std::string("5"));
+    REQUIRE(x->in_scope == GDBWIRE_MI_VAROBJ_IN_SCOPE);
+
+    y = gdbwire_varobj_cache_find(cache, "var1.y");
+    REQUIRE(y->varobj->value == std::string("4"));
+
+    var2 = gdbwire_varobj_cache_find(cache, "var2");
+    REQUIRE(var2->in_scope == GDBWIRE_MI_VAROBJ_OUT_OF_SCOPE);
+    REQUIRE(var2->varobj->value == std::string("1"));
+
+    REQUIRE(!gdbwire_varobj_cache_find(cache, "var9"));
+}
+
+TEST_CASE_METHOD_N(GdbwireVarobjCacheTest, var_update/type_changed)
+{
+    struct gdbwire_varobj *var1;
+    gdbwire_mi_command *mi_command;
+
+    fill();
+
+    mi_command = exec("type_changed.mi", GDBWIRE_MI_VAR_UPDATE);
+    REQUIRE(gdbwire_varobj_cache_var_update(cache, mi_command) ==
+        GDBWIRE_OK);
+    gdbwire_mi_command_free(mi_command);
+
+    /* The children are deleted along with the old type */
+    REQUIRE(deleted == 2);
+    REQUIRE(gdbwire_varobj_cache_size(cache) == 2);
+    REQUIRE(!gdbwire_varobj_cache_find(cache, "var1.x"));
+
+    var1 = gdbwire_varobj_cache_find(cache, "var1");
+    REQUIRE(var1->children_size == 0);
+    REQUIRE(var1->varobj->type == std::string("char *"));
+    REQUIRE(var1->varobj->numchild == 1);
+    REQUIRE(var1->varobj->value == std::string("0x601010"));
+}
+
+TEST_CASE_METHOD_N(GdbwireVarobjCacheTest, delete/child)
+{
+    struct gdbwire_varobj *var1;
+
+    fill();
+
+    REQUIRE(gdbwire_varobj_cache_delete(cache, "var1.x") == GDBWIRE_OK);
+    REQUIRE(deleted == 1);
+    var1 = gdbwire_varobj_cache_find(cache, "var1");
+    REQUIRE(var1->children_size == 1);
+    REQUIRE(var1->children[0]->varobj->name == std::string("var1.y"));
+
+    REQUIRE(gdbwire_varobj_cache_delete(cache, "var1") == GDBWIRE_OK);
+    REQUIRE(deleted == 3);
+    REQUIRE(gdbwire_varobj_cache_size(cache) == 1);
+    REQUIRE(gdbwire_varobj_cache_delete(cache, "var1") == GDBWIRE_LOGIC);
+}